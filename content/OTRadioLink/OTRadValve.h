@@ -49,9 +49,15 @@ Author(s) / Copyright (s): Damon Hart-Davis 2015--2016
 // Driver for FHT8V wireless valve actuator (and FS20 protocol encode/decode).
 #include "utility/OTRadValve_FHT8VRadValve.h"
 
+// Streaming motor-current stall detection and run profiles.
+#include "utility/OTRadValve_MotorCurrentMonitor.h"
+
 // Hardware-independent logic for direct proportional valve motor drive..
 #include "utility/OTRadValve_CurrentSenseValveMotorDirect.h"
 
+// Simulated valve motor and benchmark harness, host only.
+#include "utility/OTRadValve_ValveMotorSimulator.h"
+
 // Base for TRV1 (DORM1/REV7) and TRV2 direct valve motor drive.
 #include "utility/OTRadValve_ValveMotorBase.h"
 
@@ -28,6 +28,7 @@ Author(s) / Copyright (s): Damon Hart-Davis 2015--2016
 #include "utility/OTRadioLink_FrameType.h"
 #include "utility/OTRadioLink_SecureableFrameType.h"
 #include "utility/OTRadioLink_SecureableFrameType_V0p2Impl.h"
+#include "utility/OTRadioLink_TXMsgCtrReservation.h"
 #include "utility/OTRadioLink_Messaging.h"
 
 // Radio Link base class definition.
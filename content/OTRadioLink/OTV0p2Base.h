@@ -62,6 +62,15 @@ Author(s) / Copyright (s): Damon Hart-Davis 2015--2016
 // Some basic utility functions and definitions.
 #include "utility/OTV0P2BASE_Util.h"
 
+// Hot-path profiler with named scoped probes.
+#include "utility/OTV0P2BASE_Profiler.h"
+
+// Major-cycle time budget accounting.
+#include "utility/OTV0P2BASE_CycleBudget.h"
+
+// Wear-levelled log-structured key-value store for non-volatile storage.
+#include "utility/OTV0P2BASE_NVKVJournal.h"
+
 // EEPROM space allocation and utilities.
 #include "utility/OTV0P2BASE_EEPROM.h"
 
@@ -76,14 +85,18 @@ Author(s) / Copyright (s): Damon Hart-Davis 2015--2016
 
 // Minimal light-weight standard-speed OneWire(TM) support.
 #include "utility/OTV0P2BASE_MinOW.h"
+#include "utility/OTV0P2BASE_MinOWSimulator.h"
 
 // Base/common sensor and actuator types.
 #include "utility/OTV0P2BASE_Sensor.h"
 #include "utility/OTV0P2BASE_Actuator.h"
+#include "utility/OTV0P2BASE_SensorPollScheduler.h"
 
 // Concrete sensor implementations.
 #include "utility/OTV0P2BASE_SensorAmbientLight.h"
 #include "utility/OTV0P2BASE_SensorAmbientLightOccupancy.h"
+// Sliding-window min/max, eg for the adaptive ambient light sensor.
+#include "utility/OTV0P2BASE_SlidingWindowMinMax.h"
 #include "utility/OTV0P2BASE_SensorTemperaturePot.h"
 #include "utility/OTV0P2BASE_SensorTemperatureC16Base.h"
 #include "utility/OTV0P2BASE_SensorTMP112.h"
@@ -101,6 +114,8 @@ Author(s) / Copyright (s): Damon Hart-Davis 2015--2016
 
 // Software Real-Time Clock (RTC) support.
 #include "utility/OTV0P2BASE_RTC.h"
+// Deterministic virtual time for (host) simulations.
+#include "utility/OTV0P2BASE_VirtualTimeScheduler.h"
 
 // ADC (Analogue-to-Digital Converter) support.
 #include "utility/OTV0P2BASE_ADC.h"
@@ -33,11 +33,26 @@ namespace OTRN2483Link
 
 // TODO proper constructor
 
-OTRN2483Link::OTRN2483Link(uint8_t _nRstPin, uint8_t rxPin, uint8_t txPin) : config(NULL), ser(rxPin, txPin), nRstPin(_nRstPin) {
+OTRN2483Link::OTRN2483Link(uint8_t _nRstPin, uint8_t rxPin, uint8_t txPin) : config(NULL), ser(rxPin, txPin), nRstPin(_nRstPin), lastPollSecondsLT(0) {
 	bAvailable = false;
 	// Init OTSoftSerial
 }
 
+/**
+ * @brief   Adapts OTSoftSerial to the Stream-style interface used by TXScheduler.
+ * @note    OTSoftSerial::read() returns 0 on timeout; RN2483 replies are
+ *          printable ASCII so 0 is mapped to -1 (nothing available).
+ */
+class SoftSerialTXAdapter final
+{
+    OTV0P2BASE::OTSoftSerial &s;
+public:
+    explicit SoftSerialTXAdapter(OTV0P2BASE::OTSoftSerial &_s) : s(_s) { }
+    int read() { const uint8_t c = s.read(); return((0 == c) ? -1 : c); }
+    void print(const char c) { s.print(c); }
+    void print(const char *str) { s.print(str); }
+};
+
 bool OTRN2483Link::begin() {
 	char buffer[5];
 	memset(buffer, 0, 5);
@@ -140,9 +155,31 @@ bool OTRN2483Link::sendRaw(const uint8_t* buf, uint8_t buflen,
 }
 
 
-void OTRN2483Link::poll()
+/**
+ * @brief   Queues a frame to be sent by poll() when duty-cycle credit allows.
+ *          Several small frames queued close together are aggregated into one uplink.
+ * @retval  false if the frame cannot be queued.
+ */
+bool OTRN2483Link::queueToSend(const uint8_t *buf, uint8_t buflen,
+        int8_t /*channel*/, TXpower /*power*/)
 {
+    return(txScheduler.queueFrame(buf, buflen));
+}
 
+void OTRN2483Link::poll()
+{
+    // Restore duty-cycle credit for time elapsed since the last poll.
+    const uint8_t now = OTV0P2BASE::getSecondsLT();
+    txScheduler.addElapsedMs(1000UL * OTV0P2BASE::getElapsedSecondsLT(lastPollSecondsLT, now));
+    lastPollSecondsLT = now;
+    if(0 == txScheduler.getFramesQueued()) { return; }
+#ifdef RN2483_ALLOW_SLEEP
+    if(0 != txScheduler.msUntilNextTX()) { return; }
+    setBaud();
+    OTV0P2BASE::nap(WDTO_15MS, true);
+#endif // RN2483_ALLOW_SLEEP
+    SoftSerialTXAdapter adapter(ser);
+    txScheduler.poll(adapter);
 }
 
 uint8_t OTRN2483Link::timedBlockingRead(char *data, uint8_t length)
@@ -434,7 +471,7 @@ void OTRN2483Link::getCapacity(uint8_t& queueRXMsgsMin,
 		uint8_t& maxRXMsgLen, uint8_t& maxTXMsgLen) const {
     queueRXMsgsMin = 0;
     maxRXMsgLen = 0;
-    maxTXMsgLen = 0;
+    maxTXMsgLen = LoRaWANEU868::maxPayload(txScheduler.getDataRate());
 }
 uint8_t OTRN2483Link::getRXMsgsQueued() const {
     return 0;
@@ -67,6 +67,8 @@ Author(s) / Copyright (s): Deniz Erbilgin 2016
 #include <string.h>
 #include <stdint.h>
 
+#include "OTRN2483Link_TXScheduler.h"
+
 namespace OTRN2483Link
 {
 
@@ -127,12 +129,14 @@ public:
     bool end();
 
     bool sendRaw(const uint8_t *buf, uint8_t buflen, int8_t channel = 0, TXpower power = TXnormal, bool listenAfter = false);
-//    bool queueToSend(const uint8_t *buf, uint8_t buflen, int8_t channel = 0, TXpower power = TXnormal);
+    bool queueToSend(const uint8_t *buf, uint8_t buflen, int8_t channel = 0, TXpower power = TXnormal);
     inline bool isAvailable(){ return bAvailable; };     // checks radio is there independant of power state
     bool handleInterruptSimple() { return true;};
 
     /**
-     * @brief   Unused. For compatibility with OTRadioLink.
+     * @brief   Releases queued frames (see queueToSend()) as duty-cycle credit allows.
+     * @note    Call at least once a minute, eg once per major cycle;
+     *          less frequent calls under-count elapsed time and so only delay TX.
      */
     void poll();
     void getCapacity(uint8_t &queueRXMsgsMin, uint8_t &maxRXMsgLen, uint8_t &maxTXMsgLen) const;
@@ -177,6 +181,10 @@ private:
     static const uint16_t baud = 2400;	 // OTSoftSer baud rate. todo switch to template to allow higher speed
     bool bAvailable;
     const uint8_t nRstPin;
+    // Queued uplinks waiting for duty-cycle credit.
+    TXScheduler<> txScheduler;
+    // Seconds value (getSecondsLT()) at the last poll(), for duty-cycle credit.
+    uint8_t lastPollSecondsLT;
 
 
     static const char SYS_START[5];	  // Beginning of "sys" command set
@@ -0,0 +1,379 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * LoRaWAN (EU868) TX batching and duty-cycle scheduling for the RN2483.
+ *
+ * Portable so that it can be driven with a simulated serial stream in unit tests.
+ *
+ * See OTRN2483Link_IMPLEMENTATION_NOTES.txt for the airtime and duty-cycle background.
+ */
+
+#ifndef OTRN2483LINK_TXSCHEDULER_H_
+#define OTRN2483LINK_TXSCHEDULER_H_
+
+#include <stdint.h>
+#include <string.h>
+
+namespace OTRN2483Link
+{
+
+
+/**
+ * @brief   EU868 LoRaWAN class A constants and airtime calculation.
+ *          Data rates 0 to 5 correspond to SF12 to SF7 at 125 kHz.
+ */
+namespace LoRaWANEU868
+{
+    // Highest supported data rate (SF7/125kHz).
+    static constexpr uint8_t MAX_DR = 5;
+    // LoRaWAN MAC overhead in bytes: MHDR (1) + FHDR without FOpts (7) + FPort (1) + MIC (4).
+    static constexpr uint8_t MAC_OVERHEAD = 13;
+
+    /**
+     * @brief   Spreading factor for a data rate.
+     * @param   dataRate: 0 (SF12) to 5 (SF7); higher values are treated as 5.
+     */
+    inline constexpr uint8_t spreadingFactor(const uint8_t dataRate)
+        { return((dataRate > MAX_DR) ? 7 : (12 - dataRate)); }
+
+    /**
+     * @brief   Maximum application payload (N) in bytes for a data rate, without FOpts.
+     * @note    The implementation notes give M = N + 8: 59/59/59/123/230/230.
+     */
+    inline constexpr uint8_t maxPayload(const uint8_t dataRate)
+        { return((dataRate <= 2) ? 51 : ((3 == dataRate) ? 115 : 222)); }
+
+    /**
+     * @brief   Time on air in milliseconds (rounded up) for an uplink.
+     * @param   dataRate: 0 (SF12) to 5 (SF7).
+     * @param   appPayloadLen: Application payload length in bytes, excluding MAC_OVERHEAD.
+     * @note    Semtech formula for 125 kHz, CR 4/5, explicit header, CRC on,
+     *          8 symbol preamble, and low data rate optimisation at SF11/SF12.
+     *          All integer arithmetic in microseconds.
+     */
+    inline uint32_t airtimeMs(const uint8_t dataRate, const uint8_t appPayloadLen)
+    {
+        const uint8_t sf = spreadingFactor(dataRate);
+        const uint8_t de = (sf >= 11) ? 1 : 0;
+        const uint16_t pl = uint16_t(appPayloadLen) + MAC_OVERHEAD;
+        // Symbol time at 125 kHz is 2^SF / 125000 s == 8 * 2^SF us.
+        const uint32_t tSymUs = uint32_t(8) << sf;
+        // Payload symbols: 8 + max(ceil((8PL - 4SF + 28 + 16) / (4(SF - 2DE))) * (CR + 4), 0).
+        const int16_t num = int16_t(8 * pl) - int16_t(4 * sf) + 44;
+        const int16_t den = int16_t(4 * (sf - 2 * de));
+        const uint16_t blocks = (num > 0) ? uint16_t((num + den - 1) / den) : 0;
+        const uint32_t nPayloadSym = 8 + uint32_t(blocks) * 5;
+        // Preamble is (8 + 4.25) symbols, so work in quarter symbols.
+        const uint32_t us = (tSymUs * (49 + 4 * nPayloadSym)) / 4;
+        return((us + 999) / 1000);
+    }
+}
+
+
+/**
+ * @brief   Per-sub-band transmit off-time tracker, as the RN2483 and
+ *          LoRaWAN regional parameters enforce duty cycle.
+ *          After a TX of airtime T on a band with duty cycle 1/d,
+ *          that band may not transmit again for T * (d - 1).
+ * @param   nSubBands: Number of sub-bands tracked.
+ */
+template<uint8_t nSubBands>
+class DutyCycleTracker final
+{
+    static_assert(nSubBands > 0, "need at least one sub-band");
+    // Remaining off-time in ms per sub-band; 0 means TX allowed.
+    uint32_t offTimeMs[nSubBands];
+    // Duty-cycle divisor per sub-band, eg 100 for 1%.
+    uint16_t dutyDivisor[nSubBands];
+
+public:
+    // All sub-bands start free, at 1% duty cycle.
+    DutyCycleTracker()
+    {
+        for(uint8_t i = 0; i < nSubBands; ++i) { offTimeMs[i] = 0; dutyDivisor[i] = 100; }
+    }
+
+    /**
+     * @brief   Set duty cycle for a sub-band as a divisor, eg 100 for 1%, 1000 for 0.1%.
+     */
+    void setDutyDivisor(const uint8_t band, const uint16_t divisor)
+        { if((band < nSubBands) && (0 != divisor)) { dutyDivisor[band] = divisor; } }
+
+    /**
+     * @brief   Account for elapsed wall-clock time.
+     * @note    Under-reporting elapsed time is safe (merely conservative).
+     */
+    void addElapsedMs(const uint32_t ms)
+    {
+        for(uint8_t i = 0; i < nSubBands; ++i)
+            { offTimeMs[i] = (offTimeMs[i] > ms) ? (offTimeMs[i] - ms) : 0; }
+    }
+
+    /**
+     * @brief   True if a sub-band is free to transmit now.
+     */
+    bool canTX(const uint8_t band) const
+        { return((band < nSubBands) && (0 == offTimeMs[band])); }
+
+    /**
+     * @brief   Milliseconds until a sub-band is free; 0 if free now.
+     */
+    uint32_t msUntilFree(const uint8_t band) const
+        { return((band < nSubBands) ? offTimeMs[band] : UINT32_MAX); }
+
+    /**
+     * @brief   Record a transmission of the given airtime on a sub-band.
+     */
+    void recordTX(const uint8_t band, const uint32_t airtimeMs)
+    {
+        if(band >= nSubBands) { return; }
+        const uint32_t off = airtimeMs * (dutyDivisor[band] - 1);
+        // Back-to-back TX (eg forced) extends rather than replaces the off-time.
+        offTimeMs[band] += off;
+    }
+};
+
+
+/**
+ * @brief   Small TX queue for the RN2483 that releases uplinks only when the
+ *          duty-cycle tracker allows, aggregating several queued frames into
+ *          one uplink up to the data-rate dependent payload limit.
+ *
+ *          A single queued frame is sent unchanged on FPort SINGLE_FRAME_PORT,
+ *          as the original one-frame-per-sendRaw() driver did.
+ *          Two or more frames are sent on FPort BATCH_PORT with each frame
+ *          preceded by a single length byte, so the server can split them.
+ *
+ *          Frames are kept in FIFO order in one flat buffer as
+ *          [len][frame bytes]... with no per-frame padding.
+ *
+ * @param   queueBytes: Queue buffer size, including one length byte per frame.
+ * @param   nSubBands: Number of duty-cycle sub-bands tracked.
+ * @note    The RN2483 default channels (868.1/868.3/868.5 MHz) all lie in
+ *          sub-band 0 (868.0--868.6 MHz, 1%), which is all this uses for now.
+ */
+template<uint8_t queueBytes = 128, uint8_t nSubBands = 1>
+class TXScheduler final
+{
+public:
+    // FPort for a single unmodified frame.
+    static constexpr uint8_t SINGLE_FRAME_PORT = 1;
+    // FPort for length-prefixed aggregated frames.
+    static constexpr uint8_t BATCH_PORT = 2;
+    // Sub-band used for TX.
+    static constexpr uint8_t TX_BAND = 0;
+    // Maximum RN2483 reply line retained for parsing.
+    static constexpr uint8_t MAX_REPLY_CHARS = 16;
+
+    // Result of poll().
+    enum txStatus_t : uint8_t
+    {
+        TX_IDLE,        // Nothing queued.
+        TX_DEFERRED,    // Frames queued but no duty-cycle credit (or module busy).
+        TX_SENT,        // Uplink accepted by the module.
+        TX_FAILED       // Module rejected the uplink; frames were dropped.
+    };
+
+private:
+    // Queued frames as [len][bytes]...
+    uint8_t q[queueBytes];
+    // Bytes of q in use.
+    uint8_t qUsed = 0;
+    // Number of frames queued.
+    uint8_t qFrames = 0;
+    // Data rate assumed for payload limits and airtime; conservative by default.
+    uint8_t dataRate = 1;
+    // Off-time tracker.
+    DutyCycleTracker<nSubBands> dc;
+    // Count of uplinks sent and frames sent, saturating.
+    uint16_t uplinksSent = 0;
+    uint16_t framesSent = 0;
+
+    /**
+     * @brief   Work out how many frames from the head of the queue go in the next uplink.
+     * @param   payloadLen: Set to the uplink payload length.
+     * @retval  Number of frames; 0 if the queue is empty.
+     */
+    uint8_t planUplink(uint8_t &payloadLen) const
+    {
+        payloadLen = 0;
+        if(0 == qFrames) { return(0); }
+        const uint8_t limit = LoRaWANEU868::maxPayload(dataRate);
+        uint8_t n = 0;
+        uint16_t total = 0;
+        for(uint8_t pos = 0; n < qFrames; ++n) {
+            const uint16_t step = uint16_t(q[pos]) + 1;
+            if(total + step > limit) { break; }
+            total += step;
+            pos += step;
+        }
+        // Only one frame queued or fitting: send it as-is, without its length byte.
+        if(n <= 1) { payloadLen = q[0]; return(1); }
+        payloadLen = uint8_t(total);
+        return(n);
+    }
+
+    // Remove n frames from the head of the queue.
+    void dropFrames(uint8_t n)
+    {
+        uint8_t pos = 0;
+        for(uint8_t i = 0; (i < n) && (pos < qUsed); ++i) { pos += q[pos] + 1; }
+        memmove(q, q + pos, qUsed - pos);
+        qUsed -= pos;
+        qFrames -= n;
+    }
+
+    // Print one byte as two upper-case hex digits.
+    template<class ser_t>
+    static void printHexByte(ser_t &ser, const uint8_t b)
+    {
+        static const char hex[] = "0123456789ABCDEF";
+        ser.print(hex[b >> 4]);
+        ser.print(hex[b & 0xf]);
+    }
+
+    /**
+     * @brief   Read one reply line, dropping CR/LF.
+     * @retval  Length read; 0 if nothing arrived before read() returned -1.
+     */
+    template<class ser_t>
+    static uint8_t readReplyLine(ser_t &ser, char *buf, const uint8_t bufLen)
+    {
+        uint8_t n = 0;
+        for( ; ; ) {
+            const int ic = ser.read();
+            if((-1 == ic) || ('\n' == ic)) { break; }
+            if(('\r' != ic) && (n < bufLen - 1)) { buf[n++] = char(ic); }
+        }
+        buf[n] = '\0';
+        return(n);
+    }
+
+public:
+    /**
+     * @brief   Set the data rate used for payload limits and airtime.
+     * @note    With ADR on this should be the slowest rate permitted.
+     */
+    void setDataRate(const uint8_t dr) { dataRate = (dr > LoRaWANEU868::MAX_DR) ? LoRaWANEU868::MAX_DR : dr; }
+    uint8_t getDataRate() const { return(dataRate); }
+
+    // Direct access to the duty-cycle tracker, eg to set sub-band duty cycles.
+    DutyCycleTracker<nSubBands> &getDutyCycleTracker() { return(dc); }
+
+    /**
+     * @brief   Queue a frame for sending.
+     * @retval  false if the frame is empty, too long for one uplink at the
+     *          current data rate, or there is no space left in the queue.
+     */
+    bool queueFrame(const uint8_t *buf, const uint8_t buflen)
+    {
+        if((NULL == buf) || (0 == buflen)) { return(false); }
+        if(buflen > LoRaWANEU868::maxPayload(dataRate)) { return(false); }
+        if(uint16_t(qUsed) + buflen + 1 > queueBytes) { return(false); }
+        q[qUsed] = buflen;
+        memcpy(q + qUsed + 1, buf, buflen);
+        qUsed += buflen + 1;
+        ++qFrames;
+        return(true);
+    }
+
+    // Number of frames waiting to be sent.
+    uint8_t getFramesQueued() const { return(qFrames); }
+    // Counts of uplinks and frames sent.
+    uint16_t getUplinksSent() const { return(uplinksSent); }
+    uint16_t getFramesSent() const { return(framesSent); }
+
+    /**
+     * @brief   Account for elapsed time, restoring duty-cycle credit.
+     */
+    void addElapsedMs(const uint32_t ms) { dc.addElapsedMs(ms); }
+
+    /**
+     * @brief   Milliseconds until the next queued uplink could be released; 0 if now or idle.
+     */
+    uint32_t msUntilNextTX() const { return((0 == qFrames) ? 0 : dc.msUntilFree(TX_BAND)); }
+
+    /**
+     * @brief   Build the next uplink payload without removing it from the queue.
+     * @param   out: Buffer of at least LoRaWANEU868::maxPayload(getDataRate()) bytes.
+     * @param   port: Set to the LoRaWAN FPort to use.
+     * @param   nFrames: Set to the number of frames included.
+     * @retval  Payload length; 0 if nothing queued.
+     */
+    uint8_t buildUplink(uint8_t *out, uint8_t &port, uint8_t &nFrames) const
+    {
+        uint8_t len;
+        nFrames = planUplink(len);
+        if(0 == nFrames) { return(0); }
+        if(1 == nFrames) { memcpy(out, q + 1, len); port = SINGLE_FRAME_PORT; }
+        else { memcpy(out, q, len); port = BATCH_PORT; }
+        return(len);
+    }
+
+    /**
+     * @brief   Send the next uplink if duty-cycle credit allows.
+     *          Writes "mac tx uncnf <port> <hex>\r\n" and reads the immediate reply line:
+     *            - "ok": accepted; frames are removed and airtime charged.
+     *            - "no_free_ch" or "busy": kept for a later attempt.
+     *            - anything else (eg "invalid_data_len"): frames are dropped.
+     * @param   ser: Stream connected to the RN2483.
+     * @note    Airtime is charged to the tracker even if the module later
+     *          reports a failure, which keeps the tracker conservative.
+     */
+    template<class ser_t>
+    txStatus_t poll(ser_t &ser)
+    {
+        if(0 == qFrames) { return(TX_IDLE); }
+        if(!dc.canTX(TX_BAND)) { return(TX_DEFERRED); }
+        uint8_t len;
+        const uint8_t nFrames = planUplink(len);
+        // Stream the payload straight from the queue to save stack.
+        const uint8_t *payload = (1 == nFrames) ? (q + 1) : q;
+        const uint8_t port = (1 == nFrames) ? SINGLE_FRAME_PORT : BATCH_PORT;
+        // Drop any stale input so the reply can be matched.
+        while(-1 != ser.read()) { }
+        ser.print("mac tx uncnf ");
+        ser.print(char('0' + port));
+        ser.print(' ');
+        for(uint8_t i = 0; i < len; ++i) { printHexByte(ser, payload[i]); }
+        ser.print("\r\n");
+        char reply[MAX_REPLY_CHARS];
+        readReplyLine(ser, reply, sizeof(reply));
+        if(0 == strcmp(reply, "ok")) {
+            dc.recordTX(TX_BAND, LoRaWANEU868::airtimeMs(dataRate, len));
+            dropFrames(nFrames);
+            if(0xffff != uplinksSent) { ++uplinksSent; }
+            framesSent = (0xffff - framesSent < nFrames) ? 0xffff : (framesSent + nFrames);
+            return(TX_SENT);
+        }
+        if((0 == strcmp(reply, "no_free_ch")) || (0 == strcmp(reply, "busy")) || ('\0' == reply[0]))
+            { return(TX_DEFERRED); }
+        dropFrames(nFrames);
+        return(TX_FAILED);
+    }
+};
+// Out-of-class definitions for ODR-use (C++11).
+template<uint8_t queueBytes, uint8_t nSubBands> constexpr uint8_t TXScheduler<queueBytes, nSubBands>::SINGLE_FRAME_PORT;
+template<uint8_t queueBytes, uint8_t nSubBands> constexpr uint8_t TXScheduler<queueBytes, nSubBands>::BATCH_PORT;
+template<uint8_t queueBytes, uint8_t nSubBands> constexpr uint8_t TXScheduler<queueBytes, nSubBands>::TX_BAND;
+template<uint8_t queueBytes, uint8_t nSubBands> constexpr uint8_t TXScheduler<queueBytes, nSubBands>::MAX_REPLY_CHARS;
+
+
+} // namespace OTRN2483Link
+#endif /* OTRN2483LINK_TXSCHEDULER_H_ */
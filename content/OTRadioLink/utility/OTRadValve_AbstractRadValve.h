@@ -246,6 +246,13 @@ class HardwareMotorDriverInterfaceCallbackHandler
     // Called with each motor run sub-cycle tick.
     // Is ISR-/thread- safe.
     virtual void signalRunSCTTick(bool opening) = 0;
+
+    // Called with each raw motor current sample taken while the motor runs.
+    // Returns true if a stall (eg end-stop) is detected from the current profile,
+    // when the driver should stop as if the current were high.
+    // By default ignores the sample.
+    // Must return very quickly.
+    virtual bool signalMotorCurrent(bool /*opening*/, uint16_t /*current*/) { return(false); }
   };
 
 // Trivial do-nothing implementation of HardwareMotorDriverInterfaceCallbackHandler.
@@ -286,6 +293,9 @@ class HardwareMotorDriverInterface
     // Detect (poll) if end-stop is reached or motor current otherwise very high.
     virtual bool isCurrentHigh(HardwareMotorDriverInterface::motor_drive mdir = motorDriveOpening) const = 0;
 
+    // Raw motor current reading (eg ADC counts), or 0 if not available for this driver.
+    virtual uint16_t readMotorCurrent() const { return(0); }
+
     // Poll simple shaft encoder output; true if on mark, false if not or if unused for this driver.
     virtual bool isOnShaftEncoderMark() const { return(false); }
 
@@ -107,6 +107,219 @@ public:
 
 namespace BoilerLogic
 {
+/**
+ * @brief   Tracks the last reported open percentage from each of up to maxValves remote valves by ID,
+ *          keeping aggregate demand (sum, max, and count/sum at or above a threshold) up to date
+ *          incrementally so that each report costs O(1) (expected) rather than a rescan of all valves.
+ *
+ * Each report expires expiryM minutes after receipt unless refreshed.
+ * Expiry uses a timing wheel of per-minute buckets
+ * so that each minute tick touches only the entries actually expiring.
+ *
+ * IDs are held in a small open-addressed (linear probing) table;
+ * expired entries stay as tombstones until reused so that probe chains are not broken.
+ * The max is exact, but is recomputed lazily by a scan
+ * only if the last valve holding the maximum value expires or drops.
+ *
+ * @param   maxValves: maximum distinct valves tracked at once; [1,254].
+ * @param   expiryM: minutes after the last report that a valve is forgotten; [1,15].
+ * @note    Not ISR-/thread- safe.
+ */
+template<uint8_t maxValves = 8, uint8_t expiryM = 15>
+class ValveDemandTracker final
+{
+public:
+    // ID never accepted from a remote valve, marking an empty slot.
+    static constexpr uint16_t EMPTY_ID = 0xffffU;
+    // Number of (minute) buckets in the timing wheel; a power of two.
+    static constexpr uint8_t WHEEL_SLOTS = 16;
+
+private:
+    static_assert((maxValves > 0) && (maxValves < 255), "maxValves out of range");
+    static_assert((expiryM > 0) && (expiryM < WHEEL_SLOTS), "expiryM out of range");
+
+    // Marks no entry, eg end of a wheel bucket list.
+    static constexpr uint8_t NONE = 0xff;
+
+    // Per-valve state.
+    struct entry_t
+    {
+        // Remote valve ID; EMPTY_ID if the slot has never been used.
+        uint16_t id;
+        // Last reported percentage open [0,100].
+        uint8_t percentOpen;
+        // Wheel bucket this entry expires from; NONE if not live (empty or expired).
+        uint8_t bucket;
+        // Doubly-linked list within the wheel bucket.
+        uint8_t next, prev;
+    };
+    entry_t entries[maxValves];
+
+    // Head of the list of entries expiring from each bucket.
+    uint8_t wheel[WHEEL_SLOTS];
+    // Current (most recently expired) wheel bucket.
+    uint8_t currentBucket;
+
+    // Minimum percentage open for a valve to be counted as calling for heat.
+    uint8_t threshold;
+
+    // Aggregates over live entries.
+    uint8_t liveCount;
+    uint8_t callingCount;
+    uint16_t sumPC;
+    uint16_t callingSumPC;
+    // Maximum percentage open and number of live entries at that value;
+    // if maxCount is zero the max must be recomputed.
+    uint8_t maxPC;
+    uint8_t maxCount;
+
+    // Initial probe position for id.
+    static inline uint8_t hash(const uint16_t id) { return(uint8_t(uint8_t(id ^ (id >> 8)) % maxValves)); }
+
+    // Find the entry for id, else the slot that it should be inserted into, else NONE if the table is full.
+    uint8_t find(const uint16_t id) const
+    {
+        uint8_t firstFree = NONE;
+        uint8_t i = hash(id);
+        for(uint8_t n = maxValves; n-- > 0; ) {
+            const entry_t &e = entries[i];
+            if(id == e.id) { return(i); }
+            if(EMPTY_ID == e.id) { return((NONE != firstFree) ? firstFree : i); }
+            if((NONE == e.bucket) && (NONE == firstFree)) { firstFree = i; }
+            if(++i >= maxValves) { i = 0; }
+        }
+        return(firstFree);
+    }
+
+    // Add live entry i to aggregates and to wheel bucket b.
+    void add(const uint8_t i, const uint8_t b)
+    {
+        entry_t &e = entries[i];
+        const uint8_t pc = e.percentOpen;
+        ++liveCount;
+        sumPC += pc;
+        if(pc >= threshold) { ++callingCount; callingSumPC += pc; }
+        if(0 != maxCount) {
+            if(pc > maxPC) { maxPC = pc; maxCount = 1; }
+            else if(pc == maxPC) { ++maxCount; }
+        }
+        e.bucket = b;
+        e.prev = NONE;
+        e.next = wheel[b];
+        if(NONE != e.next) { entries[e.next].prev = i; }
+        wheel[b] = i;
+    }
+
+    // Remove live entry i from aggregates and from its wheel bucket, leaving it not live.
+    void remove(const uint8_t i)
+    {
+        entry_t &e = entries[i];
+        const uint8_t pc = e.percentOpen;
+        --liveCount;
+        sumPC -= pc;
+        if(pc >= threshold) { --callingCount; callingSumPC -= pc; }
+        if((0 != maxCount) && (pc == maxPC)) { --maxCount; }
+        if(NONE != e.prev) { entries[e.prev].next = e.next; } else { wheel[e.bucket] = e.next; }
+        if(NONE != e.next) { entries[e.next].prev = e.prev; }
+        e.bucket = NONE;
+    }
+
+public:
+    ValveDemandTracker(const uint8_t _threshold = OTRadValve::DEFAULT_VALVE_PC_SAFER_OPEN)
+      : threshold(_threshold) { reset(); }
+
+    // Forget all valves.
+    void reset()
+    {
+        for(uint8_t i = 0; i < maxValves; ++i) { entries[i].id = EMPTY_ID; entries[i].bucket = NONE; }
+        for(uint8_t b = 0; b < WHEEL_SLOTS; ++b) { wheel[b] = NONE; }
+        currentBucket = 0;
+        liveCount = 0; callingCount = 0;
+        sumPC = 0; callingSumPC = 0;
+        maxPC = 0; maxCount = 1; // Exact max of no valves is 0.
+    }
+
+    /**
+     * @brief   Record a report of percentOpen from valve id, restarting its expiry time.
+     * @param   id: remote valve ID (eg FHT8V housecode); EMPTY_ID is rejected.
+     * @param   percentOpen: [0,100]; higher values are treated as 100.
+     * @retval  false if the report is rejected, ie a bad ID or a new ID with the table full of live valves.
+     */
+    bool update(const uint16_t id, const uint8_t percentOpen)
+    {
+        if(EMPTY_ID == id) { return(false); }
+        const uint8_t i = find(id);
+        if(NONE == i) { return(false); }
+        entry_t &e = entries[i];
+        if(NONE != e.bucket) { remove(i); }
+        e.id = id;
+        e.percentOpen = OTV0P2BASE::fnmin(percentOpen, (uint8_t)100);
+        add(i, (currentBucket + expiryM) & (WHEEL_SLOTS - 1));
+        return(true);
+    }
+
+    // Advance time by one minute, expiring valves not heard from for expiryM minutes.
+    void tickMinute()
+    {
+        currentBucket = (currentBucket + 1) & (WHEEL_SLOTS - 1);
+        for(uint8_t i; NONE != (i = wheel[currentBucket]); ) {
+            remove(i);
+            // Tombstone not needed if no probe chain can continue past it.
+            const uint8_t n = (i + 1 >= maxValves) ? 0 : (i + 1);
+            if(EMPTY_ID == entries[n].id) { entries[i].id = EMPTY_ID; }
+        }
+    }
+
+    // Set the minimum percentage open for a valve to count as calling for heat; rescans all valves.
+    void setThreshold(const uint8_t _threshold)
+    {
+        threshold = _threshold;
+        callingCount = 0; callingSumPC = 0;
+        for(uint8_t i = 0; i < maxValves; ++i) {
+            const entry_t &e = entries[i];
+            if((NONE != e.bucket) && (e.percentOpen >= threshold)) { ++callingCount; callingSumPC += e.percentOpen; }
+        }
+    }
+    uint8_t getThreshold() const { return(threshold); }
+
+    // Last reported percentage open from the given valve, or 0 if not live.
+    uint8_t getPercentOpen(const uint16_t id) const
+    {
+        if(EMPTY_ID == id) { return(0); }
+        const uint8_t i = find(id);
+        if((NONE == i) || (id != entries[i].id) || (NONE == entries[i].bucket)) { return(0); }
+        return(entries[i].percentOpen);
+    }
+
+    // Number of valves currently live.
+    uint8_t getLiveCount() const { return(liveCount); }
+    // Number of live valves at or above the threshold.
+    uint8_t getCallingCount() const { return(callingCount); }
+    // Sum of percentages open of all live valves.
+    uint16_t getSumPC() const { return(sumPC); }
+    // Sum of percentages open of live valves at or above the threshold.
+    uint16_t getCallingSumPC() const { return(callingSumPC); }
+    // Maximum percentage open of any live valve, 0 if none.
+    uint8_t getMaxPC()
+    {
+        if(0 == maxCount) {
+            maxPC = 0;
+            for(uint8_t i = 0; i < maxValves; ++i) {
+                const entry_t &e = entries[i];
+                if(NONE == e.bucket) { continue; }
+                if(e.percentOpen > maxPC) { maxPC = e.percentOpen; maxCount = 1; }
+                else if(e.percentOpen == maxPC) { ++maxCount; }
+            }
+            if(0 == liveCount) { maxCount = 1; }
+        }
+        return(maxPC);
+    }
+};
+template<uint8_t maxValves, uint8_t expiryM>
+constexpr uint16_t ValveDemandTracker<maxValves, expiryM>::EMPTY_ID;
+template<uint8_t maxValves, uint8_t expiryM>
+constexpr uint8_t ValveDemandTracker<maxValves, expiryM>::WHEEL_SLOTS;
+
 /**Manages simple binary (on/off) boiler.
  * @param   outHeatCall: GPIO pin to call for heat on (high/1 => call for heat)
  * @param   forceMinBoilerOnTime: Forces boiler to use the default minimum on time rather than the value stored in
@@ -114,17 +327,25 @@ namespace BoilerLogic
  *          never activate.
  *          Defaults true so that the boiler driver will always work unless explicitly overridden..
  * @param   isRadValve: Unit is controlling a rad valve (local or remote).
+ * @param   maxTrackedValves: Maximum distinct remote valves whose demand is tracked by ID.
  * @note    (DE20170602) Removed support for:
  *          - case where unit is a boilerhub controller and also a TRV.
- *          - dealing with ID of caller for heat (was redundant in old implementation anyway).
  * @note Not ISR-/thread- safe; do not call from ISR RX.
  * @note: DHD20170614: TODO: refactor as an Actuator.
  */
 template<typename hm_t, hm_t &hm,
-         uint8_t outHeatCallPin, bool forceMinOnBoilerTime = true, bool isRadValve = false>
+         uint8_t outHeatCallPin, bool forceMinOnBoilerTime = true, bool isRadValve = false,
+         uint8_t maxTrackedValves = 8>
 class OnOffBoilerDriverLogic
 {
+public:
+    // Type of per-valve demand tracker.
+    typedef ValveDemandTracker<maxTrackedValves> valveDemand_t;
+
 private:
+    // Configured minimum percentage open for a remote valve to be considered really open; [1,100].
+    // See setMinValvePcReallyOpen().
+    uint8_t minValvePcReallyOpen = OTRadValve::DEFAULT_VALVE_PC_MIN_REALLY_OPEN;
 
 #ifdef BOILERDRIVER_UPDATE_WARNING
     // Make sure that processCallsForHeat is called in hub mode.
@@ -138,6 +359,11 @@ private:
     // Atomic to allow thread-safe lock-free access.
     bool callForHeatRX = false;
 
+    // Latest demand from each remote valve, with whole-house aggregates.
+    // Ages by one minute on each second0 tick in hub mode.
+    // Counts towards the calling sum only valves at or above getMinAggregateValvePC().
+    valveDemand_t valveDemand{OTRadValve::DEFAULT_VALVE_PC_MIN_REALLY_OPEN};
+
     // Minutes that the boiler has been off for, allowing minimum off time to be enforced.
     // Does not roll once at its maximum value (255).
     // DHD20160124: starting at zero forces at least for off time after power-up before firing up boiler (good after power-cut).
@@ -159,37 +385,55 @@ private:
     // NOTE: Case where boiler hub also controls a radvalve is not implemented.
     inline uint8_t getMinValveReallyOpen() {
         constexpr uint8_t default_minimum = OTRadValve::DEFAULT_VALVE_PC_SAFER_OPEN;
-//        if (isRadValve) {
-//            return OTV0P2BASE::fnmax(default_minimum, rv.getMinValvePcReallyOpen());
-//        } else {
-//            return default_minimum;
-//        }
-        return default_minimum;
+        return OTV0P2BASE::fnmax(default_minimum, minValvePcReallyOpen);
     }
 
 public:
+    // Minimum percentage open for a valve to count towards aggregate demand,
+    // ie the configured 'really open' level below which flow is taken to be negligible,
+    // and never below OTRadValve::DEFAULT_VALVE_PC_MIN_REALLY_OPEN.
+    // Usually well below the single-valve thresholds so that several partly-open valves can add up.
+    inline uint8_t getMinAggregateValvePC() const {
+        return OTV0P2BASE::fnmax(minValvePcReallyOpen, (uint8_t) OTRadValve::DEFAULT_VALVE_PC_MIN_REALLY_OPEN);
+    }
+
+    // Set the minimum percentage open for a remote valve to be considered really open,
+    // eg from the hub's own ModelledRadValve::getMinValvePcReallyOpen().
+    // Raises the single-valve and aggregate thresholds if above their defaults.
+    // Any out-of-range value (0 or >100) restores OTRadValve::DEFAULT_VALVE_PC_MIN_REALLY_OPEN.
+    void setMinValvePcReallyOpen(const uint8_t percent) {
+        minValvePcReallyOpen = ((0 == percent) || (percent > 100)) ?
+            OTRadValve::DEFAULT_VALVE_PC_MIN_REALLY_OPEN : percent;
+        valveDemand.setThreshold(getMinAggregateValvePC());
+    }
+
     // Clears reset internal boiler state to initial values.
     // Primarily for testing.
-    void reset() { updateCalled = false; callForHeatRX = false; boilerNoCallM = 0; boilerCountdownTicks = 0; }
+    void reset() { updateCalled = false; callForHeatRX = false; boilerNoCallM = 0; boilerCountdownTicks = 0; valveDemand.reset(); }
 
     // True if boiler should be on.
     inline bool isBoilerOn() { return(0 != boilerCountdownTicks); }
 
+    // Per-valve and aggregate (whole-house) demand from remote valves recently heard from.
+    // Eg for a modulating boiler driver or stats.
+    inline valveDemand_t &getValveDemand() { return(valveDemand); }
+
     // Raw notification of received call for heat from remote (eg FHT8V) unit.
     // This form has a 16-bit ID (eg FHT8V housecode) and percent-open value [0,100].
     // Note that this may include 0 percent values for a remote unit explicitly confirming
     // that is is not, or has stopped, calling for heat (eg instead of replying on a timeout).
     // This is not filtered, and can be delivered at any time from RX data, from a non-ISR thread.
     // Does not have to be thread-/ISR- safe.
-    // Note: callForHeat ID functionality disabled as unused anyway. API is preserved. (DE20170602)
-    void remoteCallForHeatRX(const uint16_t /*id*/, const uint8_t percentOpen, const uint8_t minuteCount)
+    // The latest value from each ID is tracked (until it expires),
+    // so that several valves each partly open may together call for heat.
+    void remoteCallForHeatRX(const uint16_t id, const uint8_t percentOpen, const uint8_t minuteCount)
     {
         #if 1
         OTV0P2BASE::MemoryChecks::recordIfMinSP();
         #endif
-        // TODO: Should be filtering first by housecode
-        // then by individual and tracked aggregate valve-open percentage.
-        // Only individual valve levels used here; no state is retained.
+        // TODO: Should be filtering first by housecode.
+        // If the ID cannot be tracked (table full) the individual level alone is used.
+        valveDemand.update(id, percentOpen);
 
 
 #ifdef BOILERDRIVER_UPDATE_WARNING
@@ -236,7 +480,12 @@ public:
         const uint8_t threshold = (!considerPause && (encourageOn || isBoilerOn())) ?
             minvro : OTV0P2BASE::fnmax(minvro, (uint8_t) (OTRadValve::DEFAULT_VALVE_PC_MODERATELY_OPEN-1));
 
-        if(percentOpen >= threshold) {
+        // Accept a single valve open past the threshold,
+        // or a valve really open that takes the total of all such valves past the threshold.
+        // Valves below getMinAggregateValvePC() are ignored as contributing little flow,
+        // matching those counted in the tracker's calling sum.
+        if((percentOpen >= threshold) ||
+           ((percentOpen >= getMinAggregateValvePC()) && (valveDemand.getCallingSumPC() >= threshold))) {
         // && FHT8VHubAcceptedHouseCode(command.hc1, command.hc2))) // Accept if house code OK.
             callForHeatRX = true;
         }
@@ -261,6 +510,9 @@ public:
             updateCalled = true;
 #endif // BOILERDRIVER_UPDATE_WARNING
 
+            // Age remote valve reports.
+            if(second0) { valveDemand.tickMinute(); }
+
             // Check if call-for-heat has been received, and clear the flag.
             // Record call for heat, both to start boiler-on cycle and possibly to defer need to listen again.
             // Ignore new calls for heat until minimum off/quiet period has been reached.
@@ -34,6 +34,9 @@ namespace OTRadValve
 {
 
 
+constexpr uint16_t MotorCurrentMonitor::NO_STALL;
+
+
 #ifdef CurrentSenseValveMotorDirect_DEFINED
 
 // Called with each motor run sub-cycle tick.
@@ -209,10 +212,12 @@ bool CurrentSenseValveMotorDirectBinaryOnly::runTowardsEndStop(const bool toOpen
   {
   // Clear the end-stop detection flag ready.
   endStopDetected = false;
-  // Run motor for fixed time.
+  // Run motor for fixed time, monitoring current.
+  currentMonitor.startRun(toOpen);
   hw->motorRun(minMotorDRTicks, toOpen ?
       OTRadValve::HardwareMotorDriverInterface::motorDriveOpening
     : OTRadValve::HardwareMotorDriverInterface::motorDriveClosing, *this);
+  currentMonitor.endRun();
   // Stop motor and ensure power off.
   hw->motorRun(0, OTRadValve::HardwareMotorDriverInterface::motorOff, *this);
   // Report if end-stop has apparently been hit.
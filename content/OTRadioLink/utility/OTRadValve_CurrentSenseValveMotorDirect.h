@@ -27,6 +27,7 @@ Author(s) / Copyright (s): Damon Hart-Davis 2015--2018
 
 #include <stdint.h>
 #include "OTRadValve_AbstractRadValve.h"
+#include "OTRadValve_MotorCurrentMonitor.h"
 
 #include "OTV0P2BASE_ErrorReport.h"
 
@@ -236,6 +237,11 @@ class CurrentSenseValveMotorDirectBinaryOnly : public OTRadValve::HardwareMotorD
     // Marked volatile for thread-safe lock-free access (with care).
     volatile bool endStopDetected = false;
 
+    // Streaming filter over motor current samples during each run,
+    // giving earlier stall detection than the hardware absolute limits,
+    // and recording a current profile of the last run in each direction.
+    MotorCurrentMonitor currentMonitor;
+
     // Current nominal percent open in range [0,100].
     // Initialised to open, reflecting initial state eg when valve fitted.
     uint8_t currentPC = 100;
@@ -406,6 +412,19 @@ class CurrentSenseValveMotorDirectBinaryOnly : public OTRadValve::HardwareMotorD
     // Is ISR-/thread- safe.
     virtual void signalRunSCTTick(bool /*opening*/) override { }
 
+    // Called with each raw motor current sample while the motor runs.
+    // Returns true to stop the motor when a stall is seen in the current profile,
+    // which is then treated as hitting the end stop.
+    virtual bool signalMotorCurrent(const bool /*opening*/, const uint16_t current) override final
+        {
+        if(!currentMonitor.sample(current)) { return(false); }
+        endStopDetected = true;
+        return(true);
+        }
+
+    // Get the motor current monitor, eg for the profiles of recent runs.
+    const MotorCurrentMonitor &getCurrentMonitor() const { return(currentMonitor); }
+
     // Call when given user signal that valve has been fitted (ie is fully on).
     virtual void signalValveFitted()
         { if(isWaitingForValveToBeFitted()) { perState.valvePinWithdrawn.valveFitted = true; } }
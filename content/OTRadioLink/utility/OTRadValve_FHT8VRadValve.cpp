@@ -26,6 +26,7 @@ Author(s) / Copyright (s): Damon Hart-Davis 2013--2016
 
 #ifdef ARDUINO_ARCH_AVR
 #include <util/parity.h>
+#include <avr/pgmspace.h>
 #endif
 
 #include <OTV0p2Base.h>
@@ -100,13 +101,58 @@ uint8_t *FHT8VRadValveUtil::_FHT8VCreate200usAppendEncBit(uint8_t *bptr, const b
 #define parity_even_bit(b) (FHT8VRadValveUtil::xor_parity_even_bit(b))
 #endif
 
-// Appends encoded byte in b msbit first plus trailing even parity bit (9 bits total)
-// to the byte stream being created by FHT8VCreate200usBitStreamBptr.
-static uint8_t *_FHT8VCreate200usAppendByteEP(uint8_t *bptr, const uint8_t b)
+// Lookup tables live in Flash on AVR to save scarce RAM.
+#ifdef ARDUINO_ARCH_AVR
+#define FHT8V_TABLE_ATTR PROGMEM
+#define FHT8V_TABLE_READ32(p) pgm_read_dword(p)
+#define FHT8V_TABLE_READ8(p) pgm_read_byte(p)
+#else
+#define FHT8V_TABLE_ATTR
+#define FHT8V_TABLE_READ32(p) (*(p))
+#define FHT8V_TABLE_READ8(p) (*(p))
+#endif
+
+// Encoded 200us-bit representation of each nibble, msbit first,
+// 1100 per 0 and 111000 per 1 as for _FHT8VCreate200usAppendEncBit().
+// Pattern is in the low 24 bits, and its length (16 to 24 bits) in the top byte.
+static const uint32_t FHT8VEncNibble[16] FHT8V_TABLE_ATTR =
   {
-  for(uint8_t mask = 0x80; mask != 0; mask >>= 1)
-    { bptr = FHT8VRadValveUtil::_FHT8VCreate200usAppendEncBit(bptr, 0 != (b & mask)); }
-  return(FHT8VRadValveUtil::_FHT8VCreate200usAppendEncBit(bptr, 0 != parity_even_bit(b))); // Append even parity bit.
+  0x1000ccccUL, 0x12033338UL, 0x1203338cUL, 0x140cce38UL,
+  0x120338ccUL, 0x140ce338UL, 0x140ce38cUL, 0x16338e38UL,
+  0x12038cccUL, 0x140e3338UL, 0x140e338cUL, 0x1638ce38UL,
+  0x140e38ccUL, 0x1638e338UL, 0x1638e38cUL, 0x18e38e38UL,
+  };
+
+// Encoder state: whole bytes are written out as soon as they are complete.
+typedef struct
+  {
+  uint8_t *bptr; // Next byte to write.
+  uint32_t acc; // Pending bits in the low nbits bits.
+  uint8_t nbits; // Number of pending bits, [0,7] between calls.
+  } encode_state_t;
+
+// Appends the n (<= 24) low bits of bits, msbit first.
+static inline void _FHT8VEncAppendBits(encode_state_t *const state, const uint32_t bits, const uint8_t n)
+  {
+  state->acc = (state->acc << n) | bits;
+  state->nbits += n;
+  while(state->nbits >= 8)
+    {
+    state->nbits -= 8;
+    *(state->bptr)++ = (uint8_t)(state->acc >> state->nbits);
+    }
+  }
+
+// Appends encoded byte in b msbit first plus trailing even parity bit (9 bits total), one nibble per lookup.
+static void _FHT8VEncAppendByteEP(encode_state_t *const state, const uint8_t b)
+  {
+  const uint32_t hi = FHT8V_TABLE_READ32(&FHT8VEncNibble[b >> 4]);
+  _FHT8VEncAppendBits(state, hi & 0xffffffUL, (uint8_t)(hi >> 24));
+  const uint32_t lo = FHT8V_TABLE_READ32(&FHT8VEncNibble[b & 0xf]);
+  _FHT8VEncAppendBits(state, lo & 0xffffffUL, (uint8_t)(lo >> 24));
+  // Append even parity bit.
+  if(0 != parity_even_bit(b)) { _FHT8VEncAppendBits(state, 0x38, 6); }
+  else { _FHT8VEncAppendBits(state, 0xc, 4); }
   }
 
 // Create stream of bytes to be transmitted to FHT80V at 200us per bit, msbit of each byte first.
@@ -116,6 +162,7 @@ static uint8_t *_FHT8VCreate200usAppendByteEP(uint8_t *bptr, const uint8_t b)
 // The maximum and minimum possible encoded message sizes are 35 (all zero bytes) and 45 (all 0xff bytes) bytes long.
 // Note that a buffer space of at least 46 bytes is needed to accommodate the longest-possible encoded message and terminator.
 // Returns pointer to the terminating 0xff on exit.
+// Output is identical to appending one bit at a time with _FHT8VCreate200usAppendEncBit().
 uint8_t *FHT8VRadValveUtil::FHT8VCreate200usBitStreamBptr(uint8_t *bptr, const FHT8VRadValveUtil::fht8v_msg_t *command)
   {
   // Generate FHT8V preamble.
@@ -126,128 +173,104 @@ uint8_t *FHT8VRadValveUtil::FHT8VCreate200usBitStreamBptr(uint8_t *bptr, const F
   *bptr++ = 0xcc;
   *bptr++ = 0xcc;
   *bptr++ = 0xcc;
-  *bptr = (uint8_t) ~0U; // Initialise for _FHT8VCreate200usAppendEncBit routine.
+  encode_state_t state;
+  state.bptr = bptr;
+  state.acc = 0;
+  state.nbits = 0;
   // Push remaining 1 of preamble.
-  bptr = _FHT8VCreate200usAppendEncBit(bptr, true); // Encode 1.
+  _FHT8VEncAppendBits(&state, 0x38, 6); // Encode 1.
 
   // Generate body.
-  bptr = _FHT8VCreate200usAppendByteEP(bptr, command->hc1);
-  bptr = _FHT8VCreate200usAppendByteEP(bptr, command->hc2);
+  _FHT8VEncAppendByteEP(&state, command->hc1);
+  _FHT8VEncAppendByteEP(&state, command->hc2);
 #ifdef OTV0P2BASE_FHT8V_ADR_USED
-  bptr = _FHT8VCreate200usAppendByteEP(bptr, command->address);
+  _FHT8VEncAppendByteEP(&state, command->address);
 #else
-  bptr = _FHT8VCreate200usAppendByteEP(bptr, 0); // Default/broadcast.  TODO: could possibly be further optimised to send 0 value more efficiently.
+  _FHT8VEncAppendByteEP(&state, 0); // Default/broadcast.
 #endif
-  bptr = _FHT8VCreate200usAppendByteEP(bptr, command->command);
-  bptr = _FHT8VCreate200usAppendByteEP(bptr, command->extension);
+  _FHT8VEncAppendByteEP(&state, command->command);
+  _FHT8VEncAppendByteEP(&state, command->extension);
   // Generate checksum.
 #ifdef OTV0P2BASE_FHT8V_ADR_USED
   const uint8_t checksum = 0xc + command->hc1 + command->hc2 + command->address + command->command + command->extension;
 #else
   const uint8_t checksum = 0xc + command->hc1 + command->hc2 + command->command + command->extension;
 #endif
-  bptr = _FHT8VCreate200usAppendByteEP(bptr, checksum);
+  _FHT8VEncAppendByteEP(&state, checksum);
 
   // Generate trailer.
-  // Append 0 bit for trailer.
-  bptr = _FHT8VCreate200usAppendEncBit(bptr, false);
-  // Append extra 0 bits to ensure that final required bits are flushed out.
-  bptr = _FHT8VCreate200usAppendEncBit(bptr, false);
-  bptr = _FHT8VCreate200usAppendEncBit(bptr, false);
-  *bptr = (uint8_t)0xff; // Terminate TX bytes.
-  return(bptr);
+  // Append 0 bit for trailer,
+  // plus extra 0 bits to ensure that final required bits are flushed out.
+  _FHT8VEncAppendBits(&state, 0xccc, 12);
+  // Any final partial byte is dropped.
+  *(state.bptr) = (uint8_t)0xff; // Terminate TX bytes.
+  return(state.bptr);
   }
 
+// Decoder symbol states between 2-bit pairs:
+// expecting the leading 11 of a bit, after 11, after 11 10, or failed.
+static const uint8_t FHT8V_DEC_LEAD = 0;
+static const uint8_t FHT8V_DEC_AFTER_11 = 1;
+static const uint8_t FHT8V_DEC_AFTER_1110 = 2;
+static const uint8_t FHT8V_DEC_ERR = 3;
+// Decode table entry flags; bits 0--1 are the next state.
+static const uint8_t FHT8V_DEC_EMIT = 0x04; // A bit completed within this nibble.
+static const uint8_t FHT8V_DEC_ONE = 0x08; // The bit completed was a 1.
+static const uint8_t FHT8V_DEC_FIRST = 0x10; // The bit completed on the first (high) pair of the nibble.
+// Transition for each state and encoded nibble (two 2-bit pairs).
+// 1100 decodes as 0 and 111000 as 1; a 01 pair, or any pair out of place, is an error.
+// At most one bit can complete per nibble since every bit is at least two pairs long.
+static const uint8_t FHT8VDecNibble[4][16] FHT8V_TABLE_ATTR =
+  {
+  // FHT8V_DEC_LEAD
+  { 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x04, 0x03, 0x02, 0x03 },
+  // FHT8V_DEC_AFTER_11
+  { 0x17, 0x17, 0x17, 0x15, 0x03, 0x03, 0x03, 0x03, 0x0c, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03 },
+  // FHT8V_DEC_AFTER_1110
+  { 0x1f, 0x1f, 0x1f, 0x1d, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03 },
+  // FHT8V_DEC_ERR
+  { 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03 },
+  };
+
 // Current decode state.
 typedef struct
   {
-  uint8_t const *bitStream; // Initially point to first byte of encoded bit stream.
+  uint8_t const *bitStream; // Byte holding the next nibble to decode; initially first byte of encoded bit stream.
   uint8_t const *lastByte; // point to last byte of bit stream.
-  uint8_t mask; // Current bit mask (the next pair of bits to read); initially 0 to become 0xc0;
+  uint8_t const *nextPairByte; // Once a bit is decoded, the byte holding the first pair not yet part of a decoded bit.
+  uint8_t symState; // FHT8V_DEC_XXX state carried between nibbles.
+  bool lowNibble; // True if the next nibble is the low half of *bitStream.
   bool failed; // If true, the decode has failed and stays failed/true.
   } decode_state_t;
 
 // Decode bit pattern 1100 as 0, 111000 as 1.
 // Returns 1 or 0 for the bit decoded, else marks the state as failed.
-// Reads two bits at a time, MSB to LSB, advancing the byte pointer if necessary.
+// Reads a nibble (two pairs of bits) per table lookup, MSB to LSB, advancing the byte pointer if necessary.
 static uint8_t readOneBit(decode_state_t *const state)
   {
-  if(state->bitStream > state->lastByte) { state->failed = true; } // Stop if off the buffer end.
-  if(state->failed) { return(0); } // Refuse to do anything further once decoding has failed.
-
-  if(0 == state->mask) { state->mask = 0xc0; } // Special treatment of 0 as equivalent to 0xc0 on entry.
-#if 0 && defined(V0P2BASE_DEBUG)
-  if((state->mask != 0xc0) && (state->mask != 0x30) && (state->mask != 0xc) && (state->mask != 3)) { panic(); }
-#endif
-
-  // First two bits read must be 11.
-  if(state->mask != (state->mask & *(state->bitStream)))
-    {
-#if 0 && defined(V0P2BASE_DEBUG)
-    V0P2BASE_DEBUG_SERIAL_PRINTLN_FLASHSTRING("leading 11 corrupt");
-#endif
-    state->failed = true; return(0);
-    }
-
-  // Advance the mask; if the mask becomes 0 (then 0xc0 again) then advance the byte pointer.
-  if(0 == ((state->mask) >>= 2))
+  for( ; ; )
     {
-    state->mask = 0xc0;
-    // If end of stream is encountered this is an error since more bits need to be read.
-    if(++(state->bitStream) > state->lastByte) { state->failed = true; return(0); }
-    }
-
-  // Next two bits can be 00 to decode a zero,
-  // or 10 (followed by 00) to decode a one.
-  const uint8_t secondPair = (state->mask & *(state->bitStream));
-  switch(secondPair)
-    {
-    case 0:
+    if(state->failed) { return(0); } // Refuse to do anything further once decoding has failed.
+    if(state->bitStream > state->lastByte) { state->failed = true; return(0); } // Stop if off the buffer end.
+    const uint8_t b = *(state->bitStream);
+    const bool wasLow = state->lowNibble;
+    const uint8_t nibble = wasLow ? (b & 0xf) : (b >> 4);
+    const uint8_t e = FHT8V_TABLE_READ8(&FHT8VDecNibble[state->symState][nibble]);
+    state->symState = e & 3;
+    uint8_t const *const thisByte = state->bitStream;
+    // Advance to the next nibble.
+    if(wasLow) { ++(state->bitStream); }
+    state->lowNibble = !wasLow;
+    if(0 != (e & FHT8V_DEC_EMIT))
       {
-#if 0 && defined(V0P2BASE_DEBUG)
-      V0P2BASE_DEBUG_SERIAL_PRINTLN_FLASHSTRING("decoded 0");
-#endif
-      // Advance the mask; if the mask becomes 0 then advance the byte pointer.
-      if(0 == ((state->mask) >>= 2)) { ++(state->bitStream); }
-      return(0);
+      // The first unused pair follows the completing one:
+      // still in this byte unless the bit completed on the last pair of the low nibble.
+      state->nextPairByte = ((0 != (e & FHT8V_DEC_FIRST)) || !wasLow) ? thisByte : (thisByte + 1);
+      // Any error in the rest of the nibble is reported on the next call.
+      return((0 != (e & FHT8V_DEC_ONE)) ? 1 : 0);
       }
-    case 0x80: case 0x20: case 8: case 2: break; // OK: looks like second pair of an encoded 1.
-    default:
-      {
-#if 0 && defined(V0P2BASE_DEBUG)
-      V0P2BASE_DEBUG_SERIAL_PRINT_FLASHSTRING("Invalid second pair ");
-      V0P2BASE_DEBUG_SERIAL_PRINTFMT(secondPair, HEX);
-      V0P2BASE_DEBUG_SERIAL_PRINT_FLASHSTRING(" from ");
-      V0P2BASE_DEBUG_SERIAL_PRINTFMT(*(state->bitStream), HEX);
-      V0P2BASE_DEBUG_SERIAL_PRINTLN();
-#endif
-      state->failed = true; return(0);
-      }
-    }
-
-  // Advance the mask; if the mask becomes 0 (then 0xc0 again) then advance the byte pointer.
-  if(0 == ((state->mask) >>= 2))
-    {
-    state->mask = 0xc0;
-    // If end of stream is encountered this is an error since more bits need to be read.
-    if(++(state->bitStream) > state->lastByte) { state->failed = true; return(0); }
-    }
-
-  // Third pair of bits must be 00.
-  if(0 != (state->mask & *(state->bitStream)))
-     {
-#if 0 && defined(V0P2BASE_DEBUG)
-    V0P2BASE_DEBUG_SERIAL_PRINTLN_FLASHSTRING("trailing 00 corrupt");
-#endif
-    state->failed = true; return(0);
+    if(FHT8V_DEC_ERR == state->symState) { state->failed = true; return(0); }
     }
-
-  // Advance the mask; if the mask becomes 0 then advance the byte pointer.
-  if(0 == ((state->mask) >>= 2)) { ++(state->bitStream); }
-#if 0 && defined(V0P2BASE_DEBUG)
-  V0P2BASE_DEBUG_SERIAL_PRINTLN_FLASHSTRING("decoded 1");
-#endif
-  return(1); // Decoded a 1.
   }
 
 // Decodes a series of encoded bits plus parity (and checks the parity, failing if wrong).
@@ -270,41 +293,48 @@ static uint8_t readOneByteWithParity(decode_state_t *const state)
   // Then get parity bit and check.
   if(parity != readOneBit(state))
     {
-#if 0 && defined(V0P2BASE_DEBUG)
-    V0P2BASE_DEBUG_SERIAL_PRINTLN_FLASHSTRING("bad parity");
-#endif
     state->failed = true;
     }
   return(result);
   }
 
+// Fast check that a raw bit stream could possibly hold an FHT8V frame.
+// Rejects streams too short for the shortest frame,
+// or with a 01 pair (never valid in 1100/111000 encoding) in the leading bytes
+// that any frame starting at bitStream must cover,
+// so noise is usually rejected within the first byte or two without any decoding.
+// Never rejects a stream that FHT8VDecodeBitStream() would accept.
+bool FHT8VRadValveUtil::FHT8VBitStreamPlausible(uint8_t const *bitStream, uint8_t const *lastByte)
+  {
+  if((lastByte < bitStream) || ((lastByte - bitStream) < (MIN_FHT8V_ENCODED_FRAME_BYTES - 1))) { return(false); }
+  for(uint8_t i = MIN_FHT8V_ENCODED_FRAME_BYTES; i-- > 0; )
+    {
+    const uint8_t b = *bitStream++;
+    // Low bit of pair set with high bit clear.
+    if(0 != (b & ~(b >> 1) & 0x55)) { return(false); }
+    }
+  return(true);
+  }
+
 // Decode raw bitstream into non-null command structure passed in; returns true if successful.
 // Will return non-null if OK, else NULL if anything obviously invalid is detected such as failing parity or checksum.
 // Finds and discards leading encoded 1 and trailing 0.
 // Returns NULL on failure, else pointer to next full byte after last decoded.
 uint8_t const * FHT8VRadValveUtil::FHT8VDecodeBitStream(uint8_t const *bitStream, uint8_t const *lastByte, FHT8VRadValveUtil::fht8v_msg_t *command)
   {
+  // Cheap rejection of obvious noise.
+  if(!FHT8VBitStreamPlausible(bitStream, lastByte)) { return(NULL); }
+
   decode_state_t state;
   state.bitStream = bitStream;
   state.lastByte = lastByte;
-  state.mask = 0;
+  state.nextPairByte = bitStream;
+  state.symState = FHT8V_DEC_LEAD;
+  state.lowNibble = false;
   state.failed = false;
 
-#if 0 && defined(V0P2BASE_DEBUG)
-  V0P2BASE_DEBUG_SERIAL_PRINT_FLASHSTRING("FHT8VDecodeBitStream:");
-  for(uint8_t const *p = bitStream; p <= lastByte; ++p)
-      {
-      V0P2BASE_DEBUG_SERIAL_PRINT_FLASHSTRING(" &");
-      V0P2BASE_DEBUG_SERIAL_PRINTFMT(*p, HEX);
-      }
-  V0P2BASE_DEBUG_SERIAL_PRINTLN();
-#endif
-
   // Find and absorb the leading encoded '1', else quit if not found by end of stream.
   while(0 == readOneBit(&state)) { if(state.failed) { return(NULL); } }
-#if 0 && defined(V0P2BASE_DEBUG)
-  V0P2BASE_DEBUG_SERIAL_PRINTLN_FLASHSTRING("Read leading 1");
-#endif
 
   command->hc1 = readOneByteWithParity(&state);
   command->hc2 = readOneByteWithParity(&state);
@@ -316,13 +346,7 @@ uint8_t const * FHT8VRadValveUtil::FHT8VDecodeBitStream(uint8_t const *bitStream
   command->command = readOneByteWithParity(&state);
   command->extension = readOneByteWithParity(&state);
   const uint8_t checksumRead = readOneByteWithParity(&state);
-  if(state.failed)
-    {
-#if 0 && defined(V0P2BASE_DEBUG)
-    V0P2BASE_DEBUG_SERIAL_PRINTLN_FLASHSTRING("Failed to read message");
-#endif
-    return(NULL);
-    }
+  if(state.failed) { return(NULL); }
 
    // Generate and check checksum.
 #ifdef OTV0P2BASE_FHT8V_ADR_USED
@@ -330,36 +354,15 @@ uint8_t const * FHT8VRadValveUtil::FHT8VDecodeBitStream(uint8_t const *bitStream
 #else
   const uint8_t checksum = 0xc + command->hc1 + command->hc2 + address + command->command + command->extension;
 #endif
-  if(checksum != checksumRead)
-    {
-#if 0 && defined(V0P2BASE_DEBUG)
-    V0P2BASE_DEBUG_SERIAL_PRINTLN_FLASHSTRING("Checksum failed");
-#endif
-    state.failed = true; return(NULL);
-    }
-#if 0 && defined(V0P2BASE_DEBUG)
-  else
-    {
-    V0P2BASE_DEBUG_SERIAL_PRINTLN_FLASHSTRING("Checksum OK");
-    }
-#endif
+  if(checksum != checksumRead) { return(NULL); }
 
   // Check the trailing encoded '0'.
-  if(0 != readOneBit(&state))
-    {
-#if 0 && defined(V0P2BASE_DEBUG)
-    V0P2BASE_DEBUG_SERIAL_PRINTLN_FLASHSTRING("Read of trailing 0 failed");
-#endif
-    state.failed = true; return(NULL);
-    }
+  if(0 != readOneBit(&state)) { return(NULL); }
   if(state.failed) { return(NULL); }
 
-#if 0 && defined(V0P2BASE_DEBUG)
-    V0P2BASE_DEBUG_SERIAL_PRINTLN_FLASHSTRING("Read entire message");
-#endif
   // Return pointer to where any trailing data may be
   // in next byte beyond end of FHT8V frame.
-  return(state.bitStream + 1);
+  return(state.nextPairByte + 1);
   }
 
 #endif // FHT8VRadValveUtil_DEFINED
@@ -434,6 +437,10 @@ void FHT8VRadValveBase::sleepUntilSubCycleTimeOptionalRX(const uint8_t sleepUnti
 #if 0 && defined(V0P2BASE_DEBUG)
     V0P2BASE_DEBUG_SERIAL_PRINT_FLASHSTRING("TXwait");
 #endif
+    // Record slack before the target time, or an overrun if already missed.
+    OTV0P2BASE::CycleBudget *const cb = OTV0P2BASE::getCycleBudget();
+    if(NULL != cb) { cb->recordSlack(OTV0P2BASE::CBC_FHT8V, OTV0P2BASE::getSubCycleTime(), sleepUntil); }
+
     // Poll I/O regularly in case listening out for radio comms.
     OTRadioLink::OTRadioLink * const r = radio;
 
@@ -101,6 +101,7 @@ class FHT8VRadValveUtil
     // For longest-possible encoded FHT8V/FS20 command in bytes plus terminating 0xff.
     static const uint8_t MIN_FHT8V_200US_BIT_STREAM_BUF_SIZE = 46;
     // Create stream of bytes to be transmitted to FHT80V at 200us per bit, msbit of each byte first.
+    // Encodes a nibble at a time from a lookup table.
     // Byte stream is terminated by 0xff byte which is not a possible valid encoded byte.
     // On entry the populated FHT8V command struct is passed by pointer.
     // On exit, the memory block starting at buffer contains the low-byte, msbit-first, 0xff terminated TX sequence.
@@ -110,10 +111,20 @@ class FHT8VRadValveUtil
     // Returns pointer to the terminating 0xff on exit.
     static uint8_t *FHT8VCreate200usBitStreamBptr(uint8_t *bptr, const fht8v_msg_t *command);
 
+    // Minimum number of leading bytes wholly occupied by any encoded frame (leading 1 to trailing 0 inclusive).
+    // The shortest frame is 6 + (6 * 9 * 4) + 4 = 226 200us-bits.
+    static const uint8_t MIN_FHT8V_ENCODED_FRAME_BYTES = 226 / 8;
+    // Fast check that a raw bit stream could possibly hold an FHT8V frame starting at bitStream.
+    // Rejects streams too short for the shortest frame, or containing a (never valid) 01 bit pair
+    // in the first MIN_FHT8V_ENCODED_FRAME_BYTES bytes, typically within the first byte or two of noise.
+    // Never rejects a stream that FHT8VDecodeBitStream() would accept.
+    static bool FHT8VBitStreamPlausible(uint8_t const *bitStream, uint8_t const *lastByte);
+
     // Decode raw bitstream into non-null command structure passed in; returns true if successful.
     // Will return non-null if OK, else NULL if anything obviously invalid is detected such as failing parity or checksum.
     // Finds and discards leading encoded 1 and trailing 0.
     // Returns NULL on failure, else pointer to next full byte after last decoded.
+    // Decodes a nibble of the raw stream per table lookup, after a FHT8VBitStreamPlausible() pre-check.
     static uint8_t const *FHT8VDecodeBitStream(uint8_t const *bitStream, uint8_t const *lastByte, fht8v_msg_t *command);
 
     // Approximate maximum transmission (TX) time for bare FHT8V command frame in ms; strictly positive.
@@ -0,0 +1,218 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * Streaming motor-current stall detection and per-run current profiles.
+ *
+ * Hardware-independent and unit testable.
+ */
+
+#ifndef ARDUINO_LIB_OTRADVALVE_MOTORCURRENTMONITOR_H_
+#define ARDUINO_LIB_OTRADVALVE_MOTORCURRENTMONITOR_H_
+
+
+#include <stdint.h>
+
+
+namespace OTRadValve
+{
+
+
+// Streaming filter over raw motor-current samples (eg ADC counts)
+// taken while a motor runs, one sample per poll of the current sense.
+//
+// Keeps a running baseline of the current with an EWMA (exponentially
+// weighted moving average) of mean and variance,
+// and detects a stall (eg hitting an end-stop) as a sustained rise
+// well above that baseline: confirmSamples consecutive samples,
+// each no lower than the one before, all above the baseline
+// by at least minRise and by at least sigmas standard deviations.
+// Isolated spikes (eg from dirt or brush noise) restart the count,
+// and samples above the threshold do not pull the baseline up.
+//
+// This typically sees a stall well before the current reaches
+// the fixed absolute limits used by the hardware drivers,
+// so the motor spends less time and energy pushing into an end-stop.
+// The absolute limits remain as a backstop.
+//
+// Also records a profile of each run, kept per direction,
+// eg for use in calibration.
+//
+// Uses only integer arithmetic, and no 64-bit values.
+// Not ISR-/thread- safe: use from the motor run loop only.
+class MotorCurrentMonitor final
+  {
+  public:
+    // Stall sample index meaning no stall seen in the run.
+    static constexpr uint16_t NO_STALL = 0xffff;
+
+    // Summary of one motor run.
+    struct runProfile_t
+      {
+      // Sum of all samples, a proxy for the charge used.
+      uint32_t sum;
+      // Number of samples taken in the run.
+      uint16_t samples;
+      // Baseline (running) current at the end of the run, or at the stall.
+      uint16_t baseline;
+      // Highest sample seen.
+      uint16_t peak;
+      // Index of the sample at which the stall was confirmed, else NO_STALL.
+      uint16_t stallAt;
+      // True once a run in this direction has completed.
+      bool valid;
+      };
+
+  private:
+    // EWMA weight is 1/2^shift.
+    const uint8_t shift;
+    // Samples at the start of each run not used (eg motor in-rush).
+    const uint8_t warmup;
+    // Minimum standard deviations above baseline counting towards a stall.
+    const uint8_t sigmas;
+    // Consecutive rising samples above threshold to confirm a stall.
+    const uint8_t confirmSamples;
+    // Minimum rise above baseline (raw units) counting towards a stall.
+    const uint16_t minRise;
+
+    // Baseline mean, scaled by 16.
+    uint16_t meanX16;
+    // Baseline variance, scaled by 256.
+    uint32_t varX256;
+    // Previous sample above threshold.
+    uint16_t lastHigh;
+    // Consecutive samples above threshold.
+    uint8_t highCount;
+    // True while a run is in progress.
+    bool running = false;
+    // True for the opening direction.
+    bool opening = false;
+    // True once a stall is confirmed in this run.
+    bool stalled;
+
+    // Run in progress.
+    runProfile_t current;
+    // Last completed run in each direction: [0] closing, [1] opening.
+    runProfile_t last[2];
+
+  public:
+    // Create a monitor.
+    //   * shift  EWMA weight 1/2^shift for the baseline [1,8]
+    //   * warmup  samples at the start of each run to skip
+    //   * sigmas  minimum standard deviations above baseline for a stall; strictly positive
+    //   * confirmSamples  consecutive rising high samples to confirm a stall; strictly positive
+    //   * minRise  minimum rise above baseline (raw units) for a stall; strictly positive
+    constexpr MotorCurrentMonitor(const uint8_t _shift = 3, const uint8_t _warmup = 2,
+                                  const uint8_t _sigmas = 4, const uint8_t _confirmSamples = 3,
+                                  const uint16_t _minRise = 24)
+      : shift(_shift), warmup(_warmup), sigmas(_sigmas),
+        confirmSamples(_confirmSamples), minRise(_minRise),
+        meanX16(0), varX256(0), lastHigh(0), highCount(0), stalled(false),
+        current{0, 0, 0, 0, NO_STALL, false}, last{{0, 0, 0, 0, NO_STALL, false}, {0, 0, 0, 0, NO_STALL, false}}
+      { }
+
+    // Start a new run in the given direction, ending any run in progress.
+    void startRun(const bool _opening)
+      {
+      if(running) { endRun(); }
+      running = true;
+      opening = _opening;
+      stalled = false;
+      highCount = 0;
+      current.sum = 0;
+      current.samples = 0;
+      current.baseline = 0;
+      current.peak = 0;
+      current.stallAt = NO_STALL;
+      current.valid = false;
+      }
+
+    // End the run in progress and record its profile; does nothing if none.
+    void endRun()
+      {
+      if(!running) { return; }
+      running = false;
+      current.valid = true;
+      if(!stalled) { current.baseline = uint16_t((meanX16 + 8) >> 4); }
+      last[opening ? 1 : 0] = current;
+      }
+
+    // Feed one raw current sample; returns true once a stall has been confirmed in this run.
+    // Samples outside a run are ignored.
+    bool sample(const uint16_t x)
+      {
+      if(!running) { return(false); }
+      if(current.samples < NO_STALL - 1) { ++current.samples; }
+      current.sum += x;
+      if(x > current.peak) { current.peak = x; }
+      if(stalled) { return(true); }
+      // Skip in-rush.
+      if(current.samples <= warmup) { return(false); }
+      // Seed the baseline from the first usable sample.
+      const uint16_t xX16 = uint16_t((x > 0xfff) ? 0xffff : (x << 4));
+      if(current.samples == uint16_t(warmup) + 1) { meanX16 = xX16; varX256 = 0; return(false); }
+      // Stall test against the baseline so far.
+      if(xX16 > meanX16)
+        {
+        const uint16_t riseX16 = xX16 - meanX16;
+        const uint32_t rise2 = uint32_t(riseX16) * riseX16;
+        if((riseX16 >= uint32_t(minRise) << 4) && ((rise2 / (uint16_t(sigmas) * sigmas)) > varX256))
+          {
+          // Require a non-falling run of high samples.
+          highCount = ((0 != highCount) && (x < lastHigh)) ? 1 : uint8_t(highCount + 1);
+          lastHigh = x;
+          if(highCount >= confirmSamples)
+            {
+            stalled = true;
+            current.stallAt = current.samples - 1;
+            current.baseline = uint16_t((meanX16 + 8) >> 4);
+            return(true);
+            }
+          // Do not pull the baseline up towards a possible stall.
+          return(false);
+          }
+        }
+      highCount = 0;
+      // Update the baseline mean and variance.
+      const int32_t d = int32_t(xX16) - int32_t(meanX16);
+      meanX16 = uint16_t(int32_t(meanX16) + (d / (int32_t(1) << shift)));
+      const uint32_t ad = uint32_t((d < 0) ? -d : d);
+      varX256 = varX256 - (varX256 >> shift) + ((ad * ad) >> shift);
+      return(false);
+      }
+
+    // True while a run is in progress.
+    bool isRunning() const { return(running); }
+    // True if a stall has been confirmed in the run in progress (or just ended).
+    bool isStalled() const { return(stalled); }
+    // Current baseline in raw units.
+    uint16_t getBaseline() const { return(uint16_t((meanX16 + 8) >> 4)); }
+    // Current baseline variance in raw units squared.
+    uint16_t getVariance() const
+      {
+      const uint32_t v = (varX256 + 128) >> 8;
+      return(uint16_t((v > 0xffff) ? 0xffff : v));
+      }
+    // Profile of the last completed run in the given direction; check the valid flag.
+    const runProfile_t &getLastRun(const bool _opening) const { return(last[_opening ? 1 : 0]); }
+  };
+
+
+}
+
+#endif /* ARDUINO_LIB_OTRADVALVE_MOTORCURRENTMONITOR_H_ */
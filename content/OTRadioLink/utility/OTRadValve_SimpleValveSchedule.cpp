@@ -91,15 +91,69 @@ uint_least16_t SimpleValveScheduleParams::getSimpleScheduleOff(const uint8_t whi
   return(endTime);
   }
 
+// Rebuild the timeline if needed; returns false if too many schedules to hold.
+// Scheduled times near the midnight wrap-around are tricky:
+// a period wrapping midnight is split in two.
+bool SimpleValveScheduleParams::updateTimeline() const
+  {
+  const uint8_t ot = onTime();
+  if(ot == timelineOnTime) { return(true); }
+  const uint8_t maxS = maxSchedules();
+  if(maxS > TIMELINE_MAX_SCHEDULES) { return(false); }
+  uint8_t n = 0;
+  for(uint8_t which = 0; which < maxS; ++which)
+    {
+    const uint_least16_t s = getSimpleScheduleOn(which);
+    // Deal with case where this schedule is not set at all (s == ~0);
+    if(uint_least16_t(~0) == s) { continue; }
+    const uint_least16_t e = getSimpleScheduleOff(which);
+    if(s < e) { timeline[n].start = s; timeline[n++].end = e; }
+    else
+      {
+      timeline[n].start = s; timeline[n++].end = OTV0P2BASE::MINS_PER_DAY;
+      if(0 != e) { timeline[n].start = 0; timeline[n++].end = e; }
+      }
+    }
+  // Insertion sort by start time; very short list.
+  for(uint8_t i = 1; i < n; ++i)
+    {
+    const interval_t t = timeline[i];
+    uint8_t j = i;
+    for( ; (j > 0) && (timeline[j-1].start > t.start); --j) { timeline[j] = timeline[j-1]; }
+    timeline[j] = t;
+    }
+  // Merge overlapping and abutting intervals.
+  uint8_t m = 0;
+  for(uint8_t i = 0; i < n; ++i)
+    {
+    if((m > 0) && (timeline[i].start <= timeline[m-1].end))
+      { if(timeline[i].end > timeline[m-1].end) { timeline[m-1].end = timeline[i].end; } }
+    else { timeline[m++] = timeline[i]; }
+    }
+  timelineLen = m;
+  timelineOnTime = ot;
+  return(true);
+  }
+
 // True iff any schedule is currently 'on'/'WARM' even when schedules overlap.
-// May be relatively slow/expensive.
 // Can be used to suppress all 'off' activity except for the final one.
 // Can be used to suppress set-backs during on times.
-// Scheduled times near the midnight wrap-around are tricky.
+// Uses the compiled timeline where possible.
 bool SimpleValveScheduleParams::isAnyScheduleOnWARMNow(const uint_least16_t mm) const
   {
   if(mm >= OTV0P2BASE::MINS_PER_DAY) { return(false); } // Invalid time.
 
+  if(updateTimeline())
+    {
+    for(uint8_t i = 0; i < timelineLen; ++i)
+      {
+      if(mm < timeline[i].start) { break; } // Sorted, so no later match.
+      if(mm < timeline[i].end) { return(true); }
+      }
+    return(false);
+    }
+
+  // Too many schedules for the timeline, so check each.
   const uint8_t maxS = maxSchedules();
   for(uint8_t which = 0; which < maxS; ++which)
     {
@@ -128,6 +182,43 @@ bool SimpleValveScheduleParams::isAnyScheduleOnWARMNow(const uint_least16_t mm)
   return(false);
   }
 
+// Minutes until the next change of isAnyScheduleOnWARMNow(), in range [1,1439].
+// Returns ~0 (0xffff) if there is no such change, eg no schedule set.
+uint_least16_t SimpleValveScheduleParams::minsToNextWARMTransition(const uint_least16_t mm) const
+  {
+  if(mm >= OTV0P2BASE::MINS_PER_DAY) { return(~0); } // Invalid time.
+
+  if(!updateTimeline())
+    {
+    // Too many schedules for the timeline, so step through the day.
+    const bool now = isAnyScheduleOnWARMNow(mm);
+    for(uint_least16_t d = 1; d < OTV0P2BASE::MINS_PER_DAY; ++d)
+      {
+      const uint_least16_t m = mm + d;
+      if(now != isAnyScheduleOnWARMNow((m >= OTV0P2BASE::MINS_PER_DAY) ? (m - OTV0P2BASE::MINS_PER_DAY) : m)) { return(d); }
+      }
+    return(~0);
+    }
+
+  if(0 == timelineLen) { return(~0); }
+  // A period running from the end of the day into the next
+  // has no transition at midnight.
+  const bool wraps = (0 == timeline[0].start) && (OTV0P2BASE::MINS_PER_DAY == timeline[timelineLen-1].end);
+  uint_least16_t best = ~0;
+  for(uint8_t i = 0; i < timelineLen; ++i)
+    {
+    for(uint8_t edge = 0; edge < 2; ++edge)
+      {
+      const uint_least16_t t = (0 == edge) ? timeline[i].start : timeline[i].end;
+      if(wraps && ((0 == t) || (OTV0P2BASE::MINS_PER_DAY == t))) { continue; }
+      // Minutes ahead, where a transition now is a day ahead.
+      const uint_least16_t d = (t > mm) ? (t - mm) : (t + OTV0P2BASE::MINS_PER_DAY - mm);
+      if(d < best) { best = d; }
+      }
+    }
+  return(best);
+  }
+
 // True iff any schedule is due 'on'/'WARM' soon even when schedules overlap.
 // May be relatively slow/expensive.
 // Can be used to allow room to be brought up to at least a set-back temperature
@@ -174,6 +265,7 @@ bool SimpleValveScheduleEEPROM::setSimpleSchedule(const uint_least16_t startMinu
   const uint8_t startMM = computeProgrammeByteFromTime(startMinutesSinceMidnightLT);
   ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
     { OTV0P2BASE::eeprom_smart_update_byte((uint8_t*)(V0P2BASE_EE_START_SIMPLE_SCHEDULE0_ON + which), startMM); }
+  invalidateTimeline();
   return(true); // Assume EEPROM programmed OK...
   }
 
@@ -186,6 +278,7 @@ void SimpleValveScheduleEEPROM::clearSimpleSchedule(const uint8_t which)
   // Clear the schedule back to 'unprogrammed' values, minimising wear.
   ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
     { OTV0P2BASE::eeprom_smart_erase_byte((uint8_t*)(V0P2BASE_EE_START_SIMPLE_SCHEDULE0_ON + which)); }
+  invalidateTimeline();
   }
 
 // Returns true if any simple schedule is set, false otherwise.
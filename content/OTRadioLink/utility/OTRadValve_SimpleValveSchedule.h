@@ -91,6 +91,14 @@ class SimpleValveScheduleBase
         //     must be less than OTV0P2BASE::MINS_PER_DAY
         virtual bool isAnyScheduleOnWARMSoon(uint_least16_t mm) const = 0;
 
+        // Minutes until the next change of isAnyScheduleOnWARMNow(), in range [1,1439].
+        // Returns ~0 (0xffff) if there is no such change, eg no schedule set.
+        // Allows callers to skip schedule checks (or sleep) until then,
+        // though the on time may change meanwhile (eg with comfort level).
+        //   * mm  minutes from midnight (usually local time);
+        //     must be less than OTV0P2BASE::MINS_PER_DAY
+        virtual uint_least16_t minsToNextWARMTransition(uint_least16_t mm) const = 0;
+
         // True iff any schedule is currently 'on'/'WARM' even when schedules overlap.
         // May be relatively slow/expensive.
         // Can be used to suppress all 'off' activity except for the final one.
@@ -113,8 +121,39 @@ class SimpleValveScheduleBase
 // Some basic properties and implementation of a simple scheduler.
 // These will hold for the EEPROM-backed AVR version for example,
 // as well as a more testable RAM-based version.
+//
+// Keeps a compiled daily timeline of the WARM periods of all schedules in RAM,
+// as a short sorted list of merged non-wrapping intervals,
+// so that the frequent WARM now/soon queries do not recompute
+// (or re-read from EEPROM) each schedule's on and off times.
+// The timeline is rebuilt on the first query after a schedule is set or cleared
+// (derived classes must call invalidateTimeline())
+// or after onTime() changes (eg with comfort level).
+// Not ISR-/thread- safe.
 class SimpleValveScheduleParams : public SimpleValveScheduleBase
     {
+    public:
+        // Maximum schedules held in the compiled timeline;
+        // queries are computed directly from each schedule if there are more.
+        static constexpr uint8_t TIMELINE_MAX_SCHEDULES = 4;
+
+    private:
+        // WARM period as [start,end) minutes after midnight, not wrapping.
+        struct interval_t { uint_least16_t start, end; };
+        // Sorted merged WARM periods; each schedule may need two if it wraps midnight,
+        // and all may wrap before merging.
+        mutable interval_t timeline[2 * TIMELINE_MAX_SCHEDULES];
+        // Number of intervals in use.
+        mutable uint8_t timelineLen = 0;
+        // onTime() when the timeline was built; 0 if the timeline needs rebuilding.
+        mutable uint8_t timelineOnTime = 0;
+        // Rebuild the timeline if needed; returns false if too many schedules to hold.
+        bool updateTimeline() const;
+
+    protected:
+        // Force the timeline to be rebuilt before the next query, eg after a schedule change.
+        void invalidateTimeline() { timelineOnTime = 0; }
+
     public:
         // Granularity of simple schedule in minutes (values may be rounded/truncated to nearest); strictly positive.
         static constexpr uint8_t SIMPLE_SCHEDULE_GRANULARITY_MINS = 6;
@@ -163,6 +202,12 @@ class SimpleValveScheduleParams : public SimpleValveScheduleBase
         //     must be less than OTV0P2BASE::MINS_PER_DAY
         virtual bool isAnyScheduleOnWARMSoon(uint_least16_t mm) const override;
 
+        // Minutes until the next change of isAnyScheduleOnWARMNow(), in range [1,1439].
+        // Returns ~0 (0xffff) if there is no such change, eg no schedule set.
+        //   * mm  minutes from midnight (usually local time);
+        //     must be less than OTV0P2BASE::MINS_PER_DAY
+        virtual uint_least16_t minsToNextWARMTransition(uint_least16_t mm) const override;
+
         // Maximum mins-after-midnight compacted value in one byte.
         // Exposed to facilitate unit testing.
         static constexpr uint8_t MAX_COMPRESSED_MINS_AFTER_MIDNIGHT = ((OTV0P2BASE::MINS_PER_DAY / SIMPLE_SCHEDULE_GRANULARITY_MINS) - 1);
@@ -249,6 +294,7 @@ class SimpleValveScheduleMock final : public SimpleValveScheduleParams
             if(startMinutesSinceMidnightLT >= OTV0P2BASE::MINS_PER_DAY) { return(false); } // Invalid time.
             const uint8_t startMM = computeProgrammeByteFromTime(startMinutesSinceMidnightLT);
             programmes[which] = startMM;
+            invalidateTimeline();
             return(true);
             }
 
@@ -260,6 +306,7 @@ class SimpleValveScheduleMock final : public SimpleValveScheduleParams
             if(which >= maxSchedules()) { return; } // Invalid schedule number.
             // Clear the schedule back to 'unprogrammed' values.
             programmes[which] = 0xff;
+            invalidateTimeline();
             }
 
         // True iff any schedule is currently 'on'/'WARM' even when schedules overlap.
@@ -381,6 +428,7 @@ class NULLValveSchedule final : public SimpleValveScheduleBase
     virtual void clearSimpleSchedule(uint8_t) override { }
     virtual bool isAnyScheduleOnWARMNow(uint_least16_t) const override { return(false); }
     virtual bool isAnyScheduleOnWARMSoon(uint_least16_t) const override { return(false); }
+    virtual uint_least16_t minsToNextWARMTransition(uint_least16_t) const override { return(uint_least16_t(~0)); }
     virtual bool isAnySimpleScheduleSet() const override { return(false); }
   };
 
@@ -394,6 +442,7 @@ class DummyValveSchedule final
         static uint_least16_t getSimpleScheduleOn(uint8_t)  { return(uint_least16_t(~0)); }
         static bool isAnyScheduleOnWARMNow() { return(false); }
         static bool isAnyScheduleOnWARMSoon() { return(false); }
+        static uint_least16_t minsToNextWARMTransition() { return(uint_least16_t(~0)); }
         static bool isAnySimpleScheduleSet() { return(false); }
     };
 
@@ -37,7 +37,8 @@ namespace OTRadValve
 // then this will return true immediately.
 // Invokes callbacks for high current (end stop) and position (shaft) encoder where applicable.
 // Aborts early if high current is detected at the start,
-// or after the minimum run period.
+// or after the minimum run period,
+// either from the absolute limit or from a stall seen by the callback in the current samples.
 // Returns true if aborted early from too little time to start, or by high current (assumed end-stop hit).
 bool ValveMotorDirectV1HardwareDriverBase::spinSCTTicks(const uint8_t maxRunTicks, const uint8_t minTicksBeforeAbort, const OTRadValve::HardwareMotorDriverInterface::motor_drive dir, OTRadValve::HardwareMotorDriverInterfaceCallbackHandler &callback)
   {
@@ -79,8 +80,9 @@ bool ValveMotorDirectV1HardwareDriverBase::spinSCTTicks(const uint8_t maxRunTick
     {
     for( ; ; )
       {
-      // Check for high current and abort if detected.
-      if(isCurrentHigh(dir)) { currentHigh = true; break; }
+      // Check for high current or stall and abort if detected.
+      const uint16_t mi = readMotorCurrent();
+      if(callback.signalMotorCurrent(isOpening, mi) || (mi > getMaxCurrentReading(dir))) { currentHigh = true; break; }
       // Poll shaft encoder output and update tick counter.
       const uint8_t newSct = OTV0P2BASE::getSubCycleTime();
       if(newSct != sct)
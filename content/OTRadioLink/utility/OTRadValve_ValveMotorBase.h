@@ -44,7 +44,14 @@ class ValveMotorDirectV1HardwareDriverBase : public OTRadValve::HardwareMotorDri
     // Min sub-cycle ticks to run up.
     static const uint8_t minMotorRunupTicks = max(1, minMotorRunupMS / OTV0P2BASE::SUBCYCLE_TICK_MS_RD);
 
+    // Detect if end-stop is reached or motor current otherwise very high.
+    virtual bool isCurrentHigh(OTRadValve::HardwareMotorDriverInterface::motor_drive mdir = motorDriveOpening) const override
+      { return(readMotorCurrent() > getMaxCurrentReading(mdir)); }
+
   protected:
+    // Absolute maximum current reading allowed when running in the given direction.
+    virtual uint16_t getMaxCurrentReading(OTRadValve::HardwareMotorDriverInterface::motor_drive mdir) const = 0;
+
     // Spin for up to the specified number of SCT ticks, monitoring current and position encoding.
     //   * maxRunTicks  maximum sub-cycle ticks to attempt to run/spin for); strictly positive
     //   * minTicksBeforeAbort  minimum ticks before abort for end-stop / high-current,
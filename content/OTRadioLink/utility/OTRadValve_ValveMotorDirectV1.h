@@ -72,28 +72,23 @@ class ValveMotorDirectV1HardwareDriver final : public ValveMotorDirectV1Hardware
   public:
     ValveMotorDirectV1HardwareDriver() : last_dir((uint8_t)motorOff) { }
 
-    // Detect if end-stop is reached or motor current otherwise very high.
-    virtual bool isCurrentHigh(OTRadValve::HardwareMotorDriverInterface::motor_drive mdir = motorDriveOpening) const
+    // Raw motor current reading; high when an end-stop is reached.
+    virtual uint16_t readMotorCurrent() const override
       {
-      // Check for high motor current indicating hitting an end-stop.
       // Measure motor current against (fixed) internal reference.
-      const uint16_t mi = OTV0P2BASE::analogueNoiseReducedRead(MOTOR_DRIVE_MI_AIN_DigitalPin, INTERNAL);
-//      const uint16_t mi = OTV0P2BASE::analogueNoiseReducedRead(MOTOR_DRIVE_MI_AIN_DigitalPin, DEFAULT);
-//#if 1 // 0 && defined(V0P2BASE_DEBUG)
-//OTV0P2BASE::serialPrintAndFlush(F("    MI: "));
-//OTV0P2BASE::serialPrintAndFlush(mi, DEC);
-//OTV0P2BASE::serialPrintlnAndFlush();
-//#endif
-      const uint16_t miHigh = (OTRadValve::HardwareMotorDriverInterface::motorDriveClosing == mdir) ?
-          maxCurrentReadingClosing : maxCurrentReadingOpening;
-      const bool currentSense = (mi > miHigh); // &&
       // TODO: capture some entropy from motor current lsbs.
-        // Recheck the value read in case spiky.
-        // (OTV0P2BASE::analogueNoiseReducedRead(MOTOR_DRIVE_MI_AIN_DigitalPin, INTERNAL) > miHigh) &&
-        // (OTV0P2BASE::analogueNoiseReducedRead(MOTOR_DRIVE_MI_AIN_DigitalPin, INTERNAL) > miHigh);
-      return(currentSense);
+      return(OTV0P2BASE::analogueNoiseReducedRead(MOTOR_DRIVE_MI_AIN_DigitalPin, INTERNAL));
       }
 
+  protected:
+    // Absolute maximum current reading allowed when running in the given direction.
+    virtual uint16_t getMaxCurrentReading(const OTRadValve::HardwareMotorDriverInterface::motor_drive mdir) const override
+      {
+      return((OTRadValve::HardwareMotorDriverInterface::motorDriveClosing == mdir) ?
+          maxCurrentReadingClosing : maxCurrentReadingOpening);
+      }
+
+  public:
     // Poll simple shaft encoder output; true if on mark, false if not or if unused for this driver.
     virtual bool isOnShaftEncoderMark() const
       {
@@ -0,0 +1,336 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * Physics-based simulated valve motor and gearbox,
+ * for offline evaluation of motor control (eg CurrentSenseValveMotorDirect).
+ *
+ * Host only.
+ */
+
+#ifndef ARDUINO_LIB_OTRADVALVE_VALVEMOTORSIMULATOR_H_
+#define ARDUINO_LIB_OTRADVALVE_VALVEMOTORSIMULATOR_H_
+
+#ifndef ARDUINO_ARCH_AVR
+
+#include <stdint.h>
+
+#include "OTRadValve_AbstractRadValve.h"
+#include "OTRadValve_CurrentSenseValveMotorDirect.h"
+
+namespace OTRadValve
+{
+
+
+// Simulated motor, gearbox and valve pin, with battery,
+// driven one sub-cycle tick at a time by motorRun().
+//
+// Models:
+//   * battery sag: the motor sees the battery voltage less the drop
+//     over the cell internal resistance, and the battery slowly drains
+//     with motor-on time, so speed falls over thousands of movements;
+//   * gear backlash: after a change of direction the motor turns
+//     for a while before the pin moves, drawing only no-load current;
+//   * variable friction: a few randomly placed sticky patches along the travel
+//     slow the pin and raise the current;
+//   * the valve spring: closing gets slower and draws more current
+//     as the pin approaches fully closed;
+//   * end stops: the pin stops and the current rises steadily
+//     until the motor is stopped;
+//   * current-sense noise, and an optional shaft encoder.
+//
+// Current readings are in ADC-like counts.
+// Stops a run on high current (absolute limit)
+// or on a stall reported by the callback, calling signalHittingEndStop().
+// A run of zero ticks runs for runupTicks.
+//
+// Deterministic for a given seed, and with no shared state,
+// so separate instances may be run concurrently.
+class ValveMotorSimulator final : public HardwareMotorDriverInterface
+  {
+  public:
+    // Simulation parameters.
+    struct params_t
+      {
+      // Ticks for full travel free-running at nominal voltage; strictly positive.
+      uint16_t travelTicks;
+      // Motor ticks of gear backlash taken up after a change of direction.
+      uint8_t backlashTicks;
+      // Number of sticky patches along the travel.
+      uint8_t stickyPatches;
+      // Extra friction in a sticky patch, as a fraction of free running load.
+      float stickyFriction;
+      // Extra load from the valve spring when closing at fully closed, as a fraction of free running load.
+      float springLoad;
+      // Battery open-circuit voltage at start (V), and nominal voltage for travelTicks (V).
+      float batteryV, nominalV;
+      // Cell internal resistance and motor winding resistance (ohm).
+      float batteryR, motorR;
+      // Battery voltage drop per motor-on tick (V).
+      float drainPerTick;
+      // Free running current reading at nominal voltage.
+      uint16_t runCurrent;
+      // Current rise per tick when pushing into an end stop.
+      uint16_t stallRamp;
+      // Absolute current limit (as for the hardware drivers).
+      uint16_t currentLimit;
+      // Peak current-sense noise (+/-).
+      uint8_t noise;
+      // Shaft encoder marks over full travel; 0 for none.
+      uint8_t encoderMarks;
+      // Minimum run ticks when asked to run for 0 ticks.
+      uint8_t runupTicks;
+      };
+
+    // Reasonable defaults, roughly as for a TRV1.x on a typical valve base with alkaline cells.
+    static params_t defaultParams()
+      {
+      params_t p;
+      p.travelTicks = 1500;
+      p.backlashTicks = 6;
+      p.stickyPatches = 4;
+      p.stickyFriction = 0.3f;
+      p.springLoad = 0.6f;
+      p.batteryV = 3.0f;
+      p.nominalV = 2.6f;
+      p.batteryR = 0.3f;
+      p.motorR = 5.0f;
+      p.drainPerTick = 1e-7f;
+      p.runCurrent = 200;
+      p.stallRamp = 15;
+      p.currentLimit = 450;
+      p.noise = 6;
+      p.encoderMarks = 0;
+      p.runupTicks = 4;
+      return(p);
+      }
+
+  private:
+    static constexpr uint8_t MAX_PATCHES = 8;
+
+    const params_t p;
+    // Small xorshift PRNG, local for determinism and thread safety.
+    uint32_t rng;
+    // Sticky patch centres, as fractions of travel from closed.
+    float patch[MAX_PATCHES];
+
+    // Pin position as a fraction of travel from fully closed (0) to fully open (1).
+    float position = 0;
+    // Backlash still to take up before the pin moves.
+    float backlashLeft = 0;
+    // Direction of the last run.
+    motor_drive lastDir = motorOff;
+    // Last current reading.
+    uint16_t current = 0;
+
+    // Statistics.
+    uint32_t motorOnTicks = 0;
+    uint32_t endStopTicks = 0;
+    uint32_t runs = 0;
+    uint32_t encoderMarksSeen = 0;
+
+    uint32_t nextRandom()
+      {
+      rng ^= rng << 13;
+      rng ^= rng >> 17;
+      rng ^= rng << 5;
+      return(rng);
+      }
+    // Uniform in [0,1).
+    float nextUnit() { return(float(nextRandom() >> 8) / float(1UL << 24)); }
+
+    // Extra friction at the current position.
+    float frictionAt(const float x) const
+      {
+      float f = 0;
+      for(uint8_t i = 0; i < p.stickyPatches && i < MAX_PATCHES; ++i)
+        {
+        // Each patch is about 2% of travel wide.
+        const float d = x - patch[i];
+        if((d > -0.01f) && (d < 0.01f)) { f += p.stickyFriction; }
+        }
+      return(f);
+      }
+
+  public:
+    explicit ValveMotorSimulator(const params_t &params = defaultParams(), const uint32_t seed = 1)
+      : p(params), rng(seed ? seed : 1)
+      {
+      for(uint8_t i = 0; i < MAX_PATCHES; ++i) { patch[i] = 0.05f + 0.9f * nextUnit(); }
+      }
+
+    // True position of the pin [0,100] % open.
+    uint8_t getPositionPC() const { return(uint8_t(position * 100 + 0.5f)); }
+    // Set the true position [0,100] % open, eg to start part way.
+    void setPositionPC(const uint8_t pc) { position = (pc > 100) ? 1.0f : (pc / 100.0f); }
+    // Present battery open-circuit voltage.
+    float getBatteryV() const { return(p.batteryV - (p.drainPerTick * motorOnTicks)); }
+
+    // Sub-cycle ticks for which the motor has been powered.
+    uint32_t getMotorOnTicks() const { return(motorOnTicks); }
+    // Motor-on ticks spent pushing against an end stop.
+    uint32_t getEndStopTicks() const { return(endStopTicks); }
+    // Number of (non-off) runs.
+    uint32_t getRuns() const { return(runs); }
+    // Shaft encoder marks passed.
+    uint32_t getEncoderMarks() const { return(encoderMarksSeen); }
+
+    virtual bool isCurrentHigh(const motor_drive /*mdir*/ = motorDriveOpening) const override
+      { return(current > p.currentLimit); }
+    virtual uint16_t readMotorCurrent() const override { return(current); }
+
+    virtual void motorRun(const uint8_t maxRunTicks, const motor_drive dir, HardwareMotorDriverInterfaceCallbackHandler &callback) override
+      {
+      if((motorDriveOpening != dir) && (motorDriveClosing != dir)) { current = 0; return; }
+      ++runs;
+      const bool isOpening = (motorDriveOpening == dir);
+      if((motorOff != lastDir) && (dir != lastDir)) { backlashLeft = p.backlashTicks; }
+      lastDir = dir;
+      const uint8_t ticks = (0 == maxRunTicks) ? p.runupTicks : maxRunTicks;
+      const float step = 1.0f / p.travelTicks;
+      uint16_t ramp = 0;
+      for(uint8_t t = 0; t < ticks; ++t)
+        {
+        ++motorOnTicks;
+        // Speed and free running current scale with the voltage across the motor.
+        const float vMotor = getBatteryV() * (p.motorR / (p.motorR + p.batteryR));
+        const float vScale = vMotor / p.nominalV;
+        callback.signalRunSCTTick(isOpening);
+        float load = 1;
+        const bool atStop = isOpening ? (position >= 1) : (position <= 0);
+        if(backlashLeft > 0) { backlashLeft -= vScale; load = 0.9f; }
+        else if(atStop) { ++endStopTicks; ramp = uint16_t(ramp + p.stallRamp); }
+        else
+          {
+          load += frictionAt(position);
+          if(!isOpening) { load += p.springLoad * (1 - position); }
+          // Speed falls with voltage and with load.
+          const float oldPos = position;
+          const float move = step * vScale / load;
+          position += isOpening ? move : -move;
+          if(position > 1) { position = 1; }
+          if(position < 0) { position = 0; }
+          if(0 != p.encoderMarks)
+            {
+            const int m0 = int(oldPos * p.encoderMarks), m1 = int(position * p.encoderMarks);
+            if(m0 != m1) { ++encoderMarksSeen; callback.signalShaftEncoderMarkStart(isOpening); }
+            }
+          }
+        const int n = int(nextRandom() % (2U * p.noise + 1)) - int(p.noise);
+        const int c = int(p.runCurrent * vScale * load) + ramp + n;
+        current = uint16_t((c < 0) ? 0 : c);
+        const bool stall = callback.signalMotorCurrent(isOpening, current);
+        if(stall || (current > p.currentLimit))
+          {
+          callback.signalHittingEndStop(isOpening);
+          break;
+          }
+        }
+      }
+  };
+
+// Runs a CurrentSenseValveMotorDirect against a ValveMotorSimulator
+// through a long randomised sequence of target positions,
+// gathering accuracy and energy statistics.
+// Each run is independent, so runs may be made concurrently.
+class ValveMotorBenchmark final
+  {
+  public:
+    struct result_t
+      {
+      // Target moves made.
+      uint32_t moves;
+      // Sum and maximum of absolute position error (driver estimate vs simulated pin) after each move.
+      uint32_t sumAbsErrorPC;
+      uint8_t maxAbsErrorPC;
+      // Motor-on ticks in total, and pushing against end stops.
+      uint32_t motorOnTicks;
+      uint32_t endStopTicks;
+      // Number of times the driver entered calibration (including the first).
+      uint16_t calibrations;
+      // True if the driver reached normal running, and if it ended in error.
+      bool reachedNormal;
+      bool errorState;
+      // Battery voltage at the end.
+      float finalBatteryV;
+      float meanAbsErrorPC() const { return((0 == moves) ? 0 : (float(sumAbsErrorPC) / moves)); }
+      };
+
+  private:
+    static uint8_t zeroSubCycleTime() { return(0); }
+
+  public:
+    // Run one benchmark.
+    //   * params  simulation parameters
+    //   * seed  seed for the simulator and the target sequence; non-zero
+    //   * moves  number of random target changes
+    //   * pollsPerMove  driver polls after each target change (~2s each)
+    static result_t run(const ValveMotorSimulator::params_t &params, const uint32_t seed,
+                        const uint32_t moves, const uint8_t pollsPerMove = 10)
+      {
+      result_t r = result_t();
+      ValveMotorSimulator sim(params, seed);
+      // Timing as for REV7.
+      CurrentSenseValveMotorDirect csv(&sim, zeroSubCycleTime,
+          CurrentSenseValveMotorDirectBinaryOnly::computeMinMotorDRTicks(7),
+          CurrentSenseValveMotorDirectBinaryOnly::computeSctAbsLimit(7, 255, 4));
+      CurrentSenseValveMotorDirectBinaryOnly::driverState last = csv._getState();
+      uint32_t rng = seed ^ 0x5a5a5a5aUL;
+      for(int i = 0; (i < 300) && !csv.isInNormalRunState() && !csv.isInErrorState(); ++i)
+        {
+        if(csv.isWaitingForValveToBeFitted()) { csv.signalValveFitted(); }
+        csv.poll();
+        if((CurrentSenseValveMotorDirectBinaryOnly::valveCalibrating == csv._getState()) &&
+           (last != CurrentSenseValveMotorDirectBinaryOnly::valveCalibrating)) { ++r.calibrations; }
+        last = csv._getState();
+        }
+      r.reachedNormal = csv.isInNormalRunState();
+      for(uint32_t m = 0; r.reachedNormal && (m < moves); ++m)
+        {
+        rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+        // Mostly mid-range targets, with some at the ends.
+        const uint8_t sel = uint8_t(rng % 10);
+        const uint8_t target = (0 == sel) ? 0 : ((1 == sel) ? 100 : uint8_t((rng >> 8) % 101));
+        csv.setTargetPC(target);
+        for(uint8_t i = 0; i < pollsPerMove; ++i)
+          {
+          csv.poll();
+          if((CurrentSenseValveMotorDirectBinaryOnly::valveCalibrating == csv._getState()) &&
+             (last != CurrentSenseValveMotorDirectBinaryOnly::valveCalibrating)) { ++r.calibrations; }
+          last = csv._getState();
+          }
+        const int e = int(csv.getCurrentPC()) - int(sim.getPositionPC());
+        const uint8_t ae = uint8_t((e < 0) ? -e : e);
+        r.sumAbsErrorPC += ae;
+        if(ae > r.maxAbsErrorPC) { r.maxAbsErrorPC = ae; }
+        ++r.moves;
+        }
+      r.motorOnTicks = sim.getMotorOnTicks();
+      r.endStopTicks = sim.getEndStopTicks();
+      r.errorState = csv.isInErrorState();
+      r.finalBatteryV = sim.getBatteryV();
+      return(r);
+      }
+  };
+
+
+}
+
+#endif // ARDUINO_ARCH_AVR
+
+#endif /* ARDUINO_LIB_OTRADVALVE_VALVEMOTORSIMULATOR_H_ */
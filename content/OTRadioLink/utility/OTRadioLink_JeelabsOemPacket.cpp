@@ -48,10 +48,6 @@ Author(s) / Copyright (s): Milenko Alcin 2016
 
 #include "OTRadioLink_JeelabsOemPacket.h"
 
-#ifdef ARDUINO_ARCH_AVR
-#include <util/crc16.h>
-#endif
-
 
 namespace OTRadioLink
     {
@@ -59,6 +55,10 @@ namespace OTRadioLink
 
 #ifdef JeelabsOemPacket_DEFINED
 
+constexpr uint8_t JeelabsOemPacket::HEADER_BYTES;
+constexpr uint8_t JeelabsOemPacket::CRC_BYTES;
+constexpr uint8_t JeelabsOemPacket::MAX_FRAME_BYTES;
+
 /*
  * Encode JeeLabs packet:
  *    buf     - holds payload, after encoding it points to the beginning of formatted packet
@@ -140,10 +140,10 @@ uint8_t JeelabsOemPacket::decode(uint8_t * const buf, uint8_t &buflen,  uint8_t
 bool JeelabsOemPacket::filter( const volatile uint8_t *buf, volatile uint8_t &buflen)
     {
        buflen  = buf[2]+5;
-       if (buflen > 64 ) return false;
+       if (buflen > MAX_FRAME_BYTES ) return false;
 
        uint16_t crc = ~0;
-       for (uint8_t i=0; i<buflen ; i++ ) crc = _crc16_update( crc, buf[i]);
+       for (uint8_t i=0; i<buflen ; i++ ) crc = OTV0P2BASE::crc16_A001_update( crc, buf[i]);
       
        if ( crc )  return false; 
     
@@ -152,30 +152,62 @@ bool JeelabsOemPacket::filter( const volatile uint8_t *buf, volatile uint8_t &bu
 
 /*
  * Configure our own group and node ID.
- * 
- * FIXME DE20180404 Commented out because no one is using it and it is currently broken:
- * - Return type does not match the code (I think it should be a bool).
- * - Function does not always return a value (I think it should return true at he end).
+ * Returns false if the node ID is out of range.
  */
-// uint8_t JeelabsOemPacket::setNodeAndGroupID(const uint8_t nodeID, const uint8_t groupID) 
-//     {
-//        if (nodeID > 31 ) return false;
-//        _nodeID = nodeID;
-//        _groupID = groupID;
-//     }
+bool JeelabsOemPacket::setNodeAndGroupID(const uint8_t nodeID, const uint8_t groupID)
+    {
+       if (nodeID > 31 ) return false;
+       _nodeID = nodeID;
+       _groupID = groupID;
+       return true;
+    }
+
+/*
+ * Filter and decode a contiguous capture of frames.
+ * Each frame is checked as by filter() then decode(), but in place.
+ */
+size_t JeelabsOemPacket::decodeBatch(const uint8_t *const capture, const size_t captureLen, frame_t *const out, const size_t maxOut, batchStats_t *const stats) const
+    {
+       batchStats_t s = { 0, 0, 0 };
+       size_t i = 0;
+       while ((s.frames < maxOut) && (i + HEADER_BYTES + CRC_BYTES <= captureLen))
+         {
+         const uint8_t *const f = capture + i;
+         const size_t flen = size_t(f[2]) + HEADER_BYTES + CRC_BYTES;
+         if ((flen > MAX_FRAME_BYTES) || (i + flen > captureLen) || (0 != calcCrc(f, uint8_t(flen))))
+           {
+           // Resynchronise at the next byte that could start one of our frames.
+           const uint8_t *const next = static_cast<const uint8_t *>(memchr(f + 1, _groupID, captureLen - i - 1));
+           const size_t skip = (NULL == next) ? (captureLen - i) : size_t(next - f);
+           s.badBytes += skip;
+           i += skip;
+           continue;
+           }
+         i += flen;
+         // Skip good frames for another group, or addressed to another node.
+         const uint8_t nodeID = f[1] & 0x1f;
+         const bool dest = (0 != (f[1] & 0x40));
+         if ( (f[0] != _groupID) || (dest && (nodeID != _nodeID)) ) { ++s.notForUs; continue; }
+         frame_t &o = out[s.frames++];
+         o.payload = f + HEADER_BYTES;
+         o.len     = f[2];
+         o.nodeID  = nodeID;
+         o.dest    = dest;
+         o.ackConf = (0 != (f[1] & 0x80));
+         o.ackReq  = (0 != (f[1] & 0x20));
+         }
+       if (NULL != stats) { *stats = s; }
+       return s.frames;
+    }
 
 
 /**Calculate CRC.
  * Used both in send and receive.
- * Uses default CRC routine from AVR standard clib.
+ * Uses the table-driven CRC16 (same as AVR _crc16_update()).
  */
 uint16_t JeelabsOemPacket::calcCrc(const uint8_t* buf, uint8_t len) 
     {
-       uint16_t crc = ~0;
-       while (len--) 
-         crc = _crc16_update( crc, *buf++);
-
-       return crc;
+       return OTV0P2BASE::crc16_A001(buf, len);
     }
 
 #endif // JeelabsOemPacket_DEFINED
@@ -39,48 +39,79 @@ Author(s) / Copyright (s): Milenko Alcin 2016
  * Method moves payload to the right place, formats packet header and add CRC.
  * 
  * Preamble and first syn byte are added by packet handler in OTRFM23BLink.
- * 
- * Currently AVR only.
+ *
+ * For a hub, decodeBatch() validates and decodes a contiguous capture of frames in place.
+ *
+ * Portable.
  */
 
 #ifndef ARDUINO_LIB_OTRADIOLINK_JEELABSOEMPACKET_H
 #define ARDUINO_LIB_OTRADIOLINK_JEELABSOEMPACKET_H
 
 #include <stdint.h>
-#include <OTV0p2Base.h>
-#include <OTRadioLink.h>
+#include <stddef.h>
 
 
 namespace OTRadioLink
     {
 
 
-#ifdef ARDUINO_ARCH_AVR
 #define JeelabsOemPacket_DEFINED
     class JeelabsOemPacket
         {
         private:
         uint8_t _nodeID;
         uint8_t _groupID;
-        uint16_t calcCrc(const uint8_t* buf, uint8_t len);
+        static uint16_t calcCrc(const uint8_t* buf, uint8_t len);
         public:
+        // Header bytes (group, header, length) and trailing CRC bytes around the payload.
+        static constexpr uint8_t HEADER_BYTES = 3;
+        static constexpr uint8_t CRC_BYTES = 2;
+        // Maximum whole frame length accepted, as for the RX filter.
+        static constexpr uint8_t MAX_FRAME_BYTES = 64;
+
         // Default node ID chosen arbitrarily, group ID is JeeLabs default.
         JeelabsOemPacket() { _nodeID = 5; _groupID = 100; }; 
-        /*
-         * Configure our own group and node ID.
-         * 
-         * FIXME DE20180404 Commented out because no one is using it and it is currently broken:
-         * - Return type does not match the code (I think it should be a bool).
-         * - Function does not always return a value (I think it should return true at he end).
-         */
-        // uint8_t setNodeAndGroupID(const uint8_t nodeID, const uint8_t groupID);
-        uint8_t getNodeID() { return _nodeID; };
-        uint8_t getGroupID() { return _groupID; };
+        // Configure our own group and node ID; returns false (and changes nothing) if the node ID is out of range.
+        bool setNodeAndGroupID(const uint8_t nodeID, const uint8_t groupID);
+        uint8_t getNodeID() const { return _nodeID; };
+        uint8_t getGroupID() const { return _groupID; };
         uint8_t encode( uint8_t * const buf,  const uint8_t buflen,  const uint8_t nodeID = 0,  const bool dest = false,  const bool ackReq = false,  const bool ackConf = false);
         uint8_t decode(uint8_t * const buf, uint8_t &buflen,  uint8_t &nodeID,  bool &dest,  bool &ackReq,  bool &ackConf);
         static bool filter( const volatile uint8_t *buf, volatile uint8_t &buflen);
+
+        // One frame found by decodeBatch(); the payload is left in place in the capture.
+        struct frame_t
+            {
+            const uint8_t *payload;
+            uint8_t len;
+            uint8_t nodeID;
+            bool dest;
+            bool ackReq;
+            bool ackConf;
+            };
+        // Counts from decodeBatch().
+        struct batchStats_t
+            {
+            // Frames decoded.
+            size_t frames;
+            // Frames with good CRC skipped as for another group or node.
+            size_t notForUs;
+            // Bytes skipped resynchronising after a bad length or CRC.
+            size_t badBytes;
+            };
+        /*
+         * Filter and decode a contiguous capture of frames, each as returned by the radio
+         * (group, header, length, payload, CRC), back to back.
+         * Applies the same checks as filter() and decode() to each frame
+         * without copying or altering the capture.
+         * On a bad length or CRC skips forward to the next byte matching our group ID and tries again.
+         * Fills out with up to maxOut frames, returning the number found;
+         * stops early if out is full.
+         * If stats is non-NULL, it is overwritten with counts for this call.
+         */
+        size_t decodeBatch(const uint8_t *capture, size_t captureLen, frame_t *out, size_t maxOut, batchStats_t *stats = NULL) const;
         };
-#endif // ARDUINO_ARCH_AVR
 
 
     }
@@ -193,29 +193,34 @@ bool boilerFrameOperation(const OTDecodeData_T &fd)
 // Local scratch: total incl template srfx_t::decodeSecureSmallFrameSafely().
 static constexpr uint8_t authAndDecodeOTSecurableFrameWithWorkspace_scratch_usage =
     16; // Primary building key size.
+// Total scratch space needed, including the callees, with the OTAESGCM 3.0 decrypt.
+static constexpr size_t authAndDecodeOTSecurableFrame_total_scratch_usage_OTAESGCM_3p0 =
+    OTV0P2BASE::scratchSum(
+        SimpleSecureFrame32or0BodyRXBase::decode_total_scratch_usage_OTAESGCM_3p0,
+        authAndDecodeOTSecurableFrameWithWorkspace_scratch_usage);
 template <typename sfrx_t,
           SimpleSecureFrame32or0BodyRXBase::fixed32BTextSize12BNonce16BTagSimpleDec_fn_t &decrypt,
           OTV0P2BASE::GetPrimary16ByteSecretKey_t &getKey>
 inline bool authAndDecodeOTSecurableFrame(OTDecodeData_T &fd, OTV0P2BASE::ScratchSpaceL &sW)
 {
-    constexpr size_t scratchSpaceNeededHere = authAndDecodeOTSecurableFrameWithWorkspace_scratch_usage;
-    if(sW.bufsize < scratchSpaceNeededHere) { return(false); } // ERROR
+    // Use scratch space for 16-byte key.
+    OTV0P2BASE::ScratchArena arena(sW);
+    uint8_t *const key = arena.alloc(authAndDecodeOTSecurableFrameWithWorkspace_scratch_usage);
+    if(arena.overflowed()) { return(false); } // ERROR
 
 #if 0
     // Probe the stack here, in case we don't get deeper.
     OTV0P2BASE::MemoryChecks::recordIfMinSP();
 #endif
 
-    // Use scratch space for 16-byte key.
-    uint8_t *key = sW.buf;
     // Get the building primary key.
     if(!getKey(key)) { // CI throws "address will never be null" error.
         OTV0P2BASE::serialPrintlnAndFlush(F("!RX key"));
         return(false);
     }
 
-    // Create sub-space for callee.
-    OTV0P2BASE::ScratchSpaceL subScratch(sW, scratchSpaceNeededHere);
+    // Pass the rest on to the callee.
+    OTV0P2BASE::ScratchSpaceL subScratch(arena.rest());
 
     // Now attempt to decrypt.
     // Assumed no need to 'adjust' node ID for this form of RX.
@@ -491,7 +496,10 @@ public:
         // 0.5s before the minor cycle end.
 #ifdef ARDUINO_ARCH_AVR
         const uint8_t sctStart = OTV0P2BASE::getSubCycleTime();
-        if(sctStart >= ((OTV0P2BASE::GSCT_MAX/4)*3)) { return(false); }
+        const uint8_t latestStart = (OTV0P2BASE::GSCT_MAX/4)*3;
+        OTV0P2BASE::CycleBudget *const cb = OTV0P2BASE::getCycleBudget();
+        if(NULL != cb) { cb->mayStart(OTV0P2BASE::CBC_MESSAGING, sctStart, latestStart); }
+        if(sctStart >= latestStart) { return(false); }
 #endif // ARDUINO_ARCH_AVR
 
         // Deal with any I/O that is queued.
@@ -519,6 +527,9 @@ public:
             if(neededWaking) { OTV0P2BASE::flushSerialProductive(); OTV0P2BASE::powerDownSerial(); }
 #endif // ARDUINO_ARCH_AVR
         }
+#ifdef ARDUINO_ARCH_AVR
+        if(NULL != cb) { cb->finished(OTV0P2BASE::CBC_MESSAGING, OTV0P2BASE::getSubCycleTime()); }
+#endif // ARDUINO_ARCH_AVR
         return(workDone);
     }
 };
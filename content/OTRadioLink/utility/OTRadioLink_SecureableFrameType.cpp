@@ -578,12 +578,11 @@ uint8_t SimpleSecureFrame32or0BodyRXBase::decodeRaw(
             const uint8_t *const key,
             const uint8_t *const iv)
     {
-    // Scratch space for this function call alone (not called fns).
-    constexpr uint8_t scratchSpaceNeededHere =
-        decodeRaw_scratch_usage;
-    if(scratchSpaceNeededHere > scratch.bufsize) { return(0); }
-    // Create a new sub scratch space for callee.
-    OTV0P2BASE::ScratchSpaceL subScratch(scratch, scratchSpaceNeededHere);
+    // Decryption buffer from the front of the scratch space;
+    // the rest is passed on to d().
+    OTV0P2BASE::ScratchArena arena(scratch);
+    uint8_t * const decryptBuf = arena.alloc(decodeRaw_scratch_usage);
+    if(arena.overflowed()) { return(0); } // ERROR
 
     if((NULL == fd.ctext) || (NULL == key) || (NULL == iv)) { return(0); } // ERROR
 
@@ -605,9 +604,8 @@ uint8_t SimpleSecureFrame32or0BodyRXBase::decodeRaw(
     // Note if plaintext is actually wanted/expected.
     const bool plaintextWanted = (NULL != fd.ptext);
     // Attempt to authenticate and decrypt.
-    uint8_t * const decryptBuf = scratch.buf;
-    //uint8_t decryptBuf[ENC_BODY_SMALL_FIXED_CTEXT_SIZE];
-    if(!d(scratch.buf+scratchSpaceNeededHere, scratch.bufsize-scratchSpaceNeededHere,
+    const OTV0P2BASE::ScratchSpaceL dScratch(arena.rest());
+    if(!d(dScratch.buf, dScratch.bufsize,
                 key, iv, buf, sfh.getHl(),
                 (0 == bl) ? NULL : buf + sfh.getBodyOffset(), buf + fl - 16,
                 decryptBuf)) { return(0); } // ERROR
@@ -824,24 +822,23 @@ uint8_t SimpleSecureFrame32or0BodyTXBase::encode(
             OTV0P2BASE::ScratchSpaceL &scratch,
             const uint8_t *const key)
     {
-    constexpr uint8_t IV_size = 12;
-    static_assert(encode_scratch_usage == IV_size + OTV0P2BASE::OpenTRV_Node_ID_Bytes, "self-use scratch size wrong");
-    static_assert(encode_scratch_usage < encode_total_scratch_usage_OTAESGCM_2p0, "scratch size calc wrong");
+    // Check up front for the callees too, before consuming a TX message counter value.
     if(scratch.bufsize < encode_total_scratch_usage_OTAESGCM_2p0) { return(0); } // ERROR
 
     if((fd.fType >= FTS_INVALID_HIGH) || (fd.fType == FTS_NONE)) { return(0); } // FAIL
-    // // iv at start of scratch space
-    uint8_t *const iv = scratch.buf; // uint8_t iv[IV_size];
+    OTV0P2BASE::ScratchArena arena(scratch);
+    uint8_t *const iv = arena.alloc(SimpleSecureFrame32or0BodyBase::IVBytes);
+    // This is the special case! Will potentially need an extra 8 bytes to store the id.
+    uint8_t *const id = arena.alloc(OTV0P2BASE::OpenTRV_Node_ID_Bytes);
+    if(arena.overflowed()) { return(0); } // ERROR
     if(!computeIVForTX12B(iv)) { return(0); }
 
-    // This is the special case! Will potentially need an extra 8 bytes to store the id.
     // If ID is short then we can cheat by reusing start of IV, else fetch again explicitly...
     const bool longID = (il_ > 6);
-    uint8_t *const id = iv + IV_size;
     if(longID && !getTXID(id)) { return(255); } // FAIL
 
-    // // Create a new scratchspace from the old one in order to pass on.
-    OTV0P2BASE::ScratchSpaceL subscratch(scratch, encode_scratch_usage);
+    // Pass the rest of the scratch space on.
+    OTV0P2BASE::ScratchSpaceL subscratch(arena.rest());
 
     const uint8_t *actualID = (longID ? id : iv);
 
@@ -892,32 +889,26 @@ uint8_t SimpleSecureFrame32or0BodyTXBase::encodeValveFrame(
                                             OTV0P2BASE::ScratchSpaceL &scratch,
                                             const uint8_t *const key)
 {
-    constexpr uint8_t IV_size = 12;
-    static_assert(encodeValveFrame_scratch_usage == IV_size, "self-use scratch size wrong");
-    static_assert(encodeValveFrame_scratch_usage < encodeValveFrame_total_scratch_usage_OTAESGCM_2p0, "scratch size calc wrong");
+    // Check up front for the callees too, before consuming a TX message counter value.
     if(scratch.bufsize < encodeValveFrame_total_scratch_usage_OTAESGCM_2p0) { return(0); } // ERROR
 
     // buffer args and consts
     uint8_t * const ptext = fd.ptext;
 
-    // iv at start of scratch space
-    uint8_t *const iv = scratch.buf; // uint8_t iv[IV_size];
+    OTV0P2BASE::ScratchArena arena(scratch);
+    uint8_t *const iv = arena.alloc(SimpleSecureFrame32or0BodyBase::IVBytes);
+    if(arena.overflowed()) { return(0); } // ERROR
     if(!computeIVForTX12B(iv)) { return(0); }
 
-    const char *const statsJSON = (const char *)&ptext[2];
-    const bool hasStats = (NULL != ptext) && ('{' == statsJSON[0]);
-    const size_t slp1 = hasStats ? strlen(statsJSON) : 1; // Stats length including trailing '}' (not sent).
-    if(slp1 > ENC_BODY_SMALL_FIXED_PTEXT_MAX_SIZE-1) { return(0); } // ERROR
-    const uint8_t statslen = (uint8_t)(slp1 - 1); // Drop trailing '}' implicitly.
-    ptext[0] = (valvePC <= 100) ? valvePC : 0x7f;
-    ptext[1] = hasStats ? 0x10 : 0; // Indicate presence of stats.
+    const uint8_t bodyLen = prepareValveFrameBody(ptext, valvePC);
+    if(0 == bodyLen) { return(0); } // ERROR
 
-    // Create a new scratchspace from the old one in order to pass on.
-    OTV0P2BASE::ScratchSpaceL subscratch(scratch, encodeValveFrame_scratch_usage);
+    // Pass the rest of the scratch space on.
+    OTV0P2BASE::ScratchSpaceL subscratch(arena.rest());
     if(il_ > 6) { return(0); } // ERROR: cannot supply that much of ID easily.
 
     // Create id buffer
-    fd.ptextLen = (hasStats ? 2+statslen : 2); // Note: callee will pad beyond this.
+    fd.ptextLen = bodyLen; // Note: callee will pad beyond this.
     fd.fType = OTRadioLink::FTS_BasicSensorOrValve;
 
     // note: id and iv are both passed in here despite pointing at the same
@@ -926,6 +917,132 @@ uint8_t SimpleSecureFrame32or0BodyTXBase::encodeValveFrame(
     return(encodeRaw(fd, iv, il_, iv, e, subscratch, key));
 }
 
+// Fills in the 2-byte 'O' frame body header in place ahead of any
+// '\0'-terminated {} JSON stats at ptext[2], as for encodeValveFrame().
+// Returns the unpadded body length to use as ptextLen, or 0 in case of error.
+uint8_t SimpleSecureFrame32or0BodyTXBase::prepareValveFrameBody(uint8_t *const ptext, const uint8_t valvePC)
+    {
+    if(NULL == ptext) { return(0); } // ERROR
+    const char *const statsJSON = (const char *)&ptext[2];
+    const bool hasStats = ('{' == statsJSON[0]);
+    const size_t slp1 = hasStats ? strlen(statsJSON) : 1; // Stats length including trailing '}' (not sent).
+    if(slp1 > ENC_BODY_SMALL_FIXED_PTEXT_MAX_SIZE-1) { return(0); } // ERROR
+    const uint8_t statslen = (uint8_t)(slp1 - 1); // Drop trailing '}' implicitly.
+    ptext[0] = (valvePC <= 100) ? valvePC : 0x7f;
+    ptext[1] = hasStats ? 0x10 : 0; // Indicate presence of stats.
+    return(hasStats ? 2+statslen : 2);
+    }
+
+// Reserves n consecutive message counters, filling the 6-byte buf with the first.
+// Draws the counters one at a time and checks that they are consecutive.
+bool SimpleSecureFrame32or0BodyTXBase::reserveTXMsgCtrs(uint8_t *const buf, const uint8_t n)
+    {
+    if((NULL == buf) || (0 == n)) { return(false); }
+    if(!getNextTXMsgCtr(buf)) { return(false); }
+    uint8_t expected[fullMsgCtrBytes];
+    uint8_t next[fullMsgCtrBytes];
+    memcpy(expected, buf, fullMsgCtrBytes);
+    for(uint8_t i = 1; i < n; ++i)
+        {
+        if(!incrementMsgCtr(expected)) { return(false); }
+        if(!getNextTXMsgCtr(next)) { return(false); }
+        if(0 != memcmp(expected, next, fullMsgCtrBytes)) { return(false); }
+        }
+    return(true);
+    }
+
+// Increments a 6-byte message counter in place, most significant byte first.
+// Returns false (leaving the counter all zeros) if it was already at its maximum value.
+bool SimpleSecureFrame32or0BodyTXBase::incrementMsgCtr(uint8_t *const ctr)
+    {
+    for(uint8_t i = fullMsgCtrBytes; i-- > 0; )
+        { if(0 != ++ctr[i]) { return(true); } }
+    return(false);
+    }
+
+// Adds n to the len least-significant bytes of a message counter in place, most significant byte first.
+// Returns true if this carried out of the top byte.
+bool SimpleSecureFrame32or0BodyTXBase::advanceMsgCtrLSBs(uint8_t *const lsbs, const uint8_t len, const uint8_t n)
+    {
+    uint16_t carry = n;
+    for(uint8_t i = len; (0 != carry) && (i-- > 0); )
+        {
+        carry += lsbs[i];
+        lsbs[i] = uint8_t(carry);
+        carry >>= 8;
+        }
+    return(0 != carry);
+    }
+
+// Subtracts n from a 6-byte message counter in place, most significant byte first.
+// Returns false if this would go below zero.
+bool SimpleSecureFrame32or0BodyTXBase::stepBackMsgCtr(uint8_t *const ctr, const uint8_t n)
+    {
+    uint16_t borrow = n;
+    for(uint8_t i = fullMsgCtrBytes; (0 != borrow) && (i-- > 0); )
+        {
+        const uint8_t b = uint8_t(borrow);
+        borrow = (borrow >> 8) + ((ctr[i] < b) ? 1 : 0);
+        ctr[i] = uint8_t(ctr[i] - b);
+        }
+    return(0 == borrow);
+    }
+
+/**
+ * @brief   Encode a batch of secure frames back to back into one buffer
+ *          for bulk transmission, eg from a hub.
+ *
+ * The TX ID is fetched once and a block of n message counters is reserved
+ * in one step; each frame is then encoded straight into place with encodeRaw().
+ *
+ * @retval  Returns the total bytes written to outbuf, or 0 if no frame
+ *          was encoded.
+ */
+size_t SimpleSecureFrame32or0BodyTXBase::encodeBulk(
+            bulkFrame_t *const frames,
+            const uint8_t n,
+            const uint8_t il_,
+            uint8_t *const outbuf,
+            const size_t outbufSize,
+            fixed32BTextSize12BNonce16BTagSimpleEnc_fn_t &e,
+            OTV0P2BASE::ScratchSpaceL &scratch,
+            const uint8_t *const key)
+    {
+    if((NULL == frames) || (0 == n) || (NULL == outbuf)) { return(0); } // ERROR
+    for(uint8_t i = 0; i < n; ++i) { frames[i].frameLen = 0; }
+    // Check up front for the callees too, before consuming any TX message counter values.
+    if(scratch.bufsize < encodeBulk_total_scratch_usage_OTAESGCM_2p0) { return(0); } // ERROR
+
+    OTV0P2BASE::ScratchArena arena(scratch);
+    uint8_t *const iv = arena.alloc(SimpleSecureFrame32or0BodyBase::IVBytes);
+    uint8_t *const id = arena.alloc(OTV0P2BASE::OpenTRV_Node_ID_Bytes);
+    if(arena.overflowed()) { return(0); } // ERROR
+    // One ID fetch and one counter reservation for the whole batch.
+    if(!getTXID(id)) { return(0); } // FAIL
+    memcpy(iv, id, SimpleSecureFrame32or0BodyBase::IVBytes - fullMsgCtrBytes);
+    uint8_t *const ctr = iv + (SimpleSecureFrame32or0BodyBase::IVBytes - fullMsgCtrBytes);
+    if(!reserveTXMsgCtrs(ctr, n)) { return(0); } // FAIL
+
+    // Pass the rest of the scratch space on.
+    OTV0P2BASE::ScratchSpaceL subscratch(arena.rest());
+
+    size_t used = 0;
+    for(uint8_t i = 0; i < n; ++i)
+        {
+        if((0 != i) && !incrementMsgCtr(ctr)) { break; } // Cannot happen for a valid reservation.
+        bulkFrame_t &f = frames[i];
+        const size_t space = outbufSize - used;
+        OTEncodeData_T fd(f.ptext, f.ptextbufSize, outbuf + used, (space > 255) ? 255 : uint8_t(space));
+        fd.ptextLen = f.ptextLen;
+        fd.fType = f.fType;
+        const uint8_t l = encodeRaw(fd, id, il_, iv, e, subscratch, key);
+        if(0 == l) { break; }
+        f.frameLen = l;
+        used += l;
+        }
+    return(used);
+    }
+
 /**
  * @brief   Decode a frame from a given ID. NOT A PUBLIC ENTRY POINT!
  * 
@@ -975,12 +1092,11 @@ uint8_t SimpleSecureFrame32or0BodyRXBase::_decodeFromID(
                                 const OTBuf_t &adjID,
                                 OTV0P2BASE::ScratchSpaceL &scratch, const uint8_t *const key)
     {
-    // Scratch space for this function call alone (not called fns).
-    constexpr uint8_t scratchSpaceNeededHere =
-        _decodeFromID_scratch_usage;
-    if(scratchSpaceNeededHere > scratch.bufsize) { return(0); }
-    // Create a new sub scratch space for callee.
-    OTV0P2BASE::ScratchSpaceL subScratch(scratch, scratchSpaceNeededHere);
+    // IV from the front of the scratch space; the rest is passed on.
+    OTV0P2BASE::ScratchArena arena(scratch);
+    uint8_t *const iv = arena.alloc(_decodeFromID_scratch_usage);
+    if(arena.overflowed()) { return(0); } // ERROR
+    OTV0P2BASE::ScratchSpaceL subScratch(arena.rest());
 
     if(adjID.bufsize < 6) { return(0); } // ERROR
 
@@ -989,7 +1105,6 @@ uint8_t SimpleSecureFrame32or0BodyRXBase::_decodeFromID(
 
     // Construct IV from supplied (possibly adjusted) ID
     // + counters from (start of) trailer.
-    uint8_t *iv = scratch.buf;
     memcpy(iv, adjID.getBuf(), 6);
     memcpy(iv + 6, fd.ctext + fd.sfh.getTrailerOffset(), SimpleSecureFrame32or0BodyBase::fullMsgCtrBytes);
     // Now do actual decrypt/auth.
@@ -1041,12 +1156,15 @@ uint8_t SimpleSecureFrame32or0BodyRXBase::decode(
             const uint8_t *const key,
             bool /*firstIDMatchOnly*/)
     {
-    // Scratch space for this function call alone (not called fns).
-    constexpr uint8_t scratchSpaceNeededHere =
-        decode_scratch_usage;
-    if(scratchSpaceNeededHere > scratch.bufsize) { return(0); }
-    // Create a new sub scratch space for callee.
-    OTV0P2BASE::ScratchSpaceL subScratch(scratch, scratchSpaceNeededHere);
+    // Node ID and message counter from the front of the scratch space.
+    // These buffers should not be visible outside the decode stack
+    // (e.g. should not be part of fd).
+    OTV0P2BASE::ScratchArena arena(scratch);
+    uint8_t *const nodeID = arena.alloc(OTV0P2BASE::OpenTRV_Node_ID_Bytes);
+    uint8_t *const messageCounter = arena.alloc(SimpleSecureFrame32or0BodyBase::fullMsgCtrBytes);
+    if(arena.overflowed()) { return(0); } // ERROR
+    // The rest is passed on.
+    OTV0P2BASE::ScratchSpaceL subScratch(arena.rest());
 
     // Rely on _decodeSecureSmallFrameFromID() for validation of items
     // not directly needed here.
@@ -1058,16 +1176,11 @@ uint8_t SimpleSecureFrame32or0BodyRXBase::decode(
     if(23 != fd.sfh.getTl()) { return(0); } // ERROR
     // Look up the full node ID of the sender in the associations table.
     // NOTE: this only tries the first match, ignoring firstIDMatchOnly.
-    // Use start of scratch space. This buffer should not be visible
-    // outside the decode stack (e.g. should not be part of fd).
-    uint8_t *const nodeID = scratch.buf;
     const OTBuf_t senderNodeID(nodeID, OTV0P2BASE::OpenTRV_Node_ID_Bytes);
     const int8_t index = _getNextMatchingNodeID(0, &fd.sfh, nodeID);
     if(index < 0) { return(0); } // ERROR
     // Extract the message counter and validate it
     // (that it is higher than previously seen)...
-    // Append to scratch space, after node id.
-    uint8_t * const messageCounter = scratch.buf + OTV0P2BASE::OpenTRV_Node_ID_Bytes;
     // Assume counter positioning as for 0x80 type trailer,
     // ie 6 bytes at start of trailer.
     // Destination and source known large enough for copy to be safe.
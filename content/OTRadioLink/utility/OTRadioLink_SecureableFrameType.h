@@ -470,6 +470,8 @@ namespace OTRadioLink
         public:
             // Size of full message counter for type-0x80 AES-GCM security frames.
             static constexpr uint8_t fullMsgCtrBytes = 6;
+            // Size of the IV/nonce for type-0x80 AES-GCM security frames.
+            static constexpr uint8_t IVBytes = 12;
         };
 
     // TX Base class for simple implementations that supports 0 or 32 byte encrypted body sections.
@@ -590,8 +592,9 @@ namespace OTRadioLink
              */
             static constexpr uint8_t encodeRaw_scratch_usage = 0;
             static constexpr size_t encodeRaw_total_scratch_usage_OTAESGCM_2p0 =
-                    workspaceRequred_GCM32B16B_OTAESGCM_2p0
-                    + encodeRaw_scratch_usage;
+                    OTV0P2BASE::scratchSum(
+                        workspaceRequred_GCM32B16B_OTAESGCM_2p0,
+                        encodeRaw_scratch_usage);
             static uint8_t encodeRaw(
                                 OTEncodeData_T &fd,
                                 // const OTBuf_t &id_,
@@ -650,6 +653,25 @@ namespace OTRadioLink
             // This should never return an all-zero count.
             // Not ISR-safe.
             virtual bool getNextTXMsgCtr(uint8_t *buf) = 0;
+            // Reserves n [1,255] consecutive message counters, filling the 6-byte buf with the first.
+            // The caller may then use the first and the n-1 values following it
+            // (see incrementMsgCtr()), once each, without further calls to this object.
+            // Returns true on success; false on failure, when some counters may have been consumed unused.
+            // The default draws the counters one at a time and checks that they are consecutive;
+            // implementations should override this to update any persistent store at most once per block.
+            // Not ISR-safe.
+            virtual bool reserveTXMsgCtrs(uint8_t *buf, uint8_t n);
+            // Increments a 6-byte message counter in place, most significant byte first.
+            // Returns false (leaving the counter all zeros) if it was already at its maximum value.
+            static bool incrementMsgCtr(uint8_t *ctr);
+            // Adds n to the len least-significant bytes of a message counter in place, most significant byte first,
+            // eg the ephemeral part of the counter.
+            // Returns true if this carried out of the top byte, ie the more significant part must be incremented.
+            static bool advanceMsgCtrLSBs(uint8_t *lsbs, uint8_t len, uint8_t n);
+            // Subtracts n from a 6-byte message counter in place, most significant byte first,
+            // eg to step back from the last of a block of counters to the first.
+            // Returns false (leaving the counter wrapped) if this would go below zero.
+            static bool stepBackMsgCtr(uint8_t *ctr, uint8_t n);
 
             // Fill in 12-byte IV for 'O'-style (0x80) AESGCM security for a frame to TX; returns false on failure.
             // This uses the local node ID as-is for the first 6 bytes by default,
@@ -703,10 +725,14 @@ namespace OTRadioLink
              * @note    Uses a scratch space, allowing the stack usage to be more tightly
              *          controlled.
              */
-            static constexpr uint8_t encode_scratch_usage = 12 + 8;
+            static constexpr uint8_t encode_scratch_usage =
+                    OTV0P2BASE::scratchSum(
+                        SimpleSecureFrame32or0BodyBase::IVBytes,
+                        OTV0P2BASE::OpenTRV_Node_ID_Bytes);
             static constexpr size_t encode_total_scratch_usage_OTAESGCM_2p0 =
-                     encodeRaw_total_scratch_usage_OTAESGCM_2p0
-                     + encode_scratch_usage;
+                    OTV0P2BASE::scratchSum(
+                        encodeRaw_total_scratch_usage_OTAESGCM_2p0,
+                        encode_scratch_usage);
             uint8_t encode(
                         OTEncodeData_T &fd,
                         uint8_t il_,
@@ -774,10 +800,12 @@ namespace OTRadioLink
              *              time/resource limits.
              * @retval  Returns number of bytes written to fd.outbuf, or 0 in case of error.
              */
-            static constexpr uint8_t encodeValveFrame_scratch_usage = 12; // + 32; as bbuf moved out to level above.
+            static constexpr uint8_t encodeValveFrame_scratch_usage =
+                    SimpleSecureFrame32or0BodyBase::IVBytes; // bbuf moved out to level above.
             static constexpr size_t encodeValveFrame_total_scratch_usage_OTAESGCM_2p0 =
-                    encodeRaw_total_scratch_usage_OTAESGCM_2p0
-                    + encodeValveFrame_scratch_usage;
+                    OTV0P2BASE::scratchSum(
+                        encodeRaw_total_scratch_usage_OTAESGCM_2p0,
+                        encodeValveFrame_scratch_usage);
             uint8_t encodeValveFrame(
                         OTEncodeData_T &fd,
                         uint8_t il_,
@@ -785,6 +813,74 @@ namespace OTRadioLink
                         fixed32BTextSize12BNonce16BTagSimpleEnc_fn_t &e,
                         OTV0P2BASE::ScratchSpaceL &scratch,
                         const uint8_t *key);
+
+            // Fills in the 2-byte 'O' frame body header in place ahead of any
+            // '\0'-terminated {} JSON stats at ptext[2], as for encodeValveFrame().
+            // Returns the unpadded body length to use as ptextLen, or 0 in case of error.
+            //  * ptext  body buffer of ENC_BODY_SMALL_FIXED_PTEXT_MAX_SIZE bytes; never NULL
+            //  * valvePC  percentage valve is open or 0x7f if no valve to report on
+            static uint8_t prepareValveFrameBody(uint8_t *ptext, uint8_t valvePC);
+
+            // One frame for encodeBulk().
+            struct bulkFrame_t final
+                {
+                // INPUT: frame type (without secure bit).
+                FrameType_Secureable fType;
+                // MUTABLE INPUT: plain-text body, padded in situ; NULL for none.
+                uint8_t *ptext;
+                // INPUT: size of the ptext buffer.
+                uint8_t ptextbufSize;
+                // INPUT: unpadded length of the body in ptext.
+                uint8_t ptextLen;
+                // OUTPUT: bytes of outbuf used by this frame, or 0 if not encoded.
+                uint8_t frameLen;
+                };
+            /**
+             * @brief   Encode a batch of secure frames back to back into one buffer
+             *          for bulk transmission, eg from a hub.
+             *
+             * The TX ID is fetched once, and a block of n message counters is
+             * reserved in one step with reserveTXMsgCtrs(), so the persistent
+             * counter store is touched at most once per batch rather than per frame.
+             * The IV for each frame is built as by the default computeIVForTX12B()
+             * with consecutive counter values, then the frame is encoded with
+             * encodeRaw() straight into place, so nothing is allocated or copied
+             * per frame.
+             *
+             * Stops at the first frame that fails to encode, eg for lack of space
+             * in outbuf; the counters reserved for that and any following frames
+             * are left unused.
+             *
+             * @param   frames: Frames to encode; frameLen is set for each.
+             * @param   n: Number of frames [1,255].
+             * @param   il_: ID length for the header, as for encode().
+             * @param   outbuf, OUTPUT: Buffer to hold the frames, each including
+             *              its leading length byte and trailer. Never NULL.
+             * @param   outbufSize, INPUT: Size of outbuf in bytes.
+             * @param   e: Encryption function.
+             * @param   scratch: Scratch space. Size must be large enough to contain
+             *              encodeBulk_total_scratch_usage_OTAESGCM_2p0 bytes.
+             * @param   key, INPUT: 16-byte secret key. Never NULL.
+             * @retval  Returns the total bytes written to outbuf, or 0 if no frame
+             *          was encoded.
+             */
+            static constexpr uint8_t encodeBulk_scratch_usage =
+                    OTV0P2BASE::scratchSum(
+                        SimpleSecureFrame32or0BodyBase::IVBytes,
+                        OTV0P2BASE::OpenTRV_Node_ID_Bytes);
+            static constexpr size_t encodeBulk_total_scratch_usage_OTAESGCM_2p0 =
+                    OTV0P2BASE::scratchSum(
+                        encodeRaw_total_scratch_usage_OTAESGCM_2p0,
+                        encodeBulk_scratch_usage);
+            size_t encodeBulk(
+                        bulkFrame_t *frames,
+                        uint8_t n,
+                        uint8_t il_,
+                        uint8_t *outbuf,
+                        size_t outbufSize,
+                        fixed32BTextSize12BNonce16BTagSimpleEnc_fn_t &e,
+                        OTV0P2BASE::ScratchSpaceL &scratch,
+                        const uint8_t *key);
         };
 
     // RX Base class for simple implementations that supports 0 or 32 byte encrypted body sections.
@@ -914,8 +1010,9 @@ namespace OTRadioLink
             static constexpr uint8_t decodeRaw_scratch_usage =
                 ENC_BODY_SMALL_FIXED_CTEXT_SIZE;
             static constexpr size_t decodeRaw_total_scratch_usage_OTAESGCM_3p0 =
-                0 /* Any additional callee space would be for d(). */ +
-                decodeRaw_scratch_usage;
+                OTV0P2BASE::scratchSum(
+                    0 /* Any additional callee space would be for d(). */,
+                    decodeRaw_scratch_usage);
             static uint8_t decodeRaw(
                                 OTDecodeData_T &fd,
                                 fixed32BTextSize12BNonce16BTagSimpleDec_fn_t &d,
@@ -1000,10 +1097,11 @@ namespace OTRadioLink
              *          of error, eg because authentication failed.
              */
             static constexpr uint8_t _decodeFromID_scratch_usage =
-                12; // Space for constructed IV.
+                SimpleSecureFrame32or0BodyBase::IVBytes; // Space for constructed IV.
             static constexpr size_t _decodeFromID_total_scratch_usage_OTAESGCM_3p0 =
-                decodeRaw_total_scratch_usage_OTAESGCM_3p0 +
-                _decodeFromID_scratch_usage;
+                OTV0P2BASE::scratchSum(
+                    decodeRaw_total_scratch_usage_OTAESGCM_3p0,
+                    _decodeFromID_scratch_usage);
             uint8_t _decodeFromID(
                         OTDecodeData_T &fd,
                         fixed32BTextSize12BNonce16BTagSimpleDec_fn_t &d,
@@ -1050,11 +1148,13 @@ namespace OTRadioLink
              *            provided.
              */
             static constexpr uint8_t decode_scratch_usage =
-                OTV0P2BASE::OpenTRV_Node_ID_Bytes +
-                SimpleSecureFrame32or0BodyBase::fullMsgCtrBytes;
+                OTV0P2BASE::scratchSum(
+                    OTV0P2BASE::OpenTRV_Node_ID_Bytes,
+                    SimpleSecureFrame32or0BodyBase::fullMsgCtrBytes);
             static constexpr size_t decode_total_scratch_usage_OTAESGCM_3p0 =
-                _decodeFromID_total_scratch_usage_OTAESGCM_3p0 +
-                decode_scratch_usage;
+                OTV0P2BASE::scratchSum(
+                    _decodeFromID_total_scratch_usage_OTAESGCM_3p0,
+                    decode_scratch_usage);
             uint8_t decode(
                         OTDecodeData_T &fd,
                         fixed32BTextSize12BNonce16BTagSimpleDec_fn_t &d,
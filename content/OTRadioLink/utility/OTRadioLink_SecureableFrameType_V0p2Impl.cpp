@@ -32,6 +32,7 @@ Author(s) / Copyright (s): Damon Hart-Davis 2015--2016
 
 #include "OTRadioLink_SecureableFrameType.h"
 #include "OTRadioLink_SecureableFrameType_V0p2Impl.h"
+#include "OTRadioLink_TXMsgCtrReservation.h"
 
 #include "OTV0P2BASE_EEPROM.h"
 
@@ -59,6 +60,40 @@ SimpleSecureFrame32or0BodyRXV0p2 &SimpleSecureFrame32or0BodyRXV0p2::getInstance(
     return(instance);
     }
 
+#ifdef OTRADIOLINK_TX_MSG_CTR_RESERVATION
+// If OTRADIOLINK_TX_MSG_CTR_RESERVATION is defined then TX message counters
+// are handed out from RAM against a high-water mark held in the EEPROM journal,
+// rather than bumping the persistent restart counter at every restart
+// and reading it back for every TX.
+// The restart counter is kept as a floor above every counter handed out
+// (as without reservation) so that losing the journal cannot cause reuse,
+// but is only incremented as the mark passes each 2^24 boundary.
+//
+// Counters reserved per write of the mark; at most this many are lost per restart.
+static constexpr uint32_t txMsgCtrReservationBlock = 1024;
+typedef TXMsgCtrReservation<OTV0P2BASE::EEPROMJournal, txMsgCtrReservationBlock> TXMsgCtrReservationV0p2;
+// Get the reservation, creating it on first use as the journal is mounted on first use.
+static TXMsgCtrReservationV0p2 &getTXMsgCtrReservation()
+    {
+    static TXMsgCtrReservationV0p2 r(OTV0P2BASE::getEEPROMJournal(), OTV0P2BASE::V0P2BASE_EE_JOURNAL_KEY_TX_RESTART_CTR);
+    return(r);
+    }
+// RAM copy of the persistent restart counter while reserving.
+static uint8_t txNVCtrPrefixCopy[SimpleSecureFrame32or0BodyTXBase::txNVCtrPrefixBytes];
+// Restart counter access for TXMsgCtrReservationV0p2::reserveWithRestartCtr(),
+// reading from the RAM copy, which is refreshed on each change.
+class TXRestartCtrV0p2 final
+    {
+    SimpleSecureFrame32or0BodyTXV0p2 &tx;
+    public:
+        TXRestartCtrV0p2(SimpleSecureFrame32or0BodyTXV0p2 &_tx) : tx(_tx) { }
+        bool get(uint8_t *const buf) const { memcpy(buf, txNVCtrPrefixCopy, sizeof(txNVCtrPrefixCopy)); return(true); }
+        bool reset()
+            { return(SimpleSecureFrame32or0BodyTXV0p2::resetRaw3BytePersistentTXRestartCounterInEEPROM(false) && tx.getTXNVCtrPrefix(txNVCtrPrefixCopy)); }
+        bool increment() { return(tx.incrementTXNVCtrPrefix() && tx.getTXNVCtrPrefix(txNVCtrPrefixCopy)); }
+    };
+#endif // OTRADIOLINK_TX_MSG_CTR_RESERVATION
+
 // Load the raw form of the persistent reboot/restart message counter from EEPROM into the supplied array.
 // Deals with inversion, but does not interpret the data or check CRCs etc.
 // Separates the EEPROM access from the data interpretation to simplify unit testing.
@@ -116,6 +151,10 @@ bool SimpleSecureFrame32or0BodyTXV0p2::resetRaw3BytePersistentTXRestartCounterIn
      *          devices to delete their keys.
      */
 //    if(!OTV0P2BASE::setPrimaryBuilding16ByteSecretKey(NULL)) { return(false); } ///@note commented as part of TODO-907 fix
+#ifdef OTRADIOLINK_TX_MSG_CTR_RESERVATION
+    // Forget the high-water mark, so that counting restarts from the new restart counter.
+    if(!getTXMsgCtrReservation().clear()) { return(false); }
+#endif
     // Reset the counter.
     if(allZeros)
         {
@@ -132,7 +171,7 @@ bool SimpleSecureFrame32or0BodyTXV0p2::resetRaw3BytePersistentTXRestartCounterIn
         // Buffer for noise bytes; msbits will be kept as zero.  Tack CRC on the end.
         // Then duplicate to second half for backup copy.
         uint8_t noise[OTV0P2BASE::VOP2BASE_EE_LEN_PERSISTENT_MSG_RESTART_CTR];
-        for(uint8_t i = 0; i < txNVCtrPrefixBytes; ) { noise[i++] = OTV0P2BASE::getSecureRandomByte(); }
+        OTV0P2BASE::getSecureRandomBytes(noise, txNVCtrPrefixBytes);
         noise[0] = 0xf & (noise[0] ^ (noise[0] >> 4)); // Keep top 4 bits clear to preserve > 90% of possible life.
         // Ensure that entire sequence is non-zero by forcing lsb to 1 (if enough of) noise seems to be 0.
         if(/*(0 == noise[txNVCtrPrefixBytes-1]) && */ (0 == noise[1]) && (0 == noise[0])) { noise[txNVCtrPrefixBytes-1] |= 1; }
@@ -245,8 +284,29 @@ bool SimpleSecureFrame32or0BodyTXV0p2::incrementTXNVCtrPrefix()
 // This should never return an all-zero count.
 // Not ISR-safe.
 bool SimpleSecureFrame32or0BodyTXV0p2::getNextTXMsgCtr(uint8_t *const buf)
+    { return(reserveTXMsgCtrs(buf, 1)); }
+
+// Reserves n consecutive message counters, filling buf with the first.
+// Advances the ephemeral part by n in one step,
+// so the persistent part is read once and incremented at most once for the block.
+// Not ISR-safe.
+bool SimpleSecureFrame32or0BodyTXV0p2::reserveTXMsgCtrs(uint8_t *const buf, const uint8_t n)
     {
-    if(NULL == buf) { return(false); }
+    if((NULL == buf) || (0 == n)) { return(false); }
+
+#ifdef OTRADIOLINK_TX_MSG_CTR_RESERVATION
+    TXMsgCtrReservationV0p2 &r = getTXMsgCtrReservation();
+    // On starting, refresh the restart counter copy, and make the start a little less predictable.
+    uint8_t offset = 0;
+    if(!r.isStarted())
+        {
+        if(!getTXNVCtrPrefix(txNVCtrPrefixCopy)) { return(false); }
+        OTV0P2BASE::getSecureRandomBytes(&offset, 1);
+        }
+    // Resumes from the mark, bumping the restart counter only as the mark passes each 2^24 boundary.
+    TXRestartCtrV0p2 rc(*this);
+    return(r.reserveWithRestartCtr(rc, buf, n, offset));
+#else
 
     // False when first called, ie on first call to this routine after board boot/restart.
     // Used to drive roll of persistent part
@@ -278,8 +338,7 @@ bool SimpleSecureFrame32or0BodyTXV0p2::getNextTXMsgCtr(uint8_t *const buf)
     uint8_t tmpE[sizeof(ephemeral)];
     if(doInitialisation)
         {
-        for(uint8_t i = sizeof(tmpE); i-- > 0; )
-            { tmpE[i] = OTV0P2BASE::getSecureRandomByte(); } // Doesn't like being called with interrupts off.
+        OTV0P2BASE::getSecureRandomBytes(tmpE, sizeof(tmpE)); // Doesn't like being called with interrupts off.
         // Mask off top bits of top (most significant byte) to preserve most of the remaining counter life
         // but allow ~20 bits ie a decent chunk of 1 million messages
         // (maybe several years at a message every 4 minutes)
@@ -298,18 +357,13 @@ bool SimpleSecureFrame32or0BodyTXV0p2::getNextTXMsgCtr(uint8_t *const buf)
             memcpy(ephemeral, tmpE, sizeof(ephemeral));
             }
 
-        // Increment the counter including the persistent part where necessary.
-        for(uint8_t i = sizeof(ephemeral); i-- > 0; )
-            {
-            if(0 != ++ephemeral[i]) { break; }
-            if(0 == i)
-                {
-                // Prepare to increment the persistent part below.
-                incrementPersistent = true;
-                }
-            }
+        // Advance the counter by n including the persistent part where necessary.
+        // The entropy-initialised ephemeral part has its top nibble clear
+        // so cannot also carry on the initialising call.
+        // Prepare to increment the persistent part below on carry.
+        if(advanceMsgCtrLSBs(ephemeral, sizeof(ephemeral), n)) { incrementPersistent = true; }
 
-        // Copy in the ephemeral part.
+        // Copy in the ephemeral part of the last counter reserved.
         memcpy(buf + 3, ephemeral, 3);
         }
 
@@ -324,7 +378,9 @@ bool SimpleSecureFrame32or0BodyTXV0p2::getNextTXMsgCtr(uint8_t *const buf)
     // Copy in the persistent part; fail entirely if it is not usable.
     if(!getTXNVCtrPrefix(buf)) { return(false); }
 
-    return(true);
+    // Step back from the last counter reserved to the first.
+    return(stepBackMsgCtr(buf, n - 1));
+#endif // OTRADIOLINK_TX_MSG_CTR_RESERVATION
     }
 
 // Read RX message count from specified EEPROM location; fails if CRC fails.
@@ -325,6 +325,10 @@ class SimpleSecureFrame32or0BodyTXV0p2Null : public SimpleSecureFrame32or0BodyTX
             // Highest-index bytes in the array increment fastest.
             // Not ISR-safe.
             virtual bool getNextTXMsgCtr(uint8_t *buf) override;
+            // Reserves n consecutive message counters in one step, filling buf with the first.
+            // The persistent part is read once and incremented at most once for the whole block.
+            // Not ISR-safe.
+            virtual bool reserveTXMsgCtrs(uint8_t *buf, uint8_t n) override;
         };
 
 
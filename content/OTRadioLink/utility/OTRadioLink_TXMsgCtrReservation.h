@@ -0,0 +1,202 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * TX message counter reservation against a persisted high-water mark.
+ *
+ * Portable and unit testable.
+ */
+
+#ifndef ARDUINO_LIB_OTRADIOLINK_TXMSGCTRRESERVATION_H
+#define ARDUINO_LIB_OTRADIOLINK_TXMSGCTRRESERVATION_H
+
+#include <stdint.h>
+#include <string.h>
+
+
+namespace OTRadioLink
+{
+
+
+// Hands out TX message counters from RAM, persisting only a high-water mark
+// blockSize counters ahead of the next counter to be handed out.
+//
+// The persisted mark is always above every counter handed out,
+// so after a reset (even mid-write) counting resumes from the mark,
+// losing at most one block of counters.
+// The store is written once per restart and once per blockSize counters,
+// and is not read at all on each TX.
+//
+// The mark is held in a journal (eg OTV0P2BASE::NVKVJournal) under one key
+// as 6 bytes, most significant first, as are all counters here.
+//
+//   * journal_t  has get(key, buf, len), put(key, buf, len) and remove(key) as NVKVJournal
+//   * blockSize  counters reserved per write of the mark; strictly positive and well under 2^24
+//
+// Not ISR-/thread- safe.
+template<class journal_t, uint32_t blockSize>
+class TXMsgCtrReservation final
+  {
+    static_assert((blockSize > 0) && (blockSize < 0x800000UL), "bad blockSize");
+
+  public:
+    // Bytes in a counter or mark.
+    static constexpr uint8_t ctrBytes = 6;
+
+  private:
+    journal_t &journal;
+    const uint8_t key;
+    // Next counter to hand out.
+    uint8_t next[ctrBytes];
+    // Persisted mark, above every counter handed out.
+    uint8_t mark[ctrBytes];
+    // True once begin() has succeeded.
+    bool started = false;
+    // Writes of the mark since construction.
+    uint16_t markWrites = 0;
+
+    // Persist m as the new mark; returns false if the write failed.
+    bool persistMark(const uint8_t *const m)
+      {
+      if(!journal.put(key, m, ctrBytes)) { return(false); }
+      memcpy(mark, m, ctrBytes);
+      ++markWrites;
+      return(true);
+      }
+
+  public:
+    TXMsgCtrReservation(journal_t &_journal, const uint8_t _key)
+      : journal(_journal), key(_key) { memset(next, 0, sizeof(next)); memset(mark, 0, sizeof(mark)); }
+
+    // Add delta to a counter in place; returns false on overflow past 0xffffffffffff.
+    static bool add(uint8_t *const ctr, uint32_t delta)
+      {
+      for(uint8_t i = ctrBytes; (0 != delta) && (i-- > 0); )
+        {
+        delta += ctr[i];
+        ctr[i] = uint8_t(delta);
+        delta >>= 8;
+        }
+      return(0 == delta);
+      }
+
+    // Start counting from the higher of the persisted mark and floor, plus offset.
+    // Persists a new mark a block ahead before returning true.
+    //   * floor  lowest counter that may be handed out (eg from another store); NULL if none
+    //   * offset  added to the start, eg a little entropy to make it less predictable
+    // Never starts at an all-zeros counter.
+    bool begin(const uint8_t *const floor = NULL, const uint8_t offset = 0)
+      {
+      started = false;
+      uint8_t start[ctrBytes] = { };
+      if(ctrBytes != journal.get(key, start, ctrBytes)) { memset(start, 0, ctrBytes); }
+      if((NULL != floor) && (memcmp(floor, start, ctrBytes) > 0)) { memcpy(start, floor, ctrBytes); }
+      if(!add(start, offset)) { return(false); }
+      bool allZeros = true;
+      for(uint8_t i = 0; i < ctrBytes; ++i) { if(0 != start[i]) { allZeros = false; break; } }
+      if(allZeros) { start[ctrBytes-1] = 1; }
+      uint8_t m[ctrBytes];
+      memcpy(m, start, ctrBytes);
+      if(!add(m, blockSize)) { return(false); }
+      if(!persistMark(m)) { return(false); }
+      memcpy(next, start, ctrBytes);
+      started = true;
+      return(true);
+      }
+
+    // Reserve n [1,255] consecutive counters, filling the 6-byte first with the first of them.
+    // Persists a new mark (once) only if the reservation would reach the current one.
+    // Returns false if not started, out of counters, or the mark could not be persisted.
+    bool reserve(uint8_t *const first, const uint8_t n)
+      {
+      if(!started || (NULL == first) || (0 == n)) { return(false); }
+      uint8_t end[ctrBytes];
+      memcpy(end, next, ctrBytes);
+      if(!add(end, n)) { return(false); }
+      if(memcmp(end, mark, ctrBytes) > 0)
+        {
+        uint8_t m[ctrBytes];
+        memcpy(m, end, ctrBytes);
+        if(!add(m, blockSize)) { return(false); }
+        if(!persistMark(m)) { return(false); }
+        }
+      memcpy(first, next, ctrBytes);
+      memcpy(next, end, ctrBytes);
+      return(true);
+      }
+
+    // Bytes in a persistent restart counter, the most significant part of a counter.
+    static constexpr uint8_t restartCtrBytes = 3;
+
+    // As reserve(), starting if need be, while keeping a persistent restart counter
+    // (as used without reservation) covering the mark,
+    // so that starting above the restart counter after losing the mark cannot reuse counters.
+    //   * restartCtr_t  has get(buf), reset() and increment() for the 3-byte restart counter,
+    //     each returning false on failure; reset() replaces an all-zeros value
+    //   * offset  added when starting, eg a little entropy
+    // On starting, resumes from the mark plus offset if there is one;
+    // only with no mark (or one below the restart counter, eg after older firmware has run)
+    // does it start above everything issued under the restart counter.
+    // The restart counter is incremented only as the mark passes a 2^24 boundary,
+    // not at every restart.
+    template<class restartCtr_t>
+    bool reserveWithRestartCtr(restartCtr_t &rc, uint8_t *const first, const uint8_t n, const uint8_t offset = 0)
+      {
+      uint8_t lim[ctrBytes];
+      if(!started)
+        {
+        memset(lim, 0, ctrBytes);
+        if(!rc.get(lim)) { return(false); }
+        if((0 == lim[0]) && (0 == lim[1]) && (0 == lim[2]))
+          { if(!rc.reset() || !rc.get(lim)) { return(false); } }
+        uint8_t m[ctrBytes];
+        const bool useFloor = (ctrBytes != journal.get(key, m, ctrBytes)) ||
+                              (memcmp(m, lim, restartCtrBytes) < 0);
+        if(!add(lim, 0x1000000UL)) { return(false); }
+        if(!begin(useFloor ? lim : NULL, offset)) { return(false); }
+        }
+      if(!reserve(first, n)) { return(false); }
+      // Bring the restart counter up to cover the mark before handing out counters.
+      for( ; ; )
+        {
+        memset(lim, 0, ctrBytes);
+        if(!rc.get(lim)) { return(false); }
+        if(!add(lim, 0x1000000UL)) { return(false); }
+        if(memcmp(mark, lim, ctrBytes) <= 0) { return(true); }
+        if(!rc.increment()) { return(false); }
+        }
+      }
+
+    // Stop handing out counters until begin() is called again, eg after a change of floor.
+    void restart() { started = false; }
+    // Forget the persisted mark, eg when the key is changed; returns false on failure.
+    // USE WITH EXTREME CAUTION: counters may then be reused with an unchanged key.
+    bool clear() { started = false; return(journal.remove(key)); }
+
+    // True once begin() has succeeded.
+    bool isStarted() const { return(started); }
+    // Copy the persisted mark to the 6-byte buf; meaningful once started.
+    void getMark(uint8_t *const buf) const { memcpy(buf, mark, ctrBytes); }
+    // Writes of the mark since construction.
+    uint16_t getMarkWrites() const { return(markWrites); }
+  };
+
+
+}
+
+#endif // ARDUINO_LIB_OTRADIOLINK_TXMSGCTRRESERVATION_H
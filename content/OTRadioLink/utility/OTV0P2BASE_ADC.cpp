@@ -19,7 +19,7 @@ Author(s) / Copyright (s): Damon Hart-Davis 2013--2018
 /*
  ADC (Analogue-to-Digital Converter) support.
 
- V0p2/AVR only for now.
+ Batch sequencing (ADCBatch) is portable; drivers are V0p2/AVR only for now.
  */
 
 
@@ -52,14 +52,63 @@ namespace OTV0P2BASE
 {
 
 
+constexpr uint16_t ADCBatchBase::INVALID_RESULT;
+constexpr uint8_t ADCBatchBase::MAX_EXTRA_BITS;
+
 #ifdef ARDUINO_ARCH_AVR
-// Allow wake from (lower-power) sleep while ADC is running.
-ISR(ADC_vect) { ADC_complete = true; }
+// Batch being run by runADCBatch(), else NULL.
+static ADCBatchBase *volatile _activeADCBatch;
 
 // Nominally accumulate mainly the bottom bits from normal ADC conversions for entropy,
 // especially from earlier unsettled conversions when taking multiple samples.
 static volatile uint8_t _adcNoise;
 
+// Allow wake from (lower-power) sleep while ADC is running.
+// When running a batch, also hand on the result and start the next conversion at once.
+ISR(ADC_vect)
+  {
+  ADC_complete = true;
+  ADCBatchBase *const b = _activeADCBatch;
+  if(NULL == b) { return; }
+  const uint8_t l = ADCL; // Capture the low byte and latch the high byte.
+  const uint8_t h = ADCH; // Capture the high byte.
+  _adcNoise = uint8_t((_adcNoise << 1) ^ l); // Capture a little entropy.
+  uint8_t admux;
+  if(b->onSample(uint16_t((h << 8) | l), admux))
+    {
+    ADMUX = admux;
+    ADCSRA |= _BV(ADSC); // Start next conversion.
+    }
+  }
+
+// Run all the conversions of the batch back to back from the ADC ISR.
+bool runADCBatch(ADCBatchBase &batch)
+  {
+  if(0 == batch.size()) { return(true); }
+  const bool neededEnable = powerUpADCIfDisabled();
+  ACSR |= _BV(ACD); // Disable the analogue comparator.
+  ADMUX = batch.begin();
+  set_sleep_mode(SLEEP_MODE_ADC);
+  ADCSRB = 0;
+  bitClear(ADCSRA, ADATE); // Single conversions, each started from the ISR.
+  _activeADCBatch = &batch;
+  bitSet(ADCSRA, ADIE); // Turn on ADC interrupt.
+  bitSet(ADCSRA, ADSC); // Start first conversion.
+  bool complete;
+  // An ADC conversion should never take more than 1 tick (~8ms).
+  while(!(complete = batch.isComplete()) && (getSubCycleTime() <= 254)) { sleep_mode(); }
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+    bitClear(ADCSRA, ADIE); // Turn off ADC interrupt.
+    _activeADCBatch = NULL;
+    }
+  // Let any conversion in progress finish before powering down.
+  while(bit_is_set(ADCSRA, ADSC)) { }
+  if(neededEnable) { powerDownADC(); }
+  batch.finish();
+  return(complete);
+  }
+
 // Read ADC/analogue input with reduced noise if possible, in range [0,1023].
 //   * admux  is the value to set ADMUX to
 //   * samples  maximum number of samples to take (if one, nap() before); strictly positive
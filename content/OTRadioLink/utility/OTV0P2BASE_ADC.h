@@ -26,14 +26,169 @@ Author(s) / Copyright (s): Damon Hart-Davis 2013--2018
 #define OTV0P2BASE_ADC_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 
 namespace OTV0P2BASE
 {
 
+// Batch of ADC conversions over several channels,
+// run back to back (eg from the ADC ISR) in a single low-noise sleep window,
+// with per-channel oversampling and decimation to extra bits of resolution.
+// The sequencing logic is portable; the driver (eg runADCBatch()) is hardware specific.
+// Use ADCBatch<N> to allocate space for N channels.
+class ADCBatchBase
+  {
+  public:
+    // Result of a channel not (fully) converted, eg on timeout.
+    static constexpr uint16_t INVALID_RESULT = 0xffff;
+    // Maximum extra bits by oversampling and decimation; 4^n samples are taken for n extra bits.
+    static constexpr uint8_t MAX_EXTRA_BITS = 3;
+
+    // Called with the context pointer and result once a batch is finished, in normal (non-ISR) context.
+    typedef void (*callback_t)(void *ctx, uint16_t result);
+
+  protected:
+    struct channel_t
+      {
+      // Value for the ADC multiplexer (ADMUX on AVR), selecting input and reference.
+      uint8_t admux;
+      // Extra bits of resolution [0,MAX_EXTRA_BITS].
+      uint8_t extraBits;
+      // Conversions to discard after switching to this channel, to let it settle.
+      uint8_t discard;
+      // Result, INVALID_RESULT until complete.
+      uint16_t result;
+      callback_t callback;
+      void *ctx;
+      };
+
+    constexpr ADCBatchBase(channel_t *const c, const uint8_t cap) : channels(c), capacity(cap) { }
+
+  private:
+    channel_t *const channels;
+    const uint8_t capacity;
+    uint8_t nChannels = 0;
+
+    // State of a run, updated from the ISR.
+    // Current channel; nChannels when complete.
+    volatile uint8_t current = 0;
+    // Conversions still to be discarded for the current channel.
+    uint8_t toDiscard = 0;
+    // Samples still to take for the current channel.
+    uint8_t toSample = 0;
+    // Sum of samples so far for the current channel; at most 64 * 1023.
+    uint16_t sum = 0;
+
+    // Set up to sample channel current.
+    void startChannel()
+      {
+      const channel_t &c = channels[current];
+      toDiscard = c.discard;
+      toSample = uint8_t(1U << (2 * c.extraBits));
+      sum = 0;
+      }
+
+  public:
+    // Queue a conversion; returns the channel index for getResult(), or -1 if full.
+    //   * admux  value for the multiplexer, eg (DEFAULT << 6) | aiNumber
+    //   * extraBits  extra bits of resolution wanted [0,MAX_EXTRA_BITS]; result is in [0,(1024<<extraBits)-1]
+    //   * discard  conversions to discard after switching to this channel; at least 1 is recommended
+    //   * callback  optional, called with ctx and the result when the batch is finished
+    int8_t add(uint8_t admux, uint8_t extraBits = 0, uint8_t discard = 1,
+               callback_t callback = NULL, void *ctx = NULL)
+      {
+      if((nChannels >= capacity) || (extraBits > MAX_EXTRA_BITS)) { return(-1); }
+      channel_t &c = channels[nChannels];
+      c.admux = admux;
+      c.extraBits = extraBits;
+      c.discard = discard;
+      c.result = INVALID_RESULT;
+      c.callback = callback;
+      c.ctx = ctx;
+      return(int8_t(nChannels++));
+      }
+
+    // Remove all channels.
+    void clear() { nChannels = 0; current = 0; }
+
+    // Number of channels queued.
+    uint8_t size() const { return(nChannels); }
+
+    // Result for a channel from the last run, or INVALID_RESULT.
+    uint16_t getResult(const uint8_t i) const { return((i < nChannels) ? channels[i].result : INVALID_RESULT); }
+
+    // Prepare to run; returns the multiplexer value for the first conversion.
+    // Not valid if the batch is empty.
+    uint8_t begin()
+      {
+      for(uint8_t i = 0; i < nChannels; ++i) { channels[i].result = INVALID_RESULT; }
+      current = 0;
+      if(0 != nChannels) { startChannel(); }
+      return(channels[0].admux);
+      }
+
+    // True once all conversions are complete (or the batch is empty).
+    bool isComplete() const { return(current >= nChannels); }
+
+    // Process one conversion result; may be called from the ADC ISR.
+    // Returns true if another conversion is needed, with admux set to the multiplexer value for it.
+    bool onSample(const uint16_t raw, uint8_t &admux)
+      {
+      uint8_t c = current;
+      if(c >= nChannels) { return(false); }
+      if(0 != toDiscard) { --toDiscard; }
+      else
+        {
+        sum += raw;
+        if(0 == --toSample)
+          {
+          // Decimate: sum of 4^n samples, shifted right n, gives n extra bits.
+          channels[c].result = sum >> channels[c].extraBits;
+          current = ++c;
+          if(c >= nChannels) { return(false); }
+          startChannel();
+          }
+        }
+      admux = channels[c].admux;
+      return(true);
+      }
+
+    // Finish a run (after completion or timeout) in normal context:
+    // stops processing and calls the callbacks of all channels in order.
+    void finish()
+      {
+      current = nChannels;
+      for(uint8_t i = 0; i < nChannels; ++i)
+        {
+        const channel_t &c = channels[i];
+        if(NULL != c.callback) { c.callback(c.ctx, c.result); }
+        }
+      }
+  };
+
+// ADC batch with space for up to maxChannels channels.
+template<uint8_t maxChannels>
+class ADCBatch final : public ADCBatchBase
+  {
+  private:
+    channel_t space[maxChannels];
+  public:
+    ADCBatch() : ADCBatchBase(space, maxChannels) { }
+  };
+
 #ifdef ARDUINO_ARCH_AVR
 static volatile bool ADC_complete;
 
+// Run all the conversions of the batch back to back from the ADC ISR
+// while the CPU sleeps in ADC noise-reduction mode, then call any callbacks.
+// Returns true if all conversions completed,
+// false if stopped early as too close to the end of the minor cycle
+// (when the incomplete channels have INVALID_RESULT).
+// Sets sleep mode to SLEEP_MODE_ADC, and disables sleep on exit.
+// Not to be used concurrently with other ADC reads.
+bool runADCBatch(ADCBatchBase &batch);
+
 // Read ADC/analogue input with reduced noise if possible, in range [0,1023].
 //   * admux  is the value to set ADMUX to
 //   * samples  maximum number of samples to take (if one, nap() before); strictly positive
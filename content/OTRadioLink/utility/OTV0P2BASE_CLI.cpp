@@ -25,7 +25,10 @@ Author(s) / Copyright (s): Deniz Erbilgin 2016
 
 // NOTE: some CLI routines may live alongside the devices they support, not here.
 
+#include <ctype.h>
+
 #include "OTV0P2BASE_CLI.h"
+#include "OTV0P2BASE_CycleBudget.h"
 
 #include "OTV0P2BASE_EEPROM.h"
 #include "OTV0P2BASE_Entropy.h"
@@ -44,7 +47,7 @@ namespace CLI {
 
 // Prints warning to serial (that must be up and running) that invalid (CLI) input has been ignored.
 // Probably should not be inlined, to avoid creating duplicate strings in Flash.
-void InvalidIgnored() { Serial.println(F("Invalid, ignored.")); }
+void InvalidIgnored() { noteInvalidIgnored(); Serial.println(F("Invalid, ignored.")); }
 
 
 // Remaining minutes to keep CLI active; zero implies inactive.
@@ -90,7 +93,10 @@ uint8_t promptAndReadCommandLine(const uint8_t maxSCT, const ScratchSpace &s, vo
 
     // Compute safe limit time given granularity of sleep and buffer fill.
     const uint8_t targetMaxSCT = (maxSCT <= MIN_CLI_POLL_SCT) ? ((uint8_t) 0) : ((uint8_t) (maxSCT - 1 - MIN_CLI_POLL_SCT));
-    if(OTV0P2BASE::getSubCycleTime() >= targetMaxSCT) { return(0); } // Too short to try.
+    OTV0P2BASE::CycleBudget *const cb = OTV0P2BASE::getCycleBudget();
+    const uint8_t sctStart = OTV0P2BASE::getSubCycleTime();
+    if(NULL != cb) { cb->mayStart(OTV0P2BASE::CBC_CLI, sctStart, targetMaxSCT); }
+    if(sctStart >= targetMaxSCT) { return(0); } // Too short to try.
 
     // Purge any stray pending input, such as a trailing LF from previous input.
     while(Serial.available() > 0) { Serial.read(); }
@@ -199,9 +205,58 @@ uint8_t promptAndReadCommandLine(const uint8_t maxSCT, const ScratchSpace &s, vo
 
     // Force any pending output before return / possible UART power-down.
     OTV0P2BASE::flushSerialSCTSensitive();
+    if(NULL != cb) { cb->finished(OTV0P2BASE::CBC_CLI, OTV0P2BASE::getSubCycleTime(), maxSCT); }
     return(n);
     }
 
+// Non-blocking alternative to promptAndReadCommandLine() for use with a CLILineReader.
+// Prints a prompt when a new line is started, then reads until a line is complete
+// or maxSCT is reached, keeping any partial input for the next call.
+uint8_t pollCommandLine(CLILineReader &r, const uint8_t maxSCT, void (*idlefn)())
+    {
+    if(r.isReady()) { r.clear(); }
+    OTV0P2BASE::CycleBudget *const cb = OTV0P2BASE::getCycleBudget();
+    const uint8_t sctStart = OTV0P2BASE::getSubCycleTime();
+    if(NULL != cb) { cb->mayStart(OTV0P2BASE::CBC_CLI, sctStart, maxSCT); }
+    if(sctStart >= maxSCT) { return(0); } // No time left.
+    if(!r.hasPartial())
+        {
+        // Prompt for a new line, with nothing part-read to lose.
+        Serial.println();
+        Serial.print(CLIPromptChar);
+        OTV0P2BASE::flushSerialSCTSensitive();
+        }
+    uint8_t n = 0;
+    while(0 == (n = r.poll(Serial)))
+        {
+        if(OTV0P2BASE::getSubCycleTime() >= maxSCT) { break; }
+        if(NULL != idlefn) { (idlefn)(); }
+        }
+    if(0 != n)
+        {
+        Serial.println();
+        // Capture a little potential timing and content entropy, though don't claim any.
+        OTV0P2BASE::addEntropyToPool(r.getLine()[0] ^ OTV0P2BASE::getSubCycleTime(), 0);
+        }
+    OTV0P2BASE::flushSerialSCTSensitive();
+    if(NULL != cb) { cb->finished(OTV0P2BASE::CBC_CLI, OTV0P2BASE::getSubCycleTime(), maxSCT); }
+    return(n);
+    }
+
+// Run batch commands from Serial until maxSCT.
+uint8_t pollBatch(CLIBatch &b, CLILineReader &r, const uint8_t maxSCT)
+    {
+    uint8_t run = 0;
+    // Run one command at a time so as to check the time before each.
+    while(b.isActive() && (OTV0P2BASE::getSubCycleTime() < maxSCT))
+        {
+        if(0 == b.poll(r, Serial, 1)) { break; }
+        ++run;
+        }
+    OTV0P2BASE::flushSerialSCTSensitive();
+    return(run);
+    }
+
 // Set / clear node association(s) (nodes to accept frames from) (eg "A hh hh hh hh hh hh hh hh").
 //        To add a new node/association: "A hh hh hh hh hh hh hh hh"
 //        - Reads first two bytes of each token in hex and ignores the rest.
@@ -455,6 +510,65 @@ bool NodeIDWithSet::doCommand(char *const buf, const uint8_t buflen)
     return(NodeID::doCommand(buf, buflen));
     }
 
+
+// Set local time (eg "T HH MM").
+bool SetTime::doCommand(char *const buf, const uint8_t buflen)
+    {
+    char *last; // Used by strtok_r().
+    char *tok1;
+    // Minimum 5 character sequence makes sense and is safe to tokenise, eg "T 1 2".
+    if((buflen >= 5) && (NULL != (tok1 = strtok_r(buf+2, " ", &last))))
+      {
+      char *tok2 = strtok_r(NULL, " ", &last);
+      if(NULL != tok2)
+        {
+        const int hh = atoi(tok1);
+        const int mm = atoi(tok2);
+        // TODO: zap collected stats if time change too large (eg >> 1h).
+        if(!OTV0P2BASE::setHoursMinutesLT(hh, mm)) { OTV0P2BASE::CLI::InvalidIgnored(); }
+        }
+      }
+    return(true);
+    }
+
+// Set TX privacy level ("X NN").
+// Lower means less privacy: 0 means send everything, 255 means send as little as possible.
+bool SetTXPrivacy::doCommand(char *const buf, const uint8_t buflen)
+    {
+    char *last; // Used by strtok_r().
+    char *tok1;
+    // Minimum 3 character sequence makes sense and is safe to tokenise, eg "X 0".
+    if((buflen >= 3) && (NULL != (tok1 = strtok_r(buf+2, " ", &last))))
+      {
+      const uint8_t nn = (uint8_t) atoi(tok1);
+      OTV0P2BASE::eeprom_smart_update_byte((uint8_t *)V0P2BASE_EE_START_STATS_TX_ENABLE, nn);
+      }
+    return(true);
+    }
+
+// Zap/erase learned statistics ('Z').
+// Avoid showing status afterwards as may already be rather a lot of output.
+bool ZapStats::doCommand(char *const, const uint8_t)
+    {
+    // Try to avoid causing an overrun if near the end of the minor cycle (even allowing for the warning message if unfinished!).
+    if(OTV0P2BASE::EEPROMByHourByteStats::_zapStats((uint16_t) OTV0P2BASE::fnmax(1, ((int)OTV0P2BASE::msRemainingThisBasicCycle()/2) - 20)))
+      { Serial.println(F("Zapped.")); }
+    else
+      { Serial.println(F("Not finished.")); }
+    return(false); // May be slow; avoid showing stats line which will in any case be unchanged.
+    }
+
+#endif // ARDUINO_ARCH_AVR
+
+
+// Count of rejected CLI input, wrapping.
+static uint8_t invalidIgnoredCount;
+void noteInvalidIgnored() { ++invalidIgnoredCount; }
+uint8_t getInvalidIgnoredCount() { return(invalidIgnoredCount); }
+
+// As InvalidIgnored() but printing to out.
+static void invalidIgnored(Print &out) { noteInvalidIgnored(); out.println(F("Invalid, ignored.")); }
+
 // Set secret key ("K ...").
 // "K B XX .. XX"  sets the primary building key, "K B *" erases it.
 // Clearing a key conditionally resets the primary TX message counter to avoid IV reuse
@@ -478,17 +592,17 @@ bool SetSecretKey::doCommand(char *const buf, const uint8_t buflen)
                 {
                 if (*tok2 == '*')
                     {
-                    OTV0P2BASE::setPrimaryBuilding16ByteSecretKey (NULL);
-                    Serial.println(F("B clear"));
+                    if(!setKeyFn(NULL)) { noteInvalidIgnored(); out.println(F("!B")); return(false); } // ERROR: key not cleared
+                    out.println(F("B clear"));
 #if 0 && defined(DEBUG)
                     uint8_t keyTest[16];
                     OTV0P2BASE::getPrimaryBuilding16ByteSecretKey(keyTest);
                     for(uint8_t i = 0; i < sizeof(keyTest); i++)
                         {
-                        Serial.print(keyTest[i], HEX);
-                        Serial.print(" ");
+                        out.print(keyTest[i], HEX);
+                        out.print(" ");
                         }
-                    Serial.println();
+                    out.println();
 #endif
                     // Notify key cleared.
                     if(NULL != keysClearedFn) { keysClearedFn(); }
@@ -506,81 +620,125 @@ bool SetSecretKey::doCommand(char *const buf, const uint8_t buflen)
                         {
                         char *thisTok = strtok_r(NULL, " ", &last);
                         const int ib = OTV0P2BASE::parseHexByte(thisTok);
-                        if(-1 == ib) { InvalidIgnored(); return(false); } // ERROR: abrupt exit.
+                        if(-1 == ib) { invalidIgnored(out); return(false); } // ERROR: abrupt exit.
                         newKey[i] = (uint8_t)ib;
                         }
-                    if(OTV0P2BASE::setPrimaryBuilding16ByteSecretKey(newKey))
-                        { Serial.println(F("B set")); }
+                    if(setKeyFn(newKey))
+                        { out.println(F("B set")); }
                     else
-                        { Serial.println(F("!B")); } // ERROR: key not set
+                        { noteInvalidIgnored(); out.println(F("!B")); } // ERROR: key not set
 
 #if 0 && defined(DEBUG)
                     uint8_t keyTest[16];
                     OTV0P2BASE::getPrimaryBuilding16ByteSecretKey(keyTest);
                     for(uint8_t i = 0; i < sizeof(keyTest); i++)
                         {
-                        Serial.print(keyTest[i], HEX);
-                        Serial.print(" ");
+                        out.print(keyTest[i], HEX);
+                        out.print(" ");
                         }
-                    Serial.println();
+                    out.println();
 #endif
                     return(false);
                     }
                 }
             }
         }
-    InvalidIgnored();
+    invalidIgnored(out);
     return(false);
     }
 
-// Set local time (eg "T HH MM").
-bool SetTime::doCommand(char *const buf, const uint8_t buflen)
+// Feed one received character.
+bool CLILineReader::feed(const int ic)
     {
-    char *last; // Used by strtok_r().
-    char *tok1;
-    // Minimum 5 character sequence makes sense and is safe to tokenise, eg "T 1 2".
-    if((buflen >= 5) && (NULL != (tok1 = strtok_r(buf+2, " ", &last))))
-      {
-      char *tok2 = strtok_r(NULL, " ", &last);
-      if(NULL != tok2)
+    if(ready) { clear(); }
+    if(ic < 0) { return(false); }
+    if(('\r' == ic) || ('\n' == ic))
         {
-        const int hh = atoi(tok1);
-        const int mm = atoi(tok2);
-        // TODO: zap collected stats if time change too large (eg >> 1h).
-        if(!OTV0P2BASE::setHoursMinutesLT(hh, mm)) { OTV0P2BASE::CLI::InvalidIgnored(); }
+        // End of line: drop an over-long line, and ignore empty lines (eg LF of CRLF).
+        if(overflow) { clear(); return(false); }
+        if(0 == n) { return(false); }
+        buf[n] = '\0';
+        ready = true;
+        return(true);
         }
-      }
-    return(true);
+    if(overflow) { return(false); }
+    if((ic < 32) || (ic > 126)) { return(false); } // Drop bogus non-printable characters.
+    char c = char(ic);
+    // Ignore any leading char that is not a letter (or '?' or '+'),
+    // and force leading (command) char to upper case.
+    if(0 == n)
+        {
+        c = char(toupper(c));
+        if(('+' != c) && ('?' != c) && ((c < 'A') || (c > 'Z'))) { return(false); }
+        }
+    if(n >= bufsize - 1) { overflow = true; n = 0; return(false); }
+    buf[n++] = c;
+    return(false);
     }
 
-// Set TX privacy level ("X NN").
-// Lower means less privacy: 0 means send everything, 255 means send as little as possible.
-bool SetTXPrivacy::doCommand(char *const buf, const uint8_t buflen)
+// Feed all characters available from s until a line is complete.
+uint8_t CLILineReader::poll(Stream &s)
     {
-    char *last; // Used by strtok_r().
-    char *tok1;
-    // Minimum 3 character sequence makes sense and is safe to tokenise, eg "X 0".
-    if((buflen >= 3) && (NULL != (tok1 = strtok_r(buf+2, " ", &last))))
-      {
-      const uint8_t nn = (uint8_t) atoi(tok1);
-      OTV0P2BASE::eeprom_smart_update_byte((uint8_t *)V0P2BASE_EE_START_STATS_TX_ENABLE, nn);
-      }
-    return(true);
+    while(s.available() > 0)
+        { if(feed(s.read())) { return(n); } }
+    return(0);
     }
 
-// Zap/erase learned statistics ('Z').
-// Avoid showing status afterwards as may already be rather a lot of output.
-bool ZapStats::doCommand(char *const, const uint8_t)
+// Start a batch.
+void CLIBatch::begin()
     {
-    // Try to avoid causing an overrun if near the end of the minor cycle (even allowing for the warning message if unfinished!).
-    if(OTV0P2BASE::EEPROMByHourByteStats::_zapStats((uint16_t) OTV0P2BASE::fnmax(1, ((int)OTV0P2BASE::msRemainingThisBasicCycle()/2) - 20)))
-      { Serial.println(F("Zapped.")); }
-    else
-      { Serial.println(F("Not finished.")); }
-    return(false); // May be slow; avoid showing stats line which will in any case be unchanged.
+    seq = 0;
+    errors = 0;
+    active = true;
+    out.println(F("+B"));
     }
 
-#endif // ARDUINO_ARCH_AVR
+// End a batch.
+void CLIBatch::end()
+    {
+    if(!active) { return; }
+    active = false;
+    out.print(F("+B "));
+    out.print(seq);
+    out.print(' ');
+    out.println(errors);
+    }
+
+// Run one complete command line and ACK it.
+bool CLIBatch::runLine(char *const line, const uint8_t len)
+    {
+    if((0 == len) || (NULL == line)) { return(true); }
+    if((1 == len) && ('+' == line[0])) { end(); return(false); }
+    const uint8_t before = getInvalidIgnoredCount();
+    bool ok = false;
+    for(uint8_t i = 0; i < tableLen; ++i)
+        {
+        if(table[i].cmd != line[0]) { continue; }
+        table[i].handler->doCommand(line, len);
+        ok = (before == getInvalidIgnoredCount());
+        break;
+        }
+    if(!ok && (0xff != errors)) { ++errors; }
+    out.print(ok ? '+' : '!');
+    out.println(seq);
+    if(0xff != seq) { ++seq; }
+    return(true);
+    }
+
+// Read and run up to maxCommands complete lines available from in.
+uint8_t CLIBatch::poll(CLILineReader &r, Stream &in, const uint8_t maxCommands)
+    {
+    uint8_t run = 0;
+    while(active && (run < maxCommands))
+        {
+        const uint8_t len = r.poll(in);
+        if(0 == len) { break; }
+        runLine(r.getLine(), len);
+        r.clear();
+        ++run;
+        }
+    return(run);
+    }
 
 
 } }
@@ -36,6 +36,7 @@ Author(s) / Copyright (s): Deniz Erbilgin 2016
 #endif
 
 //#include "OTV0P2BASE_Sleep.h"
+#include "OTV0P2BASE_Security.h"
 #include "OTV0P2BASE_Util.h"
 
 
@@ -82,7 +83,117 @@ namespace CLI {
 
     // Prints warning to serial (that must be up and running) that invalid (CLI) input has been ignored.
     // Probably should not be inlined, to avoid creating duplicate strings in Flash.
+    // Also notes the rejection as noteInvalidIgnored() does.
     void InvalidIgnored();
+    // Note that invalid CLI input has been rejected, without printing anything.
+    // Used to detect failed commands, eg in batch mode.
+    void noteInvalidIgnored();
+    // Count of rejections noted so far, wrapping.
+    uint8_t getInvalidIgnoredCount();
+
+    // Incremental CLI line reader that keeps partial input across calls,
+    // eg so that a line arriving across the end of a major cycle is not lost.
+    // Applies the same filtering as promptAndReadCommandLine():
+    // drops non-printable characters, skips leading characters other than a letter or '?' or '+',
+    // and forces the leading (command) character to upper case.
+    // A line too long for the buffer is discarded whole rather than truncated.
+    // Not thread-/ISR- safe.
+    class CLILineReader final
+        {
+        private:
+            char *const buf;
+            const uint8_t bufsize;
+            // Characters held so far.
+            uint8_t n;
+            // True when a complete line is held.
+            bool ready;
+            // True while discarding the rest of an over-long line.
+            bool overflow;
+        public:
+            // Buffer must be at least 2 bytes.
+            CLILineReader(char *const _buf, const uint8_t _bufsize)
+              : buf(_buf), bufsize(_bufsize), n(0), ready(false), overflow(false) { }
+            // Discard any partial or complete line held.
+            void clear() { n = 0; ready = false; overflow = false; }
+            // Feed one received character (as from Stream::read(), so -1 is ignored).
+            // Returns true when a complete non-empty line is held, '\0'-terminated.
+            // Feeding after a complete line starts a new one.
+            bool feed(int ic);
+            // Feed all characters available from s until a line is complete.
+            // Returns the length of the complete line, else 0.
+            uint8_t poll(Stream &s);
+            // True if part of a line has been received.
+            bool hasPartial() const { return(!ready && ((0 != n) || overflow)); }
+            // True if a complete line is held.
+            bool isReady() const { return(ready); }
+            // The line held, '\0'-terminated if complete.
+            char *getLine() const { return(buf); }
+            // Length of the line held.
+            uint8_t getLength() const { return(n); }
+        };
+
+    // Batch command runner, eg for factory provisioning of node associations and keys.
+    // Runs as many complete command lines as are available each call,
+    // dispatching on the first character to entries in a table,
+    // and prints a compact ACK for each command: "+<seq>" on success,
+    // or "!<seq>" if the command is unknown or was rejected
+    // (ie InvalidIgnored() or noteInvalidIgnored() was called), with seq counting from 0.
+    // Each entry's own output is printed before its ACK.
+    // A line of "+" alone ends the batch, printing "+B <commands> <errors>".
+    // Not thread-/ISR- safe.
+    class CLIBatch final
+        {
+        public:
+            // Command character (upper case) and its handler.
+            struct entry_t { char cmd; CLIEntryBase *handler; };
+        private:
+            const entry_t *const table;
+            const uint8_t tableLen;
+            Print &out;
+            // Commands run and failed in this batch.
+            uint8_t seq;
+            uint8_t errors;
+            bool active;
+        public:
+            CLIBatch(const entry_t *const _table, const uint8_t _tableLen, Print &_out)
+              : table(_table), tableLen(_tableLen), out(_out), seq(0), errors(0), active(false) { }
+            // Start a batch, printing "+B".
+            void begin();
+            // End a batch, printing "+B <commands> <errors>"; does nothing if not active.
+            void end();
+            // True while a batch is in progress.
+            bool isActive() const { return(active); }
+            // Run one complete command line and ACK it; the buffer may be altered.
+            // Returns false if the line ended the batch.
+            bool runLine(char *line, uint8_t len);
+            // Read and run up to maxCommands complete lines available from in.
+            // Partial input is kept for the next call.
+            // Returns the number of lines run.
+            uint8_t poll(CLILineReader &r, Stream &in, uint8_t maxCommands = 255);
+            // Commands run and failed so far in this batch.
+            uint8_t getCommands() const { return(seq); }
+            uint8_t getErrors() const { return(errors); }
+        };
+
+    // Enter batch mode (eg "B").
+    class EnterBatch final : public CLIEntryBase
+        {
+        CLIBatch &batch;
+        public:
+            EnterBatch(CLIBatch &b) : batch(b) { }
+            virtual bool doCommand(char *, uint8_t) override { batch.begin(); return(false); }
+        };
+
+#ifdef ARDUINO_ARCH_AVR
+    // Non-blocking alternative to promptAndReadCommandLine() for use with a CLILineReader.
+    // Prints a prompt when a new line is started, then reads from Serial until a line is complete
+    // or maxSCT is reached, keeping any partial input for the next call.
+    // Returns the length of a complete line, else 0; clear the reader once the line is handled.
+    // Serial must already be running.
+    uint8_t pollCommandLine(CLILineReader &r, uint8_t maxSCT, void (*idlefn)() = NULL);
+    // Run batch commands from Serial until maxSCT; returns the number run.
+    uint8_t pollBatch(CLIBatch &b, CLILineReader &r, uint8_t maxSCT);
+#endif // ARDUINO_ARCH_AVR
 
     // Reset CLI active timer to max (ie makes CLI active for a while).
     // Thread-safe.
@@ -161,11 +272,21 @@ namespace CLI {
      *          library level.
      *          FIXME - DHD should look over this and ammend/clarify as necessary.
      */
+    // A key that cannot be stored or cleared is reported as invalid (eg NAKed in a batch).
     class SetSecretKey final : public CLIEntryBase
         {
         bool (*const keysClearedFn)();
+        // Sets (or with NULL clears) the primary building key; returns false on failure.
+        bool (*const setKeyFn)(const uint8_t *key);
+        Print &out;
         public:
-            SetSecretKey(bool (*keysCleared)()) : keysClearedFn(keysCleared) { }
+#ifdef ARDUINO_ARCH_AVR
+            SetSecretKey(bool (*keysCleared)())
+              : keysClearedFn(keysCleared), setKeyFn(OTV0P2BASE::setPrimaryBuilding16ByteSecretKey), out(Serial) { }
+#endif // ARDUINO_ARCH_AVR
+            // Uses the supplied key store and output, eg for testing.
+            SetSecretKey(bool (*keysCleared)(), bool (*setKey)(const uint8_t *key), Print &_out)
+              : keysClearedFn(keysCleared), setKeyFn(setKey), out(_out) { }
             virtual bool doCommand(char *buf, uint8_t buflen);
         };
 
@@ -18,6 +18,17 @@ Author(s) / Copyright (s): Damon Hart-Davis 2015--2016
 
 #include "OTV0P2BASE_CRC.h"
 
+#ifdef ARDUINO_ARCH_AVR
+#include <avr/pgmspace.h>
+#define CRC_TABLE_ATTR PROGMEM
+#define CRC_TABLE_READ(p) pgm_read_byte(p)
+#define CRC16_TABLE_READ(p) pgm_read_word(p)
+#else
+#define CRC_TABLE_ATTR
+#define CRC_TABLE_READ(p) (*(p))
+#define CRC16_TABLE_READ(p) (*(p))
+#endif
+
 
 // Use namespaces to help avoid collisions.
 namespace OTV0P2BASE
@@ -64,6 +75,58 @@ namespace OTV0P2BASE
         return(crc7_5B_update_nz_ALT);
         }
 
+    // Dallas/Maxim CRC8 of a nibble in the low and high positions of the (reflected) register.
+    // Generated bitwise with the reflected polynomial 0x8C.
+    static const uint8_t crc8_dallas_lo[16] CRC_TABLE_ATTR =
+        { 0x00, 0x5e, 0xbc, 0xe2, 0x61, 0x3f, 0xdd, 0x83, 0xc2, 0x9c, 0x7e, 0x20, 0xa3, 0xfd, 0x1f, 0x41 };
+    static const uint8_t crc8_dallas_hi[16] CRC_TABLE_ATTR =
+        { 0x00, 0x9d, 0x23, 0xbe, 0x46, 0xdb, 0x65, 0xf8, 0x8c, 0x11, 0xaf, 0x32, 0xca, 0x57, 0xe9, 0x74 };
+
+    /**Update Dallas/Maxim 1-Wire 8-bit CRC with next byte.
+     * As the register is linear, the effect of each nibble of (crc ^ datum)
+     * can be looked up separately and combined.
+     */
+    uint8_t crc8_dallas_update(const uint8_t crc, const uint8_t datum)
+        {
+        const uint8_t x = crc ^ datum;
+        return(CRC_TABLE_READ(crc8_dallas_lo + (x & 0xf)) ^ CRC_TABLE_READ(crc8_dallas_hi + (x >> 4)));
+        }
+
+    // Compute Dallas/Maxim 1-Wire CRC8 over len bytes from buf, starting from 0.
+    uint8_t crc8_dallas(const uint8_t *buf, uint8_t len)
+        {
+        uint8_t crc = 0;
+        while(len-- > 0) { crc = crc8_dallas_update(crc, *buf++); }
+        return(crc);
+        }
+
+    // CRC16 (reflected 0xA001) of a nibble in the low and high positions of the low byte of the register.
+    // Generated bitwise with the reflected polynomial 0xA001.
+    static const uint16_t crc16_A001_lo[16] CRC_TABLE_ATTR =
+        { 0x0000, 0xc0c1, 0xc181, 0x0140, 0xc301, 0x03c0, 0x0280, 0xc241,
+          0xc601, 0x06c0, 0x0780, 0xc741, 0x0500, 0xc5c1, 0xc481, 0x0440 };
+    static const uint16_t crc16_A001_hi[16] CRC_TABLE_ATTR =
+        { 0x0000, 0xcc01, 0xd801, 0x1400, 0xf001, 0x3c00, 0x2800, 0xe401,
+          0xa001, 0x6c00, 0x7800, 0xb401, 0x5000, 0x9c01, 0x8801, 0x4400 };
+
+    /**Update 16-bit CRC with next byte.
+     * As for crc8_dallas_update(), the effect of each nibble
+     * of the low byte of (crc ^ datum) is looked up separately and combined.
+     */
+    uint16_t crc16_A001_update(const uint16_t crc, const uint8_t datum)
+        {
+        const uint8_t x = uint8_t(crc) ^ datum;
+        return((crc >> 8) ^ CRC16_TABLE_READ(crc16_A001_lo + (x & 0xf)) ^ CRC16_TABLE_READ(crc16_A001_hi + (x >> 4)));
+        }
+
+    // Compute CRC16 (reflected 0xA001) over len bytes from buf, starting from init.
+    uint16_t crc16_A001(const uint8_t *buf, uint16_t len, const uint16_t init)
+        {
+        uint16_t crc = init;
+        while(len-- > 0) { crc = crc16_A001_update(crc, *buf++); }
+        return(crc);
+        }
+
 
 //// Update 'C2' 8-bit CRC with next byte.
 //// Usually initialised with 0xff.
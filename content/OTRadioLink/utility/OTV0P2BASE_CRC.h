@@ -56,6 +56,34 @@ namespace OTV0P2BASE
      */
     extern uint8_t crc7_5B_update_nz_final(uint8_t crc, uint8_t datum);
 
+    /**Update Dallas/Maxim 1-Wire 8-bit CRC with next byte.
+     * Polynomial x^8 + x^5 + x^4 + 1 (0x31, reflected 0x8C), initialised with 0;
+     * same results as AVR _crc_ibutton_update().
+     * <p>
+     * Table-driven, a nibble at a time, using 32 bytes of table (in Flash on AVR).
+     * <p>
+     * Over a ROM ID or DS18B20 scratchpad including its final CRC byte
+     * the result is 0 if intact.
+     */
+    extern uint8_t crc8_dallas_update(uint8_t crc, uint8_t datum);
+
+    // Compute Dallas/Maxim 1-Wire CRC8 over len bytes from buf, starting from 0.
+    extern uint8_t crc8_dallas(const uint8_t *buf, uint8_t len);
+
+    /**Update 16-bit CRC with next byte.
+     * Polynomial x^16 + x^15 + x^2 + 1 (0x8005, reflected 0xA001);
+     * same results as AVR _crc16_update().
+     * Initialised with 0xffff (as for JeeLabs RF12 and Modbus) the CRC of "123456789" is 0x4b37.
+     * <p>
+     * Table-driven, a nibble at a time, using 64 bytes of table (in Flash on AVR).
+     * <p>
+     * Over a message followed by its CRC (low byte first) the result is 0 if intact.
+     */
+    extern uint16_t crc16_A001_update(uint16_t crc, uint8_t datum);
+
+    // Compute CRC16 (reflected 0xA001) over len bytes from buf, starting from init.
+    extern uint16_t crc16_A001(const uint8_t *buf, uint16_t len, uint16_t init = 0xffff);
+
 
     }
 
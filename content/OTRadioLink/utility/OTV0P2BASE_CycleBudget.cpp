@@ -0,0 +1,117 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * Major-cycle time budget accounting.
+ */
+
+#include <string.h>
+
+#include "OTV0P2BASE_CycleBudget.h"
+
+
+namespace OTV0P2BASE
+{
+
+
+constexpr uint8_t CycleBudget::CYCLE_END;
+constexpr uint8_t CycleBudget::DECAY_CYCLES;
+constexpr uint8_t CycleBudget::SLACK_LOW_BELOW;
+constexpr uint8_t CycleBudget::SLACK_MID_BELOW;
+
+// Clear all counts.
+void CycleBudget::reset()
+    {
+    memset(counts, 0, sizeof(counts));
+    memset(startTick, 0, sizeof(startTick));
+    cyclesSinceDecay = 0;
+    }
+
+// Record slack or overrun against the deadline.
+void CycleBudget::slack(const uint8_t c, const uint8_t now, const uint8_t deadline)
+    {
+    if((now < startTick[c]) || (now > deadline)) { inc(c, B_OVERRUN); return; }
+    const uint8_t s = deadline - now;
+    inc(c, (s < SLACK_LOW_BELOW) ? B_SLACK_LOW : ((s < SLACK_MID_BELOW) ? B_SLACK_MID : B_SLACK_HIGH));
+    }
+
+// True if work by component c may start now; else records a deferral.
+bool CycleBudget::mayStart(const uint8_t c, const uint8_t now, const uint8_t latestStart)
+    {
+    if(c >= CBC_COUNT) { return(now < latestStart); }
+    if(now >= latestStart) { inc(c, B_DEFERRED); return(false); }
+    startTick[c] = now;
+    return(true);
+    }
+
+// Record completion of work by component c.
+void CycleBudget::finished(const uint8_t c, const uint8_t now, const uint8_t deadline)
+    {
+    if(c >= CBC_COUNT) { return; }
+    slack(c, now, deadline);
+    }
+
+// Age the counts.
+void CycleBudget::endCycle()
+    {
+    if(++cyclesSinceDecay < DECAY_CYCLES) { return; }
+    cyclesSinceDecay = 0;
+    for(uint8_t c = 0; c < CBC_COUNT; ++c)
+        { for(uint8_t b = 0; b < B_COUNT; ++b) { counts[c][b] >>= 1; } }
+    }
+
+// Rolling deferrals plus overruns for one component.
+uint16_t CycleBudget::getMisses(const uint8_t c) const
+    {
+    const uint32_t m = uint32_t(getCount(c, B_DEFERRED)) + getCount(c, B_OVERRUN);
+    return((m > 0xffff) ? 0xffff : uint16_t(m));
+    }
+
+// Short component names, in cycleBudgetComponent_t order.
+static const char *const componentNames[CBC_COUNT] = { "mq", "cli", "fht", "stx", "app" };
+const char *CycleBudget::getName(const uint8_t c)
+    { return((c < CBC_COUNT) ? componentNames[c] : NULL); }
+
+// Print a compact JSON report of all components.
+size_t CycleBudget::printJSON(Print &p) const
+    {
+    size_t n = p.print(F("{\"cb\":{"));
+    for(uint8_t c = 0; c < CBC_COUNT; ++c)
+        {
+        if(0 != c) { n += p.print(','); }
+        n += p.print('"');
+        n += p.print(componentNames[c]);
+        n += p.print(F("\":["));
+        for(uint8_t b = 0; b < B_COUNT; ++b)
+            {
+            if(0 != b) { n += p.print(','); }
+            n += p.print((unsigned long)counts[c][b]);
+            }
+        n += p.print(']');
+        }
+    n += p.print(F("}}"));
+    return(n);
+    }
+
+// Tracker used by library components; NULL if none.
+static CycleBudget *cycleBudget;
+void setCycleBudget(CycleBudget *const cb) { cycleBudget = cb; }
+CycleBudget *getCycleBudget() { return(cycleBudget); }
+
+
+}
@@ -0,0 +1,153 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * Major-cycle time budget accounting.
+ *
+ * Records, per component, how often work is deferred for lack of time,
+ * how often it overruns its deadline, and how much slack it leaves,
+ * as a rolling histogram to help tune scheduling within the cycle.
+ *
+ * Works in sub-cycle ticks [0,255]; portable and unit testable
+ * as all times are supplied by the caller.
+ */
+
+#ifndef ARDUINO_LIB_OTV0P2BASE_CYCLEBUDGET_H
+#define ARDUINO_LIB_OTV0P2BASE_CYCLEBUDGET_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include "utility/OTV0P2BASE_ArduinoCompat.h"
+#endif
+
+
+namespace OTV0P2BASE
+{
+
+
+// Components drawing on the major cycle budget.
+enum cycleBudgetComponent_t : uint8_t
+  {
+  CBC_MESSAGING, // Inbound message queue handling ("mq").
+  CBC_CLI, // CLI prompt and line read ("cli").
+  CBC_FHT8V, // FHT8V TX timing ("fht").
+  CBC_STATS, // Stats TX ("stx").
+  CBC_APP, // Application use ("app").
+  CBC_COUNT // Number of components; not a component.
+  };
+
+// Tracks time budget use within each major cycle, per component.
+//
+// A component asks whether there is time to start some work
+// with mayStart(), which records a deferral if not,
+// and reports completion against its deadline with finished(),
+// which records an overrun or the slack left.
+// Work that only has a deadline (eg a sleep to a fixed time)
+// can use recordSlack() instead.
+//
+// Histogram buckets per component are:
+//   deferred, overrun, slack < 1/8 cycle, slack < 1/2 cycle, slack >= 1/2 cycle.
+// Counts are halved every DECAY_CYCLES calls of endCycle(),
+// so they cover roughly the last few minutes.
+//
+// Not ISR-safe: use from the main loop only.
+class CycleBudget final
+  {
+  public:
+    // Histogram buckets.
+    enum bucket_t : uint8_t { B_DEFERRED, B_OVERRUN, B_SLACK_LOW, B_SLACK_MID, B_SLACK_HIGH, B_COUNT };
+    // Last sub-cycle tick in the major cycle.
+    static constexpr uint8_t CYCLE_END = 255;
+    // Major cycles between halving the counts.
+    static constexpr uint8_t DECAY_CYCLES = 64;
+    // Slack bucket boundaries in ticks.
+    static constexpr uint8_t SLACK_LOW_BELOW = 32;
+    static constexpr uint8_t SLACK_MID_BELOW = 128;
+
+  private:
+    // Rolling counts per component and bucket.
+    uint16_t counts[CBC_COUNT][B_COUNT];
+    // Start tick of work in progress per component.
+    uint8_t startTick[CBC_COUNT];
+    // Major cycles since the last decay.
+    uint8_t cyclesSinceDecay;
+
+    void inc(const uint8_t c, const uint8_t b) { if(0xffff != counts[c][b]) { ++counts[c][b]; } }
+    void slack(uint8_t c, uint8_t now, uint8_t deadline);
+
+  public:
+    CycleBudget() { reset(); }
+
+    // Clear all counts.
+    void reset();
+
+    // True if work by component c may start at tick now, ie strictly before latestStart;
+    // otherwise records a deferral and returns false.
+    bool mayStart(uint8_t c, uint8_t now, uint8_t latestStart);
+    // Record completion of work by component c at tick now against deadline.
+    // An overrun if now is after the deadline,
+    // or before the tick passed to the matching mayStart(), ie the cycle wrapped.
+    void finished(uint8_t c, uint8_t now, uint8_t deadline = CYCLE_END);
+    // Record slack or overrun for c at tick now against deadline with no start.
+    void recordSlack(const uint8_t c, const uint8_t now, const uint8_t deadline)
+      { if(c < CBC_COUNT) { startTick[c] = now; slack(c, now, deadline); } }
+
+    // Call once at the end (or start) of each major cycle to age the counts.
+    void endCycle();
+
+    // Rolling count in one bucket; 0 if out of range.
+    uint16_t getCount(const uint8_t c, const uint8_t b) const
+      { return(((c < CBC_COUNT) && (b < B_COUNT)) ? counts[c][b] : 0); }
+    // Rolling deferrals plus overruns for one component, saturating.
+    uint16_t getMisses(uint8_t c) const;
+
+    // Short name of component c; NULL if out of range.
+    static const char *getName(uint8_t c);
+
+    // Print a compact JSON report of all components, eg
+    //   {"cb":{"mq":[deferred,overrun,slackLow,slackMid,slackHigh],...}}
+    // Returns the number of characters printed.
+    size_t printJSON(Print &p) const;
+
+    // Put the rolling misses (deferrals + overruns) of each component
+    // into a stats set (eg SimpleStatsRotation) keyed by component name,
+    // omitting components with none.
+    template<class stats_t>
+    void putStats(stats_t &stats, const bool lowPriority = true) const
+      {
+      for(uint8_t c = 0; c < CBC_COUNT; ++c)
+        {
+        const uint16_t m = getMisses(c);
+        if(0 != m) { stats.put(getName(c), int16_t((m > 0x7fff) ? 0x7fff : m), lowPriority); }
+        }
+      }
+  };
+
+// Set or get the cycle budget tracker used by library components; NULL if none.
+// Components do no accounting unless one is set.
+void setCycleBudget(CycleBudget *cb);
+CycleBudget *getCycleBudget();
+
+
+}
+
+#endif // ARDUINO_LIB_OTV0P2BASE_CYCLEBUDGET_H
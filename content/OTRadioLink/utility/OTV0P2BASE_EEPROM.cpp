@@ -21,21 +21,40 @@ Author(s) / Copyright (s): Damon Hart-Davis 2013--2016
 
  NOTE: NO EEPROM ACCESS SHOULD HAPPEN FROM ANY ISR CODE ELSE VARIOUS FAILURE MODES ARE POSSIBLE
 
- Mainly V0p2/AVR for now.
+ Mainly V0p2/AVR for now, with an emulation of the AVR EEPROM for host builds.
  */
 
 #ifdef ARDUINO_ARCH_AVR
-
 #include <util/atomic.h>
+#else
+#include <string.h>
+#endif
 
 #include "OTV0P2BASE_EEPROM.h"
 
 #include "OTV0P2BASE_RTC.h"
 
 
+#ifndef ARDUINO_ARCH_AVR
+uint8_t eeprom_read_byte(const uint8_t *const p)
+  {
+  OTV0P2BASE::EEPROMEmulator &e = OTV0P2BASE::EEPROMEmulator::getInstance();
+  return(e.read(e.toAddr(p)));
+  }
+
+void eeprom_write_byte(uint8_t *const p, const uint8_t value)
+  {
+  OTV0P2BASE::EEPROMEmulator &e = OTV0P2BASE::EEPROMEmulator::getInstance();
+  e.eraseWrite(e.toAddr(p), value);
+  }
+#endif // ARDUINO_ARCH_AVR
+
+
 namespace OTV0P2BASE
 {
 
+#ifdef ARDUINO_ARCH_AVR
+
 // Updates an EEPROM byte iff not currently already at the specified target value.
 // May be able to selectively erase or write (ie reduce wear) to reach the desired value.
 // As with the AVR eeprom_XXX_byte() macros, not safe to use outside and within ISRs as-is.
@@ -164,6 +183,179 @@ bool eeprom_smart_clear_bits(uint8_t *p, uint8_t mask)
 #endif
   }
 
+#else
+
+// Host versions of the smart routines, following the AVR split erase/write logic
+// (including its reads) so that the emulator sees the same traffic.
+
+bool eeprom_smart_update_byte(uint8_t *p, uint8_t value)
+  {
+  if((uint8_t) 0xff == value) { return(eeprom_smart_erase_byte(p)); }
+  const uint8_t oldValue = eeprom_read_byte(p);
+  if(value == oldValue) { return(false); } // No change needed.
+  if(value == (value & oldValue)) { return(eeprom_smart_clear_bits(p, value)); } // Can use pure write to clear bits to zero.
+  eeprom_write_byte(p, value); // Needs to set some (but not all) bits to 1, so needs erase and write.
+  return(true);
+  }
+
+bool eeprom_smart_erase_byte(uint8_t *p)
+  {
+  EEPROMEmulator &e = EEPROMEmulator::getInstance();
+  const uint16_t addr = e.toAddr(p);
+  if((uint8_t) 0xff == e.read(addr)) { return(false); }
+  e.erase(addr);
+  return(true);
+  }
+
+bool eeprom_smart_clear_bits(uint8_t *p, uint8_t mask)
+  {
+  EEPROMEmulator &e = EEPROMEmulator::getInstance();
+  const uint16_t addr = e.toAddr(p);
+  const uint8_t oldValue = e.read(addr);
+  if(oldValue == (oldValue & mask)) { return(false); }
+  e.write(addr, mask);
+  return(true);
+  }
+
+constexpr uint16_t EEPROMEmulator::size;
+constexpr uint16_t EEPROMEmulator::eraseWriteUS;
+constexpr uint16_t EEPROMEmulator::eraseUS;
+constexpr uint16_t EEPROMEmulator::writeUS;
+
+EEPROMEmulator &EEPROMEmulator::getInstance()
+  {
+  // Lazily create/initialise on first use, NOT statically.
+  static EEPROMEmulator instance;
+  static bool initialised;
+  if(!initialised) { instance.reset(); initialised = true; }
+  return(instance);
+  }
+
+void EEPROMEmulator::reset()
+  {
+  memset(mem, 0xff, sizeof(mem));
+  clearCounts();
+  }
+
+void EEPROMEmulator::clearCounts()
+  {
+  memset(reads, 0, sizeof(reads));
+  memset(erases, 0, sizeof(erases));
+  memset(writes, 0, sizeof(writes));
+  busyUS = 0;
+  }
+
+uint8_t EEPROMEmulator::read(const uint16_t addr)
+  {
+  if(addr >= size) { return(0xff); }
+  ++reads[addr];
+  return(mem[addr]);
+  }
+
+void EEPROMEmulator::erase(const uint16_t addr)
+  {
+  if(addr >= size) { return; }
+  ++erases[addr];
+  busyUS += eraseUS;
+  mem[addr] = 0xff;
+  }
+
+void EEPROMEmulator::write(const uint16_t addr, const uint8_t v)
+  {
+  if(addr >= size) { return; }
+  ++writes[addr];
+  busyUS += writeUS;
+  mem[addr] &= v;
+  }
+
+void EEPROMEmulator::eraseWrite(const uint16_t addr, const uint8_t v)
+  {
+  if(addr >= size) { return; }
+  ++erases[addr];
+  ++writes[addr];
+  busyUS += eraseWriteUS;
+  mem[addr] = v;
+  }
+
+uint32_t EEPROMEmulator::getTotalReads() const
+  {
+  uint32_t t = 0;
+  for(uint16_t i = 0; i < size; ++i) { t += reads[i]; }
+  return(t);
+  }
+
+uint32_t EEPROMEmulator::getTotalErases() const
+  {
+  uint32_t t = 0;
+  for(uint16_t i = 0; i < size; ++i) { t += erases[i]; }
+  return(t);
+  }
+
+uint32_t EEPROMEmulator::getTotalWrites() const
+  {
+  uint32_t t = 0;
+  for(uint16_t i = 0; i < size; ++i) { t += writes[i]; }
+  return(t);
+  }
+
+uint32_t EEPROMEmulator::getMaxErases() const
+  {
+  uint32_t m = 0;
+  for(uint16_t i = 0; i < size; ++i) { if(erases[i] > m) { m = erases[i]; } }
+  return(m);
+  }
+
+uint32_t EEPROMEmulator::getMaxPageErases() const
+  {
+  uint32_t m = 0;
+  for(uint16_t i = 0; i < size; i += V0P2BASE_EEPROM_PAGE_SIZE)
+    {
+    uint32_t p = 0;
+    for(uint8_t j = 0; j < V0P2BASE_EEPROM_PAGE_SIZE; ++j) { p += erases[i + j]; }
+    if(p > m) { m = p; }
+    }
+  return(m);
+  }
+
+void EEPROMEmulator::dumpWearHeatmap(FILE *const out, const uint8_t bytesPerRow) const
+  {
+  static const char scale[] = " .:-=+*#%@";
+  const uint8_t levels = sizeof(scale) - 3; // Erase levels above '.'.
+  const uint32_t maxErases = getMaxErases();
+  fprintf(out, "EEPROM wear: reads %lu erases %lu writes %lu busy %lums max byte erases %lu max page erases %lu\n",
+      (unsigned long)getTotalReads(), (unsigned long)getTotalErases(), (unsigned long)getTotalWrites(),
+      (unsigned long)(busyUS / 1000), (unsigned long)maxErases, (unsigned long)getMaxPageErases());
+  for(uint16_t row = 0; row < size; row += bytesPerRow)
+    {
+    uint32_t rowErases = 0, rowWrites = 0;
+    fprintf(out, "%04x |", unsigned(row));
+    for(uint16_t i = row; (i < row + bytesPerRow) && (i < size); ++i)
+      {
+      rowErases += erases[i];
+      rowWrites += writes[i];
+      char c = scale[0];
+      if(0 != erases[i]) { c = scale[2 + ((erases[i] * levels) - 1) / maxErases]; }
+      else if(0 != writes[i]) { c = scale[1]; }
+      fputc(c, out);
+      }
+    fprintf(out, "| e %lu w %lu\n", (unsigned long)rowErases, (unsigned long)rowWrites);
+    }
+  }
+
+#endif // ARDUINO_ARCH_AVR
+
+// Get the journal over the V0P2BASE_EE_START_JOURNAL area, mounting it on first use.
+// Not ISR-/thread- safe.
+EEPROMJournal &getEEPROMJournal()
+  {
+  // Lazily create/initialise on first use, NOT statically.
+  static EEPROMNVByteBackingStore store(V0P2BASE_EE_START_JOURNAL, V0P2BASE_EE_LEN_JOURNAL);
+  static EEPROMJournal journal(store);
+  static bool mounted;
+  if(!mounted) { journal.begin(); mounted = true; }
+  return(journal);
+  }
+
 // Clear all collected statistics, eg when moving device to a new room or at a major time change.
 // Requires 1.8ms per byte for each byte that actually needs erasing.
 //   * maxBytesToErase limit the number of bytes erased to this; strictly positive, else 0 to allow 65536
@@ -186,5 +378,3 @@ EEPROMByHourByteStats::_zapStats(uint16_t maxBytesToErase)
 
 }
 
-#endif // ARDUINO_ARCH_AVR
-
@@ -32,12 +32,22 @@ Author(s) / Copyright (s): Damon Hart-Davis 2013--2016
 
 #ifdef ARDUINO_ARCH_AVR
 #include <avr/eeprom.h>
+#else
+#include <stdio.h>
 #endif
 
 #include "OTV0P2BASE_RTC.h"
 #include "OTV0P2BASE_Stats.h"
+#include "OTV0P2BASE_NVKVJournal.h"
 
 
+#ifndef ARDUINO_ARCH_AVR
+// Host equivalents of the avr-libc routines, using EEPROMEmulator.
+uint8_t eeprom_read_byte(const uint8_t *p);
+// Erases and writes the byte, even if unchanged, as avr-libc does.
+void eeprom_write_byte(uint8_t *p, uint8_t value);
+#endif // ARDUINO_ARCH_AVR
+
 namespace OTV0P2BASE
 {
 
@@ -58,6 +68,15 @@ namespace OTV0P2BASE
 #define V0P2BASE_EEPROM_SPLIT_ERASE_WRITE // Separate erase and write are possible.
 #endif
 
+#else
+
+// Host builds emulate the ATmega328P EEPROM: see EEPROMEmulator.
+#define V0P2BASE_EEPROM_SIZE 1024
+#define V0P2BASE_EEPROM_PAGE_SIZE 4
+#define V0P2BASE_EEPROM_SPLIT_ERASE_WRITE // Separate erase and write are possible.
+
+#endif // ARDUINO_ARCH_AVR
+
 // Updates an EEPROM byte iff not currently at the specified target value.
 // May be able to selectively erase or write (ie reduce wear) to reach the desired value.
 // As with the AVR eeprom_XXX_byte() macros, not safe to use outside and within ISRs as-is.
@@ -199,8 +218,15 @@ static const intptr_t V0P2BASE_EE_END_RADIO = 255;
 //#error EEPROM allocation problem: filter overlaps with stats
 //#endif
 
+// Wear-levelled journal (log-structured key-value store) for small frequently-updated items.
+// See NVKVJournal: split into two banks, with compaction from one to the other when full.
+#define V0P2BASE_EE_START_JOURNAL 616 // INCLUSIVE START OF JOURNAL AREA.
+#define V0P2BASE_EE_LEN_JOURNAL 88 // SIZE OF JOURNAL AREA (bytes), even.
+#define V0P2BASE_EE_END_JOURNAL (V0P2BASE_EE_START_JOURNAL + V0P2BASE_EE_LEN_JOURNAL - 1)
+#if V0P2BASE_EE_END_STATS >= V0P2BASE_EE_START_JOURNAL
+#error EEPROM allocation problem: journal overlaps with stats
+#endif
 
-#endif // ARDUINO_ARCH_AVR
 
 // Node security association storage.
 // (ID plus permanent message counter for RX.)
@@ -237,7 +263,49 @@ static constexpr uint8_t V0P2BASE_EE_NODE_ASSOCIATIONS_MAX_SETS = 8;
 // INCLUSIVE END OF NODE ASSOCIATIONS AREA: must point to last byte used.
 static constexpr intptr_t V0P2BASE_EE_END_NODE_ASSOCIATIONS = ((V0P2BASE_EE_NODE_ASSOCIATIONS_MAX_SETS * V0P2BASE_EE_NODE_ASSOCIATIONS_SET_SIZE)-1);
 
-#ifdef ARDUINO_ARCH_AVR
+static_assert(V0P2BASE_EE_END_JOURNAL < V0P2BASE_EE_START_NODE_ASSOCIATIONS_WORK_START, "EEPROM allocation problem: journal overlaps with node associations");
+
+// Keys of items in the EEPROM journal, in range [0,V0P2BASE_EE_JOURNAL_KEYS-1].
+// RTC persisted day and time of day, 3 bytes: days (ls byte first) then quarter-hours since midnight.
+static constexpr uint8_t V0P2BASE_EE_JOURNAL_KEY_RTC = 0;
+// TX message counter persistent reboot/restart value.
+static constexpr uint8_t V0P2BASE_EE_JOURNAL_KEY_TX_RESTART_CTR = 1;
+// Overrun counter.
+static constexpr uint8_t V0P2BASE_EE_JOURNAL_KEY_OVERRUN_COUNTER = 2;
+// Number of keys in the EEPROM journal.
+// Live values must fit comfortably in one bank (half of V0P2BASE_EE_LEN_JOURNAL)
+// else compaction becomes frequent, so per-node RX counters do not fit.
+static constexpr uint8_t V0P2BASE_EE_JOURNAL_KEYS = 3;
+// Type of the EEPROM journal.
+typedef NVKVJournal<V0P2BASE_EE_JOURNAL_KEYS> EEPROMJournal;
+
+// Backing store for a region of the on-chip EEPROM, eg for NVKVJournal.
+// Uses the smart update routines so that appending onto erased bytes needs no erase.
+// Not ISR-/thread- safe.
+class EEPROMNVByteBackingStore final : public NVByteBackingStoreBase
+  {
+  private:
+    const uintptr_t start;
+    const uint16_t len;
+  public:
+    constexpr EEPROMNVByteBackingStore(const uintptr_t _start, const uint16_t _len) : start(_start), len(_len) { }
+    virtual uint16_t size() const override { return(len); }
+    virtual uint8_t read(const uint16_t addr) const override { return(eeprom_read_byte((const uint8_t *)(start + addr))); }
+    virtual bool write(const uint16_t addr, const uint8_t v) override
+      {
+      eeprom_smart_update_byte((uint8_t *)(start + addr), v);
+      return(v == read(addr));
+      }
+    virtual bool erase(const uint16_t addr) override
+      {
+      eeprom_smart_erase_byte((uint8_t *)(start + addr));
+      return(0xff == read(addr));
+      }
+  };
+
+// Get the journal over the V0P2BASE_EE_START_JOURNAL area, mounting it on first use.
+// Not ISR-/thread- safe.
+EEPROMJournal &getEEPROMJournal();
 
 // Wrapper for simple byte-wide non-volatile time-based (by hour) stats implementation in EEPROM.
 // Multiple instances can access the same EEPROM backing store.
@@ -287,7 +355,7 @@ public:
     {
         if(statsSet >= V0P2BASE_EE_STATS_SETS) { return(UNSET_BYTE); } // Invalid set.
         if(hh > 23) { return(UNSET_BYTE); } // Invalid hour.
-        return(eeprom_read_byte((uint8_t *)(V0P2BASE_EE_START_STATS + (statsSet * (int)V0P2BASE_EE_STATS_SET_SIZE) + (int)hh)));
+        return(eeprom_read_byte((uint8_t *)(intptr_t)(V0P2BASE_EE_START_STATS + (statsSet * (int)V0P2BASE_EE_STATS_SET_SIZE) + (int)hh)));
     }
     // Set raw stats value for specified hour [0,23] from stats set N in non-volatile (EEPROM) store.
     // Statically-accessible version of getByHourStatSimple();
@@ -295,13 +363,87 @@ public:
     {
         if(statsSet >= V0P2BASE_EE_STATS_SETS) { return; } // Invalid set.
         if(hh > 23) { return; } // Invalid hour.
-        eeprom_smart_update_byte((uint8_t *)(V0P2BASE_EE_START_STATS + (statsSet * (int)V0P2BASE_EE_STATS_SET_SIZE) + (int)hh), v);
+        eeprom_smart_update_byte((uint8_t *)(intptr_t)(V0P2BASE_EE_START_STATS + (statsSet * (int)V0P2BASE_EE_STATS_SET_SIZE) + (int)hh), v);
     }
 
     // Get the current hour, for use in getByHourStatRTC.
-    virtual uint8_t getHour() const override { return(OTV0P2BASE::getHoursLT()); }
+    virtual uint8_t getHour() const override { return(uint8_t(OTV0P2BASE::getMinutesSinceMidnightLT() / 60)); }
 };
 
+#ifndef ARDUINO_ARCH_AVR
+// Host emulation of the ATmega328P on-chip EEPROM,
+// behind eeprom_read_byte(), eeprom_write_byte() and the eeprom_smart_xxx() routines,
+// so that the real EEPROM traffic of (eg) stats, counters and the journal can be measured.
+//
+// Counts reads, erases and (bit-clearing) writes per address,
+// and accumulates the time the EEPROM would have been busy,
+// modelling split erase/write as on the AVR.
+// Reads are treated as taking no time.
+//
+// Addresses are as for the AVR, ie small integers cast to pointers.
+// Accesses outside the EEPROM are ignored, reading as 0xff.
+// Not thread-safe.
+class EEPROMEmulator final
+  {
+  public:
+    // Size in bytes.
+    static constexpr uint16_t size = V0P2BASE_EEPROM_SIZE;
+    // Typical AVR EEPROM programming times in microseconds (ATmega328P datasheet table 27-5).
+    static constexpr uint16_t eraseWriteUS = 3400;
+    static constexpr uint16_t eraseUS = 1800;
+    static constexpr uint16_t writeUS = 1800;
+
+    // Contents.
+    uint8_t mem[size];
+    // Per-address reads.
+    uint32_t reads[size];
+    // Per-address erases, including the erase of a combined erase/write.
+    uint32_t erases[size];
+    // Per-address writes, including the write of a combined erase/write.
+    // A write alone can only clear bits.
+    uint32_t writes[size];
+    // Total time the EEPROM would have been busy, in microseconds.
+    uint32_t busyUS;
+
+    // Get the shared instance used by the eeprom_xxx() routines.
+    static EEPROMEmulator &getInstance();
+
+    // Erase all bytes to 0xff and clear all counts.
+    void reset();
+    // Clear all counts, leaving the contents.
+    void clearCounts();
+
+    // Map an EEPROM pointer to an address, or size if out of range.
+    static uint16_t toAddr(const uint8_t *const p)
+      { const uintptr_t a = (uintptr_t)p; return(uint16_t((a < size) ? a : size)); }
+
+    // Read a byte.
+    uint8_t read(uint16_t addr);
+    // Erase a byte to 0xff without a write.
+    void erase(uint16_t addr);
+    // Write a byte without an erase, ie AND the value in, clearing bits only.
+    void write(uint16_t addr, uint8_t v);
+    // Erase then write a byte, ie set it to any value.
+    void eraseWrite(uint16_t addr, uint8_t v);
+
+    // Total reads over all addresses.
+    uint32_t getTotalReads() const;
+    // Total erases over all addresses.
+    uint32_t getTotalErases() const;
+    // Total writes over all addresses.
+    uint32_t getTotalWrites() const;
+    // Highest erase count of any byte, ie of the most worn byte.
+    uint32_t getMaxErases() const;
+    // Highest erase count of any page of V0P2BASE_EEPROM_PAGE_SIZE bytes,
+    // ie in case endurance is per page rather than per byte.
+    uint32_t getMaxPageErases() const;
+
+    // Print a heatmap of erases by address, a row of bytesPerRow bytes per line,
+    // with each byte shown by one character from ' ' (untouched) and '.' (writes only)
+    // up to '@' (most erased), followed by the row totals.
+    //   * bytesPerRow  strictly positive and a factor of size
+    void dumpWearHeatmap(FILE *out, uint8_t bytesPerRow = 32) const;
+  };
 #endif // ARDUINO_ARCH_AVR
 
 
@@ -19,7 +19,7 @@ Author(s) / Copyright (s): Damon Hart-Davis 2015--2016
 /*
  Routines for managing entropy for (crypto) random number generation.
 
- Almost entirely specific to V0p2/AVR for now.
+ Mostly specific to V0p2/AVR; the entropy pool is portable.
  */
 
 #ifdef ARDUINO_ARCH_AVR
@@ -30,6 +30,12 @@ Author(s) / Copyright (s): Damon Hart-Davis 2015--2016
 #include <Arduino.h>
 #endif
 
+#include <string.h>
+#if !defined(ARDUINO) && (defined(__unix__) || defined(__APPLE__))
+#include <stdio.h>
+#define OTV0P2BASE_ENTROPY_DEV_URANDOM
+#endif
+
 #include "OTV0P2BASE_Entropy.h"
 
 #include "OTV0P2BASE_ADC.h"
@@ -43,6 +49,108 @@ namespace OTV0P2BASE
 {
 
 
+constexpr uint8_t EntropyPool::STATE_WORDS;
+constexpr uint8_t EntropyPool::RATE_BYTES;
+constexpr uint8_t EntropyPool::MAX_BITS;
+constexpr uint8_t EntropyPool::RCT_CUTOFF;
+constexpr uint16_t EntropyPool::APT_WINDOW;
+constexpr uint16_t EntropyPool::APT_CUTOFF;
+
+static inline uint32_t rotl32(const uint32_t v, const uint8_t n) { return((v << n) | (v >> (32 - n))); }
+// ChaCha quarter round.
+static inline void qr(uint32_t &a, uint32_t &b, uint32_t &c, uint32_t &d)
+  {
+  a += b; d ^= a; d = rotl32(d, 16);
+  c += d; b ^= c; b = rotl32(b, 12);
+  a += b; d ^= a; d = rotl32(d, 8);
+  c += d; b ^= c; b = rotl32(b, 7);
+  }
+
+// Stir the whole state: alternate 'column' and 'diagonal' quarter rounds.
+void EntropyPool::permute()
+  {
+  for(uint8_t r = 4; r-- > 0; )
+    {
+    qr(w[0], w[2], w[4], w[6]);
+    qr(w[1], w[3], w[5], w[7]);
+    qr(w[0], w[3], w[4], w[7]);
+    qr(w[1], w[2], w[5], w[6]);
+    }
+  }
+
+// Clear the state, estimate and health tests (but not the failure count).
+void EntropyPool::reset()
+  {
+  memset(w, 0, sizeof(w));
+  // Arbitrary non-zero constant so that an empty pool does not sit at a fixed point.
+  w[STATE_WORDS-1] = 0x6a09e667UL;
+  pos = 0;
+  bits = 0;
+  rctLast = 0;
+  rctCount = 0;
+  aptFirst = 0;
+  aptCount = 0;
+  aptSeen = 0;
+  }
+
+// Run health tests on a sample claiming entropy; true if it passes.
+bool EntropyPool::healthy(const uint8_t data)
+  {
+  bool ok = true;
+  // Repetition count test.
+  if((0 != rctCount) && (data == rctLast))
+    { if(++rctCount >= RCT_CUTOFF) { ok = false; rctCount = 1; } }
+  else
+    { rctLast = data; rctCount = 1; }
+  // Adaptive proportion test.
+  if(0 == aptSeen) { aptFirst = data; aptCount = 1; }
+  else if(data == aptFirst) { if(++aptCount >= APT_CUTOFF) { ok = false; aptSeen = APT_WINDOW - 1; } }
+  if(++aptSeen >= APT_WINDOW) { aptSeen = 0; }
+  if(!ok)
+    {
+    bits = 0;
+    if(failures < 0xff) { ++failures; }
+    }
+  return(ok);
+  }
+
+// Mix in one byte with an estimate of how many bits of real entropy are present [0,8].
+void EntropyPool::add(const uint8_t data, const uint8_t estBits)
+  {
+  w[pos >> 2] ^= uint32_t(data) << (8 * (pos & 3));
+  if(++pos >= RATE_BYTES) { pos = 0; permute(); }
+  if((0 != estBits) && healthy(data))
+    {
+    const uint8_t eb = (estBits > 8) ? 8 : estBits;
+    bits = (bits > MAX_BITS - eb) ? MAX_BITS : (bits + eb);
+    }
+  }
+
+// Fill buf with len bytes of conditioned output.
+bool EntropyPool::extract(uint8_t *const buf, const uint8_t len)
+  {
+  const bool enough = hasBits(8U * len);
+  bits = enough ? uint8_t(bits - 8U * len) : 0;
+  // Separate output from input and flush any partial input.
+  w[STATE_WORDS-1] ^= 1;
+  permute();
+  pos = 0;
+  for(uint8_t i = 0; i < len; )
+    {
+    for(uint8_t j = 0; (j < RATE_BYTES) && (i < len); ++j)
+      { buf[i++] = uint8_t(w[j >> 2] >> (8 * (j & 3))); }
+    permute();
+    }
+  // Forget the exposed rate so that earlier output cannot be recovered from the state.
+  for(uint8_t j = 0; j < RATE_BYTES / 4; ++j) { w[j] = 0; }
+  permute();
+  return(enough);
+  }
+
+// Shared pool fed by addEntropyToPool() and captureEntropy1().
+static EntropyPool pool;
+
+
 #ifdef ARDUINO_ARCH_AVR
 
 // Extract and return a little entropy from clock jitter between CPU and 32768Hz RTC clocks; possibly up to 2 bits of entropy captured.
@@ -112,19 +220,46 @@ uint8_t getSecureRandomByte(const bool whiten)
 //   * data   byte containing 'random' bits.
 //   * estBits estimated number of truly securely random bits in range [0,8].
 // Not thread-/ISR- safe.
-void addEntropyToPool(const uint8_t data, const uint8_t /*estBits*/)
+void addEntropyToPool(const uint8_t data, const uint8_t estBits)
   {
-  // TODO: no real entropy pool yet.
+  pool.add(data, estBits);
+  // Also churn the non-secure PRNG.
   seedRNG8(data ^ ++count8, getCPUCycleCount(), getSubCycleTime());
   }
 
 // Capture a little system entropy, effectively based on call timing.
 // This call should typically take << 1ms at 1MHz CPU.
 // Does not change CPU clock speeds, mess with interrupts (other than possible brief blocking), or do I/O, or sleep.
-// Should inject some noise into secure (TBD) and non-secure (RNG8) PRNGs.
+// Injects some noise into the entropy pool (while not full) and the non-secure (RNG8) PRNG.
 void captureEntropy1()
-//  { OTV0P2BASE::seedRNG8(_getSubCycleTime() ^ _adcNoise, getCPUCycleCount() ^ Supply_mV.get(), _watchdogFired); } // FIXME
-  { OTV0P2BASE::seedRNG8(TCNT2, getCPUCycleCount() /* ^ Supply_mV.get() */, 42 /*_watchdogFired*/); } // FIXME
+  {
+//  OTV0P2BASE::seedRNG8(_getSubCycleTime() ^ _adcNoise, getCPUCycleCount() ^ Supply_mV.get(), _watchdogFired); // FIXME
+  OTV0P2BASE::seedRNG8(TCNT2, getCPUCycleCount() /* ^ Supply_mV.get() */, 42 /*_watchdogFired*/); // FIXME
+  // A couple of RTC ticks (~61us) of CPU/RTC jitter, ~1 bit, to fill the pool in idle time.
+  if(!pool.hasBits(EntropyPool::MAX_BITS)) { pool.add(uint8_t(clockJitterRTC()), 1); }
+  }
+
+// Fill buf with len 'secure' random bytes in one call.
+// Tops the pool up from the slow getSecureRandomByte() sources only as needed,
+// so is fast when the pool has been filled in idle time.
+// Gives up if the health tests keep failing.
+bool getSecureRandomBytes(uint8_t *buf, uint8_t len)
+  {
+  // Largest request that the pool can cover at once.
+  static constexpr uint8_t maxChunk = EntropyPool::MAX_BITS / 16;
+  bool ok = true;
+  while(len > 0)
+    {
+    const uint8_t n = (len > maxChunk) ? maxChunk : len;
+    // Credit half the nominal ~8 bits per slow sample.
+    for(uint8_t tries = 2*n + 8; !pool.hasBits(8U * n) && (tries > 0); --tries)
+      { pool.add(getSecureRandomByte(false), 4); }
+    if(!pool.extract(buf, n)) { ok = false; }
+    buf += n;
+    len -= n;
+    }
+  return(ok);
+  }
 
 
 // Compute a CRC of all of SRAM as a hash that should contain some entropy, especially after power-up.
@@ -236,11 +371,37 @@ void seedPRNGs()
 #endif
   }
 #else
-// Stub for integration tests
+// Add entropy to the pool along with an estimate of how many bits of real entropy are present.
+void addEntropyToPool(const uint8_t data, const uint8_t estBits) { pool.add(data, estBits); }
+
+// Fill buf with len 'secure' random bytes in one call.
+// Reads the host's /dev/urandom (credited fully) via the pool and its health tests.
+// Fails where that is not available.
+bool getSecureRandomBytes(uint8_t *const buf, const uint8_t len)
+  {
+#ifdef OTV0P2BASE_ENTROPY_DEV_URANDOM
+  if(len > EntropyPool::MAX_BITS / 8)
+    {
+    const uint8_t n = EntropyPool::MAX_BITS / 8;
+    const bool ok = getSecureRandomBytes(buf, n);
+    return(getSecureRandomBytes(buf + n, len - n) && ok);
+    }
+  uint8_t raw[EntropyPool::MAX_BITS / 8];
+  FILE *const f = fopen("/dev/urandom", "rb");
+  const size_t got = (NULL == f) ? 0 : fread(raw, 1, len, f);
+  if(NULL != f) { fclose(f); }
+  for(size_t i = 0; i < got; ++i) { pool.add(raw[i], 8); }
+#endif
+  return(pool.extract(buf, len));
+  }
+
+// Generate 'secure' new random byte; whitening is always done by the pool.
 uint8_t getSecureRandomByte(const bool)
-{
-    return (0);
-}
+  {
+  uint8_t b;
+  getSecureRandomBytes(&b, 1);
+  return(b);
+  }
 #endif // ARDUINO_ARCH_AVR
 
 
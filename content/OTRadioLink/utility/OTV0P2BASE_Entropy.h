@@ -19,7 +19,7 @@ Author(s) / Copyright (s): Damon Hart-Davis 2015--2016
 /*
  Routines for managing entropy for (crypto) random number generation.
 
- Almost entirely specific to V0p2/AVR for now.
+ Mostly specific to V0p2/AVR; the entropy pool is portable.
  */
 
 #ifndef OTV0P2BASE_ENTROPY_H
@@ -32,6 +32,76 @@ namespace OTV0P2BASE
 {
 
 
+// Entropy pool, accumulating noise cheaply and serving multi-byte requests in one call.
+// A small sponge: input is XORed into the first RATE_BYTES of the state,
+// which is stirred with an ARX (ChaCha quarter-round) permutation
+// whenever that is full and before/after output.
+// Keeps a conservative estimate of the entropy held, capped at the hidden capacity.
+// Samples claiming real entropy (estBits > 0) go through continuous health tests
+// (repetition count and adaptive proportion, after NIST SP 800-90B);
+// on a failure the sample is not credited and the estimate is dropped to zero,
+// and the failure is counted.
+// Uses about 40 bytes of RAM.
+// Not thread-/ISR- safe.
+class EntropyPool final
+  {
+  public:
+    static constexpr uint8_t STATE_WORDS = 8;
+    static constexpr uint8_t RATE_BYTES = 8;
+    // Maximum entropy estimate in bits: the state not directly exposed by output.
+    static constexpr uint8_t MAX_BITS = 8 * (4*STATE_WORDS - RATE_BYTES);
+    // Repetition count test: fail after this many identical samples in a row
+    // (1 + 20/H for a false positive rate of ~2^-20 with H = 1 bit per sample).
+    static constexpr uint8_t RCT_CUTOFF = 21;
+    // Adaptive proportion test: fail if the first sample of a window
+    // recurs at least APT_CUTOFF times in APT_WINDOW samples (H = 1).
+    static constexpr uint16_t APT_WINDOW = 512;
+    static constexpr uint16_t APT_CUTOFF = 410;
+
+  private:
+    uint32_t w[STATE_WORDS];
+    // Next byte of the rate to absorb into.
+    uint8_t pos;
+    // Current entropy estimate in bits [0,MAX_BITS].
+    uint8_t bits;
+    // Health test state.
+    uint8_t rctLast;
+    uint8_t rctCount;
+    uint8_t aptFirst;
+    uint16_t aptCount;
+    uint16_t aptSeen;
+    // Saturating count of health test failures.
+    uint8_t failures;
+
+    // Stir the whole state.
+    void permute();
+    // Run health tests on a sample claiming entropy; true if it passes.
+    bool healthy(uint8_t data);
+
+  public:
+    EntropyPool() : failures(0) { reset(); }
+
+    // Clear the state, estimate and health tests (but not the failure count).
+    void reset();
+
+    // Mix in one byte with an estimate of how many bits of real entropy are present [0,8].
+    void add(uint8_t data, uint8_t estBits);
+
+    // Fill buf with len bytes of conditioned output.
+    // Returns true if the entropy estimate covered the whole request,
+    // in which case the estimate is reduced by 8*len bits;
+    // else the output is still filled but should not be relied upon for keys.
+    // Output cannot be used to reconstruct earlier output.
+    bool extract(uint8_t *buf, uint8_t len);
+
+    // True if at least nBits of entropy are estimated to be held.
+    bool hasBits(const uint16_t nBits) const { return(bits >= nBits); }
+    uint8_t getBits() const { return(bits); }
+    // Saturating count of health test failures.
+    uint8_t getHealthFailures() const { return(failures); }
+  };
+
+
 // Note that implementation of routines declared here may be dispersed over multiple files
 // to have access to some of the available entropy in the system.
 
@@ -55,6 +125,15 @@ uint_fast8_t clockJitterEntropyByte();
 //      if false then it is easier to test if the underlying source provides new entropy reliably
 uint8_t getSecureRandomByte(bool whiten = true);
 
+// Fill buf with len 'secure' random bytes in one call, eg for keys and counter restarts.
+// Served from the entropy pool when it holds enough;
+// on V0p2/AVR tops the pool up from the slow sources as needed,
+// on a POSIX host reads /dev/urandom.
+// Returns false if enough healthy entropy could not be obtained;
+// buf is always filled but should not then be used for keys.
+// Not thread-/ISR- safe.
+bool getSecureRandomBytes(uint8_t *buf, uint8_t len);
+
 // Add entropy to the pool, if any, along with an estimate of how many bits of real entropy are present.
 //   * data   byte containing 'random' bits.
 //   * estBits estimated number of truly securely random bits in range [0,8].
@@ -64,7 +143,7 @@ void addEntropyToPool(uint8_t data, uint8_t estBits);
 // Capture a little system entropy, effectively based on call timing.
 // This call should typically take << 1ms at 1MHz CPU.
 // Does not change CPU clock speeds, mess with interrupts (other than possible brief blocking), or do I/O, or sleep.
-// Should inject some noise into secure (TBD) and non-secure (RNG8) PRNGs, or at least churn them.
+// Injects some noise into the entropy pool (while not full) and the non-secure (RNG8) PRNG.
 void captureEntropy1();
 
 // Compute a CRC of all of SRAM as a hash that should contain some entropy, especially after power-up.
@@ -396,7 +396,7 @@ uint8_t SimpleStatsRotationBase::writeJSON(uint8_t *const buf, const uint8_t buf
     // else use the first two bytes of the node ID if accessible.
     bp.print(F("\"@\":\""));
     if(NULL != id) { bp.print(id); } // Value has to be 'safe' (eg no " nor \ in it).
-#ifdef V0P2BASE_EE_START_ID // TODO: improve logic/portability
+#if defined(V0P2BASE_EE_START_ID) && defined(ARDUINO_ARCH_AVR) // TODO: improve logic/portability
     else
       {
       const uint8_t id1 = eeprom_read_byte(0 + (uint8_t *)V0P2BASE_EE_START_ID);
@@ -20,12 +20,12 @@ Note: original XABC code from "EternityForest" appears to be in the public domai
 /*
  Minimal light-weight standard-speed OneWire(TM) support.
 
- Only supported on V0p2/AVR currently.
+ Hardware bus only supported on V0p2/AVR currently.
  */
 
-#ifdef ARDUINO_ARCH_AVR // Only supported on V0p2/AVR currently.
-
+#ifdef ARDUINO_ARCH_AVR
 #include <util/atomic.h>
+#endif
 
 #include "OTV0P2BASE_MinOW.h"
 
@@ -50,6 +50,7 @@ namespace OTV0P2BASE
 // Reset the 1-Wire bus slave devices and ready them for a command.
 // Delay G (0); drive bus low, delay H (48); release bus, delay I (70); sample bus, 0 = device(s) present, 1 = no device present; delay J (410).
 // Timing intervals quite long so slightly slower impl here in base class is OK.
+#ifdef ARDUINO_ARCH_AVR
 bool MinimalOneWireBase::reset()
   {
   bool result = false;
@@ -85,6 +86,10 @@ bool MinimalOneWireBase::reset()
 
   return(result);
   }
+#else
+// No hardware bus: a simulated bus must override this.
+bool MinimalOneWireBase::reset() { return(false); }
+#endif // ARDUINO_ARCH_AVR
 
 // Read a byte.
 // Read least-significant-bit first.
@@ -240,5 +245,3 @@ void MinimalOneWireBase::skip()
 
 
 }
-
-#endif // ARDUINO_ARCH_AVR // Only supported on V0p2/AVR currently.
@@ -19,26 +19,25 @@ Author(s) / Copyright (s): Damon Hart-Davis 2013--2017
 /*
  Minimal light-weight standard-speed OneWire(TM) support.
 
- Only supported on V0p2/AVR currently.
+ Hardware bus only supported on V0p2/AVR currently;
+ the base protocol logic is portable so that it can run over a simulated bus.
  */
 
 #ifndef OTV0P2BASE_MINOW_H
 #define OTV0P2BASE_MINOW_H
 
 
-#ifdef ARDUINO_ARCH_AVR // Only supported on V0p2/AVR currently.
-
 #include <stdint.h>
 
 #ifdef ARDUINO_ARCH_AVR
 #include <util/atomic.h>
-#endif
 
 // Source of default DQ pin.
 #include "utility/OTV0P2BASE_BasicPinAssignments.h"
 // Fast GPIO support and micro timing routines.
 #include "utility/OTV0P2BASE_FastDigitalIO.h"
 #include "utility/OTV0P2BASE_Sleep.h"
+#endif // ARDUINO_ARCH_AVR
 
 namespace OTV0P2BASE
 {
@@ -64,6 +63,7 @@ class MinimalOneWireBase
     int lastDiscrepancy;
 
   protected:
+#ifdef ARDUINO_ARCH_AVR
     MinimalOneWireBase(volatile uint8_t *const ir, const uint8_t rm) : inputReg(ir), regMask(rm) { }
 
     // Register and mask can be used for generic less time-critical operations.
@@ -72,9 +72,6 @@ class MinimalOneWireBase
     // Bit mask for the OW pin.
     const uint8_t regMask;
 
-    // Address in use for search.
-    uint8_t addr[8];
-
     // Standardised delays; must be inlined and usually have interrupts turned off around them.
     // These are all reduced by enough time to allow two instructions, eg maximally-fast port operations.
     static const uint8_t stdDelayReduction = 5; // 5 suggested by COHEAT in the field 2015/09, originally 2;
@@ -103,13 +100,21 @@ class MinimalOneWireBase
     // Read selected bit.
     inline bool bitReadIn    (volatile uint8_t *const inputReg, const uint8_t bitmask) { return(0 != ((*inputReg) & bitmask)); }
 #endif
+#else
+    // For simulated buses.
+    MinimalOneWireBase() { }
+#endif // ARDUINO_ARCH_AVR
+
+    // Address in use for search.
+    uint8_t addr[8];
 
   public:
     // Reset interface; returns false if no slave device present.
     // Reset the 1-Wire bus slave devices and ready them for a command.
     // Delay G (0); drive bus low, delay H (48); release bus, delay I (70); sample bus, 0 = device(s) present, 1 = no device present; delay J (410).
     // Marks the interface as initialised.
-    bool reset();
+    // Only implemented for a hardware bus on AVR; a simulated bus must override it.
+    virtual bool reset();
 
     // Read one bit from slave; returns true if high/1.
     // Read a bit from the 1-Wire slaves (Read time slot).
@@ -135,11 +140,13 @@ class MinimalOneWireBase
 
     // Read a byte.
     // Read least-significant-bit first.
-    uint8_t read();
+    // May be overridden with a byte-level fast path, eg for a simulated bus.
+    virtual uint8_t read();
 
     // Write a byte leaving the bus unpowered at the end.
     // Write least-significant-bit first.
-    void write(uint8_t v);
+    // May be overridden with a byte-level fast path, eg for a simulated bus.
+    virtual void write(uint8_t v);
 
     // Write multiple bytes, leaving the bus unpowered at the end.
     void write_bytes(const uint8_t *buf, uint16_t count);
@@ -151,6 +158,8 @@ class MinimalOneWireBase
     void skip(void);
 };
 
+#ifdef ARDUINO_ARCH_AVR
+
 // Not intended to be thread-/ISR- safe.
 // Operations on separate instances (using different GPIOs) can be concurrent.
 template <uint8_t DigitalPin = V0p2_PIN_OW_DQ_DATA>
@@ -224,11 +233,10 @@ class MinimalOneWire final : public MinimalOneWireBase
       if(high) { delayB(); } else { delayD(); }
       }
   };
+#endif // ARDUINO_ARCH_AVR
 
 
 }
 
-#endif // ARDUINO_ARCH_AVR // Only supported on V0p2/AVR currently.
-
 
 #endif
@@ -0,0 +1,311 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ Simulated OneWire(TM) bus with DS18B20 device models, for host tests and benchmarks.
+
+ Host only.
+ */
+
+#ifndef OTV0P2BASE_MINOWSIMULATOR_H
+#define OTV0P2BASE_MINOWSIMULATOR_H
+
+#ifndef ARDUINO_ARCH_AVR
+
+#include <stdint.h>
+#include <string.h>
+
+#include "OTV0P2BASE_MinOW.h"
+#include "OTV0P2BASE_CRC.h"
+
+namespace OTV0P2BASE
+{
+
+
+// Simulated OneWire bus with up to maxDevices DS18B20s attached.
+// Models the wired-AND bus at the level of individual time slots
+// for reset, ROM commands (search, match, skip, read ROM)
+// and DS18B20 function commands (convert, read and write scratchpad),
+// so that the unmodified MinimalOneWireBase protocol code runs over it.
+// Counts resets and time slots used, to estimate bus time at standard speed.
+// read() and write() have a byte-level fast path,
+// which gives the same results as bit-by-bit operation with fewer calls.
+template <uint8_t maxDevices = 4>
+class MinimalOneWireSimulator final : public MinimalOneWireBase
+  {
+  public:
+    // Nominal standard-speed durations of a reset and of a time slot (us).
+    static constexpr uint16_t RESET_US = 960;
+    static constexpr uint8_t SLOT_US = 70;
+
+  private:
+    struct device_t
+      {
+      uint8_t rom[8];
+      uint8_t scratch[9];
+      int16_t tempC16;
+      // True while taking part in the current transaction.
+      bool active;
+      // True to corrupt scratchpad reads.
+      bool corrupt;
+      };
+    device_t devices[maxDevices];
+    uint8_t nDevices = 0;
+
+    // Bus state after each reset.
+    enum state_t : uint8_t { IDLE, ROM_CMD, SEARCH, MATCH, FUNCTION, READ_ROM, READ_SCRATCH, WRITE_SCRATCH, CONVERTING };
+    state_t state = IDLE;
+    // Byte position within a multi-byte phase, or search bit number.
+    uint8_t pos = 0;
+    // Search sub-slot: 0 read id bit, 1 read complement, 2 write direction.
+    uint8_t searchSlot = 0;
+    // Byte being assembled from written bits, and count of bits so far.
+    uint8_t rxByte = 0, rxBits = 0;
+    // Byte being sent bit by bit, and count of bits left.
+    uint8_t txByte = 0, txBits = 0;
+    // Read slots left before a conversion completes.
+    uint16_t conversionLeft = 0;
+    uint16_t conversionSlots = 0;
+
+    // Statistics.
+    uint32_t resets = 0;
+    uint32_t slots = 0;
+
+    // Recompute the CRC of a device's scratchpad.
+    static void sealScratch(device_t &d) { d.scratch[8] = crc8_dallas(d.scratch, 8); }
+
+    // Wired-AND over all active devices of bit i (LSB first) of their ROM, possibly complemented.
+    bool romBitAnd(const uint8_t i, const bool complement) const
+      {
+      bool v = true;
+      for(uint8_t d = 0; d < nDevices; ++d)
+        {
+        if(!devices[d].active) { continue; }
+        bool b = (0 != (devices[d].rom[i >> 3] & (1 << (i & 7))));
+        if(complement) { b = !b; }
+        v = v && b;
+        }
+      return(v);
+      }
+
+    // Handle a complete byte written by the master.
+    void receive(const uint8_t v)
+      {
+      switch(state)
+        {
+        case ROM_CMD:
+          pos = 0;
+          switch(v)
+            {
+            case 0xf0: state = SEARCH; searchSlot = 0; break;
+            case 0x55: state = MATCH; break;
+            case 0xcc: state = FUNCTION; break;
+            case 0x33: state = READ_ROM; break;
+            default: state = IDLE; break;
+            }
+          break;
+        case MATCH:
+          for(uint8_t d = 0; d < nDevices; ++d) { if(devices[d].rom[pos] != v) { devices[d].active = false; } }
+          if(++pos == 8) { state = FUNCTION; }
+          break;
+        case FUNCTION:
+          pos = 0;
+          switch(v)
+            {
+            case 0x44:
+              for(uint8_t d = 0; d < nDevices; ++d)
+                {
+                device_t &dev = devices[d];
+                if(!dev.active) { continue; }
+                dev.scratch[0] = uint8_t(dev.tempC16);
+                dev.scratch[1] = uint8_t(uint16_t(dev.tempC16) >> 8);
+                sealScratch(dev);
+                }
+              state = CONVERTING;
+              conversionLeft = conversionSlots;
+              break;
+            case 0xbe: state = READ_SCRATCH; break;
+            case 0x4e: state = WRITE_SCRATCH; break;
+            default: state = IDLE; break;
+            }
+          break;
+        case WRITE_SCRATCH:
+          // Th, Tl, config into scratchpad bytes 2 to 4.
+          for(uint8_t d = 0; d < nDevices; ++d)
+            {
+            device_t &dev = devices[d];
+            if(!dev.active) { continue; }
+            dev.scratch[2 + pos] = (2 == pos) ? uint8_t(v | 0x1f) : v;
+            sealScratch(dev);
+            }
+          if(++pos == 3) { state = IDLE; }
+          break;
+        default: break;
+        }
+      }
+
+    // Produce the next byte read by the master (wired-AND of all active devices).
+    uint8_t transmit()
+      {
+      uint8_t v = 0xff;
+      switch(state)
+        {
+        case READ_ROM:
+          for(uint8_t d = 0; d < nDevices; ++d) { if(devices[d].active) { v &= devices[d].rom[pos]; } }
+          if(++pos == 8) { state = IDLE; }
+          break;
+        case READ_SCRATCH:
+          for(uint8_t d = 0; d < nDevices; ++d)
+            {
+            const device_t &dev = devices[d];
+            if(!dev.active) { continue; }
+            uint8_t b = dev.scratch[pos];
+            if(dev.corrupt && (1 == pos)) { b ^= 0x10; }
+            v &= b;
+            }
+          if(++pos == 9) { state = IDLE; }
+          break;
+        default: break;
+        }
+      return(v);
+      }
+
+  public:
+    MinimalOneWireSimulator() { reset_search(); }
+
+    // Attach a DS18B20 with the given 48-bit serial number; returns its index or -1 if full.
+    // The ROM ID gets the DS18B20 family code and correct CRC.
+    int addDS18B20(const uint64_t serial, const int16_t tempC16 = 20 * 16)
+      {
+      if(nDevices >= maxDevices) { return(-1); }
+      device_t &dev = devices[nDevices];
+      dev.rom[0] = 0x28;
+      for(uint8_t i = 1; i < 7; ++i) { dev.rom[i] = uint8_t(serial >> (8 * (i - 1))); }
+      dev.rom[7] = crc8_dallas(dev.rom, 7);
+      // Power-on scratchpad: 85C, Th 75, Tl 70, 12-bit config.
+      const uint8_t por[8] = { 0x50, 0x05, 0x4b, 0x46, 0x7f, 0xff, 0x0c, 0x10 };
+      memcpy(dev.scratch, por, sizeof(por));
+      sealScratch(dev);
+      dev.tempC16 = tempC16;
+      dev.active = false;
+      dev.corrupt = false;
+      return(nDevices++);
+      }
+    // Detach the most recently attached device.
+    void removeLast() { if(nDevices > 0) { --nDevices; } }
+    // Number of devices attached.
+    uint8_t getDeviceCount() const { return(nDevices); }
+    // ROM ID of device i.
+    const uint8_t *getROM(const uint8_t i) const { return(devices[i].rom); }
+    // Scratchpad of device i.
+    const uint8_t *getScratchpad(const uint8_t i) const { return(devices[i].scratch); }
+    // Set the temperature that device i will measure at its next conversion.
+    void setTemperature(const uint8_t i, const int16_t tempC16) { devices[i].tempC16 = tempC16; }
+    // Corrupt (or stop corrupting) scratchpad reads from device i, eg to exercise the CRC.
+    void setCorrupt(const uint8_t i, const bool corrupt) { devices[i].corrupt = corrupt; }
+    // Damage the ROM ID CRC of device i, eg to exercise rejection of bad ROM IDs.
+    void setBadROMCRC(const uint8_t i) { devices[i].rom[7] ^= 0x55; }
+    // Number of read slots for which a conversion reports busy.
+    void setConversionSlots(const uint16_t n) { conversionSlots = n; }
+
+    // Number of resets and time slots since the last clearStats().
+    uint32_t getResets() const { return(resets); }
+    uint32_t getSlots() const { return(slots); }
+    // Estimated bus time (us) at standard speed since the last clearStats().
+    uint32_t getBusTime_us() const { return((resets * RESET_US) + (slots * SLOT_US)); }
+    void clearStats() { resets = 0; slots = 0; }
+
+    // Reset: all devices present take part in the next transaction.
+    virtual bool reset() override
+      {
+      ++resets;
+      for(uint8_t d = 0; d < nDevices; ++d) { devices[d].active = true; }
+      state = (0 != nDevices) ? ROM_CMD : IDLE;
+      rxBits = 0;
+      txBits = 0;
+      return(0 != nDevices);
+      }
+
+    // Read slot.
+    virtual bool read_bit() override
+      {
+      ++slots;
+      switch(state)
+        {
+        case SEARCH:
+          if(searchSlot > 1) { return(true); }
+          return(romBitAnd(pos, 1 == searchSlot++));
+        case CONVERTING:
+          if(0 != conversionLeft) { --conversionLeft; return(false); }
+          return(true);
+        default: break;
+        }
+      if(0 == txBits) { txByte = transmit(); txBits = 8; }
+      const bool b = (0 != (txByte & 1));
+      txByte >>= 1;
+      --txBits;
+      return(b);
+      }
+
+    // Write slot.
+    virtual void write_bit(const bool high) override
+      {
+      ++slots;
+      if(SEARCH == state)
+        {
+        if(2 != searchSlot) { return; }
+        // Devices whose ROM bit differs from the chosen direction drop out.
+        for(uint8_t d = 0; d < nDevices; ++d)
+          {
+          const bool b = (0 != (devices[d].rom[pos >> 3] & (1 << (pos & 7))));
+          if(b != high) { devices[d].active = false; }
+          }
+        searchSlot = 0;
+        if(++pos == 64) { state = IDLE; }
+        return;
+        }
+      rxByte = uint8_t((rxByte >> 1) | (high ? 0x80 : 0));
+      if(++rxBits == 8) { rxBits = 0; receive(rxByte); }
+      }
+
+    // Byte-level fast path, equivalent to 8 read slots outside a search.
+    virtual uint8_t read() override
+      {
+      if((SEARCH == state) || (CONVERTING == state) || (0 != txBits)) { return(MinimalOneWireBase::read()); }
+      slots += 8;
+      return(transmit());
+      }
+
+    // Byte-level fast path, equivalent to 8 write slots outside a search.
+    virtual void write(const uint8_t v) override
+      {
+      if((SEARCH == state) || (0 != rxBits)) { MinimalOneWireBase::write(v); return; }
+      slots += 8;
+      receive(v);
+      }
+  };
+
+template <uint8_t maxDevices> constexpr uint16_t MinimalOneWireSimulator<maxDevices>::RESET_US;
+template <uint8_t maxDevices> constexpr uint8_t MinimalOneWireSimulator<maxDevices>::SLOT_US;
+
+
+}
+
+#endif // ARDUINO_ARCH_AVR
+
+#endif
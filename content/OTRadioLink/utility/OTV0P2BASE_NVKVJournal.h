@@ -0,0 +1,327 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * Wear-levelled log-structured key-value store for small, frequently-updated
+ * items in non-volatile (eg EEPROM) storage.
+ *
+ * Hardware-independent and unit testable;
+ * the EEPROM-backed store is in OTV0P2BASE_EEPROM.h.
+ */
+
+#ifndef OTV0P2BASE_NVKVJOURNAL_H
+#define OTV0P2BASE_NVKVJOURNAL_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "OTV0P2BASE_CRC.h"
+
+
+namespace OTV0P2BASE
+{
+
+
+// Byte-addressed non-volatile backing store, eg a region of EEPROM.
+// Addresses are relative to the start of the region.
+// Erased bytes read as 0xff.
+// Not ISR-/thread- safe.
+class NVByteBackingStoreBase
+  {
+  public:
+    // Size of the region in bytes.
+    virtual uint16_t size() const = 0;
+    // Read the byte at addr; undefined if out of range.
+    virtual uint8_t read(uint16_t addr) const = 0;
+    // Set the byte at addr to v, avoiding erase if only bits need clearing (eg onto an erased byte).
+    // Returns true if the byte reads back as v.
+    virtual bool write(uint16_t addr, uint8_t v) = 0;
+    // Erase the byte at addr to 0xff, doing nothing if already erased.
+    // Returns true if the byte reads back as 0xff.
+    virtual bool erase(uint16_t addr) = 0;
+  };
+
+// Simple RAM-backed store, eg for unit tests.
+// Models only the erased state of fresh storage, not wear or timing.
+template<uint16_t len>
+class NVByteBackingStoreRAM final : public NVByteBackingStoreBase
+  {
+  public:
+    uint8_t mem[len];
+    NVByteBackingStoreRAM() { memset(mem, 0xff, len); }
+    virtual uint16_t size() const override { return(len); }
+    virtual uint8_t read(const uint16_t addr) const override { return(mem[addr]); }
+    virtual bool write(const uint16_t addr, const uint8_t v) override { mem[addr] = v; return(true); }
+    virtual bool erase(const uint16_t addr) override { mem[addr] = 0xff; return(true); }
+  };
+
+// Log-structured key-value store over a non-volatile backing store.
+//
+// Rather than rewriting a hot item in place (an erase and write of the same bytes each time)
+// each update appends a new record to a journal, which only has to program
+// already-erased bytes (no erase needed with split erase/write, as on AVR),
+// and spreads the wear evenly over the whole journal.
+//
+// The backing store is split into two equal banks.
+// Each bank starts with a 2-byte header: a generation number and its inverse.
+// The valid bank with the newer generation is the active one.
+// Records are appended to the active bank, each as:
+//   key (1 byte, not 0xff), value length L (1 byte), L value bytes,
+//   inverted CRC8 of the key, length and value (1 byte).
+// A first key byte of 0xff marks the free space at the end of the journal.
+// A zero-length value is a tombstone, ie marks the key deleted.
+// The latest valid record for each key holds its value.
+//
+// When the active bank is full the live records are compacted into the other bank,
+// which is erased first, and the new header is written last,
+// so a reset at any point leaves one valid bank.
+// A record torn by a reset fails its CRC and ends the scan of the journal,
+// and the bank is compacted on the next update.
+// Each compaction erases each byte of one bank at most once.
+//
+// A RAM index of one byte per key locates the latest record for each key,
+// so reads do not scan the journal.
+//
+//   * maxKeys  keys are in range [0,maxKeys-1]; strictly positive and less than 255
+//   * maxValueLen  maximum value length in bytes; strictly positive
+//
+// Banks are limited to 255 bytes.
+// Not ISR-/thread- safe.
+template<uint8_t maxKeys, uint8_t maxValueLen = 8>
+class NVKVJournal final
+  {
+    static_assert((maxKeys > 0) && (maxKeys < 255), "bad maxKeys");
+    static_assert((maxValueLen > 0) && (maxValueLen <= 127), "bad maxValueLen");
+
+  public:
+    // Bytes of header at the start of each bank.
+    static constexpr uint8_t headerBytes = 2;
+    // Bytes of overhead in each record besides the value.
+    static constexpr uint8_t recordOverhead = 3;
+
+  private:
+    NVByteBackingStoreBase &store;
+    // Size of each bank.
+    const uint8_t bankSize;
+    // Start of the active bank (0 or bankSize).
+    uint8_t active = 0;
+    // Generation of the active bank.
+    uint8_t generation = 0;
+    // Offset within the active bank of the free space.
+    uint8_t tail = headerBytes;
+    // Offset within the active bank of the latest record for each key, 0 if none.
+    uint8_t index[maxKeys];
+    // Compactions since begin().
+    uint16_t compactions = 0;
+
+    // Bank size from the store, limited to 255.
+    static uint8_t computeBankSize(const NVByteBackingStoreBase &s)
+      {
+      const uint16_t half = s.size() / 2;
+      return(uint8_t((half > 255) ? 255 : half));
+      }
+
+    // True if the bank at start has a valid header.
+    bool isValidBank(const uint8_t start) const
+      {
+      const uint8_t g = store.read(start);
+      return(uint8_t(~g) == store.read(uint16_t(start) + 1));
+      }
+
+    // Compute the stored (inverted) CRC of a record at the given absolute address.
+    uint8_t computeRecordCRC(const uint16_t addr, const uint8_t len) const
+      {
+      uint8_t crc = 0;
+      for(uint8_t i = 0; i < len + 2; ++i) { crc = crc8_dallas_update(crc, store.read(addr + i)); }
+      return(uint8_t(~crc));
+      }
+
+    // Write a record at offset off in the bank at start; returns false if it fails to read back.
+    bool writeRecord(const uint8_t start, const uint8_t off, const uint8_t key, const uint8_t *const value, const uint8_t len)
+      {
+      const uint16_t addr = uint16_t(start) + off;
+      uint8_t crc = crc8_dallas_update(crc8_dallas_update(0, key), len);
+      bool ok = store.write(addr + 1, len);
+      for(uint8_t i = 0; i < len; ++i)
+        {
+        ok = store.write(addr + 2 + i, value[i]) && ok;
+        crc = crc8_dallas_update(crc, value[i]);
+        }
+      ok = store.write(addr + 2 + len, uint8_t(~crc)) && ok;
+      // Write the key last so that a record is not seen until complete.
+      ok = store.write(addr, key) && ok;
+      return(ok);
+      }
+
+    // Scan the active bank to rebuild the RAM index and find the free space.
+    void scan()
+      {
+      memset(index, 0, sizeof(index));
+      uint8_t off = headerBytes;
+      while(off + recordOverhead <= bankSize)
+        {
+        const uint16_t addr = uint16_t(active) + off;
+        const uint8_t key = store.read(addr);
+        if(0xff == key) { break; } // Free space.
+        const uint8_t len = store.read(addr + 1);
+        // Torn or corrupt record: leave no usable free space to force compaction.
+        if((len > maxValueLen) || (off + recordOverhead + len > bankSize) ||
+           (store.read(addr + 2 + len) != computeRecordCRC(addr, len)))
+          { off = bankSize; break; }
+        if(key < maxKeys) { index[key] = (0 == len) ? 0 : off; }
+        off = uint8_t(off + recordOverhead + len);
+        }
+      tail = off;
+      }
+
+    // Erase the whole bank at start.
+    bool eraseBank(const uint8_t start)
+      {
+      bool ok = true;
+      for(uint8_t i = 0; i < bankSize; ++i) { ok = store.erase(uint16_t(start) + i) && ok; }
+      return(ok);
+      }
+
+    // Copy live records into the other bank and make it active.
+    // The record about to be superseded is kept so that it survives a reset before the append.
+    // Returns false if the copy failed, leaving the old bank active.
+    bool compact()
+      {
+      const uint8_t other = (0 == active) ? bankSize : 0;
+      if(!eraseBank(other)) { return(false); }
+      uint8_t newIndex[maxKeys];
+      memset(newIndex, 0, sizeof(newIndex));
+      uint8_t off = headerBytes;
+      for(uint8_t k = 0; k < maxKeys; ++k)
+        {
+        if(0 == index[k]) { continue; }
+        uint8_t buf[maxValueLen];
+        const int8_t len = get(k, buf, maxValueLen);
+        if(len <= 0) { continue; }
+        if(!writeRecord(other, off, k, buf, uint8_t(len))) { return(false); }
+        newIndex[k] = off;
+        off = uint8_t(off + recordOverhead + len);
+        }
+      // Commit by writing the new header, inverse last.
+      const uint8_t g = uint8_t(generation + 1);
+      if(!store.write(other, g) || !store.write(uint16_t(other) + 1, uint8_t(~g))) { return(false); }
+      active = other;
+      generation = g;
+      tail = off;
+      memcpy(index, newIndex, sizeof(index));
+      ++compactions;
+      return(true);
+      }
+
+    // Append a record, compacting first if need be.
+    bool append(const uint8_t key, const uint8_t *const value, const uint8_t len)
+      {
+      const uint8_t need = uint8_t(recordOverhead + len);
+      if(tail + need > bankSize)
+        {
+        if(!compact()) { return(false); }
+        if(tail + need > bankSize) { return(false); }
+        }
+      const uint8_t off = tail;
+      // Advance past even a failed write, which will not be read back.
+      tail = uint8_t(tail + need);
+      if(!writeRecord(active, off, key, value, len)) { return(false); }
+      index[key] = (0 == len) ? 0 : off;
+      return(true);
+      }
+
+  public:
+    // Create a journal over the whole of the given store; call begin() before use.
+    explicit NVKVJournal(NVByteBackingStoreBase &_store)
+      : store(_store), bankSize(computeBankSize(_store))
+      { memset(index, 0, sizeof(index)); }
+
+    // Find the active bank and rebuild the RAM index.
+    // If neither bank is valid (eg fresh storage) this formats the store.
+    // Returns true if existing journal contents were found.
+    bool begin()
+      {
+      compactions = 0;
+      const bool v0 = isValidBank(0);
+      const bool v1 = isValidBank(bankSize);
+      if(!v0 && !v1)
+        {
+        // Format: first write is of generation 0 into bank 0.
+        eraseBank(0);
+        eraseBank(bankSize);
+        active = 0;
+        generation = 0;
+        store.write(0, 0);
+        store.write(1, 0xff);
+        memset(index, 0, sizeof(index));
+        tail = headerBytes;
+        return(false);
+        }
+      const uint8_t g0 = store.read(0);
+      const uint8_t g1 = store.read(bankSize);
+      // With two banks the generations differ by one, modulo 256.
+      const bool use1 = v1 && (!v0 || (int8_t(g1 - g0) > 0));
+      active = use1 ? bankSize : 0;
+      generation = use1 ? g1 : g0;
+      scan();
+      return(true);
+      }
+
+    // Get the value for key into buf of bufLen bytes.
+    // Returns the value length, or -1 if not present or buf is too small.
+    int8_t get(const uint8_t key, uint8_t *const buf, const uint8_t bufLen) const
+      {
+      if((key >= maxKeys) || (0 == index[key])) { return(-1); }
+      const uint16_t addr = uint16_t(active) + index[key];
+      const uint8_t len = store.read(addr + 1);
+      if(len > bufLen) { return(-1); }
+      for(uint8_t i = 0; i < len; ++i) { buf[i] = store.read(addr + 2 + i); }
+      return(int8_t(len));
+      }
+
+    // Set the value for key; a no-op if the value is unchanged.
+    // Returns false if the key or length is invalid or the write failed.
+    bool put(const uint8_t key, const uint8_t *const value, const uint8_t len)
+      {
+      if((key >= maxKeys) || (0 == len) || (len > maxValueLen) || (NULL == value)) { return(false); }
+      uint8_t old[maxValueLen];
+      if((len == get(key, old, maxValueLen)) && (0 == memcmp(old, value, len))) { return(true); }
+      return(append(key, value, len));
+      }
+
+    // Delete the value for key; a no-op if not present.
+    bool remove(const uint8_t key)
+      {
+      if(key >= maxKeys) { return(false); }
+      if(0 == index[key]) { return(true); }
+      return(append(key, NULL, 0));
+      }
+
+    // True if a value is present for key.
+    bool contains(const uint8_t key) const { return((key < maxKeys) && (0 != index[key])); }
+    // Free bytes left in the active bank before compaction is needed.
+    uint8_t freeBytes() const { return(uint8_t(bankSize - tail)); }
+    // Generation of the active bank; increments (modulo 256) at each compaction.
+    uint8_t getGeneration() const { return(generation); }
+    // Compactions since begin().
+    uint16_t getCompactions() const { return(compactions); }
+  };
+
+
+}
+#endif
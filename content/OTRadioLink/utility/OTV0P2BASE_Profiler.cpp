@@ -0,0 +1,173 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * Lightweight hot-path profiler with scoped probes.
+ */
+
+#include <string.h>
+
+#include "OTV0P2BASE_Profiler.h"
+#include "OTV0P2BASE_Concurrency.h"
+#include "OTV0P2BASE_Sleep.h"
+
+#if !defined(OTV0P2BASE_PROFILER_TIME_SCT) && !defined(ARDUINO) && !defined(__arm__)
+#include <chrono>
+#define OTV0P2BASE_PROFILER_TIME_NS
+#endif
+
+
+namespace OTV0P2BASE
+{
+
+
+// Default profiler time source.
+uint32_t getProfilerTime()
+    {
+#if defined(OTV0P2BASE_PROFILER_TIME_SCT)
+    return(getSubCycleTime());
+#elif defined(OTV0P2BASE_PROFILER_TIME_NS)
+    return(uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count()));
+#else
+    return(0);
+#endif
+    }
+
+constexpr uint8_t ProfilerBase::BINARY_VERSION;
+constexpr uint8_t ProfilerBase::BINARY_SITE_BYTES;
+
+// Clear all statistics.
+void ProfilerBase::reset()
+    {
+#ifdef ARDUINO_ARCH_AVR
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#endif
+        {
+        memset(sites, 0, nSites * sizeof(site_t));
+        }
+#ifdef ARDUINO_ARCH_AVR
+    stackBase = RAMEND;
+#else
+    if(0 == stackBase) { stackBase = getSP(); }
+#endif
+    }
+
+// Record one completed call at a site.
+void ProfilerBase::record(const uint8_t site, const uint32_t startTime, const uint16_t stack)
+    {
+    const uint32_t d = (now() - startTime) & timeMask;
+    if(site >= nSites) { return; }
+#ifdef ARDUINO_ARCH_AVR
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#endif
+        {
+        site_t &s = sites[site];
+        if((0 == s.calls) || (d < s.minDur)) { s.minDur = d; }
+        if(d > s.maxDur) { s.maxDur = d; }
+        if(stack > s.maxStack) { s.maxStack = stack; }
+        if(0xffffffffUL != s.calls) { ++s.calls; }
+        s.total = (d > 0xffffffffUL - s.total) ? 0xffffffffUL : (s.total + d);
+        }
+    }
+
+// Snapshot of stats for one site.
+ProfilerBase::site_t ProfilerBase::getSite(const uint8_t site) const
+    {
+    site_t s;
+    if(site >= nSites) { memset(&s, 0, sizeof(s)); return(s); }
+#ifdef ARDUINO_ARCH_AVR
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#endif
+        {
+        s = sites[site];
+        }
+    return(s);
+    }
+
+// Print a compact JSON report of all sites.
+size_t ProfilerBase::printJSON(Print &p) const
+    {
+    size_t n = p.print('{');
+    // Units are only known for the default time source.
+    if(getProfilerTime == timeFn)
+        {
+#if defined(OTV0P2BASE_PROFILER_TIME_SCT)
+        n += p.print(F("\"u\":\"sct\","));
+#elif defined(OTV0P2BASE_PROFILER_TIME_NS)
+        n += p.print(F("\"u\":\"ns\","));
+#endif
+        }
+    n += p.print(F("\"prof\":{"));
+    for(uint8_t i = 0; i < nSites; ++i)
+        {
+        const site_t s = getSite(i);
+        if(0 != i) { n += p.print(','); }
+        n += p.print('"');
+        n += p.print(names[i]);
+        n += p.print(F("\":["));
+        n += p.print((unsigned long)s.calls);
+        n += p.print(',');
+        n += p.print((unsigned long)s.minDur);
+        n += p.print(',');
+        n += p.print((unsigned long)s.maxDur);
+        n += p.print(',');
+        n += p.print((unsigned long)s.total);
+        n += p.print(',');
+        n += p.print((unsigned long)s.maxStack);
+        n += p.print(']');
+        }
+    n += p.print(F("}}"));
+    return(n);
+    }
+
+// Append a little-endian uint32_t.
+static uint8_t *putLE32(uint8_t *b, const uint32_t v)
+    {
+    *b++ = uint8_t(v); *b++ = uint8_t(v >> 8); *b++ = uint8_t(v >> 16); *b++ = uint8_t(v >> 24);
+    return(b);
+    }
+
+// Write a compact binary report into buf.
+uint8_t ProfilerBase::writeBinary(uint8_t *const buf, const uint8_t bufLen) const
+    {
+    const uint16_t needed = 2 + uint16_t(nSites) * BINARY_SITE_BYTES;
+    if((NULL == buf) || (needed > bufLen)) { return(0); }
+    uint8_t *b = buf;
+    *b++ = BINARY_VERSION;
+    *b++ = nSites;
+    for(uint8_t i = 0; i < nSites; ++i)
+        {
+        const site_t s = getSite(i);
+        b = putLE32(b, s.calls);
+        b = putLE32(b, s.minDur);
+        b = putLE32(b, s.maxDur);
+        b = putLE32(b, s.total);
+        *b++ = uint8_t(s.maxStack);
+        *b++ = uint8_t(s.maxStack >> 8);
+        }
+    return(uint8_t(needed));
+    }
+
+// Profiler to report from; NULL if none.
+static ProfilerBase *globalProfiler;
+void setGlobalProfiler(ProfilerBase *const p) { globalProfiler = p; }
+ProfilerBase *getGlobalProfiler() { return(globalProfiler); }
+
+
+}
@@ -0,0 +1,219 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * Lightweight hot-path profiler with scoped probes.
+ *
+ * Records per-site call counts, min/max/total duration
+ * and stack high-water, and reports them as JSON or compact binary.
+ *
+ * Portable: durations are in sub-cycle ticks on V0p2 (AVR) hardware,
+ * and in nanoseconds on host builds.
+ */
+
+#ifndef ARDUINO_LIB_OTV0P2BASE_PROFILER_H
+#define ARDUINO_LIB_OTV0P2BASE_PROFILER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include "utility/OTV0P2BASE_ArduinoCompat.h"
+#endif
+
+#include "OTV0P2BASE_Util.h"
+
+
+namespace OTV0P2BASE
+{
+
+
+// Default profiler time source.
+// Sub-cycle ticks (wrapping at 256) where available, else nanoseconds (wrapping at 2^32) on host.
+// Always 0 on other platforms.
+uint32_t getProfilerTime();
+#if defined(ARDUINO_ARCH_AVR) || (defined(EFR32FG1P133F256GM48) && defined(V0P2BASE_SYSTICK_EMULATED_SUBCYCLE))
+#define OTV0P2BASE_PROFILER_TIME_SCT
+static constexpr uint32_t PROFILER_TIME_MASK = 0xff;
+#else
+static constexpr uint32_t PROFILER_TIME_MASK = 0xffffffff;
+#endif
+
+// Non-templated profiler core, so that reports and probes need not know the site count.
+// Sites are small integers [0,nSites-1], usually from an enum,
+// each named by an entry in a caller-supplied table of static strings,
+// eg { "loop", "pollIO", "rxSec", "statsTX" }.
+//
+// A duration is the time between probe entry and exit;
+// on AVR this must be under one major cycle (256 sub-cycle ticks) to be measured correctly.
+// Stack high-water is the depth below the stack base at probe entry.
+//
+// Counts and totals saturate rather than wrap.
+// Recording is ISR-safe on AVR; reports are not atomic across sites.
+class ProfilerBase
+  {
+  public:
+    // Per-site statistics.
+    struct site_t
+      {
+      // Calls completed since the last reset.
+      uint32_t calls;
+      // Sum of durations, saturating.
+      uint32_t total;
+      // Shortest duration; 0 if no calls.
+      uint32_t minDur;
+      // Longest duration.
+      uint32_t maxDur;
+      // Deepest stack use seen at entry, bytes.
+      uint16_t maxStack;
+      };
+
+    // Time source type.
+    typedef uint32_t (*time_fn_t)();
+
+    // Version byte at the start of the binary report.
+    static constexpr uint8_t BINARY_VERSION = 1;
+    // Bytes per site in the binary report.
+    static constexpr uint8_t BINARY_SITE_BYTES = 18;
+
+  protected:
+    // Per-site storage supplied by the derived class.
+    site_t *const sites;
+    // Number of sites.
+    const uint8_t nSites;
+    // Site names; nSites entries of static storage.
+    const char *const *const names;
+    // Time source and wrap mask.
+    const time_fn_t timeFn;
+    const uint32_t timeMask;
+    // Stack base against which stack use is measured.
+    size_t stackBase;
+
+    constexpr ProfilerBase(site_t *const _sites, const uint8_t _nSites,
+                           const char *const *const _names,
+                           const time_fn_t _timeFn, const uint32_t _timeMask)
+      : sites(_sites), nSites(_nSites), names(_names),
+        timeFn(_timeFn), timeMask(_timeMask), stackBase(0) { }
+
+  public:
+    // Clear all statistics, and take the stack base from RAMEND on AVR or the caller's frame elsewhere.
+    void reset();
+    // Set the stack base explicitly, eg from the top of main() on a host.
+    void setStackBase(const size_t base) { stackBase = base; }
+
+    // Take a timestamp for a probe entry.
+    uint32_t now() const { return(timeFn()); }
+    // Stack depth in bytes at the caller, relative to the stack base; 0 if above it.
+    uint16_t stackDepth() const
+      {
+      const size_t sp = getSP();
+      if(sp >= stackBase) { return(0); }
+      const size_t d = stackBase - sp;
+      return((d > 0xffff) ? 0xffff : uint16_t(d));
+      }
+    // Record one completed call at a site; ISR-safe.
+    // Out-of-range sites are ignored.
+    void record(uint8_t site, uint32_t startTime, uint16_t stack);
+
+    // Number of sites.
+    uint8_t getSites() const { return(nSites); }
+    // Site name; NULL if out of range.
+    const char *getName(const uint8_t site) const { return((site < nSites) ? names[site] : NULL); }
+    // Snapshot of stats for one site; all zero if out of range.
+    site_t getSite(uint8_t site) const;
+
+    // Print a compact JSON report of all sites, eg
+    //   {"u":"ns","prof":{"loop":[calls,min,max,total,stack],...}}
+    // where "u" is "sct" for sub-cycle ticks or "ns" for nanoseconds.
+    // Returns the number of characters printed.
+    size_t printJSON(Print &p) const;
+
+    // Write a compact binary report into buf; returns bytes written, or 0 if buf too small.
+    // Layout: version, site count, then per site in order
+    // calls, min, max, total (uint32_t each) and stack (uint16_t), all little-endian.
+    // Needs 2 + nSites * BINARY_SITE_BYTES bytes.
+    uint8_t writeBinary(uint8_t *buf, uint8_t bufLen) const;
+
+    // Put the longest duration of each site into a stats set (eg SimpleStatsRotation)
+    // keyed by site name, clamped to the int16_t range.
+    template<class stats_t>
+    void putMaxDurations(stats_t &stats, const bool lowPriority = true) const
+      {
+      for(uint8_t i = 0; i < nSites; ++i)
+        {
+        const uint32_t m = getSite(i).maxDur;
+        stats.put(names[i], int16_t((m > 0x7fff) ? 0x7fff : m), lowPriority);
+        }
+      }
+  };
+
+// Profiler with storage for siteCount sites.
+template<uint8_t siteCount>
+class Profiler final : public ProfilerBase
+  {
+  private:
+    site_t storage[siteCount];
+
+  public:
+    // Names must have siteCount entries and be of static storage.
+    Profiler(const char *const (&_names)[siteCount],
+             const time_fn_t _timeFn = getProfilerTime,
+             const uint32_t _timeMask = PROFILER_TIME_MASK)
+      : ProfilerBase(storage, siteCount, _names, _timeFn, _timeMask)
+      { reset(); }
+  };
+
+// Scoped probe: records the time and stack depth from construction to destruction at a site.
+class ProfileProbe final
+  {
+  private:
+    ProfilerBase &p;
+    const uint32_t start;
+    const uint16_t stack;
+    const uint8_t site;
+
+  public:
+    ProfileProbe(ProfilerBase &_p, const uint8_t _site)
+      : p(_p), start(_p.now()), stack(_p.stackDepth()), site(_site) { }
+    ~ProfileProbe() { p.record(site, start, stack); }
+    ProfileProbe(const ProfileProbe &) = delete;
+    ProfileProbe &operator=(const ProfileProbe &) = delete;
+  };
+
+// Set or get a profiler to report from, eg on watchdog timeout; NULL if none.
+void setGlobalProfiler(ProfilerBase *p);
+ProfilerBase *getGlobalProfiler();
+
+// Profile the rest of the enclosing scope at the given site.
+// Compiles to nothing unless OTV0P2BASE_PROFILING is defined,
+// so probes can be left in hot paths of production builds.
+#ifdef OTV0P2BASE_PROFILING
+#define OTV0P2BASE_PROFILE_CAT_(a, b) a ## b
+#define OTV0P2BASE_PROFILE_CAT(a, b) OTV0P2BASE_PROFILE_CAT_(a, b)
+#define OTV0P2BASE_PROFILE_SCOPE(profiler, site) \
+    OTV0P2BASE::ProfileProbe OTV0P2BASE_PROFILE_CAT(_profileProbe, __LINE__)((profiler), (site))
+#else
+#define OTV0P2BASE_PROFILE_SCOPE(profiler, site)
+#endif
+
+
+}
+
+#endif // ARDUINO_LIB_OTV0P2BASE_PROFILER_H
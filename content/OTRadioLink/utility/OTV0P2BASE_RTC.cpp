@@ -95,8 +95,23 @@ volatile uint_least16_t _daysSince1999LT;
 // though it will simply return relatively quickly from redundant calls.
 // The RTC data is stored so as not to wear out AVR EEPROM for at least several years.
 // IMPLEMENTATION OF THIS AND THE eeprom_smart_xxx_byte() ROUTINES IS CRITICAL TO PERFORMANCE AND LONGEVITY.
+//
+// If V0P2BASE_RTC_PERSIST_IN_JOURNAL is defined then the day and quarter-hour
+// are instead appended to the wear-levelled EEPROM journal at each change,
+// so no byte sees an erase for each hour, only one per journal compaction.
 void persistRTC()  // TODO Work out emulated EEPROM on EFR32
   {
+#ifdef V0P2BASE_RTC_PERSIST_IN_JOURNAL
+  uint8_t v[3];
+  ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+    {
+    v[0] = uint8_t(_daysSince1999LT);
+    v[1] = uint8_t(_daysSince1999LT >> 8);
+    v[2] = uint8_t(_minutesSinceMidnightLT / 15);
+    }
+  // Does nothing if the persisted value is already up to date.
+  getEEPROMJournal().put(V0P2BASE_EE_JOURNAL_KEY_RTC, v, sizeof(v));
+#else
   ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
     {
     uint8_t quarterHours = (_minutesSinceMidnightLT / 15);
@@ -127,6 +142,7 @@ void persistRTC()  // TODO Work out emulated EEPROM on EFR32
       if(days != _daysSince1999LT) { eeprom_write_word((uint16_t*)V0P2BASE_EE_START_RTC_DAY_PERSIST, _daysSince1999LT); }
       }
     }
+#endif // V0P2BASE_RTC_PERSIST_IN_JOURNAL
   }
 #else
 // Stub for integration tests
@@ -141,6 +157,18 @@ void persistRTC() {}
 // This restores the minutes and above but leaves seconds unset.
 bool restoreRTC()    // TODO Work out emulated EEPROM on EFR32
   {
+#ifdef V0P2BASE_RTC_PERSIST_IN_JOURNAL
+  uint8_t v[3];
+  if(3 != getEEPROMJournal().get(V0P2BASE_EE_JOURNAL_KEY_RTC, v, sizeof(v))) { return(false); }
+  if(v[2] >= 24*4) { return(false); } // Invalid quarter-hour.
+  ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+    {
+    _daysSince1999LT = uint_least16_t(v[0] | (uint_least16_t(v[1]) << 8));
+    // Start just over half-way into the quarter hour as for the non-journal version.
+    _minutesSinceMidnightLT = uint_least16_t(v[2]) * 15 + 8;
+    }
+  return(true);
+#else
   uint8_t persistedValue;
   ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
     {
@@ -173,6 +201,7 @@ bool restoreRTC()    // TODO Work out emulated EEPROM on EFR32
     { _minutesSinceMidnightLT = minutesSinceMidnight; }
 
   return(true);
+#endif // V0P2BASE_RTC_PERSIST_IN_JOURNAL
   }
 #else
 // Stub for integration tests
@@ -220,7 +249,7 @@ uint_least16_t getDaysSince1999LT()
     { result = _daysSince1999LT; }
   return(result);
   }
-#elif defined(__arm__) // XXX
+#else // Also host, eg for virtual-time simulation.
 // Get whole days since the start of 2000/01/01 (ie the midnight between 1999 and 2000), local time.
 // This will roll in about 2179, by which time I will not care.
 // This is a single cycle access on ARM.
@@ -356,25 +385,15 @@ ISR(TIMER2_OVF_vect)
     {
     if(_RTCWatchdogResetNotCalled) {
 #if defined(WDT_DEBUG)
-		uint8_t startTime[OTV0P2BASE::MemoryChecks::timeTableSize];
-		uint8_t duration[OTV0P2BASE::MemoryChecks::timeTableSize];
-        // Notify that the watchdog has been triggered.
-        OTV0P2BASE::MemoryChecks::getTimeTable(startTime, duration);
+        // Print via the flushing serial routines.
+        class SerialFlushPrint final : public Print
+          { public: virtual size_t write(const uint8_t c) override { OTV0P2BASE::serialPrintAndFlush(char(c)); return(1); } };
+        SerialFlushPrint sp;
+        // Notify that the watchdog has been triggered, with any profile of where the time went.
+        OTV0P2BASE::ProfilerBase *const prof = OTV0P2BASE::getGlobalProfiler();
         while(true) {
             OTV0P2BASE::serialPrintlnAndFlush(F("!WD"));
-            OTV0P2BASE::serialPrintlnAndFlush();
-            OTV0P2BASE::serialPrintAndFlush(F("stt: "));
-            for (uint8_t *ip = startTime; ip != startTime + sizeof(startTime); ++ip) {
-                OTV0P2BASE::serialPrintAndFlush(*ip);
-                OTV0P2BASE::serialPrintAndFlush(F("\t"));
-            }
-            OTV0P2BASE::serialPrintlnAndFlush();
-            OTV0P2BASE::serialPrintAndFlush(F("dur: "));
-            for (uint8_t *ip = duration; ip != duration + sizeof(duration); ++ip) {
-                OTV0P2BASE::serialPrintAndFlush(*ip);
-                OTV0P2BASE::serialPrintAndFlush(F("\t"));
-            }
-            OTV0P2BASE::serialPrintlnAndFlush();
+            if(NULL != prof) { prof->printJSON(sp); OTV0P2BASE::serialPrintlnAndFlush(); }
             delay(1000);
         }
 #else
@@ -382,7 +401,6 @@ ISR(TIMER2_OVF_vect)
 #endif
     }
     _RTCWatchdogResetNotCalled = true;
-    OTV0P2BASE::MemoryChecks::resetCallTable();
     }
   }
 #endif // ARDUINO_ARCH_AVR
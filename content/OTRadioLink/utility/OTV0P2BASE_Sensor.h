@@ -114,6 +114,24 @@ class Sensor : public SensorCore<T>
     // only as required to fetch new values from the underlying sensor.
     virtual uint8_t preferredPollInterval_s() const { return(0); }
 
+    // Optional split-phase (start/collect) alternative to read()
+    // for sensors with slow conversions,
+    // so that several sensors can be converting at once
+    // while the caller gets on with other work (eg listening for RX),
+    // with all the results then being collected in one pass.
+    //   * startRead() starts a conversion and returns promptly,
+    //     or returns false if a conversion could not be started (eg no sensor present).
+    //   * isReady() returns true once the conversion is complete, and may be polled;
+    //     it may do some (quick) I/O so should not be called from an ISR.
+    //   * collect() fetches the result, returning it as read() would, and updating get();
+    //     it waits (boundedly) if the conversion is not yet complete.
+    // The bus used by a sensor should not otherwise be used between its startRead() and collect().
+    // The defaults suit sensors with fast or no conversions:
+    // startRead() does nothing, isReady() is always true, and collect() calls read().
+    virtual bool startRead() { return(true); }
+    virtual bool isReady() { return(true); }
+    virtual T collect() { return(read()); }
+
 //    // Returns a suggested privacy/sensitivity level of the data from this sensor.
 //    // The default sensitivity is set to just forbid transmission at default (255) leaf settings.
 //    virtual uint8_t sensitivity() const { return(254 /* stTXsecOnly */ ); }
@@ -30,6 +30,7 @@ Author(s) / Copyright (s): Damon Hart-Davis 2013--2018
 #include "OTV0P2BASE_SensorAmbientLightOccupancy.h"
 #include "OTV0P2BASE_ADC.h"
 #include "OTV0P2BASE_Entropy.h"
+#include "OTV0P2BASE_SlidingWindowMinMax.h"
 
 
 namespace OTV0P2BASE
@@ -128,10 +129,71 @@ class SensorAmbientLightBase : public SimpleTSUint8Sensor
     bool isRangeTooNarrow() const { return(rangeTooNarrow); }
   };
 
+// Sliding window of hourly mean light levels, fed from read() once per minute.
+// Provides the min and max over the last windowHours hours,
+// once at least a day (or the whole window if shorter) has been seen.
+// Also holds the mean and sensitivity last passed to setTypMinMax().
+template <uint8_t windowHours>
+class SensorAmbientLightHourlyWindow final
+  {
+  private:
+    // Hours needed before the window min/max are used.
+    static constexpr uint8_t minHours = (windowHours < 24) ? windowHours : 24;
+    SlidingWindowMinMax<windowHours> w;
+    // Sum and count of reads this hour.
+    uint16_t sum;
+    uint8_t reads;
+    uint8_t meanNowOrFF;
+    bool sensitive;
+  public:
+    constexpr SensorAmbientLightHourlyWindow() : w(), sum(0), reads(0), meanNowOrFF(0xff), sensitive(false) { }
+    void reset() { w.reset(); sum = 0; reads = 0; meanNowOrFF = 0xff; sensitive = false; }
+    // Note one read; returns true if the usable min or max changed.
+    bool sample(const uint8_t value)
+      {
+      sum += value;
+      if(++reads < 60) { return(false); }
+      const uint8_t mean = uint8_t(sum / reads);
+      sum = 0;
+      reads = 0;
+      const bool changed = w.push(mean);
+      return(isReady() && (changed || (w.size() == minHours)));
+      }
+    bool isReady() const { return(w.size() >= minHours); }
+    uint8_t getMin() const { return(w.getMin()); }
+    uint8_t getMax() const { return(w.getMax()); }
+    void setParams(const uint8_t m, const bool s) { meanNowOrFF = m; sensitive = s; }
+    uint8_t getMeanNowOrFF() const { return(meanNowOrFF); }
+    bool getSensitive() const { return(sensitive); }
+  };
+// No window: min/max come only from setTypMinMax().
+template <>
+class SensorAmbientLightHourlyWindow<0> final
+  {
+  public:
+    constexpr SensorAmbientLightHourlyWindow() { }
+    void reset() { }
+    bool sample(uint8_t) { return(false); }
+    bool isReady() const { return(false); }
+    uint8_t getMin() const { return(0xff); }
+    uint8_t getMax() const { return(0xff); }
+    void setParams(uint8_t, bool) { }
+    uint8_t getMeanNowOrFF() const { return(0xff); }
+    bool getSensitive() const { return(false); }
+  };
+
 // Accepts stats updates to adapt better to the location fitted.
 // Also supports occupancy sensing and callbacks for reporting it.
 // Parameterise with any SensorAmbientLightOccupancyDetectorInterface.
-template <class occupancyDetector_t = SensorAmbientLightOccupancyDetectorSimple>
+//
+// If windowHours is non-zero then the sensor also tracks the min and max
+// hourly mean light level over the last windowHours hours itself
+// (at 4*windowHours + ~12 bytes of RAM),
+// and uses those in place of the min/max passed to setTypMinMax()
+// once it has seen a day's worth (or the whole window if shorter),
+// recomputing thresholds as soon as either extreme changes.
+// read() should then be called once per minute.
+template <class occupancyDetector_t = SensorAmbientLightOccupancyDetectorSimple, uint8_t windowHours = 0>
 class SensorAmbientLightAdaptiveTBase : public SensorAmbientLightBase
   {
   public:
@@ -169,6 +231,25 @@ class SensorAmbientLightAdaptiveTBase : public SensorAmbientLightBase
     uint8_t darkThreshold =
         SensorAmbientLightBase::DEFAULT_LIGHT_THRESHOLD-DEFAULT_upDelta;
 
+    // Sliding window of hourly means; empty if windowHours is 0.
+    SensorAmbientLightHourlyWindow<windowHours> window;
+
+    // Sets rollingMin/Max and thresholds, and passes them to the occupancy detector.
+    void applyTypMinMax(const uint8_t meanNowOrFF,
+            const uint8_t minOrFF, const uint8_t maxOrFF,
+            const bool sensitive)
+      {
+      rollingMin = minOrFF;
+      rollingMax = maxOrFF;
+
+      recomputeThresholds(meanNowOrFF, sensitive);
+
+      // Pass on appropriate properties to the occupancy detector.
+      occupancyDetector.setTypMinMax(meanNowOrFF,
+          minOrFF, maxOrFF,
+          sensitive);
+      }
+
     // Recomputes thresholds and 'rangeTooNarrow' based on current state.
     //   * meanNowOrFF  typical/mean light level around this time
     //     each 24h; 0xff if not known.
@@ -251,7 +332,7 @@ class SensorAmbientLightAdaptiveTBase : public SensorAmbientLightBase
     // DHD20190506: resetAdaptive() should always have been reset()
     //     else insufficiently cleared (the plug-in occupancy detector)
     //     but will be left for benefit of explicit callers.
-    void resetAdaptive() { SensorAmbientLightBase::reset(); occCallbackOpt = NULL; setTypMinMax(0xff, 0xff, 0xff, false); occupancyDetector.reset(); }
+    void resetAdaptive() { SensorAmbientLightBase::reset(); occCallbackOpt = NULL; window.reset(); setTypMinMax(0xff, 0xff, 0xff, false); occupancyDetector.reset(); }
     virtual void reset() override { resetAdaptive(); }
 
     // Get light threshold, above which the room is considered light enough for activity [1,254].
@@ -276,25 +357,34 @@ class SensorAmbientLightAdaptiveTBase : public SensorAmbientLightBase
     //         0xff if not known.
     //   * sensitive  if true be more sensitive to occupancy changes,
     //         which may mean more false +ves and less energy saving
+    // With a sliding window (windowHours non-zero) that is ready,
+    // the window's min and max are used in place of those passed in.
     void setTypMinMax(const uint8_t meanNowOrFF,
             const uint8_t longerTermMinimumOrFF, const uint8_t longerTermMaximumOrFF,
             const bool sensitive)
       {
-      rollingMin = longerTermMinimumOrFF;
-      rollingMax = longerTermMaximumOrFF;
-
-      recomputeThresholds(meanNowOrFF, sensitive);
-
-      // Pass on appropriate properties to the occupancy detector.
-      occupancyDetector.setTypMinMax(meanNowOrFF,
-          longerTermMinimumOrFF, longerTermMaximumOrFF,
-          sensitive);
+      window.setParams(meanNowOrFF, sensitive);
+      if(window.isReady())
+        { applyTypMinMax(meanNowOrFF, window.getMin(), window.getMax(), sensitive); }
+      else
+        { applyTypMinMax(meanNowOrFF, longerTermMinimumOrFF, longerTermMaximumOrFF, sensitive); }
       }
 
+    // Min and max hourly mean over the sliding window; 0xff if none or no window.
+    uint8_t getWindowMin() const { return(window.getMin()); }
+    uint8_t getWindowMax() const { return(window.getMax()); }
+
     // Updates other values based on what is in value.
     // Derived classes may wish to set value first, then call this.
     virtual uint8_t read() override
         {
+        // Recompute thresholds only when an extreme of the sliding window changes.
+        if(window.sample(value))
+            {
+            applyTypMinMax(window.getMeanNowOrFF(),
+                window.getMin(), window.getMax(), window.getSensitive());
+            }
+
         // Adjust room-lit flag, with hysteresis.
         // Should be able to detect dark when darkThreshold is zero and newValue is zero.
         const bool definitelyLit = (value > lightThreshold);
@@ -353,8 +443,8 @@ class SensorAmbientLightAdaptiveMock : public SensorAmbientLightAdaptive
 
 
 #ifdef ARDUINO_ARCH_AVR
-template <uint8_t lightSensorADCChannel, class occupancyDetector_t = SensorAmbientLightOccupancyDetectorSimple>
-class SensorAmbientLightConfigurable final : public SensorAmbientLightAdaptiveTBase<occupancyDetector_t>
+template <uint8_t lightSensorADCChannel, class occupancyDetector_t = SensorAmbientLightOccupancyDetectorSimple, uint8_t windowHours = 0>
+class SensorAmbientLightConfigurable final : public SensorAmbientLightAdaptiveTBase<occupancyDetector_t, windowHours>
 {
 private:
 public:
@@ -409,7 +499,7 @@ public:
         this->value = newValue;
 
         // Have base class update other/derived values.
-        SensorAmbientLightAdaptiveTBase<occupancyDetector_t>::read();
+        SensorAmbientLightAdaptiveTBase<occupancyDetector_t, windowHours>::read();
 
 #if 0 && defined(DEBUG)
         DEBUG_SERIAL_PRINT_FLASHSTRING("Ambient light (/1023): ");
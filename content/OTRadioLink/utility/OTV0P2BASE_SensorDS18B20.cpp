@@ -23,7 +23,11 @@ Author(s) / Copyright (s): Damon Hart-Davis 2014--2017
  DS18B20 OneWire(TM) temperature sensor.
  */
 
+#include <string.h>
+
 #include "OTV0P2BASE_SensorDS18B20.h"
+#include "OTV0P2BASE_CRC.h"
+#include "OTV0P2BASE_Sleep.h"
 
 
 #if defined(TemperatureC16_DS18B20_DEFINED)
@@ -65,6 +69,7 @@ namespace OTV0P2BASE
 // Returns true iff successful.
 // Uses specified order DS18B20 found on bus.
 // May need to be reinitialised if precision changed.
+// Revalidates the cached probes if possible, else does a full search.
 bool TemperatureC16_DS18B20::init()
   {
 #if 0 && defined(DEBUG)
@@ -72,6 +77,14 @@ bool TemperatureC16_DS18B20::init()
   DEBUG_SERIAL_PRINTLN();
 #endif
 
+  // Avoid a full search if the probes found last time are all still there.
+  if(cacheValid && revalidate())
+    {
+    initialised = true;
+    return(true);
+    }
+  suspectProbes = 0;
+
   bool found = false;
   uint8_t count = 0;
   uint8_t address[8];
@@ -100,21 +113,20 @@ bool TemperatureC16_DS18B20::init()
       continue;
       }
 
+    // Ignore a corrupted ROM ID.
+    if(0 != crc8_dallas(address, 8)) { continue; }
+
     // Found one and configured it!
     found = true;
+    // Cache the ROM ID of the first few to avoid searching on each read.
+    if(count < MAX_CACHED_PROBES) { memcpy(romCache[count], address, 8); }
     count++;
 
 #if 0 && defined(DEBUG)
     DEBUG_SERIAL_PRINTLN_FLASHSTRING("Setting precision...");
 #endif
 
-    minOW.reset();
-    // Write scratchpad/config.
-    minOW.select(address);
-    minOW.write(CMD_WRITE_SCRATCH);
-    minOW.write(0); // Th: not used.
-    minOW.write(0); // Tl: not used.
-    minOW.write(((precision - 9) << 5) | 0x1f); // Config register; lsbs all 1.
+    configure(address);
     }
 
 #if 0 && defined(DEBUG)
@@ -124,20 +136,46 @@ bool TemperatureC16_DS18B20::init()
 
   // Search has been run (whether DS18B20 was found or not).
   initialised = true;
+  cacheValid = found;
 
   sensorCount = count;
   return(found);
   }
 
+// Set the precision of the device with the given ROM ID.
+void TemperatureC16_DS18B20::configure(const uint8_t address[8])
+  {
+  minOW.reset();
+  // Write scratchpad/config.
+  minOW.select(address);
+  minOW.write(CMD_WRITE_SCRATCH);
+  minOW.write(0); // Th: not used.
+  minOW.write(0); // Tl: not used.
+  minOW.write(((precision - 9) << 5) | 0x1f); // Config register; lsbs all 1.
+  }
+
+// Confirm the suspect cached probes are still present.
+// The others have just been read successfully, which is validation enough.
+bool TemperatureC16_DS18B20::revalidate()
+  {
+  const uint8_t cached = getCachedProbeCount();
+  for(uint8_t i = 0; i < cached; ++i)
+    {
+    if(0 == (suspectProbes & (1U << i))) { continue; }
+    if(isErrorValue(readScratchpadTemp(romCache[i]))) { return(false); }
+    suspectProbes &= uint8_t(~(1U << i));
+    }
+  return(0 != cached);
+  }
+
 // Force a read/poll of temperature and return the value sensed in nominal units of 1/16 C.
 // At sub-maximum precision lsbits will be zero or undefined.
 // Expensive/slow.
 // Not thread-safe nor usable within ISRs (Interrupt Service Routines).
 int16_t TemperatureC16_DS18B20::read()
   {
-  if(1 == readMultiple(&value, 1)) { return(value); }
-  value = DEFAULT_INVALID_TEMP; 
-  return(DEFAULT_INVALID_TEMP);
+  startRead();
+  return(collect());
   }
 
 // Force a read/poll of temperature from multiple DS18B20 sensors; returns number of values read.
@@ -151,23 +189,124 @@ int16_t TemperatureC16_DS18B20::read()
 // At sub-maximum precision lsbits will be zero or undefined.
 // Expensive/slow.
 // Not thread-safe nor usable within ISRs (Interrupt Service Routines).
-uint8_t TemperatureC16_DS18B20::readMultiple(int16_t *const values, const uint8_t count, uint8_t index)
+uint8_t TemperatureC16_DS18B20::readMultiple(int16_t *const values, const uint8_t count, const uint8_t index)
   {
-  if(!initialised) { init(); }
-  if(0 == sensorCount) { return(0); }
+  if(!startRead()) { return(0); }
+  return(collectMultiple(values, count, index));
+  }
 
-  uint8_t sensor = 0;
+// Start a temperature conversion on all DS18B20s on the bus at once, and return promptly.
+// Returns false if no DS18B20 is present.
+bool TemperatureC16_DS18B20::startRead()
+  {
+  if(!initialised) { init(); }
+  if(0 == sensorCount) { return(false); }
 
-  // Start a temperature reading.
+  // Start a temperature reading on all devices.
   minOW.reset();
   minOW.skip();
   minOW.write(CMD_START_CONVO); // Start conversion without parasite power.
+  conversionPending = true;
+  return(true);
+  }
+
+// True once the conversion started by startRead() is complete on all DS18B20s.
+// While converting, a DS18B20 responds to read slots with 0, then with 1 when done.
+bool TemperatureC16_DS18B20::isReady()
+  {
+  if(!conversionPending) { return(true); }
+  return(0 != minOW.read_bit());
+  }
+
+// Collect the result of the conversion started by startRead() from the first DS18B20, as for read().
+int16_t TemperatureC16_DS18B20::collect()
+  {
+  if(1 == collectMultiple(&value, 1)) { return(value); }
+  value = DEFAULT_INVALID_TEMP;
+  return(DEFAULT_INVALID_TEMP);
+  }
 
+// Read the 9-byte scratchpad of the device with the given ROM ID into d.
+// Returns false if the CRC fails or no device responds.
+bool TemperatureC16_DS18B20::readScratchpad(const uint8_t address[8], uint8_t d[LOC_SCRATCHPAD_CRC + 1])
+  {
+  minOW.reset();
+  minOW.select(address);
+  minOW.write(CMD_READ_SCRATCH);
+  uint8_t crc = 0;
+  // An absent device reads as all 1s, which must also be rejected as the CRC would not catch it.
+  uint8_t allOnes = 0xff;
+  for(uint8_t i = 0; i <= LOC_SCRATCHPAD_CRC; ++i)
+    {
+    d[i] = minOW.read();
+    crc = crc8_dallas_update(crc, d[i]);
+    allOnes &= d[i];
+    }
+  // Terminate read and let DS18B20 go back to sleep.
+  minOW.reset();
+  // Residue is zero over data plus CRC when intact.
+  if((0 != crc) || (0xff == allOnes))
+    {
+    if(crcErrors < 255) { ++crcErrors; }
+    return(false);
+    }
+  return(true);
+  }
+
+// Read the temperature from the scratchpad of the device with the given ROM ID.
+// Reads all 9 bytes and checks the CRC, returning DEFAULT_INVALID_TEMP on failure.
+int16_t TemperatureC16_DS18B20::readScratchpadTemp(const uint8_t address[8])
+  {
+  uint8_t d[LOC_SCRATCHPAD_CRC + 1];
+  if(!readScratchpad(address, d)) { return(DEFAULT_INVALID_TEMP); }
+  // Restore the precision if lost, eg by a power cycle.
+  if(uint8_t(((precision - 9) << 5) | 0x1f) != d[LOC_CONFIGURATION]) { configure(address); }
+  // Extract raw temperature.
+  // TODO: mask out undefined LSBs if precision not maximum.
+  return((int16_t)((d[LOC_TEMP_MSB] << 8) | d[LOC_TEMP_LSB]));
+  }
+
+// Collect results of the conversion started by startRead(), as for readMultiple().
+// Cached probes are read directly by ROM ID; any beyond the cache need a bus search.
+uint8_t TemperatureC16_DS18B20::collectMultiple(int16_t *const values, const uint8_t count, uint8_t index)
+  {
+  if(!conversionPending && !startRead()) { return(0); }
+
+  // Wait for conversion complete (bus released) on all devices...
+  // Don't allow indefinite blocking;
+  // give up after a second of so.
+  uint8_t i = 67; // Allow for ~1s as ~15ms per loop.
+  while(!isReady())
+    {
+    if(--i == 0) { conversionPending = false; return(0); }
+#ifdef ARDUINO_ARCH_AVR
+    OTV0P2BASE::nap(WDTO_15MS);
+#else
+    OTV0P2BASE::nap(0); // No-op off target.
+#endif
+    }
+  conversionPending = false;
+
+  uint8_t sensor = 0;
+
+  // Read cached probes without searching.
+  const uint8_t cached = getCachedProbeCount();
+  while((sensor < count) && (index < cached))
+    {
+    const int16_t t = readScratchpadTemp(romCache[index]);
+    // Check this probe again before next use in case the probes have changed.
+    if(DEFAULT_INVALID_TEMP == t) { suspectProbes |= uint8_t(1U << index); initialised = false; }
+    probeValues[index++] = t;
+    values[sensor++] = t;
+    }
+  if((sensor == count) || (index >= sensorCount)) { return(sensor); }
+
+  // Find any remaining sensors wanted with a search.
   // Ensure no bad search state.
   minOW.reset_search();
 
   uint8_t address[8];
-  while(minOW.search(address))
+  while((sensor < count) && minOW.search(address))
     {
     // Is this a DS18B20?
     if(DS18B20_MODEL_ID != address[0])
@@ -178,6 +317,9 @@ uint8_t TemperatureC16_DS18B20::readMultiple(int16_t *const values, const uint8_
       continue;
       }
 
+    // Ignore a corrupted ROM ID, as init() does, so that indices match the cache.
+    if(0 != crc8_dallas(address, 8)) { continue; }
+
     // Have we reached the first sensor we are interested in
     if(index > 0)
       {
@@ -185,43 +327,23 @@ uint8_t TemperatureC16_DS18B20::readMultiple(int16_t *const values, const uint8_
       continue;
       }
 
-    minOW.reset();
-    minOW.select(address);
-
-    // Poll for conversion complete (bus released)...
-    // Don't allow indefinite blocking;
-    // give up after a second of so returning count of values read before this.
-    uint8_t i = 67; // Allow for ~1s as ~15ms per loop.
-    while(minOW.read_bit() == 0)
-      {
-      if(--i == 0) { return(sensor); }
-      OTV0P2BASE::nap(WDTO_15MS);
-      }
-
-    // Fetch temperature (scratchpad read).
-    minOW.reset();
-    minOW.select(address);
-    minOW.write(CMD_READ_SCRATCH);
-
-    // Read first two bytes of 9 available.  (No CRC config or check.)
-    const uint8_t d0 = minOW.read();
-    const uint8_t d1 = minOW.read();
-    // Terminate read and let DS18B20 go back to sleep.
-    minOW.reset();
-
-    // Extract raw temperature, masking any undefined lsbit.
-    // TODO: mask out undefined LSBs if precision not maximum.
-    const int16_t rawC16 = (d1 << 8) | (d0);
-
-    values[sensor++] = rawC16;
-
-    // Do we have any space left?
-    if(sensor >= count) { break; }
+    values[sensor++] = readScratchpadTemp(address);
     }
 
+  minOW.reset_search(); // Be kind to any other OW search user.
   return(sensor);
   }
 
+// Read all cached probes with one broadcast conversion and a single wait.
+uint8_t TemperatureC16_DS18B20::readAllProbes()
+  {
+  int16_t v[MAX_CACHED_PROBES];
+  if(!startRead()) { value = DEFAULT_INVALID_TEMP; return(0); }
+  const uint8_t n = collectMultiple(v, getCachedProbeCount());
+  value = (n > 0) ? v[0] : DEFAULT_INVALID_TEMP;
+  return(n);
+  }
+
 uint8_t TemperatureC16_DS18B20::getSensorCount()
   {
   if(!initialised) { init(); }
@@ -26,6 +26,7 @@ Author(s) / Copyright (s): Damon Hart-Davis 2014--2017
 
 #include "OTV0P2BASE_MinOW.h"
 #include "OTV0P2BASE_Sensor.h"
+#include "OTV0P2BASE_Util.h"
 #include "utility/OTV0P2BASE_SensorTemperatureC16Base.h"
 
 
@@ -59,16 +60,61 @@ class TemperatureC16_DS18B20 final : public TemperatureC16Base
     // True once initialised.
     bool initialised = false;
 
+    // True once romCache holds the result of a full search,
+    // so that it can be cheaply revalidated rather than searching again.
+    bool cacheValid = false;
+
     // Precision in range [9,12].
     const uint8_t precision = DEFAULT_PRECISION;
 
     // The number of sensors found on the bus
     uint8_t sensorCount = 0;
 
+    // True once a conversion has been started on all DS18B20s by startRead() and not yet collected.
+    bool conversionPending = false;
+
+  public:
+    // Maximum number of DS18B20 ROM IDs cached from the last search, and probe values kept.
+    // Devices beyond this on the bus are still readable, but by a full search each time.
+    static constexpr uint8_t MAX_CACHED_PROBES = 4;
+
+  private:
+    // ROM IDs of the first (up to) MAX_CACHED_PROBES DS18B20s found by the last search, in bus order.
+    uint8_t romCache[MAX_CACHED_PROBES][8];
+
+    // Last value collected from each cached probe, DEFAULT_INVALID_TEMP if none or bad.
+    int16_t probeValues[MAX_CACHED_PROBES];
+
+    // Count of scratchpad reads rejected for bad CRC (or an absent device); saturating.
+    uint8_t crcErrors = 0;
+
+    // Bit i set if cached probe i has failed a read since it was last validated.
+    uint8_t suspectProbes = 0;
+    static_assert(MAX_CACHED_PROBES <= 8, "suspectProbes too small");
+
+    // Read the 9-byte scratchpad of the device with the given ROM ID into d.
+    // Returns false if the CRC fails or no device responds.
+    bool readScratchpad(const uint8_t address[8], uint8_t d[9]);
+
+    // Read the temperature from the scratchpad of the device with the given ROM ID.
+    // Reads all 9 bytes and checks the CRC, returning DEFAULT_INVALID_TEMP on failure.
+    // Restores the device's precision setting if it has been lost (eg by a power cycle).
+    int16_t readScratchpadTemp(const uint8_t address[8]);
+
+    // Set the precision of the device with the given ROM ID.
+    void configure(const uint8_t address[8]);
+
+    // Confirm that the cached probes which have failed a read are still present,
+    // with a single select and CRC-checked scratchpad read each.
+    // Returns false if any is missing or corrupt, when a full search is needed.
+    // Does not notice newly-added devices: use rescan() for that.
+    bool revalidate();
+
     // Initialise the device (if any) before first use.
     // Returns true iff successful.
     // Uses specified order DS18B20 found on bus.
     // May need to be reinitialised if precision changed.
+    // Revalidates the cached probes if possible, else does a full search.
     bool init();
 
   public:
@@ -91,9 +137,9 @@ class TemperatureC16_DS18B20 final : public TemperatureC16Base
     // No two instances should attempt to target the same DS18B20,
     // though different DS18B20s on the same bus or different buses is allowed.
     // Precision defaults to minimum (9 bits, 0.5C resolution) for speed.
-    constexpr TemperatureC16_DS18B20(OTV0P2BASE::MinimalOneWireBase &ow, uint8_t _precision = DEFAULT_PRECISION)
-      : minOW(ow), precision(constrain(_precision, MIN_PRECISION, MAX_PRECISION))
-      { }
+    TemperatureC16_DS18B20(OTV0P2BASE::MinimalOneWireBase &ow, uint8_t _precision = DEFAULT_PRECISION)
+      : minOW(ow), precision(fnconstrain(_precision, uint8_t(MIN_PRECISION), uint8_t(MAX_PRECISION)))
+      { for(uint8_t i = 0; i < MAX_CACHED_PROBES; ++i) { probeValues[i] = DEFAULT_INVALID_TEMP; } }
 
     // Get current precision in bits [9,12]; 9 gives 1/2C resolution, 12 gives 1/16C resolution.
     uint8_t getPrecisionBits() const { return(precision); }
@@ -121,6 +167,70 @@ class TemperatureC16_DS18B20 final : public TemperatureC16Base
     // Expensive/slow.
     // Not thread-safe nor usable within ISRs (Interrupt Service Routines).
     uint8_t readMultiple(int16_t *values, uint8_t count, uint8_t index = 0);
+
+    // Start a temperature conversion on all DS18B20s on the bus at once, and return promptly.
+    // Conversion takes up to ~94ms at 9-bit precision, doubling for each extra bit to ~750ms at 12 bits.
+    // Returns false if no DS18B20 is present.
+    // Not thread-safe nor usable within ISRs (Interrupt Service Routines).
+    virtual bool startRead() override;
+
+    // True once the conversion started by startRead() is complete on all DS18B20s (or none is pending).
+    // Cheap: a single OneWire read slot.
+    // Not thread-safe nor usable within ISRs (Interrupt Service Routines).
+    virtual bool isReady() override;
+
+    // Collect the result of the conversion started by startRead() from the first DS18B20, as for read().
+    // Starts and waits for a conversion if none was started.
+    virtual int16_t collect() override;
+
+    // Collect results of the conversion started by startRead(), as for readMultiple().
+    // Starts and waits for a conversion if none was started.
+    // Cached probes are addressed directly by ROM ID without a bus search;
+    // every scratchpad is CRC-checked and a bad one gives DEFAULT_INVALID_TEMP.
+    uint8_t collectMultiple(int16_t *values, uint8_t count, uint8_t index = 0);
+
+    // Read all cached probes with one broadcast conversion and a single wait.
+    // Updates getProbeValue() (and get() from the first probe); returns the number of probes read.
+    // Expensive/slow.
+    // Not thread-safe nor usable within ISRs (Interrupt Service Routines).
+    uint8_t readAllProbes();
+
+    // Number of probes with cached ROM IDs (and values), [0,MAX_CACHED_PROBES].
+    uint8_t getCachedProbeCount() const
+      { return((sensorCount < MAX_CACHED_PROBES) ? sensorCount : MAX_CACHED_PROBES); }
+
+    // Last value collected from the given cached probe, or DEFAULT_INVALID_TEMP if none.
+    int16_t getProbeValue(const uint8_t probe) const
+      { return((probe < getCachedProbeCount()) ? probeValues[probe] : DEFAULT_INVALID_TEMP); }
+
+    // Get cached ROM ID of given probe, or NULL if not cached.
+    const uint8_t *getProbeROM(const uint8_t probe) const
+      { return((probe < getCachedProbeCount()) ? romCache[probe] : NULL); }
+
+    // Count of scratchpad reads rejected for bad CRC; saturates at 255.
+    uint8_t getCRCErrors() const { return(crcErrors); }
+
+    // Forget the cached ROM IDs so that the next read searches the bus again,
+    // eg after probes have been added or removed.
+    void rescan() { initialised = false; cacheValid = false; }
+  };
+
+// Sub-sensor for one probe of a multi-probe DS18B20 bus, by bus order.
+// Values come from the parent's last read of all probes, eg by readAllProbes().
+// Available only while the probe has a cached ROM ID and a valid value.
+class TemperatureC16_DS18B20_Probe final : public SubSensor<int16_t, false>
+  {
+  private:
+    const TemperatureC16_DS18B20 &parent;
+    const uint8_t probe;
+    const Sensor_tag_t t;
+  public:
+    constexpr TemperatureC16_DS18B20_Probe(const TemperatureC16_DS18B20 &p, const uint8_t probeIndex, const Sensor_tag_t tag)
+      : parent(p), probe(probeIndex), t(tag) { }
+    virtual int16_t get() const override { return(parent.getProbeValue(probe)); }
+    virtual Sensor_tag_t tag() const override { return(t); }
+    virtual bool isAvailable() const override
+      { return(TemperatureC16_DS18B20::DEFAULT_INVALID_TEMP != parent.getProbeValue(probe)); }
   };
 #endif // defined(MinimalOneWireBase_DEFINED) // Required definition.
 
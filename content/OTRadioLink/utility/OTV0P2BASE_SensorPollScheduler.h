@@ -0,0 +1,312 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * Sensor polling scheduler driven by Sensor<T>::preferredPollInterval_s().
+ *
+ * Registers heterogeneous sensors and reads each at (about) its preferred interval,
+ * merging reads that fall due close together into one wake-up,
+ * and reading sensors that share a bus in one bus power-up window.
+ */
+
+#ifndef OTV0P2BASE_SENSORPOLLSCHEDULER_H
+#define OTV0P2BASE_SENSORPOLLSCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "OTV0P2BASE_Sensor.h"
+
+namespace OTV0P2BASE
+{
+
+/**
+ * @brief   Schedules reads of up to maxSensors sensors of any value type.
+ *
+ * Time is in seconds from any monotonic source supplied by the caller
+ * (eg a count of seconds since boot); it must not wrap during use.
+ *
+ * Each sensor has a bus: BUS_NONE for sensors independent of any shared bus,
+ * else a small bus number (eg BUS_I2C for SHT21/TMP112, BUS_ONEWIRE for DS18B20).
+ * On each wake:
+ *   * any sensor due is read, plus any not yet due but within a quarter of its interval,
+ *     so that sensors with similar intervals settle into sharing wakes;
+ *   * independent sensors are all started together (split-phase, see Sensor<T>::startRead())
+ *     and collected last, overlapping their conversions with any bus work;
+ *   * sensors on each bus are read one at a time (they share the bus)
+ *     inside a single bus power-up window, if power hooks are set for that bus.
+ *
+ * A sensor with a conversion latency of (to the nearest second) a second or more
+ * is started that much ahead of when it is due, and collected on a later wake when due,
+ * rather than being waited for.
+ * A sensor on a bus holds its bus (kept powered up) from its start to its collect,
+ * so other sensors on that bus are read after it is collected.
+ *
+ * After an early read the next read stays on the original phase,
+ * so the long-run rate is as requested.
+ * After a late read the next read is one interval on, rather than catching up.
+ *
+ * getNextWake() gives the time the sleep code should next wake to service sensors.
+ *
+ * @param   maxSensors: maximum sensors registered; [1,254].
+ * @note    Not thread-safe nor usable within ISRs.
+ */
+template<uint8_t maxSensors = 8>
+class SensorPollScheduler final
+{
+public:
+    // Bus numbers; others up to MAX_BUS may be used.
+    static constexpr uint8_t BUS_NONE = 0;
+    static constexpr uint8_t BUS_I2C = 1;
+    static constexpr uint8_t BUS_ONEWIRE = 2;
+    static constexpr uint8_t MAX_BUS = 3;
+
+    // Bus power hooks; up returns true if it actually powered the bus up.
+    typedef bool (*busPowerUp_fn_t)();
+    typedef void (*busPowerDown_fn_t)();
+
+private:
+    static_assert((maxSensors > 0) && (maxSensors < 255), "maxSensors out of range");
+
+    // Type-erased access to one Sensor<T>.
+    struct entry_t
+    {
+        void *sensor;
+        bool (*startRead)(void *);
+        void (*collect)(void *);
+        uint32_t nextDue;
+        // Time to collect at, once started.
+        uint32_t collectAt;
+        uint16_t latency_ms;
+        uint8_t interval_s;
+        // Seconds to start ahead of when due, from latency_ms.
+        uint8_t lead_s;
+        uint8_t bus;
+        // True between startRead() and collect() across wakes.
+        bool started;
+    };
+    entry_t entries[maxSensors];
+    uint8_t nSensors = 0;
+
+    busPowerUp_fn_t busUp[MAX_BUS + 1];
+    busPowerDown_fn_t busDown[MAX_BUS + 1];
+    // True while a bus power-up window is open, and if the up hook actually powered the bus up.
+    bool busOpen[MAX_BUS + 1];
+    bool busPoweredUp[MAX_BUS + 1];
+
+    // Statistics.
+    uint32_t wakes = 0;
+    uint32_t reads = 0;
+    uint32_t busPowerUps = 0;
+
+    template<class T> static bool startThunk(void *const s) { return(static_cast<Sensor<T> *>(s)->startRead()); }
+    template<class T> static void collectThunk(void *const s) { static_cast<Sensor<T> *>(s)->collect(); }
+
+    // Time at which entry e should be started to be collected when due.
+    static uint32_t startDue(const entry_t &e)
+        { return((e.nextDue > e.lead_s) ? (e.nextDue - e.lead_s) : 0); }
+
+    // True if entry e (not yet started) should be started at time now.
+    static bool selected(const entry_t &e, const uint32_t now)
+        { return(startDue(e) <= now + (e.interval_s / 4U)); }
+
+    // Start e at time now, to be collected once its conversion is done
+    // and (if it has any lead) when it is due.
+    static void start(entry_t &e, const uint32_t now)
+    {
+        e.startRead(e.sensor);
+        e.started = true;
+        e.collectAt = now + e.lead_s;
+        if((0 != e.lead_s) && (e.nextDue > e.collectAt)) { e.collectAt = e.nextDue; }
+    }
+
+    // Collect e at time now and schedule its next read.
+    static void collect(entry_t &e, const uint32_t now)
+    {
+        e.collect(e.sensor);
+        e.started = false;
+        e.nextDue = ((e.nextDue > now) ? e.nextDue : now) + e.interval_s;
+    }
+
+    // Index of the started sensor holding bus b, else maxSensors if none.
+    uint8_t busHolder(const uint8_t b) const
+    {
+        for(uint8_t i = 0; i < nSensors; ++i) { if((b == entries[i].bus) && entries[i].started) { return(i); } }
+        return(maxSensors);
+    }
+
+    // Open a power-up window for bus b if not already open.
+    void openBus(const uint8_t b)
+    {
+        if(busOpen[b]) { return; }
+        busOpen[b] = true;
+        busPoweredUp[b] = (NULL != busUp[b]) && busUp[b]();
+        if(busPoweredUp[b]) { ++busPowerUps; }
+    }
+
+    // Close any power-up window for bus b.
+    void closeBus(const uint8_t b)
+    {
+        if(!busOpen[b]) { return; }
+        if(busPoweredUp[b] && (NULL != busDown[b])) { busDown[b](); }
+        busOpen[b] = false;
+        busPoweredUp[b] = false;
+    }
+
+public:
+    SensorPollScheduler()
+    {
+        for(uint8_t b = 0; b <= MAX_BUS; ++b)
+            { busUp[b] = NULL; busDown[b] = NULL; busOpen[b] = false; busPoweredUp[b] = false; }
+    }
+
+    /**
+     * @brief   Register a sensor.
+     * @param   s: sensor; must outlive this scheduler.
+     * @param   bus: BUS_NONE or the bus shared with other sensors, [0,MAX_BUS].
+     * @param   latency_ms: typical conversion time, used to order independent starts
+     *          and, to the nearest second, to start ahead of when due; 0 if unknown.
+     * @param   interval_s: read interval, or 0 to use s.preferredPollInterval_s().
+     * @param   firstDue: time of first read.
+     * @retval  false if full, the bus is invalid, or no interval is available.
+     */
+    template<class T>
+    bool add(Sensor<T> &s, const uint8_t bus = BUS_NONE, const uint16_t latency_ms = 0,
+             const uint8_t interval_s = 0, const uint32_t firstDue = 0)
+    {
+        const uint8_t i_s = (0 != interval_s) ? interval_s : s.preferredPollInterval_s();
+        if((0 == i_s) || (bus > MAX_BUS) || (nSensors >= maxSensors)) { return(false); }
+        // Keep independent sensors sorted by decreasing latency, so that the slowest start first.
+        uint8_t pos = nSensors++;
+        while((pos > 0) && (entries[pos - 1].latency_ms < latency_ms)) { entries[pos] = entries[pos - 1]; --pos; }
+        entry_t &e = entries[pos];
+        e.sensor = &s;
+        e.startRead = startThunk<T>;
+        e.collect = collectThunk<T>;
+        e.nextDue = firstDue;
+        e.collectAt = 0;
+        e.latency_ms = latency_ms;
+        e.interval_s = i_s;
+        const uint16_t lead_s = uint16_t((latency_ms + 500U) / 1000U);
+        e.lead_s = uint8_t((lead_s < 255) ? lead_s : 255);
+        e.bus = bus;
+        e.started = false;
+        return(true);
+    }
+
+    // Set power hooks for a bus, to be held up across all reads on it in one wake; NULL for none.
+    void setBusPower(const uint8_t bus, const busPowerUp_fn_t up, const busPowerDown_fn_t down)
+    {
+        if((BUS_NONE == bus) || (bus > MAX_BUS)) { return; }
+        busUp[bus] = up;
+        busDown[bus] = down;
+    }
+
+    // Number of sensors registered.
+    uint8_t getSensorCount() const { return(nSensors); }
+
+    // Time at which the next sensor start or collect is due (which may be in the past), or ~0 if no sensors.
+    // Starts are brought forward by each sensor's latency
+    // and bus sensors wait for any sensor holding their bus.
+    uint32_t getNextWake() const
+    {
+        uint32_t next = ~uint32_t(0);
+        for(uint8_t i = 0; i < nSensors; ++i) {
+            const entry_t &e = entries[i];
+            uint32_t t;
+            if(e.started) { t = e.collectAt; }
+            else {
+                t = startDue(e);
+                if(BUS_NONE != e.bus) {
+                    const uint8_t h = busHolder(e.bus);
+                    if((h < nSensors) && (entries[h].collectAt > t)) { t = entries[h].collectAt; }
+                }
+            }
+            if(t < next) { next = t; }
+        }
+        return(next);
+    }
+
+    // True if any sensor is due at time now.
+    bool isDue(const uint32_t now) const { return(getNextWake() <= now); }
+
+    /**
+     * @brief   Start and collect all sensors due (or nearly due) at time now.
+     *          Does nothing, and does not count as a wake, if none is actually due.
+     * @retval  number of sensors read, ie collected.
+     */
+    uint8_t poll(const uint32_t now)
+    {
+        if(!isDue(now)) { return(0); }
+        ++wakes;
+        uint8_t n = 0;
+        // Start independent sensors, slowest first.
+        // A failed start is still collected, as for read(), to update the value.
+        for(uint8_t i = 0; i < nSensors; ++i) {
+            entry_t &e = entries[i];
+            if((BUS_NONE != e.bus) || e.started || !selected(e, now)) { continue; }
+            start(e, now);
+        }
+        // Read sensors on each bus one at a time within a single power-up window,
+        // first collecting any sensor holding the bus from an earlier wake.
+        for(uint8_t b = BUS_NONE + 1; b <= MAX_BUS; ++b) {
+            const uint8_t h = busHolder(b);
+            if(h < nSensors) {
+                if(entries[h].collectAt > now) { continue; }
+                collect(entries[h], now);
+                ++n;
+            }
+            for(uint8_t i = 0; i < nSensors; ++i) {
+                entry_t &e = entries[i];
+                if((b != e.bus) || !selected(e, now)) { continue; }
+                openBus(b);
+                start(e, now);
+                // Hold the bus until collected on a later wake.
+                if(e.collectAt > now) { break; }
+                collect(e, now);
+                ++n;
+            }
+            if(busHolder(b) >= nSensors) { closeBus(b); }
+        }
+        // Collect independent sensors whose conversions are done.
+        for(uint8_t i = 0; i < nSensors; ++i) {
+            entry_t &e = entries[i];
+            if((BUS_NONE != e.bus) || !e.started || (e.collectAt > now)) { continue; }
+            collect(e, now);
+            ++n;
+        }
+        reads += n;
+        return(n);
+    }
+
+    // Number of wakes that read at least one sensor.
+    uint32_t getWakes() const { return(wakes); }
+    // Total sensor reads.
+    uint32_t getReads() const { return(reads); }
+    // Number of times a bus power-up hook actually powered a bus up.
+    uint32_t getBusPowerUps() const { return(busPowerUps); }
+};
+
+template<uint8_t maxSensors> constexpr uint8_t SensorPollScheduler<maxSensors>::BUS_NONE;
+template<uint8_t maxSensors> constexpr uint8_t SensorPollScheduler<maxSensors>::BUS_I2C;
+template<uint8_t maxSensors> constexpr uint8_t SensorPollScheduler<maxSensors>::BUS_ONEWIRE;
+template<uint8_t maxSensors> constexpr uint8_t SensorPollScheduler<maxSensors>::MAX_BUS;
+
+}
+
+#endif // OTV0P2BASE_SENSORPOLLSCHEDULER_H
@@ -118,46 +118,59 @@ static void SHT21_init()
 
 // Abstracting read function I2C transactions
 #ifdef ARDUINO_ARCH_AVR
-// Measure and return the current ambient temperature in units of 1/16th C.
-// This may contain up to 4 bits of information to RHS of the fixed binary point.
-// This may consume significant power and time.
-// Probably no need to do this more than (say) once per minute.
-// The first read will initialise the device as necessary
-// and leave it in a low-power mode afterwards.
-int16_t RoomTemperatureC16_SHT21::read()
+// Start a temperature conversion in no-hold-master mode, leaving the I2C bus free meanwhile.
+// Powers up TWI if necessary until collect().
+// Returns false if the SHT21 did not acknowledge the command.
+bool RoomTemperatureC16_SHT21::startRead()
 {
-    const bool neededPowerUp = OTV0P2BASE::powerUpTWIIfDisabled();
+    const bool poweredUp = OTV0P2BASE::powerUpTWIIfDisabled();
+    neededPowerUp = poweredUp || (pending && neededPowerUp);
 
     // Initialise/config if necessary.
     if(!SHT21_initialised) { SHT21_init(); }
 
-    // Max RH measurement time:
-    //   * 14-bit: 85ms
-    //   * 12-bit: 22ms
-    //   * 11-bit: 11ms
-    // Use blocking data fetch for now.
+    fetched = false;
     Wire.beginTransmission(SHT21_I2C_ADDR);
-    Wire.write((byte) SHT21_I2C_CMD_TEMP_HOLD); // Select control register.
-    if(SHT21_USE_REDUCED_PRECISION) {
-        // Should cover 12-bit conversion (22ms).
-        OTV0P2BASE::nap(WDTO_30MS);
-    } else {
-        // Should be plenty for slowest (14-bit) conversion (85ms).
-        OTV0P2BASE::sleepLowPowerMs(90);
-    }
-    Wire.endTransmission();
-    Wire.requestFrom(SHT21_I2C_ADDR, 3U);
-    while(Wire.available() < 3) {
-        // Wait for data, but avoid rolling over the end of a minor cycle...
-        if(OTV0P2BASE::getSubCycleTime() >= OTV0P2BASE::GSCT_MAX - 2) {
-            return(DEFAULT_INVALID_TEMP);  // Failure value: may be able to to better.
-        }
-    }
-    uint16_t rawTemp = (Wire.read() << 8);
+    Wire.write((byte) SHT21_I2C_CMD_TEMP_NOHOLD);
+    pending = (0 == Wire.endTransmission());
+    if(!pending && neededPowerUp) { OTV0P2BASE::powerDownTWI(); neededPowerUp = false; }
+    return(pending);
+}
+
+// True once the conversion is complete, fetching the raw result.
+// The SHT21 does not acknowledge a read until the conversion is complete.
+bool RoomTemperatureC16_SHT21::isReady()
+{
+    if(!pending || fetched) { return(true); }
+    if(Wire.requestFrom(SHT21_I2C_ADDR, 3U) < 3) { return(false); }
+    rawTemp = (Wire.read() << 8);
     rawTemp |= (Wire.read() & 0xfc); // Clear status ls bits.
+    Wire.read(); // Discard CRC.
+    fetched = true;
+    return(true);
+}
+
+// Collect the temperature from the conversion started by startRead() in units of 1/16th C.
+// Starts a conversion first if none is pending.
+// Max temperature measurement time:
+//   * 14-bit: 85ms
+//   * 12-bit: 22ms
+int16_t RoomTemperatureC16_SHT21::collect()
+{
+    if(!pending && !startRead()) { return(DEFAULT_INVALID_TEMP); }
+
+    // Wait (boundedly) in low-power mode for conversion to complete.
+    for(uint8_t i = SHT21_USE_REDUCED_PRECISION ? 3 : 7; !isReady(); --i) {
+        if(0 == i) { break; }
+        OTV0P2BASE::nap(WDTO_15MS);
+    }
+    pending = false;
 
     // Power down TWI ASAP.
-    if(neededPowerUp) { OTV0P2BASE::powerDownTWI(); }
+    if(neededPowerUp) { OTV0P2BASE::powerDownTWI(); neededPowerUp = false; }
+
+    if(!fetched) { return(DEFAULT_INVALID_TEMP); }  // Failure value: may be able to to better.
+    fetched = false;
 
     // Nominal formula: C = -46.85 + ((175.72*raw) / (1L << 16));
     // FIXME: find a good but faster approximation...
@@ -174,6 +187,18 @@ int16_t RoomTemperatureC16_SHT21::read()
     value = c16;
     return(c16);
 }
+
+// Measure and return the current ambient temperature in units of 1/16th C.
+// This may contain up to 4 bits of information to RHS of the fixed binary point.
+// This may consume significant power and time.
+// Probably no need to do this more than (say) once per minute.
+// The first read will initialise the device as necessary
+// and leave it in a low-power mode afterwards.
+int16_t RoomTemperatureC16_SHT21::read()
+{
+    startRead();
+    return(collect());
+}
 #elif defined(EFR32FG1P133F256GM48)
 // TODO
 // Measure and return the current ambient temperature in units of 1/16th C.
@@ -238,46 +263,59 @@ int16_t RoomTemperatureC16_SHT21::read()
 
 // Abstract for different i2c drivers.
 #ifdef ARDUINO_ARCH_AVR
-// Measure and return the current relative humidity in %; range [0,100] and 255 for error.
-// This may consume significant power and time.
-// Probably no need to do this more than (say) once per minute.
-// The first read will initialise the device as necessary and leave it in a low-power mode afterwards.
-// Returns 255 (~0) in case of error.
-uint8_t HumiditySensorSHT21::read()
+// Start an RH conversion in no-hold-master mode, leaving the I2C bus free meanwhile.
+// Powers up TWI if necessary until collect().
+// Returns false if the SHT21 did not acknowledge the command.
+bool HumiditySensorSHT21::startRead()
 {
-    const bool neededPowerUp = OTV0P2BASE::powerUpTWIIfDisabled();
+    const bool poweredUp = OTV0P2BASE::powerUpTWIIfDisabled();
+    neededPowerUp = poweredUp || (pending && neededPowerUp);
 
     // Initialise/config if necessary.
     if(!SHT21_initialised) { SHT21_init(); }
 
-    // Get RH%...
-    // Max RH measurement time:
-    //   * 12-bit: 29ms
-    //   *  8-bit:  4ms
-    // Use blocking data fetch for now.
+    fetched = false;
     Wire.beginTransmission(SHT21_I2C_ADDR);
-    Wire.write((byte) SHT21_I2C_CMD_RH_HOLD); // Select control register.
-    if(SHT21_USE_REDUCED_PRECISION) {
-    // Should cover 8-bit conversion (4ms).
-        OTV0P2BASE::sleepLowPowerMs(5);
-    } else {
-    // Should cover even 12-bit conversion (29ms).
-        OTV0P2BASE::nap(WDTO_30MS);
-    }
-    Wire.endTransmission();
-    Wire.requestFrom(SHT21_I2C_ADDR, 3U);
-    while(Wire.available() < 3) {
-        // Wait for data, but avoid rolling over the end of a minor cycle...
-        if(OTV0P2BASE::getSubCycleTime() >= OTV0P2BASE::GSCT_MAX - 2) {
-            // DEBUG_SERIAL_PRINTLN_FLASHSTRING("giving up");
-            return(~0);
-        }
+    Wire.write((byte) SHT21_I2C_CMD_RH_NOHOLD);
+    pending = (0 == Wire.endTransmission());
+    if(!pending && neededPowerUp) { OTV0P2BASE::powerDownTWI(); neededPowerUp = false; }
+    return(pending);
+}
+
+// True once the conversion is complete, fetching the raw result.
+// The SHT21 does not acknowledge a read until the conversion is complete.
+bool HumiditySensorSHT21::isReady()
+{
+    if(!pending || fetched) { return(true); }
+    if(Wire.requestFrom(SHT21_I2C_ADDR, 3U) < 3) { return(false); }
+    rawRH = Wire.read();
+    rawRL = Wire.read();
+    Wire.read(); // Discard CRC.
+    fetched = true;
+    return(true);
+}
+
+// Collect the relative humidity in % from the conversion started by startRead(); 255 for error.
+// Starts a conversion first if none is pending.
+// Max RH measurement time:
+//   * 12-bit: 29ms
+//   *  8-bit:  4ms
+uint8_t HumiditySensorSHT21::collect()
+{
+    if(!pending && !startRead()) { return(~0); }
+
+    // Wait (boundedly) in low-power mode for conversion to complete.
+    for(uint8_t i = SHT21_USE_REDUCED_PRECISION ? 1 : 3; !isReady(); --i) {
+        if(0 == i) { break; }
+        OTV0P2BASE::nap(WDTO_15MS);
     }
-    const uint8_t rawRH = Wire.read();
-    const uint8_t rawRL = Wire.read();
+    pending = false;
 
     // Power down TWI ASAP.
-    if(neededPowerUp) { OTV0P2BASE::powerDownTWI(); }
+    if(neededPowerUp) { OTV0P2BASE::powerDownTWI(); neededPowerUp = false; }
+
+    if(!fetched) { return(~0); }
+    fetched = false;
 
     // Assemble raw value, clearing status ls bits.
     const uint16_t raw = (((uint16_t)rawRH) << 8) | (rawRL & 0xfc);
@@ -294,6 +332,17 @@ uint8_t HumiditySensorSHT21::read()
     else if(result < (HUMIDTY_HIGH_RHPC - HUMIDITY_EPSILON_RHPC)) { highWithHyst = false; }
     return(result);
 }
+
+// Measure and return the current relative humidity in %; range [0,100] and 255 for error.
+// This may consume significant power and time.
+// Probably no need to do this more than (say) once per minute.
+// The first read will initialise the device as necessary and leave it in a low-power mode afterwards.
+// Returns 255 (~0) in case of error.
+uint8_t HumiditySensorSHT21::read()
+{
+    startRead();
+    return(collect());
+}
 #elif defined(EFR32FG1P133F256GM48)
 // Measure and return the current relative humidity in %; range [0,100] and 255 for error.
 // This may consume significant power and time.
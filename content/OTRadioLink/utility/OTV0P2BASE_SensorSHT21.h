@@ -98,15 +98,53 @@ class HumiditySensorMock final : public HumiditySensorBase
 
 // Sensor for relative humidity percentage; 0 is dry, 100 is condensing humid, 255 for error.
 // TODO: detect low supply voltage with user reg, and make isAvailable() return false if too low to be reliable.
+// On AVR supports split-phase startRead()/isReady()/collect()
+// using the SHT21 no-hold-master mode, leaving the I2C bus free during conversion.
+// Temperature and RH conversions share the device so must not overlap.
 #define HumiditySensorSHT21_DEFINED
 class HumiditySensorSHT21 final : public HumiditySensorBase
-  { public: virtual uint8_t read(); };
+  {
+#ifdef ARDUINO_ARCH_AVR
+  private:
+    // Split-phase state: conversion started, and raw result fetched by isReady().
+    bool pending = false;
+    bool fetched = false;
+    // True if TWI was powered up by startRead() and should be powered down by collect().
+    bool neededPowerUp = false;
+    // Raw result bytes, MSB first.
+    uint8_t rawRH, rawRL;
+  public:
+    virtual bool startRead() override;
+    virtual bool isReady() override;
+    virtual uint8_t collect() override;
+#endif // ARDUINO_ARCH_AVR
+  public:
+    virtual uint8_t read() override;
+  };
 
 // SHT21 sensor for ambient/room temperature in 1/16th of one degree Celsius.
 // TODO: detect low supply voltage with user reg, and make isAvailable() return false if too low to be reliable.
+// On AVR supports split-phase startRead()/isReady()/collect() as for HumiditySensorSHT21.
 #define RoomTemperatureC16_SHT21_DEFINED
 class RoomTemperatureC16_SHT21 final : public OTV0P2BASE::TemperatureC16Base
-  { public: virtual int16_t read(); };
+  {
+#ifdef ARDUINO_ARCH_AVR
+  private:
+    // Split-phase state: conversion started, and raw result fetched by isReady().
+    bool pending = false;
+    bool fetched = false;
+    // True if TWI was powered up by startRead() and should be powered down by collect().
+    bool neededPowerUp = false;
+    // Raw result, status bits cleared.
+    uint16_t rawTemp;
+  public:
+    virtual bool startRead() override;
+    virtual bool isReady() override;
+    virtual int16_t collect() override;
+#endif // ARDUINO_ARCH_AVR
+  public:
+    virtual int16_t read() override;
+  };
 
 #endif // ARDUINO_ARCH_AVR || __arm__
 
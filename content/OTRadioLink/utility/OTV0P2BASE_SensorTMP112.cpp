@@ -49,16 +49,13 @@ static const uint8_t TMP112_CTRL_B1 = 0x31; // Byte 1 for control register: 12-b
 static const uint8_t TMP112_CTRL_B1_OS = 0x80; // Control register: one-shot flag in byte 1.
 static const uint8_t TMP112_CTRL_B2 = 0x0; // Byte 2 for control register: 0.25Hz conversion rate and not extended mode (EM).
 
-// Measure/store/return the current room ambient temperature in units of 1/16th C.
-// This may contain up to 4 bits of information to the right of the fixed binary point.
-// This may consume significant power and time.
-// Probably no need to do this more than (say) once per minute.
-// The first read will initialise the device as necessary and leave it in a low-power mode afterwards.
-// This will simulate a zero temperature in case of detected error talking to the sensor as fail-safe for this use.
-// Check for errors at certain critical places, not everywhere.
-int16_t RoomTemperatureC16_TMP112::read()
+// Start a one-shot temperature conversion, and return promptly.
+// Powers up TWI if necessary until collect().
+// Returns false in case of error talking to the sensor.
+bool RoomTemperatureC16_TMP112::startRead()
   {
-  const bool neededPowerUp = OTV0P2BASE::powerUpTWIIfDisabled();
+  const bool poweredUp = OTV0P2BASE::powerUpTWIIfDisabled();
+  neededPowerUp = poweredUp || (pending && neededPowerUp);
 
 #if 0 && defined(DEBUG)
   DEBUG_SERIAL_PRINT_FLASHSTRING("TMP112 needed power-up: ");
@@ -76,61 +73,97 @@ int16_t RoomTemperatureC16_TMP112::read()
   Wire.write((byte) TMP112_REG_CTRL); // Select control register.
   Wire.write((byte) TMP112_CTRL_B1 | TMP112_CTRL_B1_OS); // Start one-shot conversion.
   //Wire.write((byte) TMP112_CTRL_B2);
-  if(Wire.endTransmission()) { return(DEFAULT_INVALID_TEMP); } // Exit if error.
+  pending = (0 == Wire.endTransmission());
+  if(!pending && neededPowerUp) { OTV0P2BASE::powerDownTWI(); neededPowerUp = false; }
+  return(pending);
+  }
+
+// True once the one-shot conversion is complete (or if none is pending).
+// Returns false on error talking to the sensor, which collect() will time out on.
+bool RoomTemperatureC16_TMP112::isReady()
+  {
+  if(!pending) { return(true); }
+  Wire.beginTransmission(TMP112_I2C_ADDR);
+  Wire.write((byte) TMP112_REG_CTRL); // Select control register.
+  if(Wire.endTransmission()) { return(false); }
+  if(Wire.requestFrom(TMP112_I2C_ADDR, 1U) != 1) { return(false); }
+  const byte b1 = Wire.read();
+  return(0 != (b1 & TMP112_CTRL_B1_OS)); // Conversion completed.
+  }
+
+// Collect the result of the conversion started by startRead() in units of 1/16th C.
+// Starts a conversion first if none is pending.
+// Returns DEFAULT_INVALID_TEMP in case of detected error talking to the sensor.
+int16_t RoomTemperatureC16_TMP112::collect()
+  {
+  if(!pending && !startRead()) { return(DEFAULT_INVALID_TEMP); }
 
   // Wait for temperature measurement/conversion to complete, in low-power sleep mode for the bulk of the time.
 #if 0 && defined(DEBUG)
   DEBUG_SERIAL_PRINTLN_FLASHSTRING("TMP112 waiting for conversion...");
 #endif
-  Wire.beginTransmission(TMP112_I2C_ADDR);
-  Wire.write((byte) TMP112_REG_CTRL); // Select control register.
-  if(Wire.endTransmission()) { return(DEFAULT_INVALID_TEMP); } // Exit if error.
-  for(int i = 8; --i; ) // 2 orbits should generally be plenty.
+  bool ready = false;
+  for(int i = 8; --i > 0; ) // 2 orbits should generally be plenty.
     {
-    if(i <= 0) { return(DEFAULT_INVALID_TEMP); } // Exit if error.
-    if(Wire.requestFrom(TMP112_I2C_ADDR, 1U) != 1) { return(DEFAULT_INVALID_TEMP); } // Exit if error.
-    const byte b1 = Wire.read();
-    if(b1 & TMP112_CTRL_B1_OS) { break; } // Conversion completed.
+    if((ready = isReady())) { break; }
     OTV0P2BASE::nap(WDTO_15MS); // One or two of these naps should allow typical ~26ms conversion to complete...
     }
+  pending = false;
 
-  // Fetch temperature.
+  int16_t t16 = DEFAULT_INVALID_TEMP;
+  if(ready)
+    {
+    // Fetch temperature.
 #if 0 && defined(DEBUG)
-  DEBUG_SERIAL_PRINTLN_FLASHSTRING("TMP112 fetching temperature...");
+    DEBUG_SERIAL_PRINTLN_FLASHSTRING("TMP112 fetching temperature...");
 #endif
-  Wire.beginTransmission(TMP112_I2C_ADDR);
-  Wire.write((byte) TMP112_REG_TEMP); // Select temperature register (set ptr to 0).
-  if(Wire.endTransmission()) { return(DEFAULT_INVALID_TEMP); } // Exit if error.
-  if(Wire.requestFrom(TMP112_I2C_ADDR, 2U) != 2)  { return(DEFAULT_INVALID_TEMP); }
-  if(Wire.endTransmission()) { return(DEFAULT_INVALID_TEMP); } // Exit if error.
-
-  const byte b1 = Wire.read(); // MSByte, should be signed whole degrees C.
-  const uint8_t b2 = Wire.read(); // Avoid sign extension...
-
-  if(neededPowerUp) { OTV0P2BASE::powerDownTWI(); }
-
-  // Builds 12-bit value (assumes not in extended mode)
-  // and sign-extends if necessary for sub-zero temps.
-  const int t16 = (b1 << 4) | (b2 >> 4) | ((b1 & 0x80) ? 0xf000 : 0);
+    Wire.beginTransmission(TMP112_I2C_ADDR);
+    Wire.write((byte) TMP112_REG_TEMP); // Select temperature register (set ptr to 0).
+    if((0 == Wire.endTransmission()) &&
+       (2 == Wire.requestFrom(TMP112_I2C_ADDR, 2U)) &&
+       (0 == Wire.endTransmission()))
+      {
+      const byte b1 = Wire.read(); // MSByte, should be signed whole degrees C.
+      const uint8_t b2 = Wire.read(); // Avoid sign extension...
+
+      // Builds 12-bit value (assumes not in extended mode)
+      // and sign-extends if necessary for sub-zero temps.
+      t16 = (b1 << 4) | (b2 >> 4) | ((b1 & 0x80) ? 0xf000 : 0);
 
 #if 0 && defined(DEBUG)
-  DEBUG_SERIAL_PRINT_FLASHSTRING("TMP112 temp: ");
-  DEBUG_SERIAL_PRINT(b1);
-  DEBUG_SERIAL_PRINT_FLASHSTRING("C / ");
-  DEBUG_SERIAL_PRINT(temp16);
-  DEBUG_SERIAL_PRINTLN();
+      DEBUG_SERIAL_PRINT_FLASHSTRING("TMP112 temp: ");
+      DEBUG_SERIAL_PRINT(b1);
+      DEBUG_SERIAL_PRINT_FLASHSTRING("C / ");
+      DEBUG_SERIAL_PRINT(temp16);
+      DEBUG_SERIAL_PRINTLN();
 #endif
 
-  // Capture entropy from ls bits if (transformed) value has changed.
-  // Claim one bit of noise in the raw value if the full value has changed,
-  // though it is possible that this might be directly manipulatable by Eve,
-  // and nearly all of the raw info is visible in the result.
-  if(t16 != value) { addEntropyToPool(b1 ^ b2, 1); }
+      // Capture entropy from ls bits if (transformed) value has changed.
+      // Claim one bit of noise in the raw value if the full value has changed,
+      // though it is possible that this might be directly manipulatable by Eve,
+      // and nearly all of the raw info is visible in the result.
+      if(t16 != value) { addEntropyToPool(b1 ^ b2, 1); }
+      value = t16;
+      }
+    }
 
-  value = t16;
+  if(neededPowerUp) { OTV0P2BASE::powerDownTWI(); neededPowerUp = false; }
   return(t16);
   }
 
+// Measure/store/return the current room ambient temperature in units of 1/16th C.
+// This may contain up to 4 bits of information to the right of the fixed binary point.
+// This may consume significant power and time.
+// Probably no need to do this more than (say) once per minute.
+// The first read will initialise the device as necessary and leave it in a low-power mode afterwards.
+// This will simulate a zero temperature in case of detected error talking to the sensor as fail-safe for this use.
+// Check for errors at certain critical places, not everywhere.
+int16_t RoomTemperatureC16_TMP112::read()
+  {
+  startRead();
+  return(collect());
+  }
+
 /**
  * @brief   Report whether or not the TMP112 is available.
  * 
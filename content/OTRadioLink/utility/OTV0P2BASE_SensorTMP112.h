@@ -32,12 +32,22 @@ namespace OTV0P2BASE
 
 #ifdef ARDUINO_ARCH_AVR
 // TMP112 sensor for ambient/room temperature in 1/16th of one degree Celsius.
+// Supports split-phase startRead()/isReady()/collect()
+// using a one-shot conversion (~26ms) with the device otherwise shut down.
 #define RoomTemperatureC16_TMP112_DEFINED
 class RoomTemperatureC16_TMP112 final : public OTV0P2BASE::TemperatureC16Base
 {
+private:
+    // True while a conversion started by startRead() is not yet collected.
+    bool pending = false;
+    // True if TWI was powered up by startRead() and should be powered down by collect().
+    bool neededPowerUp = false;
 public: 
-    virtual int16_t read();
+    virtual int16_t read() override;
     virtual bool isAvailable() const override;
+    virtual bool startRead() override;
+    virtual bool isReady() override;
+    virtual int16_t collect() override;
 };
 #endif // ARDUINO_ARCH_AVR
 
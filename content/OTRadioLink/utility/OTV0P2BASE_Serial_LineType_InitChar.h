@@ -41,6 +41,7 @@ enum Serial_LineType_InitChar : uint8_t {
     SERLINE_START_CHAR_INFO = '+', // Informational log line.
     SERLINE_START_CHAR_RSTATS = '@', // Remote (binary) stats log line.
     SERLINE_START_CHAR_RJSTATS = '{', // Remote (JSON) stats log line.
+    SERLINE_START_CHAR_BSTATS = '#', // Local binary stats record (length-prefixed, see BinaryStatusRecord).
     SERLINE_START_CHAR_STATS = '=' // Local stats log line.
 };
 
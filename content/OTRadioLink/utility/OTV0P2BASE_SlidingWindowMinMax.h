@@ -0,0 +1,108 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * Sliding-window minimum and maximum over the last N uint8_t samples.
+ *
+ * Portable and unit testable.
+ */
+
+#ifndef ARDUINO_LIB_OTV0P2BASE_SLIDINGWINDOWMINMAX_H
+#define ARDUINO_LIB_OTV0P2BASE_SLIDINGWINDOWMINMAX_H
+
+#include <stdint.h>
+
+
+namespace OTV0P2BASE
+{
+
+
+// Minimum and maximum of the last N samples in [0,254], with 0xff meaning none.
+// Uses a pair of monotonic deques (ascending for min, descending for max)
+// held in fixed ring buffers, so each push is O(1) amortised
+// and no past samples need to be rescanned.
+// Uses 4*N + 6 bytes.
+// Not thread-/ISR- safe.
+template<uint8_t N>
+class SlidingWindowMinMax final
+  {
+  static_assert(N > 0, "window must be non-empty");
+  static_assert(N < 255, "window too long for 8-bit sequence numbers");
+
+  private:
+    // Sample value and its sequence number (mod 256).
+    struct entry_t { uint8_t v; uint8_t seq; };
+    // Monotonic deque in a ring buffer of N entries.
+    struct deque_t
+      {
+      entry_t e[N];
+      uint8_t head;
+      uint8_t len;
+      entry_t &at(const uint8_t i) { return(e[(head + i) % N]); }
+      const entry_t &front() const { return(e[head]); }
+      void popFront() { head = uint8_t((head + 1) % N); --len; }
+      };
+    deque_t minQ;
+    deque_t maxQ;
+    // Sequence number of the next sample.
+    uint8_t seq;
+    // Samples in the window, up to N.
+    uint8_t count;
+
+    // Drop entries that have left the window, then add v,
+    // first dropping from the back any entries that can no longer be the extreme.
+    void add(deque_t &q, const uint8_t v, const bool isMin)
+      {
+      while((0 != q.len) && (uint8_t(seq - q.front().seq) >= N)) { q.popFront(); }
+      while((0 != q.len) && (isMin ? (q.at(q.len - 1).v >= v) : (q.at(q.len - 1).v <= v))) { --q.len; }
+      entry_t &b = q.at(q.len++);
+      b.v = v;
+      b.seq = seq;
+      }
+
+  public:
+    constexpr SlidingWindowMinMax() : minQ(), maxQ(), seq(0), count(0) { }
+
+    // Empty the window.
+    void reset() { minQ.head = 0; minQ.len = 0; maxQ.head = 0; maxQ.len = 0; seq = 0; count = 0; }
+
+    // Add a sample, dropping the oldest once N are held; 0xff is ignored.
+    // Returns true if the minimum or maximum changed.
+    bool push(const uint8_t v)
+      {
+      if(0xff == v) { return(false); }
+      const uint8_t oldMin = getMin();
+      const uint8_t oldMax = getMax();
+      add(minQ, v, true);
+      add(maxQ, v, false);
+      ++seq;
+      if(count < N) { ++count; }
+      return((oldMin != getMin()) || (oldMax != getMax()));
+      }
+
+    // Minimum and maximum of the samples in the window; 0xff if none.
+    uint8_t getMin() const { return((0 == minQ.len) ? 0xff : minQ.front().v); }
+    uint8_t getMax() const { return((0 == maxQ.len) ? 0xff : maxQ.front().v); }
+    // Number of samples in the window [0,N].
+    uint8_t size() const { return(count); }
+  };
+
+
+}
+
+#endif // ARDUINO_LIB_OTV0P2BASE_SLIDINGWINDOWMINMAX_H
@@ -22,29 +22,113 @@ Author(s) / Copyright (s): Deniz Erbilgin 2016
 #define CONTENT_OTRADIOLINK_UTILITY_OTV0P2BASE_SOFTSERIALASYNC_H_
 
 
-#ifdef ARDUINO_ARCH_AVR
-
 #include <stdint.h>
+
+#ifdef ARDUINO_ARCH_AVR
 #include "Arduino.h"
 #include <Stream.h>
 #include "utility/OTV0P2BASE_FastDigitalIO.h"
 #include "utility/OTV0P2BASE_Sleep.h"
+#endif // ARDUINO_ARCH_AVR
 
 namespace OTV0P2BASE
 {
 
 static const uint8_t OTSOFTSERIALASYNC_BUFFER_SIZE = 32;  // size of buffer for holding input chars
 
+/**
+ * @class   ISRRXByteRingBuffer
+ * @brief   Lock-free single-producer single-consumer byte ring buffer.
+ *          The producer is an ISR calling push(), the consumer is the main
+ *          thread calling pop()/peek()/size().
+ * @param   bufSize: Capacity in bytes. Must be a power of two, max 128.
+ * @note    Head and tail are free-running 8-bit indices each written by only
+ *          one side, and single-byte loads and stores are atomic on AVR,
+ *          so no interrupt lock-out is needed on either side.
+ * @note    When full, incoming bytes are dropped and counted in getOverruns().
+ * @note    Portable so that it can be unit tested off-target.
+ */
+template <uint8_t bufSize>
+class ISRRXByteRingBuffer final
+{
+    static_assert(0 != bufSize, "buffer must not be empty");
+    static_assert(0 == (bufSize & (bufSize - 1)), "buffer size must be a power of 2");
+    static_assert(bufSize <= 128, "free-running 8-bit indices need size <= 128");
+    static constexpr uint8_t mask = bufSize - 1;
+
+    // Index of next byte to be read; written only by the consumer.
+    volatile uint8_t head = 0;
+    // Index of next byte to be written; written only by the producer.
+    volatile uint8_t tail = 0;
+    // Count of bytes dropped because the buffer was full; saturates at 255.
+    volatile uint8_t overruns = 0;
+    volatile uint8_t buf[bufSize];
+
+public:
+    /**
+     * @brief   Append a byte. Call only from the producer (ISR) side.
+     * @retval  true if the byte was stored, false if the buffer was full.
+     */
+    bool push(const uint8_t c)
+    {
+        const uint8_t t = tail;
+        if((uint8_t)(t - head) >= bufSize) {
+            if(0xff != overruns) { overruns = overruns + 1; }
+            return(false);
+        }
+        buf[t & mask] = c;
+        tail = t + 1; // Publish only once the byte is in place.
+        return(true);
+    }
+    /**
+     * @brief   Remove and return the oldest byte. Call only from the consumer side.
+     * @retval  Oldest byte, or -1 if empty.
+     */
+    int pop()
+    {
+        const uint8_t h = head;
+        if(h == tail) { return(-1); }
+        const uint8_t c = buf[h & mask];
+        head = h + 1; // Release the slot only once the byte has been copied out.
+        return(c);
+    }
+    /**
+     * @brief   Return the oldest byte without removing it.
+     * @retval  Oldest byte, or -1 if empty.
+     */
+    int peek() const
+    {
+        const uint8_t h = head;
+        if(h == tail) { return(-1); }
+        return(buf[h & mask]);
+    }
+    // Number of bytes waiting to be read; O(1).
+    uint8_t size() const { return((uint8_t)(tail - head)); }
+    // Discard all queued bytes. Call only from the consumer side.
+    void clear() { head = tail; }
+    // Number of bytes dropped because the buffer was full (saturating).
+    uint8_t getOverruns() const { return(overruns); }
+    // Buffer capacity in bytes.
+    static constexpr uint8_t capacity() { return(bufSize); }
+};
+
+
+#ifdef ARDUINO_ARCH_AVR
 /**
  * @class   OTSoftSerialAsync
  * @brief   Asynchronous software serial with exposed interrupt handler.
  *          Extends Stream.h from the Arduino core libraries.
+ *          Reception is interrupt-driven: the application routes the
+ *          pin-change interrupt for rxPin to handle_interrupt(), which times
+ *          the frame from the start-bit edge, samples all 8 data bits and
+ *          queues the byte in a lock-free ring buffer.
+ *          available(), peek() and read() are O(1) and never block.
  * @param   rxPin: Receive pin for software UART.
  * @param   txPin: Transmit pin for software UART.
  * @param   baud: Speed of UART in baud. Currently reliably supports up to 4800 (will usually work at 9600 with no other interrupt enabled).
- * @note    This currently does not support a ring buffer. The read buffer is reset after each write.
  * @note    This currently supports a max speed of 4800 baud when used with the ATMega pin change interrupts
  *          and with an F_CPU of 1 MHz.
+ * @note    RX is half-duplex: bytes arriving while write() holds interrupts off are lost.
  * @todo    Move everything back into source file without breaking templating.
  */
 template <uint8_t rxPin, uint8_t txPin, uint16_t baud>
@@ -54,28 +138,23 @@ protected:
     // All these are compile time calculations and are automatically substituted as part of program code.
     static const constexpr uint16_t bitCycles = (F_CPU/4) / baud;  // Number of times _delay_x4cycles needs to loop for 1 bit.
     static const constexpr uint8_t writeDelay = bitCycles - 3;
-    static const constexpr uint8_t quarterDelay = (bitCycles / 4) - 1;  // For multisampling within a bit.
-    static const constexpr uint8_t halfDelay = (bitCycles / 2) - 6;  // Standard inter-bit delay.
-    static const constexpr uint8_t longDelay = halfDelay + quarterDelay;  // Longer inter-bit delay.
-    static const constexpr uint8_t shortDelay = halfDelay - quarterDelay;  // Shorter inter-bit delay.
-    static const constexpr uint8_t startDelay = (3 * bitCycles / 4) - 2;  // 3/4 bit delay + isr entry for first read.
+    // Approximate ISR entry latency (vector jump, prologue and edge check) in delay loops.
+    static const constexpr uint8_t isrEntryDelay = 10;
+    // Delay from the start-bit edge to the middle of the first data bit, less ISR entry.
+    static const constexpr uint16_t startDelay16 = ((3 * bitCycles) / 2) - isrEntryDelay;
+    static_assert((startDelay16 > 0) && (startDelay16 < 256), "baud out of range for F_CPU");
+    static const constexpr uint8_t startDelay = startDelay16;
+    // Inter-sample delay, less per-bit sample and shift overhead.
+    static const constexpr uint8_t readDelay = bitCycles - 3;
 
-    uint8_t rxBufferHead;  // Head of buffer.
-    volatile uint8_t rxBufferTail;  // Tail. Must be volatile as accessed from interrupt.
-    volatile uint8_t rxBuffer[OTSOFTSERIALASYNC_BUFFER_SIZE];
+    // Received bytes, filled by handle_interrupt().
+    ISRRXByteRingBuffer<OTSOFTSERIALASYNC_BUFFER_SIZE> rxBuffer;
 
 public:
     /**
-     * @brief   Constructor for OTSoftSerial2
-     */
-    OTSoftSerialAsync()
-    {
-        rxBufferHead = 0;
-        rxBufferTail = 0;
-    }
-    /**
-     * @brief   Initialises OTSoftSerial2 and sets up pins.
+     * @brief   Initialises OTSoftSerialAsync and sets up pins.
      * @param   speed: Not used. Kept for compatibility with Arduino libraries.
+     * @note    Does not enable the RX interrupt: see enableRXInterrupt().
      */
     void begin(const unsigned long, const uint8_t)
     {
@@ -83,20 +162,20 @@ public:
         pinMode(rxPin, INPUT_PULLUP);
         pinMode(txPin, OUTPUT);
         fastDigitalWrite(txPin, HIGH);
-        // init buffer
-        memset( (void *)rxBuffer, 0, OTSOFTSERIALASYNC_BUFFER_SIZE);
+        rxBuffer.clear();
     }
     void begin(const unsigned long) { begin(0, 0); }
 
     /**
      * @brief   Disables serial and releases pins.
      */
-    void end() { pinMode(txPin, INPUT_PULLUP); }
+    void end() { disableRXInterrupt(); pinMode(txPin, INPUT_PULLUP); }
 
     /**
      * @brief   Write a byte to serial as a binary value.
      * @param   byte: Byte to write.
      * @retval  Number of bytes written (always 1).
+     * @note    Queued RX bytes are retained; use discardInput() to drop stale input.
      */
     size_t write(const uint8_t byte)
     {
@@ -105,8 +184,6 @@ public:
             uint8_t mask = 0x01;
             uint8_t c = byte;
 
-            memset((void *)rxBuffer, 0, OTSOFTSERIALASYNC_BUFFER_SIZE); //for debug
-
             // Send start bit
             fastDigitalWrite(txPin, LOW);
             _softserial_delay(writeDelay);
@@ -122,45 +199,25 @@ public:
             // send stop bit
             fastDigitalWrite(txPin, HIGH);
             _softserial_delay(writeDelay);
-            // reset rx buffer.
-            rxBufferHead = 0;
-            rxBufferTail = 0;
         }
         return 1;
     }
 
     /**
      * @brief   Read next character in the input buffer without removing it.
-     * @retval  Next character in input buffer.
+     * @retval  Next character in input buffer. -1 if empty.
      */
-    int peek()
-    {
-        uint8_t head = rxBufferHead;
-        uint8_t tail = rxBufferTail;
-        if ((tail > 0) && (head < tail)) {
-            return rxBuffer[head];
-        }
-        else return -1;
-    }
+    int peek() { return(rxBuffer.peek()); }
     /**
      * @brief   Reads a byte from the serial and removes it from the buffer.
      * @retval  Next character in input buffer. -1 if empty.
      */
-    int read()
-    {
-        uint8_t head = rxBufferHead;
-        uint8_t tail = rxBufferTail;
-        if ((tail > 0) && (head < tail)) {
-            rxBufferHead = head + 1;
-            return rxBuffer[head];
-        }
-        else return -1;
-    }
+    int read() { return(rxBuffer.pop()); }
     /**
      * @brief   Get the number of bytes available to read in the input buffer.
      * @retval  The number of bytes available.
      */
-    int available() { return rxBufferTail-rxBufferHead; }
+    int available() { return(rxBuffer.size()); }
     /**
      * @brief   Check if serial port is ready for use.
      * @todo    Implement the time checks using this?
@@ -182,6 +239,39 @@ public:
         fastDigitalWrite(txPin, HIGH);
     }
 
+    /**
+     * @brief   Drop any bytes queued in the RX buffer.
+     */
+    void discardInput() { rxBuffer.clear(); }
+    /**
+     * @brief   Number of received bytes dropped because the RX buffer was full.
+     */
+    uint8_t getRXOverruns() const { return(rxBuffer.getOverruns()); }
+
+    /**
+     * @brief   Enable the pin-change interrupt for rxPin.
+     * @note    The application must route the relevant PCINTn_vect to handle_interrupt().
+     */
+    void enableRXInterrupt()
+    {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            *digitalPinToPCMSK(rxPin) |= _BV(digitalPinToPCMSKbit(rxPin));
+            PCICR |= _BV(digitalPinToPCICRbit(rxPin));
+        }
+    }
+    /**
+     * @brief   Disable the pin-change interrupt for rxPin, eg to save power when no reply is expected.
+     * @note    Leaves PCICR alone as other pins in the same group may still need it.
+     */
+    void disableRXInterrupt()
+    {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            *digitalPinToPCMSK(rxPin) &= (uint8_t)~_BV(digitalPinToPCMSKbit(rxPin));
+        }
+    }
+
     /**
      * @brief   Inline delay.
      * @param   n: Number of loops to delay for. Each loop takes 4 clock cycles.
@@ -202,74 +292,33 @@ public:
 
     /**
      * @brief   Interrupt handler containing read routine.
-     * @fixme   Does not read the most significant bit.
-     * @fixme   Cannot enter and exit fast enough for this to be reliable at 9600 baud.
+     *          Call from the pin-change ISR covering rxPin.
+     *          Entry to the ISR is taken as the timestamp of the falling
+     *          start-bit edge; each data bit is then sampled once at its
+     *          centre relative to that, and the byte queued in rxBuffer.
+     *          Returns at the centre of the last data bit, leaving at least
+     *          1.5 bit times before the next start bit can arrive.
+     * @note    Rising edges (eg into the stop bit) see the line high and
+     *          return immediately.
      */
     inline void handle_interrupt() __attribute__((always_inline))
     {
-        // Blocking read:
-        uint8_t bufptr = rxBufferTail;
+        // Not a start bit.
+        if(fastDigitalRead(rxPin)) { return; }
         uint8_t val = 0;
-        // wait for first read time (start bit + 1 quarter of 1st bit)
+        // Wait for the centre of the first data bit.
         _softserial_delay(startDelay);
-
-        // Step through bits and read value.
-        for (uint8_t i = 0; i < 7; i++) {
-            // The loop fills in the top bit of and shifts down to reverse bit order
-            // (UART is sent least significant bit(lsb) first, we need most significant bit (msb) first)
-            uint8_t bitval = 0;
-
-            // Put 3 samples, each a quarter of a bit apart, into bitval.
-            // fixme this could be put in a loop.
-            bitval = fastDigitalRead(rxPin);
-            bitval = (bitval << 1);
-            _softserial_delay(quarterDelay);
-            bitval += fastDigitalRead(rxPin);
-            bitval = (bitval << 1);
-            _softserial_delay(quarterDelay);
-            bitval += fastDigitalRead(rxPin);
-
-            // Work out if bit high and adjust delay.
-            // If bitval == 111, 110 or 011, the bit was high.
-            if ((bitval >= 5) || (bitval == 3)) { // True
-                val += (1 << 7);  // Set msb in val high.
-                // If 011, we sampled too early so we wait longer.
-                if(bitval == 0b011) _softserial_delay(longDelay);
-                // If 110, we sampled too late so we wait less.
-                else if (bitval == 0b110) _softserial_delay(shortDelay);
-                // If 111 or 101, we don't adjust the delay.
-                else _softserial_delay(halfDelay);
-            } else { // False
-                val += (0 << 7);  // set lsb in val low.
-                if(bitval == 0b100) _softserial_delay(longDelay); // Too fast
-                else if ( bitval == 0b001) _softserial_delay(shortDelay); // Too slow
-                else _softserial_delay(halfDelay);
-            }
-            val = val >> 1;  // shift val down.
-        }
-#if 0 // Cannot exit fast enough with this.
-        // This reads the last bit. No need for a delay as we exit the interrupt afterwards.
-        {
-            uint8_t bitval = 0;
-            PORTC |= (1 << 2);
-            bitval = fastDigitalRead(rxPin);
-            _delay_x4cycles(quarterDelay);
-            bitval += fastDigitalRead(rxPin);
-            _delay_x4cycles(quarterDelay);
-            bitval += fastDigitalRead(rxPin);
-            PORTC &= ~(1 << 2);
-            if ((bitval >= 5) || (bitval == 3)) { // True
-                val += (1 << 7);
-            } else { // False
-                val += (0 << 7);
-            }
-        }
-#endif
-        // Put val in the read buffer and increment the tail.
-        if (bufptr < sizeof(rxBuffer)) {
-            rxBuffer[bufptr] = val;
-            rxBufferTail = bufptr + 1;
+        // Step through bits, LSB first, filling in the top bit and shifting down.
+        for(uint8_t i = 8; ; ) {
+            val >>= 1;
+            if(fastDigitalRead(rxPin)) { val |= 0x80; }
+            if(0 == --i) { break; }
+            _softserial_delay(readDelay);
         }
+        // Clear the pending flag raised by data-bit edges while sampling,
+        // so the handler does not immediately re-enter mid-frame.
+        PCIFR = _BV(digitalPinToPCICRbit(rxPin));
+        rxBuffer.push(val);
     }
     /**************************************************************************
      * ------------------------ Unimplemented ------------------------------- *
@@ -292,10 +341,9 @@ public:
     int availableForWrite() { return 0; }  //
 
 };
+#endif // ARDUINO_ARCH_AVR
 
 
 }
 
-#endif // ARDUINO_ARCH_AVR
-
 #endif /* CONTENT_OTRADIOLINK_UTILITY_OTV0P2BASE_SOFTSERIALASYNC_H_ */
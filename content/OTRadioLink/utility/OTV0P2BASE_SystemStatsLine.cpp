@@ -0,0 +1,110 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ Binary status record encoding and decoding.
+ */
+
+#include "OTV0P2BASE_SystemStatsLine.h"
+#include "OTV0P2BASE_CRC.h"
+
+
+namespace OTV0P2BASE
+{
+
+
+constexpr uint8_t BinaryStatusRecord::VERSION;
+constexpr uint8_t BinaryStatusRecord::MAX_PAYLOAD_BYTES;
+constexpr uint8_t BinaryStatusRecord::MAX_FRAME_BYTES;
+
+// Encode as a complete frame; returns the frame length, or 0 if buf is too small.
+uint8_t BinaryStatusRecord::encode(uint8_t *const buf, const uint8_t bufLen) const
+    {
+    if((NULL == buf) || (bufLen < MAX_FRAME_BYTES)) { return(0); }
+    uint8_t *p = buf + 2;
+    *p++ = VERSION;
+    *p++ = flags & (MODE_MASK | HAS_VALVE | HAS_TEMP | HAS_RH | HAS_AMBLIGHT | HAS_OCC);
+    if(0 != (flags & HAS_VALVE)) { *p++ = valvePC; }
+    if(0 != (flags & HAS_TEMP)) { *p++ = uint8_t(tempC16); *p++ = uint8_t(uint16_t(tempC16) >> 8); }
+    if(0 != (flags & HAS_RH)) { *p++ = rh; }
+    if(0 != (flags & HAS_AMBLIGHT)) { *p++ = ambLight; }
+    if(0 != (flags & HAS_OCC)) { *p++ = occ; }
+    const uint8_t payloadLen = uint8_t(p - (buf + 2));
+    buf[0] = SERLINE_START_CHAR_BSTATS;
+    buf[1] = payloadLen;
+    *p++ = crc8_dallas(buf + 1, uint8_t(payloadLen + 1));
+    *p++ = '\r';
+    *p++ = '\n';
+    return(uint8_t(p - buf));
+    }
+
+// Decode one frame starting at buf; returns the frame length if valid, else 0.
+uint8_t BinaryStatusRecord::decode(const uint8_t *const buf, const size_t len)
+    {
+    if((NULL == buf) || (len < 7) || (SERLINE_START_CHAR_BSTATS != buf[0])) { return(0); }
+    const uint8_t payloadLen = buf[1];
+    if((payloadLen < 2) || (payloadLen > MAX_PAYLOAD_BYTES)) { return(0); }
+    const uint8_t frameLen = uint8_t(payloadLen + 5);
+    if(len < frameLen) { return(0); }
+    if(crc8_dallas(buf + 1, uint8_t(payloadLen + 1)) != buf[payloadLen + 2]) { return(0); }
+    const uint8_t *p = buf + 2;
+    if(VERSION != *p++) { return(0); }
+    const uint8_t f = *p++;
+    // Check that the flagged fields exactly fill the payload.
+    const uint8_t expected = uint8_t(2 +
+        ((0 != (f & HAS_VALVE)) ? 1 : 0) + ((0 != (f & HAS_TEMP)) ? 2 : 0) +
+        ((0 != (f & HAS_RH)) ? 1 : 0) + ((0 != (f & HAS_AMBLIGHT)) ? 1 : 0) +
+        ((0 != (f & HAS_OCC)) ? 1 : 0));
+    if(expected != payloadLen) { return(0); }
+    BinaryStatusRecord r;
+    r.flags = f;
+    if(0 != (f & HAS_VALVE)) { r.valvePC = *p++; }
+    if(0 != (f & HAS_TEMP)) { r.tempC16 = int16_t(uint16_t(p[0] | (uint16_t(p[1]) << 8))); p += 2; }
+    if(0 != (f & HAS_RH)) { r.rh = *p++; }
+    if(0 != (f & HAS_AMBLIGHT)) { r.ambLight = *p++; }
+    if(0 != (f & HAS_OCC)) { r.occ = *p++; }
+    *this = r;
+    return(frameLen);
+    }
+
+// Decode all valid frames in a logged serial capture, in order.
+size_t BinaryStatusRecord::decodeBatch(const uint8_t *const capture, const size_t len,
+                                       BinaryStatusRecord *const out, const size_t maxOut,
+                                       size_t *const skippedOpt)
+    {
+    size_t n = 0;
+    size_t skipped = 0;
+    size_t i = 0;
+    while((i < len) && (n < maxOut))
+        {
+        // Skip quickly to the next possible frame start.
+        const uint8_t *const s = (const uint8_t *)memchr(capture + i, SERLINE_START_CHAR_BSTATS, len - i);
+        if(NULL == s) { skipped += len - i; i = len; break; }
+        skipped += size_t(s - (capture + i));
+        i = size_t(s - capture);
+        const uint8_t fl = out[n].decode(s, len - i);
+        if(0 == fl) { ++skipped; ++i; continue; }
+        ++n;
+        i += fl;
+        }
+    if(NULL != skippedOpt) { *skippedOpt = skipped + (len - i); }
+    return(n);
+    }
+
+
+}
@@ -25,6 +25,7 @@ Author(s) / Copyright (s): Damon Hart-Davis 2017
 #ifndef OTV0P2BASE_SYSTEMSTATSLINE_H
 #define OTV0P2BASE_SYSTEMSTATSLINE_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -40,6 +41,66 @@ namespace OTV0P2BASE
 {
 
 
+// Compact binary alternative to the '=' status line.
+// Built into a small buffer and written in one burst,
+// so that the UART is powered for less time,
+// and cheap to parse on a logging hub.
+// Portable, so that hosts can decode logged serial captures.
+//
+// Frame: '#' len payload[len] crc CR LF
+//   * len is the payload length [2,MAX_PAYLOAD_BYTES]
+//   * crc is crc8_dallas() over len and the payload
+//   * the trailing CRLF keeps text-oriented loggers happy
+//     and is not covered by the CRC.
+// Payload:
+//   * version (VERSION)
+//   * flags: mode in bits 0--1 (0 FROST, 1 WARM, 2 BAKE) then HAS_XXX bits
+//   * then in order, only if flagged present:
+//     valve % open, temperature C*16 (int16_t little-endian),
+//     RH%, ambient light, occupancy %.
+struct BinaryStatusRecord final
+  {
+  static constexpr uint8_t VERSION = 1;
+  static constexpr uint8_t MODE_MASK = 3;
+  static constexpr uint8_t MODE_FROST = 0;
+  static constexpr uint8_t MODE_WARM = 1;
+  static constexpr uint8_t MODE_BAKE = 2;
+  static constexpr uint8_t HAS_VALVE = 4;
+  static constexpr uint8_t HAS_TEMP = 8;
+  static constexpr uint8_t HAS_RH = 16;
+  static constexpr uint8_t HAS_AMBLIGHT = 32;
+  static constexpr uint8_t HAS_OCC = 64;
+  static constexpr uint8_t MAX_PAYLOAD_BYTES = 8;
+  static constexpr uint8_t MAX_FRAME_BYTES = MAX_PAYLOAD_BYTES + 5;
+
+  // Mode and HAS_XXX flags.
+  uint8_t flags = MODE_FROST;
+  uint8_t valvePC = 0;
+  int16_t tempC16 = 0;
+  uint8_t rh = 0;
+  uint8_t ambLight = 0;
+  uint8_t occ = 0;
+
+  // Mode as shown in the text line: 'F', 'W' or 'B'.
+  char getModeChar() const
+    { const uint8_t m = flags & MODE_MASK; return((MODE_BAKE == m) ? 'B' : ((MODE_WARM == m) ? 'W' : 'F')); }
+
+  // Encode as a complete frame; returns the frame length, or 0 if buf is too small.
+  uint8_t encode(uint8_t *buf, uint8_t bufLen) const;
+
+  // Decode one frame starting at buf (with up to len bytes available).
+  // Returns the frame length if valid, else 0 leaving this unchanged.
+  uint8_t decode(const uint8_t *buf, size_t len);
+
+  // Decode all valid frames in a logged serial capture, in order,
+  // skipping text lines and corrupt data.
+  // Returns the number of records written to out (at most maxOut);
+  // if skippedOpt is not NULL it is set to the number of bytes not in any frame decoded.
+  static size_t decodeBatch(const uint8_t *capture, size_t len,
+                            BinaryStatusRecord *out, size_t maxOut,
+                            size_t *skippedOpt = NULL);
+  };
+
 // V0.09 / V0.2 style '=' stats line generation.
 // Parameterised and made somewhat unit testable.
 //
@@ -105,6 +166,9 @@ namespace OTV0P2BASE
 //'HC' introduces the optional FHT8V house codes section, if supported and codes are set.
 //eg 'HC99 99'
 //HChc1 hc2 are the house codes 1 and 2 for an FHT8V valve.
+//
+// In binary mode (see setBinaryMode()) a BinaryStatusRecord frame
+// is sent instead, with all the available sensor values each time.
 
 template
   <
@@ -167,9 +231,55 @@ class SystemStatsLine final
         typedef typename typeIf<noJS, dummySSR, SimpleStatsRotation<ss1Size>>::t ss1_type;
         ss1_type ss1;
 
+        // True to send binary records rather than text lines.
+        bool binaryMode = false;
+
+        // Reads an optional source into v and returns true if it is present (non-NULL).
+        // Selected at compile time so that no call through a NULL source is generated.
+        template <class T, const T *source, bool present = (NULL != source)>
+          struct optValue final
+            { template <class V> static bool read(V &v) { v = source->get(); return(true); } };
+        template <class T, const T *source>
+          struct optValue<T, source, false> final
+            { template <class V> static bool read(V &) { return(false); } };
+
     public:
+        // Select binary records rather than text lines from serialStatusReport().
+        void setBinaryMode(const bool binary) { binaryMode = binary; }
+        bool isBinaryMode() const { return(binaryMode); }
+
+        // Sends a BinaryStatusRecord frame in one write.
+        // Will turn on UART just for the duration of this call if powered off.
+        void serialStatusReportBinary()
+            {
+            BinaryStatusRecord r;
+            r.flags = valveMode->inWarmMode() ?
+                (valveMode->inBakeMode() ? BinaryStatusRecord::MODE_BAKE : BinaryStatusRecord::MODE_WARM) :
+                BinaryStatusRecord::MODE_FROST;
+            if(optValue<radValve_t, modelledRadValveOpt>::read(r.valvePC)) { r.flags |= BinaryStatusRecord::HAS_VALVE; }
+            if(optValue<tempC16_t, tempC16Opt>::read(r.tempC16)) { r.flags |= BinaryStatusRecord::HAS_TEMP; }
+            if(optValue<humidity_t, humidityOpt>::read(r.rh)) { r.flags |= BinaryStatusRecord::HAS_RH; }
+            if(optValue<ambLight_t, ambLightOpt>::read(r.ambLight)) { r.flags |= BinaryStatusRecord::HAS_AMBLIGHT; }
+            if(optValue<occupancy_t, occupancyOpt>::read(r.occ)) { r.flags |= BinaryStatusRecord::HAS_OCC; }
+            uint8_t buf[BinaryStatusRecord::MAX_FRAME_BYTES];
+            const uint8_t n = r.encode(buf, sizeof(buf));
+
+#if defined(ARDUINO_ARCH_AVR)
+            const bool neededWaking = wakeFlushSleepSerial &&
+                OTV0P2BASE::powerUpSerialIfDisabled<>();
+#endif
+            // Via Print so that a derived write(uint8_t) cannot hide the bulk write.
+            static_cast<Print *>(printer)->write(buf, n);
+#if defined(ARDUINO_ARCH_AVR)
+            OTV0P2BASE::flushSerialSCTSensitive();
+            if(neededWaking) { OTV0P2BASE::powerDownSerial(); }
+#endif
+            }
+
         void serialStatusReport()
             {
+            if(binaryMode) { serialStatusReportBinary(); return; }
+
             // GCC/clang 4.x sillies prevent validating statically or otherwise...
 //            static_assert(printer, "printer must not be null");
 //            static_assert(valveMode, "valveMode must not be null");
@@ -211,6 +211,79 @@ class ScratchSpaceTemplate final
 
 using ScratchSpace = ScratchSpaceTemplate<uint8_t>;
 
+// Compile-time aggregation of scratch space requirements.
+// scratchSum() for space used together (eg a routine's own plus its callee's),
+// scratchMax() for space used by alternative callees in turn.
+constexpr size_t scratchSum() { return(0); }
+template<typename... Ts>
+constexpr size_t scratchSum(const size_t n, const Ts... rest) { return(n + scratchSum(rest...)); }
+constexpr size_t scratchMax() { return(0); }
+template<typename... Ts>
+constexpr size_t scratchMax(const size_t n, const Ts... rest)
+    { return((n > scratchMax(rest...)) ? n : scratchMax(rest...)); }
+
+// Bump-pointer arena over caller-supplied scratch space.
+// Sub-buffers are carved off the front with alloc()
+// and released in LIFO order by restoring a Mark,
+// so no per-buffer offsets or sizes need be maintained by hand.
+// Allocation failure returns NULL and is remembered (see overflowed()),
+// so a routine may make all its allocations and then check once.
+// Not limited to 255 bytes, so may be used for larger (eg batch) buffers.
+// Not thread-/ISR- safe.
+class ScratchArena final
+  {
+  private:
+    uint8_t *const base;
+    const size_t size;
+    // Bytes currently allocated.
+    size_t top = 0;
+    // Maximum bytes ever allocated.
+    size_t hwm = 0;
+    // True once any allocation has failed.
+    bool overflow = false;
+
+  public:
+    // Arena over buf, of size bytes; unusable if buf is NULL or size is 0.
+    constexpr ScratchArena(uint8_t *const buf, const size_t size_)
+      : base((0 == size_) ? NULL : buf), size((NULL == buf) ? 0 : size_) { }
+    // Arena over the whole of an existing scratch space.
+    explicit constexpr ScratchArena(const ScratchSpaceL &s) : base(s.buf), size(s.bufsize) { }
+
+    // Allocate n (> 0) contiguous bytes, else return NULL and note the overflow.
+    uint8_t *alloc(const size_t n)
+      {
+      if((0 == n) || (n > size - top)) { overflow = true; return(NULL); }
+      uint8_t *const p = base + top;
+      top += n;
+      if(top > hwm) { hwm = top; }
+      return(p);
+      }
+
+    // All unallocated space as a ScratchSpaceL, eg for a callee.
+    ScratchSpaceL rest() const { return(ScratchSpaceL((NULL == base) ? NULL : base + top, size - top)); }
+
+    size_t getSize() const { return(size); }
+    size_t used() const { return(top); }
+    size_t remaining() const { return(size - top); }
+    // Maximum space ever in use at once, eg to size the backing buffer.
+    size_t highWater() const { return(hwm); }
+    // True if any allocation has failed.
+    bool overflowed() const { return(overflow); }
+
+    // Scoped mark: frees everything allocated after it when it goes out of scope.
+    class Mark final
+      {
+      private:
+        ScratchArena &a;
+        const size_t savedTop;
+      public:
+        explicit Mark(ScratchArena &a_) : a(a_), savedTop(a_.top) { }
+        ~Mark() { a.top = savedTop; }
+        Mark(const Mark &) = delete;
+        Mark &operator=(const Mark &) = delete;
+      };
+  };
+
 // Diagnostic tools for memory problems.
 // Arduino AVR memory layout: DATA, BSS [_end, __bss_end], (HEAP,) [SP] STACK [RAMEND]
 // See: http://web-engineering.info/node/30
@@ -325,137 +398,15 @@ class MemoryChecks
     // stored counter is multiplied by 2 to to correspond to disassembly output.
     static size_t getPC() {return programCounter * 2;}
 
-#ifdef OTMEMCHECKS_FREQ_PROFILING
-  public:
-    static constexpr uint8_t callTableSize = 8;
-  private:
-    // coarse profiling
-    // Arrays to store maximum and minimum calls by various functions.
-    // Will work as long as functions are not called more than 255 times - highly unlikely in V0p2.
-    static volatile uint8_t curCalls[callTableSize];
-    static volatile uint8_t maxCalls[callTableSize];
-    static volatile uint8_t minCalls[callTableSize];
-  public:
-    // Reset call table to appropriate values (curCalls and maxCalls should grow upwards, minCalls should grow downwards)
-    // Assuming that we don't have to worry about overflowing in this instance, to avoid needing atomics.
-    static void initCallTable() { memset ((uint8_t * const)curCalls, 0, sizeof curCalls); memset((uint8_t * const)maxCalls, 0, sizeof(maxCalls)); memset((uint8_t * const)minCalls, 255, sizeof(minCalls)); };
-
-    // Update maxCalls and minCalls then clear curCalls.
-    // This should be called by the watchdog routine in OTRadioLink_RTC.h/cpp
-    static void resetCallTable()
-    {
-        uint8_t *maxp = (uint8_t *)maxCalls;
-        uint8_t *minp = (uint8_t *)minCalls;
-        for( uint8_t * ip = (uint8_t *)curCalls; ip != ( curCalls + sizeof(curCalls) );) {
-            *maxp = OTV0P2BASE::fnmax(*maxp, *ip);
-            *minp = OTV0P2BASE::fnmin(*minp, *ip);
-            *ip = 0;  // Since we're iterating through it, reset currCalls as we go.
-            // Point to next entries.
-            ++ip; ++maxp; ++minp;
-        }
-    }
-
-    /**
-     * @brief   Increments current calls table.
-     * @note    Location Table:
-     *           0: loop
-     *           1: ISR(PCINT0_vect)
-     *           2: pollIO
-     *           3: decodeAndHandleSecureFrame
-     *           4: bareStatsTX
-     * @note    Calls table will overflow at 255 calls. Not a problem on V0p2
-     *          but may require bounds checking/larger tables in other apps.
-     */
-    static void fnCalled(uint8_t loc) { ++curCalls[loc]; }
-
-    /**
-     * @brief   Copy the min and max calls into a pair of uint8_t arrays
-     *          supplied by the caller.
-     * @param   maxBuf: Array to copy maximum number number of calls into.
-     *                  Minimum length is callTableSize.
-     * @param   minBuf: Array to copy minimum number number of calls into.
-     *                  Minimum length is callTableSize.
-     */
-    static void getCallTable(uint8_t * const maxBuf, uint8_t * const minBuf)
-        {memcpy(maxBuf, (const uint8_t *)maxCalls, sizeof(maxCalls)); memcpy(minBuf, (const uint8_t *)minCalls, sizeof(minCalls));}
-#else // OTMEMCHECKS_FREQ_PROFILING
-    // stub versions of profiling functions
+    // Stubs for the old fixed call/time profiling tables, kept for source compatibility.
+    // Use the named scoped probes in OTV0P2BASE_Profiler.h instead.
     static void initCallTable() {}
     static void resetCallTable() {}
     static void fnCalled(uint8_t) {}
     static void getCallTable(uint8_t *const, uint8_t *const) {}
-#endif // OTMEMCHECKS_FREQ_PROFILING
-#ifdef OTMEMCHECKS_TIME_PROFILING
-  public:
-    static constexpr uint8_t timeTableSize = 8;
-  private:
-    // coarse profiling
-    // Arrays to store maximum and minimum calls by various functions.
-    // Will work as long as functions are not called more than 255 times - highly unlikely in V0p2.
-    static volatile uint8_t tempStartTime[timeTableSize];
-    static volatile uint8_t startTime[timeTableSize];
-    static volatile uint8_t duration[timeTableSize];
-  public:
-    // Reset call table to appropriate values (curCalls and maxCalls should grow upwards, minCalls should grow downwards)
-    // Assuming that we don't have to worry about overflowing in this instance, to avoid needing atomics.
-    static void initTimeTable() { memset((uint8_t * const)tempStartTime, 0, sizeof(tempStartTime)); memset ((uint8_t * const)startTime, 0, sizeof startTime); memset((uint8_t * const)duration, 0, sizeof(duration)); };
-
-//    // Update maxCalls and minCalls then clear curCalls.
-//    // This should be called by the watchdog routine in OTRadioLink_RTC.h/cpp
-//    static void resetTimeTable()
-//    {
-//        uint8_t *maxp = (uint8_t *)maxCalls;
-//        uint8_t *minp = (uint8_t *)minCalls;
-//        for( uint8_t * ip = (uint8_t *)curCalls; ip != ( curCalls + sizeof(curCalls) );) {
-//            *maxp = OTV0P2BASE::fnmax(*maxp, *ip);
-//            *minp = OTV0P2BASE::fnmin(*minp, *ip);
-//            *ip = 0;  // Since we're iterating through it, reset currCalls as we go.
-//            // Point to next entries.
-//            ++ip; ++maxp; ++minp;
-//        }
-//    }
-
-    /**
-     * @brief   Increments current calls table.
-     * @note    Location Table:
-     *           0: loop
-     *           1: ISR(PCINT0_vect)
-     *           2: pollIO
-     *           3: decodeAndHandleSecureFrame
-     *           4: bareStatsTX
-     * @note    Calls table will overflow at 255 calls. Not a problem on V0p2
-     *          but may require bounds checking/larger tables in other apps.
-     */
-    static void fnStart(uint8_t loc) {
-        tempStartTime[loc] = OTV0P2BASE::getSubCycleTime();
-    }
-    static void fnExit(uint8_t loc) {
-        const uint8_t curTime = OTV0P2BASE::getSubCycleTime();
-        const uint8_t temp = tempStartTime[loc];
-        volatile uint8_t &start = startTime[loc];
-        volatile uint8_t &dur = duration[loc];
-        const uint8_t curDur = curTime - temp;
-        if(255 < (uint16_t)(start + dur)) { return; }
-        if(curDur > dur) { start = temp; dur = curDur;}
-//        volatile uint8_t *const start = &startTime[loc];
-//        volatile uint8_t *const dur = &duration[loc];
-//        const uint8_t curDur = curTime - temp;
-//        if(255 < (uint16_t)(*start + *dur)) { return; }
-//        if(curDur > *dur) { *start = temp; *dur = curDur;}
-    }
-
-    /**
-     * @brief   Copy the min and max calls into a pair of uint8_t arrays
-     *          supplied by the caller.
-     * @param   maxBuf: Array to copy maximum number number of calls into.
-     *                  Minimum length is callTableSize.
-     * @param   minBuf: Array to copy minimum number number of calls into.
-     *                  Minimum length is callTableSize.
-     */
-    static void getTimeTable(uint8_t * const startTimeBuf, uint8_t * const durBuf)
-        {memcpy(startTimeBuf, (const uint8_t *)startTime, sizeof(startTime)); memcpy(durBuf, (const uint8_t *)duration, sizeof(duration));}
-//#else // OTMEMCHECKS_TIME_PROFILING
-#endif
+    static void initTimeTable() {}
+    static void fnStart(uint8_t) {}
+    static void fnExit(uint8_t) {}
 };
 
 /**
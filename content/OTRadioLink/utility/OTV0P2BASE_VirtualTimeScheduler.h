@@ -0,0 +1,277 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * Deterministic discrete-event virtual-time scheduler for host simulations.
+ *
+ * Drives the RTC (seconds, minutes since midnight, days)
+ * and a virtual sub-cycle time from a single virtual clock,
+ * and calls components' periodic poll()/read()/tick() routines
+ * from a priority queue of events in virtual time order.
+ *
+ * The clock jumps straight to the next due event,
+ * so idle periods cost nothing and months of device time
+ * can be simulated in seconds.
+ *
+ * Host only: not for use on AVR, where time is real.
+ */
+
+#ifndef OTV0P2BASE_VIRTUALTIMESCHEDULER_H
+#define OTV0P2BASE_VIRTUALTIMESCHEDULER_H
+
+#ifndef ARDUINO_ARCH_AVR
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "OTV0P2BASE_RTC.h"
+#include "OTV0P2BASE_Sensor.h"
+
+namespace OTV0P2BASE
+{
+namespace VirtualTime
+{
+
+// Virtual time in sub-cycle ticks since midnight at the start of day 0.
+typedef uint64_t vtime_t;
+
+// Sub-cycle ticks per basic (2s) cycle, ie GSCT_MAX + 1 on V0p2 hardware.
+static constexpr uint16_t SUBCYCLE_TICKS_PER_CYCLE = 256;
+// Length of the basic cycle in seconds.
+static constexpr uint8_t CYCLE_S = 2;
+// Sub-cycle ticks per second.
+static constexpr uint8_t TICKS_PER_S = uint8_t(SUBCYCLE_TICKS_PER_CYCLE / CYCLE_S);
+
+// Convert seconds, minutes and (days, hours, minutes, seconds) to virtual time.
+inline constexpr vtime_t seconds(const uint32_t s) { return(vtime_t(s) * TICKS_PER_S); }
+inline constexpr vtime_t minutes(const uint32_t m) { return(seconds(m * 60U)); }
+inline constexpr vtime_t at(const uint16_t days, const uint8_t hours, const uint8_t mins, const uint8_t secs = 0)
+    { return(seconds(((uint32_t(days) * 24U + hours) * 60U + mins) * 60U + secs)); }
+
+// Shadow of the current virtual sub-cycle time [0,255].
+inline uint8_t &_subCycleTimeVT() { static uint8_t sct; return(sct); }
+// Virtual-time equivalent of OTV0P2BASE::getSubCycleTime() [0,255];
+// suitable for passing as a getSubCycleTime-style function pointer.
+inline uint8_t getSubCycleTimeVT() { return(_subCycleTimeVT()); }
+
+// Adapt an object and one of its nullary member functions (eg read(), poll(), tick()) to a task.
+// The member's return value, if any, is discarded.
+// Eg: callMember<Sensor<uint8_t>, uint8_t, &Sensor<uint8_t>::read>
+template<class T, typename R, R (T::*m)()>
+void callMember(void *const ctx) { (static_cast<T *>(ctx)->*m)(); }
+
+/**
+ * @brief   Discrete-event scheduler with a virtual clock.
+ *
+ * Tasks are a function and context pointer,
+ * run once at a given time or periodically thereafter.
+ * Events due at the same virtual time run in the order they were scheduled,
+ * so runs are fully deterministic.
+ *
+ * Before each event runs, the RTC globals (getSecondsLT(),
+ * getMinutesSinceMidnightLT(), getDaysSince1999LT()) and getSubCycleTimeVT()
+ * are set from the virtual clock, so code under test sees consistent time.
+ *
+ * Holds no more than maxTasks tasks; no heap allocation.
+ * Not thread-safe; only one instance should be driving time at once.
+ *
+ * @param   maxTasks: maximum tasks scheduled at once; [1,254].
+ */
+template<uint8_t maxTasks = 16>
+class Scheduler final
+{
+public:
+    // Task routine, called with the context pointer given when scheduled.
+    typedef void (*task_fn_t)(void *ctx);
+
+private:
+    static_assert((maxTasks > 0) && (maxTasks < 255), "maxTasks out of range");
+
+    // Scheduled task; an unused slot has a NULL fn.
+    struct task_t
+    {
+        task_fn_t fn;
+        void *ctx;
+        // Interval between runs; 0 for one-shot.
+        vtime_t period;
+    };
+    task_t tasks[maxTasks];
+
+    // Pending event for a task; each task has exactly one while scheduled.
+    struct event_t
+    {
+        vtime_t due;
+        // Sequence number for FIFO order of events due at the same time.
+        uint32_t seq;
+        uint8_t task;
+    };
+    // Binary min-heap of pending events by (due, seq).
+    event_t heap[maxTasks];
+    uint8_t heapSize = 0;
+
+    // Current virtual time.
+    vtime_t now = 0;
+    // Next event sequence number.
+    uint32_t nextSeq = 0;
+    // Count of events run.
+    uint32_t eventsRun = 0;
+
+    static bool before(const event_t &a, const event_t &b)
+        { return((a.due < b.due) || ((a.due == b.due) && (a.seq < b.seq))); }
+
+    void push(const vtime_t due, const uint8_t task)
+    {
+        uint8_t i = heapSize++;
+        const event_t e = { due, nextSeq++, task };
+        while(i > 0) {
+            const uint8_t parent = uint8_t((i - 1) / 2);
+            if(!before(e, heap[parent])) { break; }
+            heap[i] = heap[parent];
+            i = parent;
+        }
+        heap[i] = e;
+    }
+
+    event_t pop()
+    {
+        const event_t top = heap[0];
+        const event_t last = heap[--heapSize];
+        uint8_t i = 0;
+        for( ; ; ) {
+            uint8_t child = uint8_t(2 * i + 1);
+            if(child >= heapSize) { break; }
+            if((child + 1 < heapSize) && before(heap[child + 1], heap[child])) { ++child; }
+            if(!before(heap[child], last)) { break; }
+            heap[i] = heap[child];
+            i = child;
+        }
+        if(heapSize > 0) { heap[i] = last; }
+        return(top);
+    }
+
+    // Publish the virtual clock to the RTC and sub-cycle time.
+    void publish() const
+    {
+        const vtime_t s = now / TICKS_PER_S;
+        _subCycleTimeVT() = uint8_t(now % SUBCYCLE_TICKS_PER_CYCLE);
+        _secondsLT = uint_fast8_t(s % 60);
+        _minutesSinceMidnightLT = uint_least16_t((s / 60) % 1440);
+        _daysSince1999LT = uint_least16_t(s / 86400U);
+    }
+
+public:
+    // Start at the given virtual time, eg at(6000, 12, 0) for noon on day 6000.
+    explicit Scheduler(const vtime_t startTime = 0) : now(startTime)
+    {
+        for(uint8_t i = 0; i < maxTasks; ++i) { tasks[i].fn = NULL; }
+        publish();
+    }
+
+    // Current virtual time.
+    vtime_t getTime() const { return(now); }
+    // Number of events run so far.
+    uint32_t getEventsRun() const { return(eventsRun); }
+    // Number of tasks currently scheduled.
+    uint8_t getTasksScheduled() const { return(heapSize); }
+    // True if an event is pending, in which case nextDue is set to its time.
+    bool getNextDue(vtime_t &nextDue) const
+    {
+        if(0 == heapSize) { return(false); }
+        nextDue = heap[0].due;
+        return(true);
+    }
+
+    /**
+     * @brief   Schedule a task.
+     * @param   fn: task routine; never NULL.
+     * @param   ctx: passed to fn.
+     * @param   delay: time from now of the first run; 0 runs at the current time.
+     * @param   period: time between runs, or 0 to run only once.
+     * @retval  task slot used, or -1 if no room or fn is NULL.
+     */
+    int addTask(const task_fn_t fn, void *const ctx, const vtime_t delay, const vtime_t period = 0)
+    {
+        if(NULL == fn) { return(-1); }
+        for(uint8_t i = 0; i < maxTasks; ++i) {
+            task_t &t = tasks[i];
+            if(NULL != t.fn) { continue; }
+            t.fn = fn;
+            t.ctx = ctx;
+            t.period = period;
+            push(now + delay, i);
+            return(i);
+        }
+        return(-1);
+    }
+
+    /**
+     * @brief   Schedule periodic read() of a sensor at its preferredPollInterval_s(),
+     *          or once per basic cycle if it expresses no preference.
+     * @param   delay: time from now of the first read.
+     * @retval  task slot used, or -1 if no room.
+     */
+    template<class T>
+    int addSensor(Sensor<T> &s, const vtime_t delay = 0)
+    {
+        const uint8_t pi = s.preferredPollInterval_s();
+        return(addTask(callMember<Sensor<T>, T, &Sensor<T>::read>, &s,
+                       delay, seconds((0 == pi) ? CYCLE_S : pi)));
+    }
+
+    /**
+     * @brief   Run the next event if it is due no later than limit.
+     *          Advances the clock to the event time first.
+     * @retval  true if an event was run.
+     */
+    bool step(const vtime_t limit)
+    {
+        if((0 == heapSize) || (heap[0].due > limit)) { return(false); }
+        const event_t e = pop();
+        task_t &t = tasks[e.task];
+        now = e.due;
+        publish();
+        ++eventsRun;
+        // Reschedule before running so that the task may add tasks.
+        const task_fn_t fn = t.fn;
+        void *const ctx = t.ctx;
+        if(0 != t.period) { push(e.due + t.period, e.task); }
+        else { t.fn = NULL; }
+        fn(ctx);
+        return(true);
+    }
+
+    // Run all events due up to and including endTime, then leave the clock at endTime.
+    // Returns the number of events run.
+    uint32_t runUntil(const vtime_t endTime)
+    {
+        const uint32_t startCount = eventsRun;
+        while(step(endTime)) { }
+        if(endTime > now) { now = endTime; publish(); }
+        return(eventsRun - startCount);
+    }
+
+    // Run for the given duration from now; returns the number of events run.
+    uint32_t runFor(const vtime_t duration) { return(runUntil(now + duration)); }
+};
+
+}
+}
+
+#endif // ARDUINO_ARCH_AVR
+
+#endif // OTV0P2BASE_VIRTUALTIMESCHEDULER_H
@@ -164,3 +164,165 @@ TEST(BoilerDriverTest, processCallsForHeatStackUsage)
     EXPECT_GT(BoilerDriverTest::maxStackProcessCallsForHeat, baseStack - OTV0P2BASE::MemoryChecks::getMinSP());
 }
 #endif
+
+// Test per-valve tracking and aggregates of ValveDemandTracker.
+TEST(BoilerDriverTest, valveDemandTrackerAggregates)
+{
+    OTRadValve::BoilerLogic::ValveDemandTracker<4, 3> vd(20);
+    EXPECT_EQ(0, vd.getLiveCount());
+    EXPECT_EQ(0, vd.getMaxPC());
+    EXPECT_TRUE(vd.update(0x1234, 50));
+    EXPECT_TRUE(vd.update(0x4321, 10));
+    EXPECT_TRUE(vd.update(0x0001, 30));
+    EXPECT_FALSE(vd.update(vd.EMPTY_ID, 30));
+    EXPECT_EQ(3, vd.getLiveCount());
+    EXPECT_EQ(90, vd.getSumPC());
+    EXPECT_EQ(2, vd.getCallingCount());
+    EXPECT_EQ(80, vd.getCallingSumPC());
+    EXPECT_EQ(50, vd.getMaxPC());
+    EXPECT_EQ(10, vd.getPercentOpen(0x4321));
+    EXPECT_EQ(0, vd.getPercentOpen(0x9999));
+    // Updating an existing ID replaces its value.
+    EXPECT_TRUE(vd.update(0x1234, 5));
+    EXPECT_EQ(3, vd.getLiveCount());
+    EXPECT_EQ(45, vd.getSumPC());
+    EXPECT_EQ(1, vd.getCallingCount());
+    EXPECT_EQ(30, vd.getMaxPC());
+    // Values are capped at 100.
+    EXPECT_TRUE(vd.update(0x0002, 255));
+    EXPECT_EQ(100, vd.getMaxPC());
+    // Table is full.
+    EXPECT_FALSE(vd.update(0x0003, 50));
+    // Changing threshold recomputes calling aggregates.
+    vd.setThreshold(5);
+    EXPECT_EQ(4, vd.getCallingCount());
+    EXPECT_EQ(145, vd.getCallingSumPC());
+}
+
+// Test timing-wheel expiry of ValveDemandTracker entries.
+TEST(BoilerDriverTest, valveDemandTrackerExpiry)
+{
+    OTRadValve::BoilerLogic::ValveDemandTracker<4, 3> vd(20);
+    EXPECT_TRUE(vd.update(1, 40));
+    vd.tickMinute();
+    EXPECT_TRUE(vd.update(2, 60));
+    vd.tickMinute();
+    EXPECT_EQ(2, vd.getLiveCount());
+    vd.tickMinute(); // Valve 1 now 3 minutes old.
+    EXPECT_EQ(1, vd.getLiveCount());
+    EXPECT_EQ(0, vd.getPercentOpen(1));
+    EXPECT_EQ(60, vd.getMaxPC());
+    // Refresh restarts expiry.
+    EXPECT_TRUE(vd.update(2, 70));
+    vd.tickMinute();
+    vd.tickMinute();
+    EXPECT_EQ(70, vd.getPercentOpen(2));
+    vd.tickMinute();
+    EXPECT_EQ(0, vd.getLiveCount());
+    EXPECT_EQ(0, vd.getSumPC());
+    EXPECT_EQ(0, vd.getCallingCount());
+    EXPECT_EQ(0, vd.getMaxPC());
+    // Expired slots are reused.
+    for(uint16_t id = 10; id < 14; ++id) { EXPECT_TRUE(vd.update(id, 25)); }
+    EXPECT_EQ(4, vd.getLiveCount());
+    EXPECT_EQ(100, vd.getCallingSumPC());
+    for(uint16_t id = 10; id < 14; ++id) { EXPECT_EQ(25, vd.getPercentOpen(id)); }
+}
+
+// Test that several valves each only partly open can together call for heat.
+TEST(BoilerDriverTest, boilerHubModeAggregateHeatCall)
+{
+    constexpr uint8_t heatCallPin = 0; // unused in unit tests.
+    constexpr bool inHubMode = true;
+    OTRadValve::BoilerLogic::OnOffBoilerDriverLogic<decltype(BoilerDriverTest::hm), BoilerDriverTest::hm, heatCallPin> bh;
+    // Trick boiler hub into believing 10 minutes have passed.
+    for(auto i = 0; i < 10; ++i) {
+        bh.processCallsForHeat(true, inHubMode);
+    }
+    // Just really open, but well short of moderately open, outside the 'encourage on' window.
+    const uint8_t pc = OTRadValve::DEFAULT_VALVE_PC_SAFER_OPEN;
+    ASSERT_LT(pc, OTRadValve::DEFAULT_VALVE_PC_MODERATELY_OPEN - 1);
+    const uint8_t minute = 60;
+    bh.remoteCallForHeatRX(1, pc, minute);
+    bh.processCallsForHeat(false, inHubMode);
+    EXPECT_FALSE(bh.isBoilerOn());
+    // Same valve again does not add up.
+    bh.remoteCallForHeatRX(1, pc, minute);
+    bh.processCallsForHeat(false, inHubMode);
+    EXPECT_FALSE(bh.isBoilerOn());
+    // Enough other valves do.
+    for(uint16_t id = 2; !bh.isBoilerOn() && (id < 8); ++id) {
+        bh.remoteCallForHeatRX(id, pc, minute);
+        bh.processCallsForHeat(false, inHubMode);
+    }
+    EXPECT_TRUE(bh.isBoilerOn());
+    EXPECT_LE(OTRadValve::DEFAULT_VALVE_PC_MODERATELY_OPEN - 1, bh.getValveDemand().getCallingSumPC());
+}
+
+// Test that valves only a little past really open add up to a call for heat,
+// while those below really open are ignored.
+TEST(BoilerDriverTest, boilerHubModeAggregateLowValves)
+{
+    constexpr uint8_t heatCallPin = 0; // unused in unit tests.
+    constexpr bool inHubMode = true;
+    typedef OTRadValve::BoilerLogic::OnOffBoilerDriverLogic<decltype(BoilerDriverTest::hm), BoilerDriverTest::hm, heatCallPin> bh_t;
+    bh_t bh;
+    EXPECT_EQ(OTRadValve::DEFAULT_VALVE_PC_MIN_REALLY_OPEN, bh.getValveDemand().getThreshold());
+    // Trick boiler hub into believing 10 minutes have passed.
+    for(auto i = 0; i < 10; ++i) {
+        bh.processCallsForHeat(true, inHubMode);
+    }
+    const uint8_t minute = 60;
+    // Barely open valves do not count, even several of them.
+    for(uint16_t id = 10; id < 14; ++id) {
+        bh.remoteCallForHeatRX(id, OTRadValve::DEFAULT_VALVE_PC_MIN_REALLY_OPEN - 1, minute);
+        bh.processCallsForHeat(false, inHubMode);
+    }
+    EXPECT_FALSE(bh.isBoilerOn());
+    EXPECT_EQ(0, bh.getValveDemand().getCallingSumPC());
+    // 20% + 25% is not enough...
+    bh.remoteCallForHeatRX(1, 20, minute);
+    bh.remoteCallForHeatRX(2, 25, minute);
+    bh.processCallsForHeat(false, inHubMode);
+    EXPECT_FALSE(bh.isBoilerOn());
+    EXPECT_EQ(45, bh.getValveDemand().getCallingSumPC());
+    // ... but another valve at 30% takes the total past moderately open.
+    bh.remoteCallForHeatRX(3, 30, minute);
+    bh.processCallsForHeat(false, inHubMode);
+    EXPECT_TRUE(bh.isBoilerOn());
+    EXPECT_EQ(75, bh.getValveDemand().getCallingSumPC());
+    EXPECT_EQ(3, bh.getValveDemand().getCallingCount());
+}
+
+// Valves below a configured higher minimum really-open do not add up to a call for heat.
+TEST(BoilerDriverTest, boilerHubModeAggregateConfiguredMin)
+{
+    constexpr uint8_t heatCallPin = 0; // unused in unit tests.
+    constexpr bool inHubMode = true;
+    typedef OTRadValve::BoilerLogic::OnOffBoilerDriverLogic<decltype(BoilerDriverTest::hm), BoilerDriverTest::hm, heatCallPin> bh_t;
+    bh_t bh;
+    // Never below the default.
+    bh.setMinValvePcReallyOpen(5);
+    EXPECT_EQ(OTRadValve::DEFAULT_VALVE_PC_MIN_REALLY_OPEN, bh.getMinAggregateValvePC());
+    bh.setMinValvePcReallyOpen(35);
+    EXPECT_EQ(35, bh.getMinAggregateValvePC());
+    EXPECT_EQ(35, bh.getValveDemand().getThreshold());
+    // Trick boiler hub into believing 10 minutes have passed.
+    for(auto i = 0; i < 10; ++i) {
+        bh.processCallsForHeat(true, inHubMode);
+    }
+    const uint8_t minute = 60;
+    // Valves the installer treats as not really open are ignored however many.
+    for(uint16_t id = 1; id <= 4; ++id) {
+        bh.remoteCallForHeatRX(id, 30, minute);
+        bh.processCallsForHeat(false, inHubMode);
+    }
+    EXPECT_FALSE(bh.isBoilerOn());
+    EXPECT_EQ(0, bh.getValveDemand().getCallingSumPC());
+    // Restoring the default lets the same valves add up.
+    bh.setMinValvePcReallyOpen(0);
+    EXPECT_EQ(120, bh.getValveDemand().getCallingSumPC());
+    bh.remoteCallForHeatRX(4, 30, minute);
+    bh.processCallsForHeat(false, inHubMode);
+    EXPECT_TRUE(bh.isBoilerOn());
+}
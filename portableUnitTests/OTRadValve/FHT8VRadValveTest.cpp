@@ -422,3 +422,91 @@ TEST(FHT8VRadValve,FHTEncodingHeadAndTail)
 //    #endif
 //    #endif
 }
+
+// Reference bit-at-a-time encoder of byte b plus even parity using _FHT8VCreate200usAppendEncBit().
+static uint8_t *refAppendByteEP(uint8_t *bptr, const uint8_t b)
+{
+    for(int i = 8; --i >= 0; ) { bptr = OTRadValve::FHT8VRadValveUtil::_FHT8VCreate200usAppendEncBit(bptr, 0 != (b & (1 << i))); }
+    return(OTRadValve::FHT8VRadValveUtil::_FHT8VCreate200usAppendEncBit(bptr, 0 != OTRadValve::FHT8VRadValveUtil::xor_parity_even_bit(b)));
+}
+
+// Check that the table-driven encoder produces exactly the bit-at-a-time encoding,
+// and that the table-driven decoder recovers the command from it.
+TEST(FHT8VRadValve,FHTTableEncodingMatchesReference)
+{
+    uint8_t buf[OTRadValve::FHT8VRadValveUtil::MIN_FHT8V_200US_BIT_STREAM_BUF_SIZE];
+    uint8_t ref[OTRadValve::FHT8VRadValveUtil::MIN_FHT8V_200US_BIT_STREAM_BUF_SIZE];
+    OTRadValve::FHT8VRadValveUtil::fht8v_msg_t command;
+    OTRadValve::FHT8VRadValveUtil::fht8v_msg_t commandDecoded;
+    srandom(42);
+    for(int n = 0; n < 2000; ++n)
+        {
+        command.hc1 = (uint8_t)random();
+        command.hc2 = (uint8_t)random();
+#ifdef OTV0P2BASE_FHT8V_ADR_USED
+        command.address = 0;
+#endif
+        command.command = (uint8_t)random();
+        command.extension = (uint8_t)random();
+        // Reference encoding.
+        memset(ref, 0, sizeof(ref));
+        uint8_t *bptr = ref;
+        for(int i = 6; --i >= 0; ) { *bptr++ = 0xcc; }
+        *bptr = 0xff;
+        bptr = OTRadValve::FHT8VRadValveUtil::_FHT8VCreate200usAppendEncBit(bptr, true);
+        bptr = refAppendByteEP(bptr, command.hc1);
+        bptr = refAppendByteEP(bptr, command.hc2);
+        bptr = refAppendByteEP(bptr, 0);
+        bptr = refAppendByteEP(bptr, command.command);
+        bptr = refAppendByteEP(bptr, command.extension);
+        bptr = refAppendByteEP(bptr, (uint8_t)(0xc + command.hc1 + command.hc2 + command.command + command.extension));
+        bptr = OTRadValve::FHT8VRadValveUtil::_FHT8VCreate200usAppendEncBit(bptr, false);
+        bptr = OTRadValve::FHT8VRadValveUtil::_FHT8VCreate200usAppendEncBit(bptr, false);
+        bptr = OTRadValve::FHT8VRadValveUtil::_FHT8VCreate200usAppendEncBit(bptr, false);
+        *bptr = 0xff;
+        // Table-driven encoding.
+        memset(buf, 0, sizeof(buf));
+        const uint8_t *const result = OTRadValve::FHT8VRadValveUtil::FHT8VCreate200usBitStreamBptr(buf, &command);
+        ASSERT_EQ(bptr - ref, result - buf);
+        ASSERT_EQ(0, memcmp(buf, ref, sizeof(buf)));
+        // Round trip.
+        ASSERT_TRUE(OTRadValve::FHT8VRadValveUtil::FHT8VBitStreamPlausible(buf, buf + sizeof(buf) - 1));
+        const uint8_t *const afterBody = OTRadValve::FHT8VRadValveUtil::FHT8VDecodeBitStream(buf, buf + sizeof(buf) - 1, &commandDecoded);
+        ASSERT_TRUE(NULL != afterBody);
+        // The trailer starts at or just before the terminator.
+        EXPECT_GE(result, afterBody);
+        EXPECT_LE(result - 1, afterBody);
+        EXPECT_EQ(command.hc1, commandDecoded.hc1);
+        EXPECT_EQ(command.hc2, commandDecoded.hc2);
+        EXPECT_EQ(command.command, commandDecoded.command);
+        EXPECT_EQ(command.extension, commandDecoded.extension);
+        // Truncated streams are always rejected.
+        EXPECT_TRUE(NULL == OTRadValve::FHT8VRadValveUtil::FHT8VDecodeBitStream(buf, result - 3, &commandDecoded));
+        }
+}
+
+// Check that corrupt and noise streams are rejected, mostly by the fast plausibility check.
+TEST(FHT8VRadValve,FHTDecodingRejectsNoise)
+{
+    uint8_t buf[OTRadValve::FHT8VRadValveUtil::MIN_FHT8V_200US_BIT_STREAM_BUF_SIZE];
+    OTRadValve::FHT8VRadValveUtil::fht8v_msg_t commandDecoded;
+    // Too short to hold any frame.
+    memset(buf, 0xcc, sizeof(buf));
+    EXPECT_FALSE(OTRadValve::FHT8VRadValveUtil::FHT8VBitStreamPlausible(buf, buf + OTRadValve::FHT8VRadValveUtil::MIN_FHT8V_ENCODED_FRAME_BYTES - 2));
+    EXPECT_TRUE(OTRadValve::FHT8VRadValveUtil::FHT8VBitStreamPlausible(buf, buf + OTRadValve::FHT8VRadValveUtil::MIN_FHT8V_ENCODED_FRAME_BYTES - 1));
+    // All preamble and no frame.
+    EXPECT_TRUE(NULL == OTRadValve::FHT8VRadValveUtil::FHT8VDecodeBitStream(buf, buf + sizeof(buf) - 1, &commandDecoded));
+    // A 01 bit pair is never valid.
+    buf[3] = 0xc4;
+    EXPECT_FALSE(OTRadValve::FHT8VRadValveUtil::FHT8VBitStreamPlausible(buf, buf + sizeof(buf) - 1));
+    // Random noise.
+    srandom(4242);
+    int plausible = 0;
+    for(int n = 0; n < 1000; ++n)
+        {
+        for(size_t i = 0; i < sizeof(buf); ++i) { buf[i] = (uint8_t)random(); }
+        if(OTRadValve::FHT8VRadValveUtil::FHT8VBitStreamPlausible(buf, buf + sizeof(buf) - 1)) { ++plausible; }
+        EXPECT_TRUE(NULL == OTRadValve::FHT8VRadValveUtil::FHT8VDecodeBitStream(buf, buf + sizeof(buf) - 1, &commandDecoded));
+        }
+    EXPECT_EQ(0, plausible);
+}
@@ -0,0 +1,158 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * OTRadValve MotorCurrentMonitor tests.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+
+#include <OTRadValve.h>
+
+
+// Deterministic small noise in [-6,6].
+static int noise(const int i) { return(((i * 37) % 13) - 6); }
+
+// A flat noisy current with isolated spikes never stalls,
+// and the baseline tracks the running current.
+TEST(MotorCurrentMonitor,noStallOnNoise)
+{
+    OTRadValve::MotorCurrentMonitor m;
+    EXPECT_FALSE(m.sample(1000)) << "ignored outside a run";
+    EXPECT_FALSE(m.getLastRun(true).valid);
+    m.startRun(true);
+    EXPECT_TRUE(m.isRunning());
+    for(int i = 0; i < 200; ++i)
+        {
+        int x = 200 + noise(i);
+        if(0 == (i % 50)) { x += 150; } // Single spike.
+        if(0 == (i % 70)) { x = 600; } // In-rush size spike.
+        EXPECT_FALSE(m.sample(uint16_t(x))) << i;
+        }
+    m.endRun();
+    EXPECT_FALSE(m.isRunning());
+    EXPECT_NEAR(200, m.getBaseline(), 4);
+    EXPECT_GT(30, m.getVariance());
+    const OTRadValve::MotorCurrentMonitor::runProfile_t &p = m.getLastRun(true);
+    EXPECT_TRUE(p.valid);
+    EXPECT_EQ(200, p.samples);
+    EXPECT_EQ(600, p.peak);
+    EXPECT_EQ(OTRadValve::MotorCurrentMonitor::NO_STALL, p.stallAt);
+    EXPECT_NEAR(200, p.baseline, 4);
+    EXPECT_LT(200U * 200U, p.sum);
+    EXPECT_FALSE(m.getLastRun(false).valid);
+}
+
+// A sustained rise is seen as a stall well before an absolute limit.
+TEST(MotorCurrentMonitor,stallOnRamp)
+{
+    OTRadValve::MotorCurrentMonitor m;
+    m.startRun(false);
+    // In-rush is ignored.
+    EXPECT_FALSE(m.sample(700));
+    EXPECT_FALSE(m.sample(500));
+    int i;
+    for(i = 0; i < 50; ++i) { EXPECT_FALSE(m.sample(uint16_t(300 + noise(i)))); }
+    // End-stop: current rises 15 per sample.
+    int stalledAt = -1;
+    for(int j = 1; j < 40; ++j)
+        {
+        if(m.sample(uint16_t(300 + 15*j + noise(i + j)))) { stalledAt = j; break; }
+        }
+    EXPECT_LT(0, stalledAt);
+    // Absolute limit of 600 would need 20 samples.
+    EXPECT_GE(6, stalledAt);
+    EXPECT_TRUE(m.isStalled());
+    EXPECT_TRUE(m.sample(0)) << "stays stalled for the rest of the run";
+    m.endRun();
+    const OTRadValve::MotorCurrentMonitor::runProfile_t &p = m.getLastRun(false);
+    EXPECT_TRUE(p.valid);
+    EXPECT_EQ(2 + 50 + stalledAt - 1, p.stallAt);
+    EXPECT_NEAR(300, p.baseline, 8);
+    // Next run starts afresh.
+    m.startRun(false);
+    EXPECT_FALSE(m.isStalled());
+    EXPECT_FALSE(m.sample(300));
+}
+
+// Simulated motor running into the fully-open end-stop,
+// where the current rises steadily until the motor is stopped.
+class RampHardwareDriver final : public OTRadValve::HardwareMotorDriverInterface
+  {
+  public:
+    // Absolute current limit (as in the hardware drivers).
+    static constexpr uint16_t maxCurrent = 450;
+    // Ticks of travel from closed to open.
+    static constexpr uint16_t travel = 300;
+    // If true, do not stop on a stall signalled by the callback.
+    bool absoluteOnly = false;
+    // Pin position in ticks from closed.
+    uint16_t position = 0;
+    // Motor ticks spent pushing into the end-stop.
+    uint32_t stallTicks = 0;
+    int n = 0;
+    uint16_t current = 0;
+    virtual bool isCurrentHigh(motor_drive /*mdir*/ = motorDriveOpening) const override { return(current > maxCurrent); }
+    virtual uint16_t readMotorCurrent() const override { return(current); }
+    virtual void motorRun(const uint8_t maxRunTicks, const motor_drive dir, OTRadValve::HardwareMotorDriverInterfaceCallbackHandler &callback) override
+      {
+      if(motorOff == dir) { return; }
+      const bool isOpening = (motorDriveOpening == dir);
+      for(int t = 0, ramp = 0; t < maxRunTicks; ++t)
+        {
+        callback.signalRunSCTTick(isOpening);
+        if(isOpening && (position >= travel)) { ++stallTicks; ramp += 15; }
+        else if(isOpening) { ++position; }
+        else if(position > 0) { --position; }
+        current = uint16_t(200 + ramp + noise(++n));
+        const bool stall = callback.signalMotorCurrent(isOpening, current);
+        if((stall && !absoluteOnly) || (current > maxCurrent))
+          {
+          callback.signalHittingEndStop(isOpening);
+          return;
+          }
+        }
+      }
+  };
+
+// Always claims to be at the start of a major cycle.
+static uint8_t zeroGetSubCycleTime() { return(0); }
+
+// Withdrawing the pin at power-up spends less motor time pushing into the end-stop.
+TEST(MotorCurrentMonitor,earlierEndStopWhenWithdrawing)
+{
+    uint32_t stallTicks[2];
+    for(int absoluteOnly = 0; absoluteOnly < 2; ++absoluteOnly)
+        {
+        RampHardwareDriver hw;
+        hw.absoluteOnly = (1 == absoluteOnly);
+        OTRadValve::CurrentSenseValveMotorDirectBinaryOnly csv(&hw, zeroGetSubCycleTime,
+            OTRadValve::CurrentSenseValveMotorDirectBinaryOnly::computeMinMotorDRTicks(7),
+            OTRadValve::CurrentSenseValveMotorDirectBinaryOnly::computeSctAbsLimit(7, 255, 4));
+        for(int i = 1000; --i > 0 && !csv.isWaitingForValveToBeFitted(); ) { csv.poll(); }
+        EXPECT_TRUE(csv.isWaitingForValveToBeFitted());
+        EXPECT_EQ(uint16_t(RampHardwareDriver::travel), hw.position);
+        stallTicks[absoluteOnly] = hw.stallTicks;
+        const OTRadValve::MotorCurrentMonitor::runProfile_t &p = csv.getCurrentMonitor().getLastRun(true);
+        EXPECT_TRUE(p.valid);
+        EXPECT_LT(0, p.samples);
+        if(!hw.absoluteOnly) { EXPECT_NE(OTRadValve::MotorCurrentMonitor::NO_STALL, p.stallAt); }
+        }
+    EXPECT_LT(2 * stallTicks[0], stallTicks[1]);
+}
@@ -0,0 +1,131 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * OTRadValve ValveMotorSimulator and benchmark tests.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <OTRadValve.h>
+
+
+namespace VMSTest {
+// Counts callbacks.
+class CountingCallback final : public OTRadValve::HardwareMotorDriverInterfaceCallbackHandler
+  {
+  public:
+    int endStops = 0, ticks = 0, marks = 0;
+    virtual void signalHittingEndStop(bool) override { ++endStops; }
+    virtual void signalShaftEncoderMarkStart(bool) override { ++marks; }
+    virtual void signalRunSCTTick(bool) override { ++ticks; }
+  };
+
+// Runs in one direction until the end stop, in 35-tick pulses; returns ticks taken.
+static int runToEnd(OTRadValve::ValveMotorSimulator &s, const bool open)
+{
+    VMSTest::CountingCallback cb;
+    for(int i = 0; (i < 1000) && (0 == cb.endStops); ++i)
+        {
+        s.motorRun(35, open ? OTRadValve::HardwareMotorDriverInterface::motorDriveOpening
+                            : OTRadValve::HardwareMotorDriverInterface::motorDriveClosing, cb);
+        }
+    return(cb.ticks);
+}
+}
+
+// Basic physics: end stops, spring asymmetry, backlash and battery drain.
+TEST(ValveMotorSimulator,physics)
+{
+    OTRadValve::ValveMotorSimulator::params_t p = OTRadValve::ValveMotorSimulator::defaultParams();
+    p.encoderMarks = 20;
+    OTRadValve::ValveMotorSimulator s(p, 42);
+    EXPECT_EQ(0, s.getPositionPC());
+    const int toOpen = VMSTest::runToEnd(s, true);
+    EXPECT_EQ(100, s.getPositionPC());
+    const int toClosed = VMSTest::runToEnd(s, false);
+    EXPECT_EQ(0, s.getPositionPC());
+    // Full travel at above nominal voltage is a bit quicker than nominal.
+    EXPECT_NEAR(p.travelTicks, toOpen, p.travelTicks / 4);
+    // Closing against the spring is slower.
+    EXPECT_LT(toOpen + toOpen / 10, toClosed);
+    EXPECT_LT(0U, s.getEndStopTicks());
+    EXPECT_LE(uint32_t(2 * (p.encoderMarks - 1)), s.getEncoderMarks());
+    // Backlash: a short pulse after reversal moves less than one in the same direction.
+    VMSTest::CountingCallback cb;
+    s.setPositionPC(50);
+    s.motorRun(10, OTRadValve::HardwareMotorDriverInterface::motorDriveOpening, cb);
+    const uint8_t afterReverse = s.getPositionPC();
+    s.setPositionPC(50);
+    s.motorRun(10, OTRadValve::HardwareMotorDriverInterface::motorDriveOpening, cb);
+    EXPECT_LT(afterReverse, s.getPositionPC());
+    // Battery slowly drains with motor use.
+    EXPECT_GT(p.batteryV, s.getBatteryV());
+    EXPECT_LT(2U, s.getRuns());
+}
+
+// Runs randomised movement sequences in parallel across parameter sets,
+// and reports accuracy and energy use.
+TEST(ValveMotorSimulator,benchmark)
+{
+    const bool verbose = false;
+    const uint32_t moves = 500;
+    std::vector<OTRadValve::ValveMotorSimulator::params_t> sets;
+    const OTRadValve::ValveMotorSimulator::params_t d = OTRadValve::ValveMotorSimulator::defaultParams();
+    sets.push_back(d);
+    OTRadValve::ValveMotorSimulator::params_t p = d;
+    p.backlashTicks = 20; sets.push_back(p);
+    p = d; p.stickyFriction = 0.5f; p.stickyPatches = 8; sets.push_back(p);
+    p = d; p.batteryV = 2.4f; p.batteryR = 1.0f; p.drainPerTick = 5e-7f; sets.push_back(p);
+    p = d; p.travelTicks = 900; p.springLoad = 1.0f; sets.push_back(p);
+    std::vector<OTRadValve::ValveMotorBenchmark::result_t> results(sets.size());
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < sets.size(); ++i)
+        {
+        threads.push_back(std::thread([&sets, &results, i, moves]()
+            { results[i] = OTRadValve::ValveMotorBenchmark::run(sets[i], uint32_t(1 + i), moves); }));
+        }
+    for(size_t i = 0; i < threads.size(); ++i) { threads[i].join(); }
+    for(size_t i = 0; i < sets.size(); ++i)
+        {
+        const OTRadValve::ValveMotorBenchmark::result_t &r = results[i];
+        if(verbose)
+            {
+            printf("set %u: moves %u meanErr %.1f%% maxErr %u%% motorOn %u endStop %u calibrations %u battery %.3fV\n",
+                unsigned(i), unsigned(r.moves), double(r.meanAbsErrorPC()), unsigned(r.maxAbsErrorPC),
+                unsigned(r.motorOnTicks), unsigned(r.endStopTicks), unsigned(r.calibrations), double(r.finalBatteryV));
+            }
+        SCOPED_TRACE(testing::Message() << "set " << i);
+        EXPECT_TRUE(r.reachedNormal);
+        EXPECT_FALSE(r.errorState);
+        EXPECT_EQ(moves, r.moves);
+        EXPECT_LE(1, r.calibrations);
+        EXPECT_LT(0U, r.motorOnTicks);
+        EXPECT_GT(r.motorOnTicks, r.endStopTicks);
+        EXPECT_GT(25, r.meanAbsErrorPC());
+        }
+    // Runs are deterministic, whether or not run concurrently.
+    const OTRadValve::ValveMotorBenchmark::result_t r0 = OTRadValve::ValveMotorBenchmark::run(sets[0], 1, moves);
+    EXPECT_EQ(results[0].sumAbsErrorPC, r0.sumAbsErrorPC);
+    EXPECT_EQ(results[0].motorOnTicks, r0.motorOnTicks);
+    EXPECT_EQ(results[0].calibrations, r0.calibrations);
+}
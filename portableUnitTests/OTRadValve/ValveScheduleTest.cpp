@@ -127,5 +127,134 @@ TEST(SimpleValveSchedule,isAnyScheduleOnWARMNow0)
         }
 }
 
+namespace VSTest {
+// Reference WARM-now computation directly from each schedule's on and off times.
+static bool refWARMNow(const OTRadValve::SimpleValveScheduleBase &svs, const uint16_t mm)
+{
+    for(uint8_t which = 0; which < svs.maxSchedules(); ++which)
+        {
+        const uint16_t s = svs.getSimpleScheduleOn(which);
+        if(0xffff == s) { continue; }
+        const uint16_t e = svs.getSimpleScheduleOff(which);
+        if((s < e) ? ((s <= mm) && (mm < e)) : ((s <= mm) || (mm < e))) { return(true); }
+        }
+    return(false);
+}
+
+// Check WARM now and next transition against the reference for every minute of the day.
+static void checkWholeDay(const OTRadValve::SimpleValveScheduleBase &svs)
+{
+    bool ref[OTV0P2BASE::MINS_PER_DAY];
+    bool anyChange = false;
+    for(uint16_t m = 0; m < OTV0P2BASE::MINS_PER_DAY; ++m) { ref[m] = refWARMNow(svs, m); }
+    for(uint16_t m = 0; m < OTV0P2BASE::MINS_PER_DAY; ++m)
+        {
+        ASSERT_EQ(ref[m], svs.isAnyScheduleOnWARMNow(m)) << m;
+        uint16_t d = 1;
+        while((d < OTV0P2BASE::MINS_PER_DAY) && (ref[(m + d) % OTV0P2BASE::MINS_PER_DAY] == ref[m])) { ++d; }
+        if(d < OTV0P2BASE::MINS_PER_DAY) { anyChange = true; }
+        ASSERT_EQ((d < OTV0P2BASE::MINS_PER_DAY) ? d : 0xffff, svs.minsToNextWARMTransition(m)) << m;
+        }
+    if(!anyChange) { EXPECT_EQ(0xffff, svs.minsToNextWARMTransition(0)); }
+}
+
+// Schedule with an on time that can be changed, eg as by comfort level.
+class VariableOnTimeSchedule final : public OTRadValve::SimpleValveScheduleParams
+    {
+    private:
+        uint8_t programmes[2] = { 0xff, 0xff };
+    public:
+        uint8_t on = 60;
+        virtual uint8_t maxSchedules() const override { return(2); }
+        virtual uint8_t onTime() const override { return(on); }
+        virtual uint_least16_t getSimpleScheduleOn(const uint8_t which) const override
+            {
+            if((which >= 2) || (programmes[which] > MAX_COMPRESSED_MINS_AFTER_MIDNIGHT)) { return(uint_least16_t(~0)); }
+            return(computeScheduleOnTimeFromProgrammeByte(programmes[which]));
+            }
+        virtual bool setSimpleSchedule(const uint_least16_t mm, const uint8_t which) override
+            {
+            if(which >= 2) { return(false); }
+            programmes[which] = computeProgrammeByteFromTime(mm);
+            invalidateTimeline();
+            return(true);
+            }
+        virtual void clearSimpleSchedule(const uint8_t which) override
+            { if(which < 2) { programmes[which] = 0xff; invalidateTimeline(); } }
+        virtual bool isAnySimpleScheduleSet() const override
+            { return((programmes[0] <= MAX_COMPRESSED_MINS_AFTER_MIDNIGHT) || (programmes[1] <= MAX_COMPRESSED_MINS_AFTER_MIDNIGHT)); }
+    };
+}
 
-// TODO: needs more thorough checking, eg through a whole simulated day.
+// The compiled timeline agrees with a direct computation through whole days
+// for random schedules, including overlapping and midnight-wrapping ones,
+// and is rebuilt when schedules are set or cleared.
+TEST(SimpleValveSchedule,timelineWholeDay)
+{
+    srandom((unsigned)::testing::UnitTest::GetInstance()->random_seed()); // Seed random() for use in tests; --gtest_shuffle will force it to change.
+    OTRadValve::SimpleValveScheduleMock<2> svsm;
+    VSTest::checkWholeDay(svsm);
+    EXPECT_EQ(0xffff, svsm.minsToNextWARMTransition(0));
+    // Wrapping midnight.
+    svsm.setSimpleSchedule(10, 0);
+    VSTest::checkWholeDay(svsm);
+    // Overlapping.
+    svsm.setSimpleSchedule(60, 1);
+    VSTest::checkWholeDay(svsm);
+    // Abutting: one period ends as the next starts.
+    svsm.setSimpleSchedule(600, 0);
+    svsm.setSimpleSchedule(600 + OTRadValve::SimpleValveScheduleParams::PREWARM_MINS + svsm.onTime(), 1);
+    VSTest::checkWholeDay(svsm);
+    EXPECT_EQ(2*(OTRadValve::SimpleValveScheduleParams::PREWARM_MINS + svsm.onTime()),
+              svsm.minsToNextWARMTransition(600 - OTRadValve::SimpleValveScheduleParams::PREWARM_MINS));
+    svsm.clearSimpleSchedule(1);
+    VSTest::checkWholeDay(svsm);
+    for(int i = 0; i < 20; ++i)
+        {
+        svsm.setSimpleSchedule(uint16_t(random() % OTV0P2BASE::MINS_PER_DAY), 0);
+        if(random() & 1) { svsm.setSimpleSchedule(uint16_t(random() % OTV0P2BASE::MINS_PER_DAY), 1); }
+        else { svsm.clearSimpleSchedule(1); }
+        VSTest::checkWholeDay(svsm);
+        }
+    // More schedules than the timeline holds are computed directly.
+    OTRadValve::SimpleValveScheduleMock<OTRadValve::SimpleValveScheduleParams::TIMELINE_MAX_SCHEDULES + 1> svsm5;
+    for(uint8_t w = 0; w < svsm5.maxSchedules(); ++w) { svsm5.setSimpleSchedule(uint16_t(random() % OTV0P2BASE::MINS_PER_DAY), w); }
+    VSTest::checkWholeDay(svsm5);
+}
+
+// Several schedules all wrapping midnight fit in the timeline
+// without disturbing the stored schedules.
+TEST(SimpleValveSchedule,timelineAllWrapping)
+{
+    OTRadValve::SimpleValveScheduleMock<OTRadValve::SimpleValveScheduleParams::TIMELINE_MAX_SCHEDULES> svsm;
+    const uint16_t starts[] = { 23*60 + 6, 23*60 + 18, 23*60 + 30, 23*60 + 42 };
+    static_assert(sizeof(starts)/sizeof(starts[0]) == OTRadValve::SimpleValveScheduleParams::TIMELINE_MAX_SCHEDULES, "one per schedule");
+    for(uint8_t n = 3; n <= svsm.maxSchedules(); ++n)
+        {
+        uint16_t on[sizeof(starts)/sizeof(starts[0])];
+        for(uint8_t w = 0; w < n; ++w)
+            {
+            svsm.setSimpleSchedule(starts[w], w);
+            on[w] = svsm.getSimpleScheduleOn(w);
+            // Wraps past midnight.
+            ASSERT_GT(on[w], svsm.getSimpleScheduleOff(w));
+            }
+        VSTest::checkWholeDay(svsm);
+        for(uint8_t w = 0; w < n; ++w) { EXPECT_EQ(on[w], svsm.getSimpleScheduleOn(w)); }
+        }
+}
+
+// The timeline follows a change of on time without a schedule change.
+TEST(SimpleValveSchedule,timelineOnTimeChange)
+{
+    VSTest::VariableOnTimeSchedule svs;
+    svs.setSimpleSchedule(7*60, 0);
+    VSTest::checkWholeDay(svs);
+    const uint16_t mm = 7*60;
+    const uint16_t d60 = svs.minsToNextWARMTransition(mm);
+    svs.on = 120;
+    VSTest::checkWholeDay(svs);
+    EXPECT_EQ(d60 + 60, svs.minsToNextWARMTransition(mm));
+    svs.on = 60;
+    EXPECT_EQ(d60, svs.minsToNextWARMTransition(mm));
+}
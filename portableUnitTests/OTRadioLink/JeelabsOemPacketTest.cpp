@@ -0,0 +1,147 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * OTRadioLink JeelabsOemPacket and CRC16 tests.
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <OTV0p2Base.h>
+#include "OTRadioLink_JeelabsOemPacket.h"
+
+
+namespace JOPTest {
+// Bitwise reference CRC16, as AVR _crc16_update().
+static uint16_t crc16Ref(uint16_t crc, const uint8_t a)
+{
+    crc ^= a;
+    for(int i = 0; i < 8; ++i) { crc = (crc & 1) ? ((crc >> 1) ^ 0xA001) : (crc >> 1); }
+    return(crc);
+}
+
+// Appends a frame encoded by p to the capture.
+static void addFrame(std::vector<uint8_t> &cap, OTRadioLink::JeelabsOemPacket &p,
+                     const uint8_t payloadLen, const uint8_t seed,
+                     const uint8_t nodeID = 0, const bool dest = false)
+{
+    uint8_t buf[OTRadioLink::JeelabsOemPacket::MAX_FRAME_BYTES];
+    for(uint8_t i = 0; i < payloadLen; ++i) { buf[i] = uint8_t(seed + i); }
+    const uint8_t n = p.encode(buf, payloadLen, nodeID, dest);
+    cap.insert(cap.end(), buf, buf + n);
+}
+}
+
+// Table-driven CRC16 matches the bitwise reference and the standard check value.
+TEST(JeelabsOemPacket,crc16)
+{
+    for(int c = 0; c < 0x10000; c += 97)
+        for(int d = 0; d < 256; ++d)
+            { ASSERT_EQ(JOPTest::crc16Ref(uint16_t(c), uint8_t(d)), OTV0P2BASE::crc16_A001_update(uint16_t(c), uint8_t(d))); }
+    const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    EXPECT_EQ(0x4b37, OTV0P2BASE::crc16_A001(check, sizeof(check)));
+}
+
+// Single frame encode, filter and decode round trip.
+TEST(JeelabsOemPacket,roundTrip)
+{
+    OTRadioLink::JeelabsOemPacket p;
+    EXPECT_FALSE(p.setNodeAndGroupID(32, 1));
+    EXPECT_TRUE(p.setNodeAndGroupID(7, 210));
+    EXPECT_EQ(7, p.getNodeID());
+    EXPECT_EQ(210, p.getGroupID());
+    uint8_t buf[32] = { 1, 2, 3, 4 };
+    const uint8_t n = p.encode(buf, 4, 7, true, true, false);
+    EXPECT_EQ(9, n);
+    EXPECT_EQ(210, buf[0]);
+    volatile uint8_t flen = 0;
+    EXPECT_TRUE(OTRadioLink::JeelabsOemPacket::filter(buf, flen));
+    EXPECT_EQ(9, flen);
+    uint8_t len, nodeID;
+    bool dest, ackReq, ackConf;
+    EXPECT_EQ(4, p.decode(buf, len, nodeID, dest, ackReq, ackConf));
+    EXPECT_EQ(4, len);
+    EXPECT_EQ(7, nodeID);
+    EXPECT_TRUE(dest);
+    EXPECT_TRUE(ackReq);
+    EXPECT_FALSE(ackConf);
+    EXPECT_EQ(3, buf[2]);
+    // Corruption is caught.
+    p.encode(buf, 4);
+    buf[4] ^= 1;
+    EXPECT_FALSE(OTRadioLink::JeelabsOemPacket::filter(buf, flen));
+}
+
+// Batch decode skips corrupt data and frames not for us, leaving payloads in place.
+TEST(JeelabsOemPacket,batch)
+{
+    OTRadioLink::JeelabsOemPacket p;
+    OTRadioLink::JeelabsOemPacket other;
+    other.setNodeAndGroupID(3, 42);
+    std::vector<uint8_t> cap;
+    JOPTest::addFrame(cap, p, 10, 0x10);
+    JOPTest::addFrame(cap, other, 5, 0x20); // Another group.
+    JOPTest::addFrame(cap, p, 6, 0x30, 9, true); // Another node.
+    const size_t corruptAt = cap.size();
+    JOPTest::addFrame(cap, p, 8, 0x40);
+    cap[corruptAt + 5] ^= 0x80;
+    JOPTest::addFrame(cap, p, 0, 0); // Empty payload.
+    JOPTest::addFrame(cap, p, 3, 0x50, p.getNodeID(), true);
+    cap.push_back(p.getGroupID()); // Trailing fragment.
+    const std::vector<uint8_t> orig(cap);
+
+    OTRadioLink::JeelabsOemPacket::frame_t out[8];
+    OTRadioLink::JeelabsOemPacket::batchStats_t st;
+    const size_t n = p.decodeBatch(cap.data(), cap.size(), out, 8, &st);
+    ASSERT_EQ(3U, n);
+    EXPECT_EQ(3U, st.frames);
+    EXPECT_EQ(2U, st.notForUs);
+    EXPECT_EQ(13U, st.badBytes);
+    EXPECT_EQ(10, out[0].len);
+    EXPECT_EQ(0x19, out[0].payload[9]);
+    EXPECT_FALSE(out[0].dest);
+    EXPECT_EQ(5, out[0].nodeID);
+    EXPECT_EQ(0, out[1].len);
+    EXPECT_EQ(3, out[2].len);
+    EXPECT_TRUE(out[2].dest);
+    EXPECT_EQ(0x52, out[2].payload[2]);
+    EXPECT_TRUE(orig == cap);
+    // Stops when the output is full.
+    EXPECT_EQ(1U, p.decodeBatch(cap.data(), cap.size(), out, 1));
+}
+
+// Throughput of batch decode over a large capture.
+TEST(JeelabsOemPacket,benchmark)
+{
+    const bool verbose = false;
+    OTRadioLink::JeelabsOemPacket p;
+    std::vector<uint8_t> cap;
+    const size_t frames = 20000;
+    for(size_t i = 0; i < frames; ++i) { JOPTest::addFrame(cap, p, uint8_t(i % 60), uint8_t(i)); }
+    std::vector<OTRadioLink::JeelabsOemPacket::frame_t> out(frames);
+    const auto start = std::chrono::steady_clock::now();
+    const size_t n = p.decodeBatch(cap.data(), cap.size(), out.data(), out.size());
+    const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(frames, n);
+    if(verbose) { printf("%u frames, %u bytes in %.3fms: %.1f MB/s\n", unsigned(n), unsigned(cap.size()), s * 1000, cap.size() / s / 1e6); }
+}
@@ -0,0 +1,235 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * OTRN2483Link TX scheduler tests.
+ */
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "OTRN2483Link.h"
+
+
+namespace RN2483Emu {
+
+/**
+ * @brief   Simple emulator for the RN2483 'mac tx' command.
+ *          Collects commands written and replies to each complete line.
+ */
+class RN2483SerialSimulator final : public Stream
+    {
+    private:
+        // Data available to be read().
+        std::string toBeRead;
+        // Partial command line being written.
+        std::string line;
+
+    public:
+        // Complete command lines received, without CR LF.
+        std::vector<std::string> commands;
+        // Reply to give to the next 'mac tx' command.
+        std::string nextReply = "ok";
+
+        // Method from Stream.
+        virtual size_t write(uint8_t uc) override
+        {
+            const char c = (char)uc;
+            if('\n' == c) {
+                if(!line.empty() && ('\r' == line.back())) { line.pop_back(); }
+                commands.push_back(line);
+                if(0 == line.compare(0, 7, "mac tx ")) { toBeRead += nextReply + "\r\n"; }
+                line.clear();
+            }
+            else { line += c; }
+            return(1);
+        }
+        // Method from Stream.
+        virtual int read() override
+        {
+            if(toBeRead.empty()) { return(-1); }
+            const char c = toBeRead.front();
+            toBeRead.erase(0, 1);
+            return(c);
+        }
+        // Method from Stream.
+        virtual int available() override { return(int(toBeRead.size())); }
+        // Method from Stream.
+        virtual int peek() override { return(toBeRead.empty() ? -1 : toBeRead.front()); }
+        // Method from Stream.
+        virtual void flush() override { }
+    };
+
+}
+
+
+// Check airtime against the implementation notes table (50 byte payload, 1% duty cycle).
+TEST(OTRN2483Link,AirtimeEU868)
+{
+    // SF7: 11.8s between sends at 1% implies ~118ms airtime.
+    EXPECT_EQ(119U, OTRN2483Link::LoRaWANEU868::airtimeMs(5, 50));
+    // SF10: 69.8s implies ~698ms.
+    EXPECT_NEAR(698, (int)OTRN2483Link::LoRaWANEU868::airtimeMs(2, 50), 2);
+    // SF12: 279.3s implies ~2793ms.
+    EXPECT_NEAR(2793, (int)OTRN2483Link::LoRaWANEU868::airtimeMs(0, 50), 2);
+    // Airtime never decreases with payload length.
+    for(uint8_t dr = 0; dr <= OTRN2483Link::LoRaWANEU868::MAX_DR; ++dr) {
+        for(uint8_t len = 1; len < OTRN2483Link::LoRaWANEU868::maxPayload(dr); ++len) {
+            ASSERT_LE(OTRN2483Link::LoRaWANEU868::airtimeMs(dr, len - 1),
+                      OTRN2483Link::LoRaWANEU868::airtimeMs(dr, len));
+        }
+    }
+    EXPECT_EQ(51, OTRN2483Link::LoRaWANEU868::maxPayload(0));
+    EXPECT_EQ(115, OTRN2483Link::LoRaWANEU868::maxPayload(3));
+    EXPECT_EQ(222, OTRN2483Link::LoRaWANEU868::maxPayload(5));
+}
+
+// Off-time is airtime * (d - 1) and is worked off by elapsed time.
+TEST(OTRN2483Link,DutyCycleTracker)
+{
+    OTRN2483Link::DutyCycleTracker<2> dc;
+    dc.setDutyDivisor(1, 1000);
+    EXPECT_TRUE(dc.canTX(0));
+    EXPECT_TRUE(dc.canTX(1));
+    EXPECT_FALSE(dc.canTX(2));
+    dc.recordTX(0, 100);
+    dc.recordTX(1, 100);
+    EXPECT_FALSE(dc.canTX(0));
+    EXPECT_EQ(9900U, dc.msUntilFree(0));
+    EXPECT_EQ(99900U, dc.msUntilFree(1));
+    dc.addElapsedMs(9899);
+    EXPECT_FALSE(dc.canTX(0));
+    dc.addElapsedMs(1);
+    EXPECT_TRUE(dc.canTX(0));
+    EXPECT_FALSE(dc.canTX(1));
+    dc.addElapsedMs(100000);
+    EXPECT_TRUE(dc.canTX(1));
+}
+
+// A single frame goes out unchanged on port 1 and then blocks the band.
+TEST(OTRN2483Link,TXSchedulerSingleFrame)
+{
+    RN2483Emu::RN2483SerialSimulator ser;
+    OTRN2483Link::TXScheduler<> s;
+    typedef OTRN2483Link::TXScheduler<> s_t;
+    EXPECT_EQ(s_t::TX_IDLE, s.poll(ser));
+    const uint8_t f[] = { 0x01, 0xab, 0x7f };
+    EXPECT_TRUE(s.queueFrame(f, sizeof(f)));
+    EXPECT_EQ(1, s.getFramesQueued());
+    EXPECT_EQ(s_t::TX_SENT, s.poll(ser));
+    ASSERT_EQ(1U, ser.commands.size());
+    EXPECT_EQ("mac tx uncnf 1 01AB7F", ser.commands[0]);
+    EXPECT_EQ(0, s.getFramesQueued());
+    EXPECT_EQ(1, s.getUplinksSent());
+    // Second frame must wait for duty-cycle credit.
+    EXPECT_TRUE(s.queueFrame(f, sizeof(f)));
+    EXPECT_EQ(s_t::TX_DEFERRED, s.poll(ser));
+    EXPECT_EQ(1U, ser.commands.size());
+    const uint32_t wait = s.msUntilNextTX();
+    EXPECT_EQ(99 * OTRN2483Link::LoRaWANEU868::airtimeMs(1, sizeof(f)), wait);
+    s.addElapsedMs(wait);
+    EXPECT_EQ(s_t::TX_SENT, s.poll(ser));
+    EXPECT_EQ(2U, ser.commands.size());
+}
+
+// Frames queued while the band is blocked are aggregated, length-prefixed, on port 2.
+TEST(OTRN2483Link,TXSchedulerAggregates)
+{
+    RN2483Emu::RN2483SerialSimulator ser;
+    OTRN2483Link::TXScheduler<> s;
+    typedef OTRN2483Link::TXScheduler<> s_t;
+    const uint8_t f1[] = { 0x11 };
+    const uint8_t f2[] = { 0x21, 0x22 };
+    EXPECT_TRUE(s.queueFrame(f1, sizeof(f1)));
+    EXPECT_TRUE(s.queueFrame(f2, sizeof(f2)));
+    EXPECT_EQ(s_t::TX_SENT, s.poll(ser));
+    ASSERT_EQ(1U, ser.commands.size());
+    EXPECT_EQ("mac tx uncnf 2 0111022122", ser.commands[0]);
+    EXPECT_EQ(2, s.getFramesSent());
+    EXPECT_EQ(1, s.getUplinksSent());
+}
+
+// Aggregation stops at the data-rate payload limit.
+TEST(OTRN2483Link,TXSchedulerPayloadLimit)
+{
+    RN2483Emu::RN2483SerialSimulator ser;
+    OTRN2483Link::TXScheduler<255> s;
+    typedef OTRN2483Link::TXScheduler<255> s_t;
+    s.setDataRate(0); // 51 byte limit.
+    uint8_t f[20];
+    memset(f, 0xa5, sizeof(f));
+    // Too big for one uplink at this rate.
+    uint8_t big[52] = { };
+    EXPECT_FALSE(s.queueFrame(big, sizeof(big)));
+    for(int i = 0; i < 5; ++i) { EXPECT_TRUE(s.queueFrame(f, sizeof(f))); }
+    uint8_t out[51];
+    uint8_t port, n;
+    EXPECT_EQ(42, s.buildUplink(out, port, n));
+    EXPECT_EQ(2, n);
+    EXPECT_EQ(s_t::BATCH_PORT, port);
+    EXPECT_EQ(s_t::TX_SENT, s.poll(ser));
+    EXPECT_EQ(3, s.getFramesQueued());
+    // A frame exactly at the limit is sent alone, without its length byte.
+    s.addElapsedMs(s.msUntilNextTX());
+    uint8_t full[51] = { };
+    OTRN2483Link::TXScheduler<> s2;
+    s2.setDataRate(0);
+    EXPECT_TRUE(s2.queueFrame(full, sizeof(full)));
+    EXPECT_TRUE(s2.queueFrame(f, 1));
+    EXPECT_EQ(51, s2.buildUplink(out, port, n));
+    EXPECT_EQ(1, n);
+    EXPECT_EQ(s_t::SINGLE_FRAME_PORT, port);
+}
+
+// Module busy/no free channel keeps frames; a hard error drops them.
+TEST(OTRN2483Link,TXSchedulerErrors)
+{
+    RN2483Emu::RN2483SerialSimulator ser;
+    OTRN2483Link::TXScheduler<> s;
+    typedef OTRN2483Link::TXScheduler<> s_t;
+    const uint8_t f[] = { 0x42 };
+    EXPECT_TRUE(s.queueFrame(f, sizeof(f)));
+    ser.nextReply = "no_free_ch";
+    EXPECT_EQ(s_t::TX_DEFERRED, s.poll(ser));
+    EXPECT_EQ(1, s.getFramesQueued());
+    ser.nextReply = "busy";
+    EXPECT_EQ(s_t::TX_DEFERRED, s.poll(ser));
+    EXPECT_EQ(1, s.getFramesQueued());
+    ser.nextReply = "invalid_data_len";
+    EXPECT_EQ(s_t::TX_FAILED, s.poll(ser));
+    EXPECT_EQ(0, s.getFramesQueued());
+    EXPECT_EQ(0, s.getUplinksSent());
+    // No airtime was charged for the failures.
+    EXPECT_EQ(0U, s.getDutyCycleTracker().msUntilFree(s_t::TX_BAND));
+}
+
+// Queue space is bounded.
+TEST(OTRN2483Link,TXSchedulerQueueFull)
+{
+    OTRN2483Link::TXScheduler<16> s;
+    const uint8_t f[7] = { };
+    EXPECT_TRUE(s.queueFrame(f, sizeof(f)));
+    EXPECT_TRUE(s.queueFrame(f, sizeof(f)));
+    EXPECT_FALSE(s.queueFrame(f, sizeof(f)));
+    EXPECT_FALSE(s.queueFrame(f, 0));
+    EXPECT_FALSE(s.queueFrame(NULL, 1));
+    EXPECT_EQ(2, s.getFramesQueued());
+}
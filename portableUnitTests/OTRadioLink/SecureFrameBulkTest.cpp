@@ -0,0 +1,191 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * OTRadioLink bulk secure frame encoding tests,
+ * using the NULL enc so not dependent on OTAESGCM.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+
+#include <OTV0p2Base.h>
+#include "OTRadioLink_SecureableFrameType.h"
+
+
+namespace SFBTest {
+// Mock TX with a real incrementing counter; counts counter fetches.
+class CountingTXMock final : public OTRadioLink::SimpleSecureFrame32or0BodyTXBase
+  {
+  public:
+    uint8_t ctr[6] = { 0, 0, 1, 0, 0, 0xfd };
+    int fetches = 0;
+    bool skip = false;
+    virtual bool getTXID(uint8_t *id) const override
+        { for(uint8_t i = 0; i < OTV0P2BASE::OpenTRV_Node_ID_Bytes; ++i) { id[i] = uint8_t(0x80 + i); } return(true); }
+    virtual bool getTXNVCtrPrefix(uint8_t *buf) const override { memcpy(buf, ctr, 3); return(true); }
+    virtual bool resetTXNVCtrPrefix(bool /*allZeros*/ = false) override { return(false); }
+    virtual bool incrementTXNVCtrPrefix() override { return(false); }
+    virtual bool getNextTXMsgCtr(uint8_t *buf) override
+        {
+        ++fetches;
+        incrementMsgCtr(ctr);
+        if(skip) { incrementMsgCtr(ctr); }
+        memcpy(buf, ctr, 6);
+        return(true);
+        }
+  };
+
+static OTRadioLink::SimpleSecureFrame32or0BodyTXBase::fixed32BTextSize12BNonce16BTagSimpleEnc_fn_t &e =
+    OTRadioLink::fixed32BTextSize12BNonce16BTagSimpleEnc_NULL_IMPL;
+static const uint8_t key[16] = { };
+}
+
+// 6-byte counter increment, and default block reservation.
+TEST(SecureFrameBulk,reserveCounters)
+{
+    uint8_t c[6] = { 0, 0, 0, 0, 0xff, 0xff };
+    EXPECT_TRUE(OTRadioLink::SimpleSecureFrame32or0BodyTXBase::incrementMsgCtr(c));
+    const uint8_t c1[6] = { 0, 0, 0, 1, 0, 0 };
+    EXPECT_EQ(0, memcmp(c, c1, 6));
+    memset(c, 0xff, 6);
+    EXPECT_FALSE(OTRadioLink::SimpleSecureFrame32or0BodyTXBase::incrementMsgCtr(c));
+
+    SFBTest::CountingTXMock tx;
+    uint8_t first[6];
+    EXPECT_FALSE(tx.reserveTXMsgCtrs(first, 0));
+    EXPECT_TRUE(tx.reserveTXMsgCtrs(first, 4));
+    const uint8_t f[6] = { 0, 0, 1, 0, 0, 0xfe };
+    EXPECT_EQ(0, memcmp(first, f, 6));
+    const uint8_t last[6] = { 0, 0, 1, 0, 1, 1 };
+    EXPECT_EQ(0, memcmp(tx.ctr, last, 6));
+    // Gaps are caught.
+    tx.skip = true;
+    EXPECT_FALSE(tx.reserveTXMsgCtrs(first, 2));
+}
+
+// Ephemeral carry and step back used by block reservation, as in the V0p2 implementation.
+TEST(SecureFrameBulk,ephemeralCarryAndBorrow)
+{
+    typedef OTRadioLink::SimpleSecureFrame32or0BodyTXBase TXB;
+    // n = 1 at the 0xffffff rollover carries into the persistent part.
+    uint8_t e[3] = { 0xff, 0xff, 0xff };
+    EXPECT_TRUE(TXB::advanceMsgCtrLSBs(e, 3, 1));
+    EXPECT_EQ(0, e[0]); EXPECT_EQ(0, e[1]); EXPECT_EQ(0, e[2]);
+    // n = 255 up to exactly 0xffffff does not carry.
+    e[0] = 0xff; e[1] = 0xff; e[2] = 0;
+    EXPECT_FALSE(TXB::advanceMsgCtrLSBs(e, 3, 255));
+    EXPECT_EQ(0xff, e[0]); EXPECT_EQ(0xff, e[1]); EXPECT_EQ(0xff, e[2]);
+    // n = 255 across the rollover.
+    e[0] = 0xff; e[1] = 0xff; e[2] = 2;
+    EXPECT_TRUE(TXB::advanceMsgCtrLSBs(e, 3, 255));
+    EXPECT_EQ(0, e[0]); EXPECT_EQ(0, e[1]); EXPECT_EQ(1, e[2]);
+    // Stepping back borrows from the persistent part.
+    uint8_t c[6] = { 0, 0, 2, 0, 0, 1 };
+    EXPECT_TRUE(TXB::stepBackMsgCtr(c, 254));
+    const uint8_t c1[6] = { 0, 0, 1, 0xff, 0xff, 3 };
+    EXPECT_EQ(0, memcmp(c, c1, 6));
+    EXPECT_TRUE(TXB::stepBackMsgCtr(c, 0));
+    EXPECT_EQ(0, memcmp(c, c1, 6));
+    memset(c, 0, 6);
+    EXPECT_FALSE(TXB::stepBackMsgCtr(c, 1));
+
+    // Blocks of n = 1 and n = 255 (and between) around the rollover
+    // match counters drawn one at a time.
+    uint8_t prefix[3] = { 0, 0, 1 };
+    uint8_t eph[3] = { 0xff, 0xfd, 0x10 };
+    uint8_t expected[6] = { 0, 0, 1, 0xff, 0xfd, 0x10 };
+    const uint8_t ns[] = { 1, 255, 200, 255, 1, 255, 17, 255, 1 };
+    for(const uint8_t n : ns)
+        {
+        // First expected counter.
+        ASSERT_TRUE(TXB::incrementMsgCtr(expected));
+        uint8_t buf[6];
+        if(TXB::advanceMsgCtrLSBs(eph, 3, n)) { ++prefix[2]; }
+        memcpy(buf, prefix, 3);
+        memcpy(buf + 3, eph, 3);
+        ASSERT_TRUE(TXB::stepBackMsgCtr(buf, n - 1));
+        EXPECT_EQ(0, memcmp(buf, expected, 6));
+        for(uint8_t i = 1; i < n; ++i) { ASSERT_TRUE(TXB::incrementMsgCtr(expected)); }
+        }
+    const uint8_t p2[3] = { 0, 0, 2 };
+    EXPECT_EQ(0, memcmp(prefix, p2, 3));
+}
+
+// Bulk frames match those encoded one at a time, and stop cleanly when out of space.
+TEST(SecureFrameBulk,encodeBulk)
+{
+    typedef OTRadioLink::SimpleSecureFrame32or0BodyTXBase TXB;
+    constexpr uint8_t il = 4;
+    uint8_t bodies[3][OTRadioLink::ENC_BODY_SMALL_FIXED_CTEXT_SIZE] = { };
+    strcpy((char *)bodies[0] + 2, "{\"b\":1}");
+    EXPECT_EQ(8, TXB::prepareValveFrameBody(bodies[0], 42));
+    EXPECT_EQ(0x10, bodies[0][1]);
+    EXPECT_EQ(2, TXB::prepareValveFrameBody(bodies[1], 200));
+    EXPECT_EQ(0x7f, bodies[1][0]);
+    EXPECT_EQ(0, TXB::prepareValveFrameBody(NULL, 0));
+    TXB::bulkFrame_t frames[4] = {
+        { OTRadioLink::FTS_BasicSensorOrValve, bodies[0], sizeof(bodies[0]), 8, 0xff },
+        { OTRadioLink::FTS_BasicSensorOrValve, bodies[1], sizeof(bodies[1]), 2, 0xff },
+        { OTRadioLink::FTS_ALIVE, NULL, 0, 0, 0xff },
+        { OTRadioLink::FTS_ALIVE, NULL, 0, 0, 0xff },
+        };
+    uint8_t orig[3][sizeof(bodies[0])];
+    memcpy(orig, bodies, sizeof(orig));
+
+    uint8_t workspace[TXB::encodeBulk_total_scratch_usage_OTAESGCM_2p0];
+    OTV0P2BASE::ScratchSpaceL sW(workspace, sizeof(workspace));
+    SFBTest::CountingTXMock tx;
+    uint8_t out[256];
+    const size_t n = tx.encodeBulk(frames, 4, il, out, sizeof(out), SFBTest::e, sW, SFBTest::key);
+    EXPECT_EQ(4, tx.fetches);
+    EXPECT_EQ(size_t(frames[0].frameLen + frames[1].frameLen + frames[2].frameLen + frames[3].frameLen), n);
+
+    // Same frames one at a time from the same counter start.
+    SFBTest::CountingTXMock tx1;
+    size_t off = 0;
+    for(uint8_t i = 0; i < 4; ++i)
+        {
+        uint8_t body[sizeof(bodies[0])];
+        if(i < 3) { memcpy(body, orig[i], sizeof(body)); }
+        uint8_t buf[64];
+        OTRadioLink::OTEncodeData_T fd((NULL == frames[i].ptext) ? NULL : body, frames[i].ptextbufSize, buf, sizeof(buf));
+        fd.ptextLen = frames[i].ptextLen;
+        fd.fType = frames[i].fType;
+        const uint8_t l = tx1.encode(fd, il, SFBTest::e, sW, SFBTest::key);
+        ASSERT_EQ(l, frames[i].frameLen);
+        EXPECT_EQ(0, memcmp(buf, out + off, l));
+        off += l;
+        }
+    // Consecutive sequence numbers in the headers.
+    EXPECT_EQ(0xe0, out[2] & 0xf0);
+    EXPECT_EQ(0xf0, out[frames[0].frameLen + 2] & 0xf0);
+
+    // Only the frames that fit are encoded.
+    memcpy(bodies, orig, sizeof(orig));
+    const size_t n2 = tx.encodeBulk(frames, 3, il, out, frames[0].frameLen + 5, SFBTest::e, sW, SFBTest::key);
+    EXPECT_EQ(frames[0].frameLen, n2);
+    EXPECT_EQ(0, frames[1].frameLen);
+    EXPECT_EQ(0, frames[2].frameLen);
+    EXPECT_EQ(7, tx.fetches);
+    // Too little scratch fails before reserving counters.
+    OTV0P2BASE::ScratchSpaceL small(workspace, 10);
+    EXPECT_EQ(0U, tx.encodeBulk(frames, 3, il, out, sizeof(out), SFBTest::e, small, SFBTest::key));
+    EXPECT_EQ(7, tx.fetches);
+}
@@ -0,0 +1,205 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * OTRadioLink TX message counter reservation tests.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+
+#include <OTV0p2Base.h>
+#include "OTRadioLink_TXMsgCtrReservation.h"
+
+
+namespace TXMCRTest {
+typedef OTV0P2BASE::NVKVJournal<3> Journal;
+constexpr uint32_t block = 16;
+typedef OTRadioLink::TXMsgCtrReservation<Journal, block> Reservation;
+constexpr uint8_t key = 1;
+
+// Restart counter as a plain integer, counting changes.
+class RestartCtrMock final
+  {
+  public:
+    uint32_t ctr = 0;
+    int increments = 0;
+    int resets = 0;
+    bool get(uint8_t *buf) const { buf[0] = uint8_t(ctr >> 16); buf[1] = uint8_t(ctr >> 8); buf[2] = uint8_t(ctr); return(true); }
+    bool reset() { ++resets; ctr = 0x12; return(true); }
+    bool increment() { ++increments; ++ctr; return(true); }
+  };
+
+// Counter as an integer, for easy comparison.
+static uint64_t value(const uint8_t *const c)
+{
+    uint64_t v = 0;
+    for(uint8_t i = 0; i < 6; ++i) { v = (v << 8) | c[i]; }
+    return(v);
+}
+}
+
+// Counters come from RAM between writes of the mark, and restarts resume above all issued.
+TEST(TXMsgCtrReservation,restarts)
+{
+    OTV0P2BASE::NVByteBackingStoreRAM<88> store;
+    uint64_t last = 0;
+    for(int boot = 0; boot < 5; ++boot)
+        {
+        TXMCRTest::Journal j(store);
+        j.begin();
+        TXMCRTest::Reservation r(j, TXMCRTest::key);
+        uint8_t c[6];
+        EXPECT_FALSE(r.reserve(c, 1));
+        const uint8_t floor[6] = { 0, 0, 1, 0, 0, 0 };
+        ASSERT_TRUE(r.begin(floor, 3));
+        EXPECT_EQ(1U, r.getMarkWrites());
+        for(int i = 0; i < 40; ++i)
+            {
+            ASSERT_TRUE(r.reserve(c, 1));
+            const uint64_t v = TXMCRTest::value(c);
+            EXPECT_LT(last, v);
+            // Nothing is lost within a boot.
+            if(0 != i) { EXPECT_EQ(last + 1, v); }
+            // At most one block plus the offset is lost per restart.
+            else if(0 != boot) { EXPECT_GE(last + 1 + TXMCRTest::block + 3, v); }
+            else { EXPECT_EQ(0x1000003U, v); }
+            last = v;
+            uint8_t m[6];
+            r.getMark(m);
+            EXPECT_LT(v, TXMCRTest::value(m));
+            }
+        // One write per block rather than per counter.
+        EXPECT_EQ(1U + 40 / TXMCRTest::block, r.getMarkWrites());
+        }
+}
+
+// Blocks, floors, clearing and limits.
+TEST(TXMsgCtrReservation,blocksAndLimits)
+{
+    OTV0P2BASE::NVByteBackingStoreRAM<88> store;
+    TXMCRTest::Journal j(store);
+    j.begin();
+    TXMCRTest::Reservation r(j, TXMCRTest::key);
+    // Never starts at zero.
+    ASSERT_TRUE(r.begin());
+    uint8_t c[6];
+    ASSERT_TRUE(r.reserve(c, 1));
+    EXPECT_EQ(1U, TXMCRTest::value(c));
+    // A block reservation is consecutive and needs one write at most.
+    ASSERT_TRUE(r.reserve(c, 40));
+    EXPECT_EQ(2U, TXMCRTest::value(c));
+    EXPECT_EQ(2U, r.getMarkWrites());
+    ASSERT_TRUE(r.reserve(c, 1));
+    EXPECT_EQ(42U, TXMCRTest::value(c));
+    EXPECT_FALSE(r.reserve(c, 0));
+    // A higher floor wins over the mark.
+    const uint8_t floor[6] = { 0, 0, 0, 1, 0, 0 };
+    ASSERT_TRUE(r.begin(floor));
+    ASSERT_TRUE(r.reserve(c, 1));
+    EXPECT_EQ(0x10000U, TXMCRTest::value(c));
+    // Clearing forgets the mark.
+    EXPECT_TRUE(r.clear());
+    EXPECT_FALSE(r.isStarted());
+    ASSERT_TRUE(r.begin());
+    ASSERT_TRUE(r.reserve(c, 1));
+    EXPECT_EQ(1U, TXMCRTest::value(c));
+    // No counters beyond the maximum.
+    const uint8_t high[6] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xe0 };
+    ASSERT_TRUE(r.begin(high));
+    EXPECT_TRUE(r.reserve(c, 15));
+    // Up to the mark without a write, but no mark can be persisted beyond the maximum.
+    EXPECT_TRUE(r.reserve(c, 1));
+    EXPECT_EQ(0xffffffffffefULL, TXMCRTest::value(c));
+    EXPECT_FALSE(r.reserve(c, 1));
+    const uint8_t top[6] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xf8 };
+    EXPECT_FALSE(r.begin(top));
+}
+
+// The restart counter is bumped only as the mark passes a 2^24 boundary, not at every reboot.
+TEST(TXMsgCtrReservation,rebootsWithRestartCtr)
+{
+    OTV0P2BASE::NVByteBackingStoreRAM<88> store;
+    TXMCRTest::RestartCtrMock rc;
+    uint64_t last = 0;
+    for(int boot = 0; boot < 6; ++boot)
+        {
+        TXMCRTest::Journal j(store);
+        j.begin();
+        TXMCRTest::Reservation r(j, TXMCRTest::key);
+        for(int i = 0; i < 20; ++i)
+            {
+            uint8_t c[6];
+            ASSERT_TRUE(r.reserveWithRestartCtr(rc, c, 1, 7));
+            const uint64_t v = TXMCRTest::value(c);
+            EXPECT_LT(last, v);
+            if(0 == boot + i) { EXPECT_EQ(0x13000007U, v); }
+            // Each reboot resumes from the mark, losing at most a block plus the offset.
+            else if(0 == i) { EXPECT_GE(last + 1 + TXMCRTest::block + 7, v); }
+            else { EXPECT_EQ(last + 1, v); }
+            last = v;
+            // The restart counter always covers everything handed out.
+            EXPECT_GT(uint64_t(rc.ctr + 1) << 24, v);
+            }
+        }
+    // All-zeros restart counter replaced once, then bumped once to cover the first mark.
+    EXPECT_EQ(1, rc.resets);
+    EXPECT_EQ(1, rc.increments);
+    EXPECT_EQ(0x13U, rc.ctr);
+
+    // Passing a 2^24 boundary bumps the restart counter once.
+    {
+    TXMCRTest::Journal j(store);
+    j.begin();
+    const uint8_t m[6] = { 0, 0, 0x13, 0xff, 0xff, 0xe0 };
+    ASSERT_TRUE(j.put(TXMCRTest::key, m, sizeof(m)));
+    TXMCRTest::Reservation r(j, TXMCRTest::key);
+    uint8_t c[6];
+    for(int i = 0; i < 40; ++i) { ASSERT_TRUE(r.reserveWithRestartCtr(rc, c, 1)); }
+    EXPECT_EQ(0x14000007U, TXMCRTest::value(c));
+    EXPECT_EQ(2, rc.increments);
+    EXPECT_EQ(0x14U, rc.ctr);
+    last = TXMCRTest::value(c);
+    }
+
+    // A restart counter advanced past the mark (eg by older firmware) is used as the floor.
+    rc.ctr = 0x20;
+    {
+    TXMCRTest::Journal j(store);
+    j.begin();
+    TXMCRTest::Reservation r(j, TXMCRTest::key);
+    uint8_t c[6];
+    ASSERT_TRUE(r.reserveWithRestartCtr(rc, c, 1));
+    EXPECT_EQ(0x21000000U, TXMCRTest::value(c));
+    EXPECT_EQ(0x21U, rc.ctr);
+    last = TXMCRTest::value(c);
+    }
+
+    // Losing the mark restarts above the restart counter, so above everything handed out.
+    {
+    OTV0P2BASE::NVByteBackingStoreRAM<88> fresh;
+    TXMCRTest::Journal j(fresh);
+    j.begin();
+    TXMCRTest::Reservation r(j, TXMCRTest::key);
+    uint8_t c[6];
+    ASSERT_TRUE(r.reserveWithRestartCtr(rc, c, 1));
+    EXPECT_LT(last, TXMCRTest::value(c));
+    EXPECT_EQ(0x22000000U, TXMCRTest::value(c));
+    }
+}
@@ -0,0 +1,129 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * ADC batch sequencing tests, driven by synthetic conversion results.
+ */
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "OTV0p2Base.h"
+
+
+namespace ADCBatchTest {
+// Simulated ADC: the raw value for each channel (by ADMUX), plus optional dither.
+struct SimADC
+{
+    uint16_t values[16];
+    bool dither = false;
+    uint8_t n = 0;
+    uint16_t convert(const uint8_t admux) { return(uint16_t(values[admux & 0xf] + (dither ? ((n++ >> 1) & 1) : 0))); }
+};
+
+// Run a batch to completion as the ISR would; returns conversions done.
+static int runToCompletion(OTV0P2BASE::ADCBatchBase &b, SimADC &adc, const int limit = 1000)
+{
+    uint8_t admux = b.begin();
+    int conversions = 0;
+    while(conversions < limit) {
+        ++conversions;
+        if(!b.onSample(adc.convert(admux), admux)) { break; }
+    }
+    b.finish();
+    return(conversions);
+}
+
+static uint16_t cbResult;
+static int cbCount;
+static void cb(void *ctx, uint16_t result) { ++cbCount; cbResult = result; *static_cast<uint16_t *>(ctx) = result; }
+}
+
+// Channels are converted in order with settling samples discarded.
+TEST(ADCBatch,Sequencing)
+{
+    ADCBatchTest::SimADC adc;
+    for(int i = 0; i < 16; ++i) { adc.values[i] = uint16_t(100 * i); }
+    OTV0P2BASE::ADCBatch<3> b;
+    EXPECT_EQ(0, b.size());
+    EXPECT_EQ(0, b.add(0x41));
+    EXPECT_EQ(1, b.add(0x4e, 0, 2));
+    EXPECT_EQ(2, b.add(0x43, 0, 0));
+    EXPECT_EQ(-1, b.add(0x44));
+    EXPECT_EQ(3, b.size());
+    EXPECT_FALSE(b.isComplete());
+    // 2 + 3 + 1 conversions.
+    EXPECT_EQ(6, ADCBatchTest::runToCompletion(b, adc));
+    EXPECT_TRUE(b.isComplete());
+    EXPECT_EQ(100, b.getResult(0));
+    EXPECT_EQ(1400, b.getResult(1));
+    EXPECT_EQ(300, b.getResult(2));
+    EXPECT_EQ(OTV0P2BASE::ADCBatchBase::INVALID_RESULT, b.getResult(3));
+    b.clear();
+    EXPECT_EQ(0, b.size());
+    EXPECT_TRUE(b.isComplete());
+}
+
+// Oversampling and decimation give extra bits.
+TEST(ADCBatch,Oversampling)
+{
+    ADCBatchTest::SimADC adc;
+    adc.values[0] = 1023;
+    adc.values[1] = 512;
+    adc.dither = true;
+    OTV0P2BASE::ADCBatch<4> b;
+    EXPECT_EQ(-1, b.add(0, 4));
+    EXPECT_EQ(0, b.add(0, 3, 0));
+    EXPECT_EQ(1, b.add(1, 1, 0));
+    EXPECT_EQ(2, b.add(1, 2, 0));
+    // 64 + 4 + 16 conversions.
+    EXPECT_EQ(84, ADCBatchTest::runToCompletion(b, adc));
+    // Half of samples are 1 higher: 13 bits, max (1023 + 0.5) * 8.
+    EXPECT_EQ(8188, b.getResult(0));
+    EXPECT_EQ(1025, b.getResult(1));
+    EXPECT_EQ(2050, b.getResult(2));
+}
+
+// Callbacks are called on finish, including for incomplete channels.
+TEST(ADCBatch,CallbacksAndTimeout)
+{
+    ADCBatchTest::SimADC adc;
+    adc.values[2] = 777;
+    adc.values[3] = 42;
+    OTV0P2BASE::ADCBatch<2> b;
+    uint16_t r2 = 0, r3 = 0;
+    b.add(2, 0, 1, ADCBatchTest::cb, &r2);
+    b.add(3, 2, 1, ADCBatchTest::cb, &r3);
+    ADCBatchTest::cbCount = 0;
+    EXPECT_EQ(2 + 17, ADCBatchTest::runToCompletion(b, adc));
+    EXPECT_EQ(2, ADCBatchTest::cbCount);
+    EXPECT_EQ(777, r2);
+    EXPECT_EQ(168, r3);
+    // Stopped early, eg at the end of the minor cycle.
+    ADCBatchTest::cbCount = 0;
+    EXPECT_EQ(5, ADCBatchTest::runToCompletion(b, adc, 5));
+    EXPECT_TRUE(b.isComplete());
+    EXPECT_EQ(2, ADCBatchTest::cbCount);
+    EXPECT_EQ(777, r2);
+    EXPECT_EQ(OTV0P2BASE::ADCBatchBase::INVALID_RESULT, r3);
+    EXPECT_EQ(OTV0P2BASE::ADCBatchBase::INVALID_RESULT, ADCBatchTest::cbResult);
+    // No more processing after finish().
+    uint8_t admux;
+    EXPECT_FALSE(b.onSample(0, admux));
+}
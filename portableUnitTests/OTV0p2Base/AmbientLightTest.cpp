@@ -146,3 +146,79 @@ TEST(AmbientLight,setTypMinMax)
     EXPECT_FALSE(alm.isRoomVeryDark());
     EXPECT_EQ(0, alm.getDarkMinutes());
 }
+
+// Sliding-window min/max matches a brute-force rescan of the last N samples.
+TEST(AmbientLight,slidingWindowMinMax)
+{
+    constexpr uint8_t N = 24;
+    OTV0P2BASE::SlidingWindowMinMax<N> w;
+    EXPECT_EQ(0xff, w.getMin());
+    EXPECT_EQ(0xff, w.getMax());
+    EXPECT_FALSE(w.push(0xff));
+    EXPECT_EQ(0, w.size());
+    uint8_t hist[1000];
+    uint32_t x = 1;
+    for(int i = 0; i < 1000; ++i)
+        {
+        // Mix of random walk and jumps to exercise both deques.
+        x = x * 1103515245U + 12345U;
+        const uint8_t v = (0 == (x >> 28)) ? uint8_t((x >> 8) % 255) : uint8_t(((i > 0) ? hist[i-1] : 128) + int((x >> 16) % 7) - 3) % 255;
+        hist[i] = v;
+        const uint8_t oldMin = w.getMin(), oldMax = w.getMax();
+        const bool changed = w.push(v);
+        uint8_t mn = 0xff, mx = 0;
+        for(int j = (i >= N) ? (i - N + 1) : 0; j <= i; ++j) { if(hist[j] < mn) { mn = hist[j]; } if(hist[j] > mx) { mx = hist[j]; } }
+        ASSERT_EQ(mn, w.getMin()) << i;
+        ASSERT_EQ(mx, w.getMax()) << i;
+        ASSERT_EQ((oldMin != mn) || (oldMax != mx), changed) << i;
+        }
+    EXPECT_EQ(N, w.size());
+    w.reset();
+    EXPECT_EQ(0, w.size());
+    EXPECT_EQ(0xff, w.getMin());
+}
+
+namespace ALTest {
+// Adaptive mock tracking its own min/max hourly means over a day.
+class SensorAmbientLightWindowMock final : public OTV0P2BASE::SensorAmbientLightAdaptiveTBase<OTV0P2BASE::SensorAmbientLightOccupancyDetectorSimple, 24>
+  {
+  public:
+    bool set(const uint8_t newValue) { value = newValue; return(true); }
+  };
+}
+
+// With a window the sensor adapts its thresholds itself once it has a day of hourly means.
+TEST(AmbientLight,windowAdapts)
+{
+    ALTest::SensorAmbientLightWindowMock alm;
+    const uint8_t dlt = OTV0P2BASE::SensorAmbientLightBase::DEFAULT_LIGHT_THRESHOLD;
+    alm.setTypMinMax(64, 0xff, 0xff, false);
+    // A day of hourly levels from 1 to 183, read once per minute.
+    for(int h = 0; h < 24; ++h)
+        {
+        alm.set(uint8_t((h < 12) ? 1 : 183));
+        for(int m = 0; m < 60; ++m)
+            {
+            // Not adapted until a whole day is seen.
+            if(h < 23) { ASSERT_EQ(dlt, alm.getLightThreshold()); }
+            alm.read();
+            }
+        }
+    EXPECT_EQ(1, alm.getWindowMin());
+    EXPECT_EQ(183, alm.getWindowMax());
+    // Same thresholds as supplying these stats directly.
+    EXPECT_EQ(17, alm.getLightThreshold());
+    EXPECT_EQ(6, alm.getDarkThreshold());
+    // Stats-supplied min/max are now overridden by the window.
+    alm.setTypMinMax(64, 123, 123, false);
+    EXPECT_FALSE(alm.isRangeTooNarrow());
+    EXPECT_EQ(17, alm.getLightThreshold());
+    // Once the dark hours slide out the range narrows.
+    alm.set(183);
+    for(int m = 0; m < 12 * 60; ++m) { alm.read(); }
+    EXPECT_EQ(183, alm.getWindowMin());
+    EXPECT_TRUE(alm.isRangeTooNarrow());
+    alm.resetAdaptive();
+    EXPECT_EQ(0xff, alm.getWindowMin());
+    EXPECT_EQ(dlt, alm.getLightThreshold());
+}
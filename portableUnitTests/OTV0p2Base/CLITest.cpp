@@ -0,0 +1,165 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * OTV0P2BASE CLI line reader and batch tests.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "OTV0P2BASE_CLI.h"
+
+
+namespace CLITest {
+// Serial simulator: input queued with add(), output captured.
+class SerialSimulator final : public Stream
+  {
+  public:
+    std::string toBeRead;
+    std::string written;
+    void add(const char *s) { toBeRead += s; }
+    virtual size_t write(uint8_t uc) override { written += char(uc); return(1); }
+    virtual int read() override
+      {
+      if(toBeRead.empty()) { return(-1); }
+      const char c = toBeRead.front();
+      toBeRead.erase(0, 1);
+      return(c);
+      }
+    virtual int available() override { return(int(toBeRead.size())); }
+    virtual int peek() override { return(toBeRead.empty() ? -1 : toBeRead.front()); }
+    virtual void flush() override { }
+  };
+
+// Records command lines; rejects any containing 'X'.
+class RecordingEntry final : public OTV0P2BASE::CLIEntryBase
+  {
+  public:
+    std::vector<std::string> lines;
+    virtual bool doCommand(char *buf, uint8_t) override
+      {
+      lines.push_back(buf);
+      if(NULL != strchr(buf, 'X')) { OTV0P2BASE::CLI::noteInvalidIgnored(); }
+      return(false);
+      }
+  };
+}
+
+// Partial input survives across polls; filtering matches promptAndReadCommandLine().
+TEST(CLI,lineReader)
+{
+    char buf[8];
+    OTV0P2BASE::CLI::CLILineReader r(buf, sizeof(buf));
+    CLITest::SerialSimulator s;
+    s.add(" \x01" "a 1");
+    EXPECT_EQ(0, r.poll(s));
+    EXPECT_TRUE(r.hasPartial());
+    // Rest of the line arrives in a later cycle.
+    s.add("2\r\nb");
+    EXPECT_EQ(4, r.poll(s));
+    EXPECT_STREQ("A 12", r.getLine());
+    EXPECT_FALSE(r.hasPartial());
+    // The LF of CRLF and the next partial line are left for the next poll.
+    EXPECT_EQ(0, r.poll(s));
+    EXPECT_TRUE(r.hasPartial());
+    r.clear();
+    // Over-long lines are discarded whole.
+    s.add("K 12345678\rI\r");
+    EXPECT_EQ(1, r.poll(s));
+    EXPECT_STREQ("I", r.getLine());
+    EXPECT_EQ(0, r.poll(s));
+    EXPECT_FALSE(r.hasPartial());
+}
+
+// Batch mode runs many commands per poll with a compact ACK each.
+TEST(CLI,batch)
+{
+    CLITest::RecordingEntry a, k;
+    const OTV0P2BASE::CLI::CLIBatch::entry_t table[] = { { 'A', &a }, { 'K', &k } };
+    CLITest::SerialSimulator s;
+    OTV0P2BASE::CLI::CLIBatch b(table, 2, s);
+    char buf[32];
+    OTV0P2BASE::CLI::CLILineReader r(buf, sizeof(buf));
+    EXPECT_EQ(0, b.poll(r, s));
+    OTV0P2BASE::CLI::EnterBatch eb(b);
+    eb.doCommand(buf, 1);
+    EXPECT_TRUE(b.isActive());
+    s.add("A 01 02\r\nA 0X\r\nQ\r\nk B\r\nA 0");
+    EXPECT_EQ(3, b.poll(r, s, 3));
+    EXPECT_EQ(1, b.poll(r, s));
+    EXPECT_EQ(2U, a.lines.size());
+    ASSERT_EQ(1U, k.lines.size());
+    EXPECT_EQ("K B", k.lines[0]);
+    s.add("3\r\n+\r\nA 04\r\n");
+    EXPECT_EQ(2, b.poll(r, s));
+    EXPECT_FALSE(b.isActive());
+    EXPECT_EQ(3U, a.lines.size());
+    EXPECT_EQ("A 03", a.lines[2]);
+    EXPECT_EQ("+B\r\n+0\r\n!1\r\n!2\r\n+3\r\n+4\r\n+B 5 2\r\n", s.written);
+    EXPECT_EQ(5, b.getCommands());
+    EXPECT_EQ(2, b.getErrors());
+}
+
+namespace CLITest {
+// Key store that fails, or records and succeeds.
+static bool keyStoreOK;
+static uint8_t storedKey[16];
+static bool setKey(const uint8_t *key)
+  {
+  if(!keyStoreOK) { return(false); }
+  if(NULL == key) { memset(storedKey, 0xff, sizeof(storedKey)); }
+  else { memcpy(storedKey, key, sizeof(storedKey)); }
+  return(true);
+  }
+}
+
+// A key that cannot be stored is not ACKed in a batch.
+TEST(CLI,batchKeyStoreFails)
+{
+    CLITest::SerialSimulator s;
+    OTV0P2BASE::CLI::SetSecretKey k(NULL, CLITest::setKey, s);
+    const OTV0P2BASE::CLI::CLIBatch::entry_t table[] = { { 'K', &k } };
+    OTV0P2BASE::CLI::CLIBatch b(table, 1, s);
+    char buf[64];
+    OTV0P2BASE::CLI::CLILineReader r(buf, sizeof(buf));
+    OTV0P2BASE::CLI::EnterBatch eb(b);
+    eb.doCommand(buf, 1);
+    const char *const line = "K B 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f 10\r\n";
+    CLITest::keyStoreOK = false;
+    s.add(line);
+    s.add("K B *\r\n");
+    EXPECT_EQ(2, b.poll(r, s));
+    EXPECT_EQ("+B\r\n!B\r\n!0\r\n!B\r\n!1\r\n", s.written);
+    EXPECT_EQ(2, b.getErrors());
+    // Once the store works the same commands are ACKed.
+    s.written.clear();
+    CLITest::keyStoreOK = true;
+    s.add(line);
+    EXPECT_EQ(1, b.poll(r, s));
+    EXPECT_EQ("B set\r\n+2\r\n", s.written);
+    EXPECT_EQ(16, CLITest::storedKey[15]);
+    s.written.clear();
+    s.add("K B *\r\n");
+    EXPECT_EQ(1, b.poll(r, s));
+    EXPECT_EQ("B clear\r\n+3\r\n", s.written);
+    EXPECT_EQ(2, b.getErrors());
+}
@@ -0,0 +1,91 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * OTV0P2BASE CycleBudget tests.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+
+#include "OTV0P2BASE_CycleBudget.h"
+#include "OTV0P2BASE_JSONStats.h"
+
+
+// Deferrals, overruns (including across the cycle wrap) and slack buckets.
+TEST(CycleBudget,buckets)
+{
+    OTV0P2BASE::CycleBudget cb;
+    const uint8_t mq = OTV0P2BASE::CBC_MESSAGING;
+    // Too late to start.
+    EXPECT_FALSE(cb.mayStart(mq, 200, 191));
+    EXPECT_EQ(1, cb.getCount(mq, OTV0P2BASE::CycleBudget::B_DEFERRED));
+    // Starts and finishes with lots of slack.
+    EXPECT_TRUE(cb.mayStart(mq, 10, 191));
+    cb.finished(mq, 40);
+    EXPECT_EQ(1, cb.getCount(mq, OTV0P2BASE::CycleBudget::B_SLACK_HIGH));
+    // Finishes past its deadline.
+    EXPECT_TRUE(cb.mayStart(mq, 100, 191));
+    cb.finished(mq, 180, 150);
+    // Finishes in the next cycle.
+    EXPECT_TRUE(cb.mayStart(mq, 180, 191));
+    cb.finished(mq, 5);
+    EXPECT_EQ(2, cb.getCount(mq, OTV0P2BASE::CycleBudget::B_OVERRUN));
+    // Close to the deadline, and middling.
+    cb.recordSlack(mq, 240, 255);
+    cb.recordSlack(mq, 155, 255);
+    EXPECT_EQ(1, cb.getCount(mq, OTV0P2BASE::CycleBudget::B_SLACK_LOW));
+    EXPECT_EQ(1, cb.getCount(mq, OTV0P2BASE::CycleBudget::B_SLACK_MID));
+    EXPECT_EQ(3, cb.getMisses(mq));
+    // Other components untouched; out of range ignored.
+    EXPECT_EQ(0, cb.getMisses(OTV0P2BASE::CBC_CLI));
+    EXPECT_FALSE(cb.mayStart(OTV0P2BASE::CBC_COUNT, 10, 5));
+    cb.finished(OTV0P2BASE::CBC_COUNT, 10);
+    EXPECT_EQ(0, cb.getCount(OTV0P2BASE::CBC_COUNT, 0));
+    EXPECT_STREQ("mq", OTV0P2BASE::CycleBudget::getName(mq));
+    EXPECT_EQ(NULL, OTV0P2BASE::CycleBudget::getName(OTV0P2BASE::CBC_COUNT));
+}
+
+// Counts decay over time, and are reported via JSON and stats.
+TEST(CycleBudget,decayAndReports)
+{
+    const bool verbose = false;
+    OTV0P2BASE::CycleBudget cb;
+    const uint8_t cli = OTV0P2BASE::CBC_CLI;
+    for(int i = 0; i < 10; ++i) { cb.mayStart(cli, 250, 240); }
+    cb.recordSlack(OTV0P2BASE::CBC_FHT8V, 20, 10);
+    for(int i = 0; i < OTV0P2BASE::CycleBudget::DECAY_CYCLES - 1; ++i) { cb.endCycle(); }
+    EXPECT_EQ(10, cb.getCount(cli, OTV0P2BASE::CycleBudget::B_DEFERRED));
+    cb.endCycle();
+    EXPECT_EQ(5, cb.getCount(cli, OTV0P2BASE::CycleBudget::B_DEFERRED));
+
+    char buf[128];
+    OTV0P2BASE::BufPrint bp(buf, sizeof(buf));
+    const size_t n = cb.printJSON(bp);
+    if(verbose) { printf("%s\n", buf); }
+    EXPECT_EQ(strlen(buf), n);
+    EXPECT_STREQ("{\"cb\":{\"mq\":[0,0,0,0,0],\"cli\":[5,0,0,0,0],\"fht\":[0,0,0,0,0],\"stx\":[0,0,0,0,0],\"app\":[0,0,0,0,0]}}", buf);
+
+    OTV0P2BASE::SimpleStatsRotation<4> rs;
+    cb.putStats(rs);
+    EXPECT_EQ(1, rs.size());
+    EXPECT_TRUE(rs.containsKey("cli"));
+    cb.reset();
+    EXPECT_EQ(0, cb.getMisses(cli));
+}
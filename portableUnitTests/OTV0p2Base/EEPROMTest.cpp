@@ -43,3 +43,92 @@ TEST(EEPROM, UnaryEncoding)
   EXPECT_EQ(-1, OTV0P2BASE::eeprom_unary_1byte_decode(0xef));
   EXPECT_EQ(-1, OTV0P2BASE::eeprom_unary_2byte_decode(0xccccU));
   }
+
+// Host EEPROM emulator counts traffic and time for the smart routines.
+TEST(EEPROM, EmulatorSmartOps)
+  {
+  OTV0P2BASE::EEPROMEmulator &e = OTV0P2BASE::EEPROMEmulator::getInstance();
+  e.reset();
+  uint8_t *const p = (uint8_t *)(intptr_t)5;
+  EXPECT_EQ(0xff, eeprom_read_byte(p));
+  // Erasing an erased byte costs only a read.
+  EXPECT_FALSE(OTV0P2BASE::eeprom_smart_erase_byte(p));
+  EXPECT_EQ(0U, e.busyUS);
+  // From erased, clearing bits needs only a write.
+  EXPECT_TRUE(OTV0P2BASE::eeprom_smart_update_byte(p, 0x7f));
+  EXPECT_EQ(0U, e.erases[5]);
+  EXPECT_EQ(1U, e.writes[5]);
+  EXPECT_EQ(uint32_t(OTV0P2BASE::EEPROMEmulator::writeUS), e.busyUS);
+  EXPECT_FALSE(OTV0P2BASE::eeprom_smart_update_byte(p, 0x7f));
+  EXPECT_TRUE(OTV0P2BASE::eeprom_smart_clear_bits(p, 0x3f));
+  EXPECT_EQ(0x3f, eeprom_read_byte(p));
+  EXPECT_EQ(0U, e.erases[5]);
+  // Setting a bit needs an erase and write.
+  EXPECT_TRUE(OTV0P2BASE::eeprom_smart_update_byte(p, 0x40));
+  EXPECT_EQ(0x40, eeprom_read_byte(p));
+  EXPECT_EQ(1U, e.erases[5]);
+  EXPECT_EQ(3U, e.writes[5]);
+  EXPECT_TRUE(OTV0P2BASE::eeprom_smart_erase_byte(p));
+  EXPECT_EQ(2U, e.erases[5]);
+  EXPECT_EQ(uint32_t(2*OTV0P2BASE::EEPROMEmulator::writeUS + OTV0P2BASE::EEPROMEmulator::eraseWriteUS + OTV0P2BASE::EEPROMEmulator::eraseUS), e.busyUS);
+  EXPECT_EQ(2U, e.getMaxErases());
+  EXPECT_LT(5U, e.getTotalReads());
+  // Other bytes untouched, and out-of-range accesses ignored.
+  EXPECT_EQ(2U, e.getTotalErases());
+  OTV0P2BASE::eeprom_smart_update_byte((uint8_t *)(intptr_t)V0P2BASE_EEPROM_SIZE, 0);
+  EXPECT_EQ(3U, e.getTotalWrites());
+  e.reset();
+  EXPECT_EQ(0U, e.getTotalReads());
+  }
+
+// Measures EEPROM wear from a simulated week of by-hour stats updates
+// and of quarter-hour RTC persistence through the journal.
+TEST(EEPROM, EmulatorWear)
+  {
+  const bool verbose = false;
+  OTV0P2BASE::EEPROMEmulator &e = OTV0P2BASE::EEPROMEmulator::getInstance();
+  e.reset();
+  OTV0P2BASE::EEPROMByHourByteStats ms;
+  OTV0P2BASE::EEPROMNVByteBackingStore js(V0P2BASE_EE_START_JOURNAL, V0P2BASE_EE_LEN_JOURNAL);
+  OTV0P2BASE::EEPROMJournal j(js);
+  j.begin();
+  const uint16_t days = 7;
+  for(uint16_t d = 0; d < days; ++d)
+    {
+    for(uint8_t q = 0; q < 96; ++q)
+      {
+      const uint8_t v[] = { uint8_t(d), 0, q };
+      ASSERT_TRUE(j.put(OTV0P2BASE::V0P2BASE_EE_JOURNAL_KEY_RTC, v, sizeof(v)));
+      if(3 == (q & 3))
+        {
+        const uint8_t hh = q / 4;
+        ms.setByHourStatSimple(OTV0P2BASE::NVByHourByteStatsBase::STATS_SET_TEMP_BY_HOUR, hh, uint8_t(100 + (d & 1) + hh));
+        ms.setByHourStatSimple(OTV0P2BASE::NVByHourByteStatsBase::STATS_SET_TEMP_BY_HOUR_SMOOTHED, hh, uint8_t(100 + hh));
+        }
+      }
+    }
+  if(verbose) { e.dumpWearHeatmap(stdout); }
+  uint8_t buf[3];
+  EXPECT_EQ(3, j.get(OTV0P2BASE::V0P2BASE_EE_JOURNAL_KEY_RTC, buf, sizeof(buf)));
+  EXPECT_EQ(days - 1, buf[0]);
+  // Only the stats and journal areas are touched.
+  for(uint16_t a = 0; a < V0P2BASE_EEPROM_SIZE; ++a)
+    {
+    if((a >= V0P2BASE_EE_START_STATS) && (a <= V0P2BASE_EE_END_JOURNAL)) { continue; }
+    EXPECT_EQ(0U, e.erases[a] + e.writes[a]) << a;
+    }
+  // Alternating stats values are rewritten every day, smoothed ones only once.
+  const uint16_t raw = V0P2BASE_EE_STATS_START_ADDR(OTV0P2BASE::NVByHourByteStatsBase::STATS_SET_TEMP_BY_HOUR);
+  const uint16_t smoothed = V0P2BASE_EE_STATS_START_ADDR(OTV0P2BASE::NVByHourByteStatsBase::STATS_SET_TEMP_BY_HOUR_SMOOTHED);
+  EXPECT_EQ(uint32_t(days / 2), e.erases[raw]);
+  EXPECT_EQ(0U, e.erases[smoothed]);
+  // The journal spreads 4 RTC updates per hour so each byte is erased
+  // less often than once per hour, as for the in-place encoding.
+  uint32_t maxJournalErases = 0;
+  for(uint16_t a = V0P2BASE_EE_START_JOURNAL; a <= V0P2BASE_EE_END_JOURNAL; ++a)
+    { if(e.erases[a] > maxJournalErases) { maxJournalErases = e.erases[a]; } }
+  EXPECT_LT(0U, maxJournalErases);
+  EXPECT_GT(uint32_t(days) * 24, maxJournalErases);
+  EXPECT_LT(0U, e.busyUS);
+  e.reset();
+  }
@@ -0,0 +1,97 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * OTV0P2BASE entropy pool tests.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+
+#include "OTV0P2BASE_Entropy.h"
+
+
+// Entropy is credited, capped and debited; output depends on all input.
+TEST(Entropy,poolAccounting)
+{
+    OTV0P2BASE::EntropyPool p;
+    EXPECT_EQ(0, p.getBits());
+    uint8_t a[16], b[16];
+    // Nothing credited yet, but output is still produced.
+    EXPECT_FALSE(p.extract(a, 1));
+    for(int i = 0; i < 64; ++i) { p.add(uint8_t(i * 37), 4); }
+    EXPECT_EQ(OTV0P2BASE::EntropyPool::MAX_BITS, p.getBits());
+    EXPECT_TRUE(p.extract(a, 16));
+    EXPECT_EQ(OTV0P2BASE::EntropyPool::MAX_BITS - 128, p.getBits());
+    EXPECT_FALSE(p.extract(b, 16));
+    EXPECT_EQ(0, p.getBits());
+    EXPECT_NE(0, memcmp(a, b, sizeof(a)));
+    // Uncredited input is mixed in but adds no entropy.
+    OTV0P2BASE::EntropyPool q1, q2;
+    q1.add(1, 0);
+    q2.add(2, 0);
+    EXPECT_EQ(0, q1.getBits());
+    q1.extract(a, 16);
+    q2.extract(b, 16);
+    EXPECT_NE(0, memcmp(a, b, sizeof(a)));
+    EXPECT_EQ(0, p.getHealthFailures());
+}
+
+// A stuck source fails the repetition count test and loses its credit.
+TEST(Entropy,healthRepetition)
+{
+    OTV0P2BASE::EntropyPool p;
+    for(int i = 0; i < OTV0P2BASE::EntropyPool::RCT_CUTOFF - 1; ++i) { p.add(0x55, 1); }
+    EXPECT_EQ(OTV0P2BASE::EntropyPool::RCT_CUTOFF - 1, p.getBits());
+    EXPECT_EQ(0, p.getHealthFailures());
+    p.add(0x55, 1);
+    EXPECT_EQ(1, p.getHealthFailures());
+    EXPECT_EQ(0, p.getBits());
+    // Zero-credit samples are not tested.
+    for(int i = 0; i < 100; ++i) { p.add(0, 0); }
+    EXPECT_EQ(1, p.getHealthFailures());
+}
+
+// A heavily biased source fails the adaptive proportion test.
+TEST(Entropy,healthProportion)
+{
+    OTV0P2BASE::EntropyPool p;
+    for(int i = 0; i < OTV0P2BASE::EntropyPool::APT_WINDOW; ++i)
+        { p.add(((i % 8) == 7) ? uint8_t(i) : 0xa5, 1); }
+    EXPECT_EQ(1, p.getHealthFailures());
+    // A fair source passes.
+    OTV0P2BASE::EntropyPool f;
+    for(int i = 0; i < 4 * OTV0P2BASE::EntropyPool::APT_WINDOW; ++i)
+        { f.add(uint8_t(i * 73 + (i >> 3)), 1); }
+    EXPECT_EQ(0, f.getHealthFailures());
+}
+
+// The host build serves multi-byte requests from /dev/urandom.
+TEST(Entropy,hostSecureRandomBytes)
+{
+    uint8_t a[40], b[40];
+    ASSERT_TRUE(OTV0P2BASE::getSecureRandomBytes(a, sizeof(a)));
+    ASSERT_TRUE(OTV0P2BASE::getSecureRandomBytes(b, sizeof(b)));
+    EXPECT_NE(0, memcmp(a, b, sizeof(a)));
+    // Crude sanity check on the bits set.
+    int ones = 0;
+    for(size_t i = 0; i < sizeof(a); ++i) { for(uint8_t v = a[i]; 0 != v; v &= v - 1) { ++ones; } }
+    EXPECT_LT(100, ones);
+    EXPECT_GT(220, ones);
+}
@@ -0,0 +1,236 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * OneWire, Dallas CRC8 and DS18B20 tests over a simulated bus.
+ */
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "OTV0p2Base.h"
+
+
+namespace MinOWTest {
+// Simple bitwise reference for the Dallas/Maxim CRC8.
+static uint8_t crc8Bitwise(uint8_t crc, const uint8_t datum)
+{
+    crc ^= datum;
+    for(int i = 0; i < 8; ++i) { crc = (crc & 1) ? ((crc >> 1) ^ 0x8c) : (crc >> 1); }
+    return(crc);
+}
+}
+
+// Table-driven CRC8 matches the bitwise definition and the datasheet example.
+TEST(MinOW,CRC8Dallas)
+{
+    for(int c = 0; c < 256; ++c) {
+        for(int d = 0; d < 256; ++d) {
+            ASSERT_EQ(MinOWTest::crc8Bitwise(uint8_t(c), uint8_t(d)),
+                      OTV0P2BASE::crc8_dallas_update(uint8_t(c), uint8_t(d)));
+        }
+    }
+    // ROM ID example from Maxim application note 27.
+    const uint8_t rom[8] = { 0x02, 0x1c, 0xb8, 0x01, 0x00, 0x00, 0x00, 0xa2 };
+    EXPECT_EQ(0xa2, OTV0P2BASE::crc8_dallas(rom, 7));
+    EXPECT_EQ(0, OTV0P2BASE::crc8_dallas(rom, 8));
+}
+
+// The unmodified search finds all simulated devices, with valid ROM CRCs.
+TEST(MinOW,SimulatedSearch)
+{
+    OTV0P2BASE::MinimalOneWireSimulator<4> ow;
+    EXPECT_FALSE(ow.reset());
+    uint8_t addr[8];
+    ow.reset_search();
+    EXPECT_FALSE(ow.search(addr));
+    EXPECT_EQ(0, ow.addDS18B20(0x123456));
+    EXPECT_EQ(1, ow.addDS18B20(0x123457));
+    EXPECT_EQ(2, ow.addDS18B20(0xabcdef));
+    EXPECT_TRUE(ow.reset());
+    int found = 0;
+    uint8_t seen = 0;
+    ow.reset_search();
+    while(ow.search(addr)) {
+        ++found;
+        EXPECT_EQ(0x28, addr[0]);
+        EXPECT_EQ(0, OTV0P2BASE::crc8_dallas(addr, 8));
+        for(uint8_t i = 0; i < ow.getDeviceCount(); ++i) {
+            if(0 == memcmp(addr, ow.getROM(i), 8)) { seen |= uint8_t(1 << i); }
+        }
+    }
+    EXPECT_EQ(3, found);
+    EXPECT_EQ(7, seen);
+}
+
+// Multi-probe DS18B20 reads with one conversion, CRC checks and cached ROMs.
+TEST(MinOW,DS18B20MultiProbe)
+{
+    OTV0P2BASE::MinimalOneWireSimulator<4> ow;
+    ow.addDS18B20(0x1001, 21 * 16);
+    ow.addDS18B20(0x2002, -5 * 16);
+    ow.addDS18B20(0x3003, 60 * 16 + 8);
+    ow.setConversionSlots(10);
+    OTV0P2BASE::TemperatureC16_DS18B20 ds(ow);
+    EXPECT_EQ(3, ds.getSensorCount());
+    EXPECT_TRUE(ds.isAvailable());
+    EXPECT_EQ(3, ds.getCachedProbeCount());
+    // Precision was set on all devices.
+    for(uint8_t i = 0; i < 3; ++i) { EXPECT_EQ(0x1f, ow.getScratchpad(i)[4]); }
+    EXPECT_EQ(3, ds.readAllProbes());
+    // Values by bus (search) order, matched back to devices.
+    int found = 0;
+    for(uint8_t p = 0; p < 3; ++p) {
+        for(uint8_t i = 0; i < 3; ++i) {
+            if(0 != memcmp(ds.getProbeROM(p), ow.getROM(i), 8)) { continue; }
+            ++found;
+            const int16_t expected = (0 == i) ? 21 * 16 : ((1 == i) ? -5 * 16 : 60 * 16 + 8);
+            EXPECT_EQ(expected, ds.getProbeValue(p));
+        }
+    }
+    EXPECT_EQ(3, found);
+    EXPECT_EQ(ds.getProbeValue(0), ds.get());
+    // Probes as sub-sensors.
+    const OTV0P2BASE::TemperatureC16_DS18B20_Probe p2(ds, 2, "T2|C16");
+    EXPECT_EQ(ds.getProbeValue(2), p2.get());
+    EXPECT_TRUE(p2.isAvailable());
+    EXPECT_STREQ("T2|C16", p2.tag());
+    const OTV0P2BASE::TemperatureC16_DS18B20_Probe p3(ds, 3, "T3|C16");
+    EXPECT_FALSE(p3.isAvailable());
+    // A corrupt scratchpad is rejected.
+    EXPECT_EQ(0, ds.getCRCErrors());
+    for(uint8_t i = 0; i < 3; ++i) { ow.setCorrupt(i, true); }
+    EXPECT_EQ(3, ds.readAllProbes());
+    EXPECT_FALSE(p2.isAvailable());
+    EXPECT_TRUE(ds.isErrorValue(ds.get()));
+    EXPECT_LE(3, ds.getCRCErrors());
+    for(uint8_t i = 0; i < 3; ++i) { ow.setCorrupt(i, false); }
+    EXPECT_EQ(3, ds.readAllProbes());
+    EXPECT_TRUE(p2.isAvailable());
+    // Reading by index beyond the cache still works (by search).
+    int16_t v[2];
+    EXPECT_EQ(1, ds.readMultiple(v, 2, 2));
+    EXPECT_EQ(ds.getProbeValue(2), v[0]);
+}
+
+// A corrupted ROM ID ahead of a probe beyond the cache does not shift reads by index.
+TEST(MinOW,DS18B20BadROMBeyondCache)
+{
+    OTV0P2BASE::MinimalOneWireSimulator<6> ow;
+    for(int i = 0; i < 6; ++i) { ow.addDS18B20(0x10203 * (i + 1), int16_t(16 * (10 + i))); }
+    // Damage the first ROM ID found.
+    uint8_t addr[8];
+    ow.reset_search();
+    ASSERT_TRUE(ow.search(addr));
+    uint8_t bad = 0;
+    while(0 != memcmp(addr, ow.getROM(bad), 8)) { ++bad; }
+    ow.setBadROMCRC(bad);
+    // Devices in search order.
+    uint8_t order[6];
+    uint8_t n = 0;
+    ow.reset_search();
+    while(ow.search(addr)) {
+        for(uint8_t i = 0; i < 6; ++i) { if(0 == memcmp(addr, ow.getROM(i), 8)) { order[n++] = i; } }
+    }
+    ASSERT_EQ(6, n);
+    ASSERT_EQ(bad, order[0]);
+    OTV0P2BASE::TemperatureC16_DS18B20 ds(ow);
+    EXPECT_EQ(5, ds.getSensorCount());
+    EXPECT_EQ(uint8_t(OTV0P2BASE::TemperatureC16_DS18B20::MAX_CACHED_PROBES), ds.getCachedProbeCount());
+    // The last probe, beyond the cache, is found by search.
+    int16_t v[2];
+    EXPECT_EQ(1, ds.readMultiple(v, 2, 4));
+    EXPECT_EQ(16 * (10 + order[5]), v[0]);
+    // Cached probes are unaffected.
+    EXPECT_EQ(1, ds.readMultiple(v, 1, 3));
+    EXPECT_EQ(16 * (10 + order[4]), v[0]);
+}
+
+// Revalidation of the cached ROM list is much cheaper than a full search.
+TEST(MinOW,RevalidationBenchmark)
+{
+    OTV0P2BASE::MinimalOneWireSimulator<4> ow;
+    for(int i = 0; i < 4; ++i) { ow.addDS18B20(0x5a5a00 + 37 * i, int16_t(16 * i)); }
+    OTV0P2BASE::TemperatureC16_DS18B20 ds(ow);
+    ow.clearStats();
+    EXPECT_EQ(4, ds.getSensorCount());
+    const uint32_t searchTime = ow.getBusTime_us();
+    ow.clearStats();
+    EXPECT_EQ(4, ds.readAllProbes());
+    const uint32_t plainReadTime = ow.getBusTime_us();
+    // A bad read forces re-initialisation, which need only revalidate the cache.
+    ow.setCorrupt(0, true);
+    ds.readAllProbes();
+    ow.setCorrupt(0, false);
+    ow.clearStats();
+    EXPECT_EQ(4, ds.readAllProbes());
+    const uint32_t revalidateTime = ow.getBusTime_us() - plainReadTime;
+    EXPECT_LT(0U, revalidateTime);
+    EXPECT_LT(2 * revalidateTime, searchTime);
+    const bool verbose = false;
+    if(verbose)
+        {
+        printf("DS18B20 x4 init: search %uus, revalidate %uus; read all %uus\n",
+            unsigned(searchTime), unsigned(revalidateTime), unsigned(plainReadTime));
+        }
+    // A removed probe fails revalidation and a full search finds the rest.
+    ow.removeLast();
+    EXPECT_EQ(4, ds.readAllProbes());
+    EXPECT_TRUE(ds.isErrorValue(ds.getProbeValue(3)));
+    EXPECT_EQ(3, ds.readAllProbes());
+    EXPECT_EQ(3, ds.getSensorCount());
+    // rescan() always searches.
+    ds.rescan();
+    ow.clearStats();
+    EXPECT_EQ(3, ds.getSensorCount());
+    EXPECT_LT(2 * revalidateTime, ow.getBusTime_us());
+}
+
+// Byte-level reads/writes take the same number of slots as bit-level ones.
+TEST(MinOW,BytePathMatchesBitPath)
+{
+    OTV0P2BASE::MinimalOneWireSimulator<2> ow;
+    ow.addDS18B20(0x42, 123);
+    OTV0P2BASE::MinimalOneWireBase &base = ow;
+    // Byte path.
+    ow.clearStats();
+    base.reset();
+    base.skip();
+    base.write(0x44);
+    base.reset();
+    base.skip();
+    base.write(0xbe);
+    uint8_t d1[9];
+    for(int i = 0; i < 9; ++i) { d1[i] = base.read(); }
+    const uint32_t byteSlots = ow.getSlots();
+    // Bit path.
+    ow.clearStats();
+    base.reset();
+    for(int b = 0; b < 8; ++b) { base.write_bit(0 != (0xcc & (1 << b))); }
+    for(int b = 0; b < 8; ++b) { base.write_bit(0 != (0xbe & (1 << b))); }
+    uint8_t d2[9];
+    for(int i = 0; i < 9; ++i) {
+        d2[i] = 0;
+        for(int b = 0; b < 8; ++b) { if(base.read_bit()) { d2[i] |= uint8_t(1 << b); } }
+    }
+    EXPECT_EQ(0, memcmp(d1, d2, 9));
+    EXPECT_EQ(0, OTV0P2BASE::crc8_dallas(d1, 9));
+    EXPECT_EQ(123, d1[0]);
+    EXPECT_EQ(byteSlots - 16, ow.getSlots());
+}
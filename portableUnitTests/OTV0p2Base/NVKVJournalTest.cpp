@@ -0,0 +1,176 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * NVKVJournal log-structured key-value store tests.
+ */
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "OTV0p2Base.h"
+
+
+namespace NVKVJournalTest {
+// RAM store that counts erases per byte, and can fail all writes after a limit, eg to model a reset.
+template<uint16_t len>
+class CountingStore final : public OTV0P2BASE::NVByteBackingStoreBase
+  {
+  public:
+    uint8_t mem[len];
+    uint32_t erases[len];
+    uint32_t writes = 0;
+    // If non-negative, the number of further writes that succeed.
+    int32_t writesLeft = -1;
+    CountingStore() { memset(mem, 0xff, len); memset(erases, 0, sizeof(erases)); }
+    virtual uint16_t size() const override { return(len); }
+    virtual uint8_t read(const uint16_t addr) const override { return(mem[addr]); }
+    virtual bool write(const uint16_t addr, const uint8_t v) override
+      {
+      if(0 == writesLeft) { return(false); }
+      if(writesLeft > 0) { --writesLeft; }
+      ++writes;
+      if(v != (v & mem[addr])) { ++erases[addr]; } // Needs an erase to set bits.
+      mem[addr] = v;
+      return(true);
+      }
+    virtual bool erase(const uint16_t addr) override
+      {
+      if(0 == writesLeft) { return(false); }
+      if(0xff != mem[addr]) { ++erases[addr]; }
+      mem[addr] = 0xff;
+      return(true);
+      }
+    uint32_t maxErases() const
+      {
+      uint32_t m = 0;
+      for(uint16_t i = 0; i < len; ++i) { if(erases[i] > m) { m = erases[i]; } }
+      return(m);
+      }
+  };
+}
+
+// Values can be set, updated and removed, and survive a remount.
+TEST(NVKVJournal,basics)
+{
+    OTV0P2BASE::NVByteBackingStoreRAM<64> s;
+    OTV0P2BASE::NVKVJournal<4> j(s);
+    EXPECT_FALSE(j.begin()) << "fresh store is formatted";
+    uint8_t buf[8];
+    EXPECT_EQ(-1, j.get(0, buf, sizeof(buf)));
+    const uint8_t a[] = { 1, 2, 3 };
+    const uint8_t b[] = { 0xff, 0 };
+    EXPECT_TRUE(j.put(0, a, sizeof(a)));
+    EXPECT_TRUE(j.put(3, b, sizeof(b)));
+    EXPECT_FALSE(j.put(4, a, sizeof(a))) << "bad key";
+    EXPECT_FALSE(j.put(1, a, 0)) << "empty value";
+    EXPECT_EQ(32 - 2 - 6 - 5, j.freeBytes());
+    EXPECT_TRUE(j.put(0, a, sizeof(a)));
+    EXPECT_EQ(32 - 2 - 6 - 5, j.freeBytes()) << "unchanged value not rewritten";
+    EXPECT_EQ(3, j.get(0, buf, sizeof(buf)));
+    EXPECT_EQ(0, memcmp(a, buf, 3));
+    EXPECT_EQ(-1, j.get(0, buf, 2)) << "buffer too small";
+    EXPECT_TRUE(j.remove(0));
+    EXPECT_FALSE(j.contains(0));
+    EXPECT_TRUE(j.contains(3));
+    // Remount.
+    OTV0P2BASE::NVKVJournal<4> j2(s);
+    EXPECT_TRUE(j2.begin());
+    EXPECT_FALSE(j2.contains(0));
+    EXPECT_EQ(2, j2.get(3, buf, sizeof(buf)));
+    EXPECT_EQ(0, memcmp(b, buf, 2));
+    EXPECT_EQ(j.freeBytes(), j2.freeBytes());
+}
+
+// Repeated updates of a hot key are spread across the journal,
+// and compaction keeps the other values.
+TEST(NVKVJournal,wearLevelling)
+{
+    NVKVJournalTest::CountingStore<88> s;
+    OTV0P2BASE::NVKVJournal<3> j(s);
+    j.begin();
+    const uint8_t cold[] = { 42, 43, 44, 45 };
+    EXPECT_TRUE(j.put(2, cold, sizeof(cold)));
+    const uint32_t updates = 1000;
+    for(uint32_t i = 0; i < updates; ++i)
+        {
+        const uint8_t v[] = { uint8_t(i), uint8_t(i >> 8), uint8_t(i % 96) };
+        ASSERT_TRUE(j.put(0, v, sizeof(v)));
+        }
+    uint8_t buf[8];
+    EXPECT_EQ(3, j.get(0, buf, sizeof(buf)));
+    EXPECT_EQ(uint8_t(updates - 1), buf[0]);
+    EXPECT_EQ(4, j.get(2, buf, sizeof(buf)));
+    EXPECT_EQ(0, memcmp(cold, buf, 4));
+    // Each compaction erases each byte of one bank at most once.
+    EXPECT_LT(0, j.getCompactions());
+    EXPECT_GE(uint32_t(j.getCompactions()) / 2 + 1, s.maxErases());
+    // Much less wear than rewriting one location in place each time.
+    EXPECT_GT(updates / 5, s.maxErases());
+    // Contents survive a remount, even after the generation wraps.
+    OTV0P2BASE::NVKVJournal<3> j2(s);
+    EXPECT_TRUE(j2.begin());
+    EXPECT_EQ(j.getGeneration(), j2.getGeneration());
+    EXPECT_EQ(3, j2.get(0, buf, sizeof(buf)));
+    EXPECT_EQ(uint8_t(updates - 1), buf[0]);
+    EXPECT_EQ(4, j2.get(2, buf, sizeof(buf)));
+}
+
+// A reset part way through any update leaves either the old or the new value.
+TEST(NVKVJournal,resetDuringUpdate)
+{
+    for(int32_t failAfter = 0; failAfter < 200; ++failAfter)
+        {
+        SCOPED_TRACE(testing::Message() << "failAfter " << failAfter);
+        NVKVJournalTest::CountingStore<32> s;
+        OTV0P2BASE::NVKVJournal<2, 4> j(s);
+        j.begin();
+        const uint8_t other[] = { 7 };
+        ASSERT_TRUE(j.put(1, other, 1));
+        uint8_t last = 0;
+        s.writesLeft = failAfter;
+        // Enough updates to force compactions into a bank of 16.
+        for(uint8_t i = 1; i < 20; ++i)
+            {
+            const uint8_t v[] = { i, uint8_t(~i) };
+            if(!j.put(0, v, 2)) { break; }
+            last = i;
+            }
+        // Remount after the "reset" with writes working again.
+        s.writesLeft = -1;
+        OTV0P2BASE::NVKVJournal<2, 4> j2(s);
+        EXPECT_TRUE(j2.begin());
+        uint8_t buf[4];
+        const int8_t len = j2.get(0, buf, sizeof(buf));
+        if(0 == last) { EXPECT_TRUE((-1 == len) || ((2 == len) && (1 == buf[0]))); }
+        else
+            {
+            ASSERT_EQ(2, len);
+            EXPECT_TRUE((last == buf[0]) || (last + 1 == buf[0]));
+            EXPECT_EQ(uint8_t(~buf[0]), buf[1]);
+            }
+        EXPECT_EQ(1, j2.get(1, buf, sizeof(buf)));
+        EXPECT_EQ(7, buf[0]);
+        // Still usable.
+        const uint8_t v[] = { 99, 98 };
+        EXPECT_TRUE(j2.put(0, v, 2));
+        EXPECT_EQ(2, j2.get(0, buf, sizeof(buf)));
+        EXPECT_EQ(99, buf[0]);
+        }
+}
@@ -38,3 +38,16 @@ TEST(OTV0p2Base,parseHex)
     // The compiler can't find this for some reason (function def in source file).
     EXPECT_EQ(10, OTV0P2BASE::parseHexByte(s));
 }
+
+// Check default split-phase (start/collect) sensor behaviour:
+// start always succeeds, always ready, collect() is read().
+TEST(OTV0p2Base,SensorSplitPhaseDefaults)
+{
+    OTV0P2BASE::TemperatureC16Mock t;
+    t.set(21 << 4);
+    OTV0P2BASE::Sensor<int16_t> &s = t;
+    EXPECT_TRUE(s.startRead());
+    EXPECT_TRUE(s.isReady());
+    EXPECT_EQ(21 << 4, s.collect());
+    EXPECT_EQ(21 << 4, s.get());
+}
@@ -0,0 +1,138 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * OTV0P2BASE Profiler tests.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+
+#include "OTV0P2BASE_Profiler.h"
+#include "OTV0P2BASE_JSONStats.h"
+
+
+namespace PTest {
+// Sites, as an app would declare them.
+enum { P_LOOP, P_POLLIO, P_RX, P_SITES };
+static const char *const names[P_SITES] = { "loop", "pollIO", "rx" };
+
+// Manually-advanced clock, wrapping as sub-cycle ticks do.
+static uint32_t fakeTime;
+static uint32_t getFakeTime() { return(fakeTime); }
+
+// Nests a probe below the caller's frame to use some stack.
+static void __attribute__((noinline)) nested(OTV0P2BASE::ProfilerBase &p, const int depth)
+{
+    volatile uint8_t pad[64];
+    pad[0] = uint8_t(depth);
+    OTV0P2BASE::ProfileProbe probe(p, P_RX);
+    if(depth > 0) { nested(p, depth - 1); }
+    (void)pad[0];
+}
+}
+
+// Counts, min/max/total durations and wrap of the time source.
+TEST(Profiler,basics)
+{
+    OTV0P2BASE::Profiler<PTest::P_SITES> p(PTest::names, PTest::getFakeTime, 0xff);
+    EXPECT_EQ(PTest::P_SITES, p.getSites());
+    EXPECT_STREQ("pollIO", p.getName(PTest::P_POLLIO));
+    EXPECT_EQ(NULL, p.getName(PTest::P_SITES));
+    EXPECT_EQ(0U, p.getSite(PTest::P_LOOP).calls);
+    PTest::fakeTime = 10;
+    { OTV0P2BASE::ProfileProbe probe(p, PTest::P_LOOP); PTest::fakeTime += 5; }
+    { OTV0P2BASE::ProfileProbe probe(p, PTest::P_LOOP); PTest::fakeTime += 20; }
+    // Spans the sub-cycle wrap from 250 to 4.
+    PTest::fakeTime = 250;
+    { OTV0P2BASE::ProfileProbe probe(p, PTest::P_POLLIO); PTest::fakeTime = 4; }
+    // Out of range sites are ignored.
+    { OTV0P2BASE::ProfileProbe probe(p, PTest::P_SITES); }
+    const OTV0P2BASE::ProfilerBase::site_t l = p.getSite(PTest::P_LOOP);
+    EXPECT_EQ(2U, l.calls);
+    EXPECT_EQ(5U, l.minDur);
+    EXPECT_EQ(20U, l.maxDur);
+    EXPECT_EQ(25U, l.total);
+    const OTV0P2BASE::ProfilerBase::site_t io = p.getSite(PTest::P_POLLIO);
+    EXPECT_EQ(1U, io.calls);
+    EXPECT_EQ(10U, io.maxDur);
+    EXPECT_EQ(0U, p.getSite(PTest::P_RX).calls);
+    p.reset();
+    EXPECT_EQ(0U, p.getSite(PTest::P_LOOP).calls);
+    EXPECT_EQ(0U, p.getSite(PTest::P_LOOP).total);
+}
+
+// Stack high-water grows with nesting, and the host clock runs forwards.
+TEST(Profiler,stackAndHostTime)
+{
+    OTV0P2BASE::Profiler<PTest::P_SITES> p(PTest::names);
+    p.setStackBase(OTV0P2BASE::getSP());
+    PTest::nested(p, 0);
+    const uint16_t shallow = p.getSite(PTest::P_RX).maxStack;
+    PTest::nested(p, 4);
+    const OTV0P2BASE::ProfilerBase::site_t s = p.getSite(PTest::P_RX);
+    EXPECT_EQ(6U, s.calls);
+    EXPECT_LT(0, shallow);
+    EXPECT_LT(shallow + 4*64, s.maxStack);
+    EXPECT_LE(s.maxDur, s.total);
+}
+
+// JSON and binary reports, and putting into a stats set.
+TEST(Profiler,reports)
+{
+    const bool verbose = false;
+    OTV0P2BASE::Profiler<PTest::P_SITES> p(PTest::names, PTest::getFakeTime, 0xff);
+    p.setStackBase(0); // All stack depths 0.
+    PTest::fakeTime = 0;
+    { OTV0P2BASE::ProfileProbe probe(p, PTest::P_POLLIO); PTest::fakeTime = 3; }
+    char buf[128];
+    OTV0P2BASE::BufPrint bp(buf, sizeof(buf));
+    const size_t n = p.printJSON(bp);
+    if(verbose) { printf("%s\n", buf); }
+    EXPECT_EQ(strlen(buf), n);
+    EXPECT_STREQ("{\"prof\":{\"loop\":[0,0,0,0,0],\"pollIO\":[1,3,3,3,0],\"rx\":[0,0,0,0,0]}}", buf);
+
+    uint8_t bin[2 + PTest::P_SITES * OTV0P2BASE::ProfilerBase::BINARY_SITE_BYTES];
+    EXPECT_EQ(0, p.writeBinary(bin, sizeof(bin) - 1));
+    ASSERT_EQ(sizeof(bin), p.writeBinary(bin, sizeof(bin)));
+    EXPECT_EQ(OTV0P2BASE::ProfilerBase::BINARY_VERSION, bin[0]);
+    EXPECT_EQ(PTest::P_SITES, bin[1]);
+    const uint8_t *const io = bin + 2 + OTV0P2BASE::ProfilerBase::BINARY_SITE_BYTES;
+    EXPECT_EQ(1, io[0]); // calls
+    EXPECT_EQ(3, io[4]); // min
+    EXPECT_EQ(3, io[8]); // max
+    EXPECT_EQ(3, io[12]); // total
+
+    OTV0P2BASE::SimpleStatsRotation<4> rs;
+    p.putMaxDurations(rs);
+    EXPECT_EQ(PTest::P_SITES, rs.size());
+    EXPECT_TRUE(rs.containsKey("pollIO"));
+}
+
+// The default host clock reports in nanoseconds.
+TEST(Profiler,hostJSONUnits)
+{
+    static const char *const oneName[1] = { "loop" };
+    OTV0P2BASE::Profiler<1> p(oneName);
+    { OTV0P2BASE::ProfileProbe probe(p, 0); }
+    char buf[64];
+    OTV0P2BASE::BufPrint bp(buf, sizeof(buf));
+    p.printJSON(bp);
+    EXPECT_EQ(0, strncmp("{\"u\":\"ns\",\"prof\":{\"loop\":[1,", buf, 26));
+}
@@ -0,0 +1,168 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * Sensor polling scheduler tests.
+ */
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include "OTV0p2Base.h"
+
+
+namespace SPSTest {
+// Records start/collect calls and bus power changes in order.
+static std::string trace;
+static int busUps, busDowns;
+static bool busUp() { ++busUps; trace += '+'; return(true); }
+static void busDown() { ++busDowns; trace += '-'; }
+
+// Sensor with a given poll interval, tracing calls with its (lower/upper case) name.
+class TracingSensor final : public OTV0P2BASE::SimpleTSUint8Sensor
+{
+    const char name;
+    const uint8_t interval;
+public:
+    uint32_t reads = 0;
+    TracingSensor(const char n, const uint8_t i) : name(n), interval(i) { }
+    virtual uint8_t read() override { startRead(); return(collect()); }
+    virtual bool startRead() override { trace += char(name + ('a' - 'A')); return(true); }
+    virtual uint8_t collect() override { trace += name; return(value = uint8_t(++reads)); }
+    virtual uint8_t preferredPollInterval_s() const override { return(interval); }
+};
+}
+
+// Registration uses the preferred interval unless overridden, and is bounded.
+TEST(SensorPollScheduler,Registration)
+{
+    typedef OTV0P2BASE::SensorPollScheduler<2> sps_t;
+    sps_t s;
+    EXPECT_EQ(~uint32_t(0), s.getNextWake());
+    EXPECT_EQ(0, s.poll(1000));
+    SPSTest::TracingSensor noInterval('A', 0), a('B', 60);
+    EXPECT_FALSE(s.add(noInterval));
+    EXPECT_TRUE(s.add(noInterval, sps_t::BUS_NONE, 0, 30, 5));
+    EXPECT_FALSE(s.add(a, sps_t::MAX_BUS + 1));
+    EXPECT_TRUE(s.add(a, sps_t::BUS_NONE, 0, 0, 10));
+    EXPECT_FALSE(s.add(a));
+    EXPECT_EQ(2, s.getSensorCount());
+    EXPECT_EQ(5U, s.getNextWake());
+    EXPECT_FALSE(s.isDue(4));
+    EXPECT_EQ(0, s.poll(4));
+    EXPECT_EQ(0U, s.getWakes());
+    // Second sensor is pulled forward into the first wake (10 <= 5 + 60/4).
+    EXPECT_EQ(2, s.poll(5));
+    EXPECT_EQ(35U, s.getNextWake());
+    EXPECT_EQ(1U, noInterval.reads);
+    EXPECT_EQ(1U, a.reads);
+}
+
+// Independent sensors are started first, slowest first, and collected last;
+// sensors on a bus are read one at a time within one power-up window.
+TEST(SensorPollScheduler,BusBatching)
+{
+    typedef OTV0P2BASE::SensorPollScheduler<> sps_t;
+    SPSTest::trace.clear();
+    SPSTest::busUps = 0;
+    SPSTest::busDowns = 0;
+    sps_t s;
+    SPSTest::TracingSensor fast('F', 60), slow('S', 60), t('T', 60), h('H', 60), d('D', 60);
+    EXPECT_TRUE(s.add(fast, sps_t::BUS_NONE, 1));
+    EXPECT_TRUE(s.add(t, sps_t::BUS_I2C, 85));
+    EXPECT_TRUE(s.add(slow, sps_t::BUS_NONE, 100));
+    EXPECT_TRUE(s.add(h, sps_t::BUS_I2C, 29));
+    EXPECT_TRUE(s.add(d, sps_t::BUS_ONEWIRE, 750));
+    s.setBusPower(sps_t::BUS_I2C, SPSTest::busUp, SPSTest::busDown);
+    // The slow 1-Wire sensor is started but collected on the next wake.
+    EXPECT_EQ(4, s.poll(0));
+    EXPECT_EQ("sf+tThH-dSF", SPSTest::trace);
+    EXPECT_EQ(1U, s.getNextWake());
+    EXPECT_EQ(1, s.poll(1));
+    EXPECT_EQ("sf+tThH-dSFD", SPSTest::trace);
+    EXPECT_EQ(1, SPSTest::busUps);
+    EXPECT_EQ(1, SPSTest::busDowns);
+    EXPECT_EQ(1U, s.getBusPowerUps());
+    // Nothing more until the next interval, when the slow sensor is started a second early.
+    EXPECT_EQ(60U, s.getNextWake());
+    EXPECT_EQ(0, s.poll(59));
+    EXPECT_EQ(4, s.poll(60));
+    EXPECT_EQ(1, s.poll(61));
+    EXPECT_EQ(2, SPSTest::busUps);
+}
+
+// Slow sensors are started ahead by their latency so as to be collected when due,
+// holding any bus until then.
+TEST(SensorPollScheduler,LatencyLead)
+{
+    typedef OTV0P2BASE::SensorPollScheduler<> sps_t;
+    SPSTest::trace.clear();
+    SPSTest::busUps = 0;
+    SPSTest::busDowns = 0;
+    sps_t s;
+    SPSTest::TracingSensor slow('S', 60), a('A', 60), d('D', 60), e('E', 60);
+    EXPECT_TRUE(s.add(slow, sps_t::BUS_NONE, 2000, 0, 10));
+    EXPECT_TRUE(s.add(a, sps_t::BUS_NONE, 10, 0, 10));
+    EXPECT_TRUE(s.add(d, sps_t::BUS_ONEWIRE, 750, 0, 10));
+    EXPECT_TRUE(s.add(e, sps_t::BUS_ONEWIRE, 0, 0, 10));
+    s.setBusPower(sps_t::BUS_ONEWIRE, SPSTest::busUp, SPSTest::busDown);
+    EXPECT_EQ(8U, s.getNextWake());
+    // The fast sensor rides along with the early start; the bus is held by the 1-Wire start.
+    EXPECT_EQ(1, s.poll(8));
+    EXPECT_EQ("sa+dA", SPSTest::trace);
+    EXPECT_EQ(10U, s.getNextWake());
+    EXPECT_EQ(0, s.poll(9));
+    // Both slow sensors are collected when due, then the rest of the bus is read.
+    EXPECT_EQ(3, s.poll(10));
+    EXPECT_EQ("sa+dADeE-S", SPSTest::trace);
+    EXPECT_EQ(1, SPSTest::busUps);
+    EXPECT_EQ(1, SPSTest::busDowns);
+    // The slow sensors stay on phase.
+    EXPECT_EQ(68U, s.getNextWake());
+    EXPECT_EQ(1U, slow.reads);
+    EXPECT_EQ(2U, s.getWakes());
+}
+
+// Sensors with similar intervals share wakes,
+// while each keeps its long-run rate.
+TEST(SensorPollScheduler,FewerWakes)
+{
+    typedef OTV0P2BASE::SensorPollScheduler<> sps_t;
+    sps_t s;
+    SPSTest::TracingSensor a('A', 60), b('B', 64), c('C', 120);
+    EXPECT_TRUE(s.add(a));
+    EXPECT_TRUE(s.add(b, sps_t::BUS_NONE, 0, 0, 4));
+    EXPECT_TRUE(s.add(c, sps_t::BUS_NONE, 0, 0, 7));
+    uint32_t naiveWakes = 0;
+    for(uint32_t t = 0; t < 3600; ++t) {
+        if((0 == (t % 60)) || ((t >= 4) && (0 == ((t - 4) % 64))) || ((t >= 7) && (0 == ((t - 7) % 120)))) { ++naiveWakes; }
+        // Sleep code wakes only when told to.
+        if(t < s.getNextWake()) { continue; }
+        EXPECT_LT(0, s.poll(t));
+    }
+    // Early reads may bring one extra read into the hour.
+    EXPECT_NEAR(3600 / 60, int(a.reads), 1);
+    EXPECT_NEAR(3600 / 64, int(b.reads), 1);
+    EXPECT_NEAR(3600 / 120, int(c.reads), 1);
+    EXPECT_EQ(a.reads + b.reads + c.reads, s.getReads());
+    EXPECT_EQ(144U, naiveWakes);
+    // Most B and C reads ride along with other wakes.
+    EXPECT_GT(100U, s.getWakes());
+}
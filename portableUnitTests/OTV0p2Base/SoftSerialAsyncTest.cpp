@@ -0,0 +1,79 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * Driver for OTSoftSerialAsync portable component tests.
+ */
+
+#include <stdint.h>
+#include <gtest/gtest.h>
+#include <OTV0p2Base.h>
+
+#include "OTV0P2BASE_SoftSerialAsync.h"
+
+
+// Basic FIFO behaviour of the ISR RX ring buffer.
+TEST(SoftSerialAsync,RingBufferBasics)
+{
+    OTV0P2BASE::ISRRXByteRingBuffer<4> rb;
+    EXPECT_EQ(4, rb.capacity());
+    EXPECT_EQ(0, rb.size());
+    EXPECT_EQ(-1, rb.peek());
+    EXPECT_EQ(-1, rb.pop());
+    EXPECT_TRUE(rb.push('a'));
+    EXPECT_TRUE(rb.push(0xff));
+    EXPECT_EQ(2, rb.size());
+    EXPECT_EQ('a', rb.peek());
+    EXPECT_EQ('a', rb.pop());
+    EXPECT_EQ(0xff, rb.pop());
+    EXPECT_EQ(-1, rb.pop());
+    EXPECT_EQ(0, rb.size());
+}
+
+// Overrun drops new bytes, keeps old ones, and is counted.
+TEST(SoftSerialAsync,RingBufferOverrun)
+{
+    OTV0P2BASE::ISRRXByteRingBuffer<4> rb;
+    for(uint8_t i = 0; i < 4; ++i) { EXPECT_TRUE(rb.push(i)); }
+    EXPECT_EQ(0, rb.getOverruns());
+    EXPECT_FALSE(rb.push(42));
+    EXPECT_EQ(1, rb.getOverruns());
+    EXPECT_EQ(4, rb.size());
+    for(uint8_t i = 0; i < 4; ++i) { EXPECT_EQ(i, rb.pop()); }
+    // Space is available again.
+    EXPECT_TRUE(rb.push(43));
+    rb.clear();
+    EXPECT_EQ(0, rb.size());
+    EXPECT_EQ(-1, rb.peek());
+}
+
+// Free-running indices must wrap cleanly through 255 -> 0 many times.
+TEST(SoftSerialAsync,RingBufferWrap)
+{
+    OTV0P2BASE::ISRRXByteRingBuffer<32> rb;
+    uint8_t in = 0, out = 0;
+    for(int round = 0; round < 1000; ++round) {
+        // Interleave bursts of writes and reads of varying lengths.
+        const uint8_t w = (uint8_t)(1 + (round % 31));
+        for(uint8_t i = 0; i < w; ++i) { ASSERT_TRUE(rb.push(in++)); }
+        ASSERT_EQ(w, rb.size());
+        for(uint8_t i = 0; i < w; ++i) { ASSERT_EQ(out++, rb.pop()); }
+        ASSERT_EQ(0, rb.size());
+    }
+    EXPECT_EQ(0, rb.getOverruns());
+}
@@ -21,6 +21,7 @@ Author(s) / Copyright (s): Damon Hart-Davis 2017
  */
 
 #include <stdint.h>
+#include <vector>
 #include <gtest/gtest.h>
 #include <OTV0p2Base.h>
 #include <OTRadValve.h>
@@ -129,3 +130,87 @@ TEST(SystemStatsLine,Basics)
 //    ASSERT_EQ('\0', Basics::buf[0]);
 }
 
+
+// Binary records round trip, and can be bulk-decoded from a capture mixed with text lines.
+namespace Binary
+    {
+    // Captures all output bytes.
+    class CapturePrint final : public Print
+        {
+        public:
+            std::vector<uint8_t> bytes;
+            size_t writes = 0;
+            virtual size_t write(uint8_t c) override { bytes.push_back(c); return(1); }
+            virtual size_t write(const uint8_t *buf, size_t size) override { ++writes; bytes.insert(bytes.end(), buf, buf + size); return(size); }
+        };
+    static CapturePrint cp;
+    static OTRadValve::ValveMode valveMode;
+    static OTRadValve::RadValveMock modelledRadValve;
+    static OTV0P2BASE::TemperatureC16Mock tempC16;
+    static OTV0P2BASE::HumiditySensorMock rh;
+    }
+TEST(SystemStatsLine,Binary)
+{
+    Binary::cp.bytes.clear();
+    Binary::valveMode.reset();
+    Binary::modelledRadValve.reset();
+    Binary::tempC16.set(-((2 << 4) + 3));
+    Binary::rh.set(61);
+    OTV0P2BASE::SystemStatsLine<
+        decltype(Binary::valveMode), &Binary::valveMode,
+        decltype(Binary::modelledRadValve), &Binary::modelledRadValve,
+        decltype(Binary::tempC16), &Binary::tempC16,
+        decltype(Binary::rh), &Binary::rh,
+        OTV0P2BASE::SensorAmbientLightBase, (OTV0P2BASE::SensorAmbientLightBase *)NULL,
+        OTV0P2BASE::PseudoSensorOccupancyTracker, (OTV0P2BASE::PseudoSensorOccupancyTracker *)NULL,
+        OTRadValve::SimpleValveScheduleBase, (OTRadValve::SimpleValveScheduleBase *)NULL,
+        false,
+        decltype(Binary::cp), &Binary::cp> ssl;
+    EXPECT_FALSE(ssl.isBinaryMode());
+    ssl.serialStatusReport();
+    std::vector<uint8_t> capture(Binary::cp.bytes);
+    EXPECT_EQ('=', capture[0]);
+    const size_t textLen = capture.size();
+
+    ssl.setBinaryMode(true);
+    Binary::cp.bytes.clear();
+    Binary::cp.writes = 0;
+    ssl.serialStatusReport();
+    // Sent in one burst: '#' len version flags valve temp(2) rh crc CR LF.
+    EXPECT_EQ(1U, Binary::cp.writes);
+    ASSERT_EQ(11U, Binary::cp.bytes.size());
+    EXPECT_EQ(OTV0P2BASE::SERLINE_START_CHAR_BSTATS, Binary::cp.bytes[0]);
+    EXPECT_EQ(6, Binary::cp.bytes[1]);
+    OTV0P2BASE::BinaryStatusRecord r;
+    EXPECT_EQ(11, r.decode(Binary::cp.bytes.data(), Binary::cp.bytes.size()));
+    EXPECT_EQ('F', r.getModeChar());
+    EXPECT_EQ(-((2 << 4) + 3), r.tempC16);
+    EXPECT_EQ(61, r.rh);
+    EXPECT_EQ(0, r.flags & OTV0P2BASE::BinaryStatusRecord::HAS_OCC);
+    capture.insert(capture.end(), Binary::cp.bytes.begin(), Binary::cp.bytes.end());
+
+    // A corrupted record and another good one with all fields.
+    const size_t corruptAt = capture.size();
+    capture.insert(capture.end(), Binary::cp.bytes.begin(), Binary::cp.bytes.end());
+    capture[corruptAt + 5] ^= 1;
+    OTV0P2BASE::BinaryStatusRecord all;
+    all.flags = OTV0P2BASE::BinaryStatusRecord::MODE_BAKE | 0x7c;
+    all.valvePC = 100;
+    all.tempC16 = 0x7fff;
+    all.occ = 42;
+    uint8_t buf[OTV0P2BASE::BinaryStatusRecord::MAX_FRAME_BYTES];
+    EXPECT_EQ(0, all.encode(buf, sizeof(buf) - 1));
+    const uint8_t n = all.encode(buf, sizeof(buf));
+    EXPECT_EQ(OTV0P2BASE::BinaryStatusRecord::MAX_FRAME_BYTES, n);
+    capture.insert(capture.end(), buf, buf + n);
+    capture.push_back('#'); // Truncated.
+
+    OTV0P2BASE::BinaryStatusRecord out[4];
+    size_t skipped;
+    ASSERT_EQ(2U, OTV0P2BASE::BinaryStatusRecord::decodeBatch(capture.data(), capture.size(), out, 4, &skipped));
+    EXPECT_EQ(textLen + 11 + 1, skipped);
+    EXPECT_EQ(61, out[0].rh);
+    EXPECT_EQ('B', out[1].getModeChar());
+    EXPECT_EQ(0x7fff, out[1].tempC16);
+    EXPECT_EQ(42, out[1].occ);
+}
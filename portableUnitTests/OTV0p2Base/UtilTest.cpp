@@ -109,3 +109,43 @@ TEST(ScratchSpace,basics)
     EXPECT_EQ(sizeof(buf)-4, sss4.bufsize);
 }
 
+// Test ScratchArena allocation, marks, overflow detection and compile-time sizing.
+TEST(ScratchArena,basics)
+{
+    static_assert(0 == OTV0P2BASE::scratchSum(), "");
+    static_assert(20 == OTV0P2BASE::scratchSum(12, 8), "");
+    static_assert(12 == OTV0P2BASE::scratchMax(6, 12, 8), "");
+    static_assert(26 == OTV0P2BASE::scratchSum(6, OTV0P2BASE::scratchMax(12, 20)), "");
+
+    OTV0P2BASE::ScratchArena bad(NULL, 10);
+    EXPECT_EQ(0U, bad.getSize());
+    EXPECT_EQ(NULL, bad.alloc(1));
+    EXPECT_TRUE(bad.overflowed());
+
+    // Larger than a ScratchSpace can describe.
+    uint8_t buf[300];
+    OTV0P2BASE::ScratchArena a(buf, sizeof(buf));
+    EXPECT_EQ(buf, a.alloc(12));
+    {
+        OTV0P2BASE::ScratchArena::Mark m(a);
+        EXPECT_EQ(buf + 12, a.alloc(280));
+        EXPECT_EQ(8U, a.remaining());
+        const OTV0P2BASE::ScratchSpaceL r(a.rest());
+        EXPECT_EQ(buf + 292, r.buf);
+        EXPECT_EQ(8U, r.bufsize);
+        EXPECT_FALSE(a.overflowed());
+        EXPECT_EQ(NULL, a.alloc(9));
+        EXPECT_TRUE(a.overflowed());
+    }
+    // Released back to the mark.
+    EXPECT_EQ(12U, a.used());
+    EXPECT_EQ(292U, a.highWater());
+    EXPECT_EQ(buf + 12, a.alloc(1));
+    // Full use leaves no callee space.
+    OTV0P2BASE::ScratchSpaceL ss(buf, 20);
+    OTV0P2BASE::ScratchArena b(ss);
+    EXPECT_NE((uint8_t *)NULL, b.alloc(20));
+    EXPECT_EQ(NULL, b.rest().buf);
+    EXPECT_EQ(0U, b.rest().bufsize);
+}
+
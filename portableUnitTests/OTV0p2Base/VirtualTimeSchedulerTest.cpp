@@ -0,0 +1,113 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): agent 2026
+*/
+
+/*
+ * Virtual-time scheduler tests.
+ */
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include "OTV0p2Base.h"
+
+
+namespace VTSTest {
+// Records the order in which tasks run.
+static std::string trace;
+static void appendA(void *) { trace += 'A'; }
+static void appendB(void *) { trace += 'B'; }
+static void appendC(void *) { trace += 'C'; }
+// Counts calls.
+static void count(void *ctx) { ++*static_cast<uint32_t *>(ctx); }
+
+// Sensor counting its reads.
+class CountingSensor final : public OTV0P2BASE::SimpleTSUint8Sensor
+{
+public:
+    uint32_t reads = 0;
+    virtual uint8_t read() override { ++reads; return(value = uint8_t(reads)); }
+    virtual uint8_t preferredPollInterval_s() const override { return(60); }
+};
+}
+
+// Events run in time order, with ties in scheduling order.
+TEST(VirtualTimeScheduler,Ordering)
+{
+    namespace VT = OTV0P2BASE::VirtualTime;
+    VTSTest::trace.clear();
+    VT::Scheduler<4> s;
+    EXPECT_EQ(0, s.addTask(VTSTest::appendA, NULL, VT::seconds(2)));
+    EXPECT_EQ(1, s.addTask(VTSTest::appendB, NULL, VT::seconds(1)));
+    EXPECT_EQ(2, s.addTask(VTSTest::appendC, NULL, VT::seconds(2)));
+    EXPECT_EQ(-1, s.addTask(NULL, NULL, 0));
+    EXPECT_EQ(3U, s.runFor(VT::seconds(10)));
+    EXPECT_EQ("BAC", VTSTest::trace);
+    EXPECT_EQ(VT::seconds(10), s.getTime());
+    // One-shot slots are reused.
+    EXPECT_EQ(0, s.addTask(VTSTest::appendA, NULL, 0));
+    EXPECT_EQ(1U, s.runFor(0));
+    // Periodic tasks interleave deterministically.
+    VTSTest::trace.clear();
+    s.addTask(VTSTest::appendA, NULL, 0, VT::seconds(2));
+    s.addTask(VTSTest::appendB, NULL, 0, VT::seconds(3));
+    s.runFor(VT::seconds(6));
+    EXPECT_EQ("ABABABA", VTSTest::trace); // At 6s B was rescheduled first.
+    // Capacity is bounded.
+    EXPECT_LE(0, s.addTask(VTSTest::appendC, NULL, 1, 1));
+    EXPECT_LE(0, s.addTask(VTSTest::appendC, NULL, 1, 1));
+    EXPECT_EQ(-1, s.addTask(VTSTest::appendC, NULL, 1, 1));
+}
+
+// The RTC and sub-cycle time follow virtual time.
+TEST(VirtualTimeScheduler,DrivesRTC)
+{
+    namespace VT = OTV0P2BASE::VirtualTime;
+    VT::Scheduler<> s(VT::at(6000, 23, 59, 58));
+    EXPECT_EQ(23 * 60 + 59, OTV0P2BASE::getMinutesSinceMidnightLT());
+    EXPECT_EQ(58, OTV0P2BASE::getSecondsLT());
+    EXPECT_EQ(6000, OTV0P2BASE::getDaysSince1999LT());
+    EXPECT_EQ(0, VT::getSubCycleTimeVT());
+    s.runFor(VT::TICKS_PER_S + 10);
+    EXPECT_EQ(59, OTV0P2BASE::getSecondsLT());
+    EXPECT_EQ(VT::TICKS_PER_S + 10, VT::getSubCycleTimeVT());
+    s.runFor(VT::seconds(1));
+    EXPECT_EQ(0, OTV0P2BASE::getMinutesSinceMidnightLT());
+    EXPECT_EQ(6001, OTV0P2BASE::getDaysSince1999LT());
+    EXPECT_EQ(10, VT::getSubCycleTimeVT());
+}
+
+// Long idle gaps are skipped: months of sparse events run quickly.
+TEST(VirtualTimeScheduler,SkipsIdleTime)
+{
+    namespace VT = OTV0P2BASE::VirtualTime;
+    VT::Scheduler<> s;
+    uint32_t fourMinuteCalls = 0;
+    uint32_t hourlyCalls = 0;
+    VTSTest::CountingSensor sensor;
+    s.addTask(VTSTest::count, &fourMinuteCalls, VT::minutes(4), VT::minutes(4));
+    s.addTask(VTSTest::count, &hourlyCalls, 0, VT::minutes(60));
+    EXPECT_LE(0, s.addSensor(sensor));
+    const uint16_t days = 120;
+    s.runFor(VT::at(days, 0, 0));
+    EXPECT_EQ(days * 24U * 15U, fourMinuteCalls);
+    EXPECT_EQ(days * 24U + 1, hourlyCalls);
+    EXPECT_EQ(days * 24U * 60U + 1, sensor.reads);
+    EXPECT_EQ(days, OTV0P2BASE::getDaysSince1999LT());
+}